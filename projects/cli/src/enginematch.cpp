@@ -17,6 +17,7 @@
 
 #include "enginematch.h"
 #include <QMultiMap>
+#include "metricsexporter.h"
 #include <chessplayer.h>
 #include <playerbuilder.h>
 #include <chessgame.h>
@@ -32,6 +33,8 @@ EngineMatch::EngineMatch(Tournament* tournament, QObject* parent)
 	  m_debug(false),
 	  m_ratingInterval(0),
 	  m_outcomeInterval(0),
+	  m_latencyReport(false),
+	  m_metricsExporter(nullptr),
 	  m_bookMode(OpeningBook::Ram)
 {
 	Q_ASSERT(tournament != nullptr);
@@ -77,6 +80,9 @@ void EngineMatch::start()
 		connect(m_tournament->gameManager(), SIGNAL(debugMessage(QString)),
 			this, SLOT(print(QString)));
 
+	if (m_metricsExporter != nullptr)
+		m_metricsExporter->start();
+
 	QMetaObject::invokeMethod(m_tournament, "start", Qt::QueuedConnection);
 }
 
@@ -102,6 +108,18 @@ void EngineMatch::setOutcomeInterval(int interval)
 	m_outcomeInterval = interval;
 }
 
+void EngineMatch::setLatencyReport(bool enabled)
+{
+	m_latencyReport = enabled;
+}
+
+MetricsExporter* EngineMatch::metricsExporter()
+{
+	if (m_metricsExporter == nullptr)
+		m_metricsExporter = new MetricsExporter(m_tournament, this);
+	return m_metricsExporter;
+}
+
 void EngineMatch::setBookMode(OpeningBook::AccessMode mode)
 {
 	m_bookMode = mode;
@@ -159,10 +177,30 @@ void EngineMatch::onTournamentFinished()
 	||  m_tournament->finishedGameCount() % m_outcomeInterval != 0)
 		printOutcomes();
 
+	if (m_latencyReport)
+		printLatencies();
+	if (m_metricsExporter != nullptr)
+		m_metricsExporter->stop();
+
 	QString error = m_tournament->errorString();
 	if (!error.isEmpty())
 		qWarning("%s", qUtf8Printable(error));
 
+	const GameManager* manager = m_tournament->gameManager();
+	int hits = manager->playerPoolHits();
+	int misses = manager->playerPoolMisses();
+	if (hits + misses > 0)
+		qInfo("Engines reused from pool: %d of %d (%.1f%%)",
+		      hits, hits + misses, 100.0 * hits / (hits + misses));
+
+	const auto loads = manager->workerLoads();
+	for (int i = 0; i < loads.size(); i++)
+	{
+		const auto& load = loads.at(i);
+		qInfo("Worker %d: %d games, %.1f%% busy",
+		      i + 1, load.totalGames, 100.0 * load.utilization);
+	}
+
 	qInfo("Finished match");
 	connect(m_tournament->gameManager(), SIGNAL(finished()),
 		this, SIGNAL(finished()));
@@ -183,3 +221,42 @@ void EngineMatch::printOutcomes()
 {
 	qInfo("%s", qUtf8Printable(m_tournament->outcomes()));
 }
+
+void EngineMatch::printLatencies()
+{
+	auto format = [](qint64 nsecs)
+	{
+		if (nsecs < 1000)
+			return QString("%1ns").arg(nsecs);
+		if (nsecs < 1000000)
+			return QString("%1us").arg(nsecs / 1000.0, 0, 'f', 1);
+		if (nsecs < 1000000000)
+			return QString("%1ms").arg(nsecs / 1000000.0, 0, 'f', 2);
+		return QString("%1s").arg(nsecs / 1000000000.0, 0, 'f', 3);
+	};
+
+	for (int i = 0; i < m_tournament->playerCount(); i++)
+	{
+		const TournamentPlayer& player = m_tournament->playerAt(i);
+		const MoveLatency& latency = player.moveLatency();
+		if (latency.count() == 0)
+			continue;
+
+		qInfo("Move latency of %s (%llu moves):",
+		      qUtf8Printable(player.name()), latency.count());
+		qInfo("%-10s %10s %10s %10s %10s %10s",
+		      "Stage", "Mean", "50%", "90%", "99%", "Max");
+		for (int j = 0; j < MoveLatency::StageCount; j++)
+		{
+			const auto stage = MoveLatency::Stage(j);
+			const LatencyHistogram& h = latency.histogram(stage);
+			qInfo("%-10s %10s %10s %10s %10s %10s",
+			      qUtf8Printable(MoveLatency::stageName(stage)),
+			      qUtf8Printable(format(h.mean())),
+			      qUtf8Printable(format(h.percentile(50))),
+			      qUtf8Printable(format(h.percentile(90))),
+			      qUtf8Printable(format(h.percentile(99))),
+			      qUtf8Printable(format(h.max())));
+		}
+	}
+}
@@ -28,6 +28,7 @@
 class ChessGame;
 class OpeningBook;
 class Tournament;
+class MetricsExporter;
 
 
 class EngineMatch : public QObject
@@ -42,6 +43,8 @@ class EngineMatch : public QObject
 		void setDebugMode(bool debug);
 		void setRatingInterval(int interval);
 		void setOutcomeInterval(int interval);
+		void setLatencyReport(bool enabled);
+		MetricsExporter* metricsExporter();
 		void setBookMode(OpeningBook::AccessMode mode);
 
 		void start();
@@ -59,11 +62,14 @@ class EngineMatch : public QObject
 	private:
 		void printRanking();
 		void printOutcomes();
+		void printLatencies();
 
 		Tournament* m_tournament;
 		bool m_debug;
 		int m_ratingInterval;
 		int m_outcomeInterval;
+		bool m_latencyReport;
+		MetricsExporter* m_metricsExporter;
 		OpeningBook::AccessMode m_bookMode;
 		QMap<QString, OpeningBook*> m_books;
 		QElapsedTimer m_startTime;
@@ -26,6 +26,7 @@
 #include <QFile>
 #include <QMetaType>
 #include <QSysInfo>
+#include <QScopedPointer>
 
 #include <mersenne.h>
 #include <enginemanager.h>
@@ -37,6 +38,12 @@
 #include <enginefactory.h>
 #include <enginetextoption.h>
 #include <openingsuite.h>
+#include <coreslots.h>
+#include <compressiondevice.h>
+#include <outputwriter.h>
+#include <gamearchive.h>
+#include <pgnstream.h>
+#include <tournamentjournal.h>
 #include <sprt.h>
 #include <board/syzygytablebase.h>
 #include <board/result.h>
@@ -44,6 +51,7 @@
 #include "cutechesscoreapp.h"
 #include "matchparser.h"
 #include "enginematch.h"
+#include "metricsexporter.h"
 
 namespace {
 
@@ -253,6 +261,109 @@ bool parseEngine(const QStringList& args, EngineData& data)
 	return true;
 }
 
+bool isCompressionSupported(const QString& fileName)
+{
+	auto codec = CompressionDevice::codecForFileName(fileName);
+	if (CompressionDevice::isSupported(codec))
+		return true;
+
+	qWarning("%s compression is not supported by this build",
+		 qUtf8Printable(CompressionDevice::codecName(codec)));
+	return false;
+}
+
+// Converts the games in file "input" between PGN and the binary game
+// archive format. The formats are chosen by the file name suffixes.
+int convertGames(const QString& input, const QString& output)
+{
+	if (!isCompressionSupported(input) || !isCompressionSupported(output))
+		return 1;
+	if (QFile::exists(output))
+	{
+		qWarning("File %s already exists", qUtf8Printable(output));
+		return 1;
+	}
+
+	QString error;
+	QScopedPointer<QIODevice> device(
+		CompressionDevice::openFile(input, QIODevice::ReadOnly, &error));
+	if (device.isNull())
+	{
+		qWarning("Cannot open file %s: %s",
+			 qUtf8Printable(input), qUtf8Printable(error));
+		return 1;
+	}
+
+	OutputWriter writer;
+	writer.setFileName(output);
+	writer.setBatch(256, 0);
+
+	const bool archiveOut = GameArchiveReader::isArchiveFileName(output);
+	if (archiveOut)
+		writer.setFileHeader(GameArchiveWriter::fileHeader());
+
+	int count = 0;
+	bool ok = true;
+	auto writeGame = [&](const PgnGame& game)
+	{
+		count++;
+		if (archiveOut)
+		{
+			const QByteArray record(GameArchiveWriter::encode(game));
+			if (!record.isEmpty() && writer.writeData(record))
+				return;
+		}
+		else
+		{
+			QString text;
+			QTextStream out(&text);
+			if (game.write(out) && writer.write(text))
+				return;
+		}
+
+		qWarning("Could not convert game %d", count);
+		ok = false;
+	};
+
+	PgnGame game;
+	if (GameArchiveReader::isArchiveFileName(input))
+	{
+		GameArchiveReader reader(device.data());
+		while (reader.read(game, INT_MAX - 1, false))
+			writeGame(game);
+
+		if (!reader.errorString().isEmpty())
+		{
+			qWarning("%s: %s", qUtf8Printable(input),
+				 qUtf8Printable(reader.errorString()));
+			ok = false;
+		}
+	}
+	else
+	{
+		PgnStream stream(device.data());
+		while (game.read(stream, INT_MAX - 1, false))
+			writeGame(game);
+
+		// The stream reads past the end of the data only when
+		// every game was read. A mapped file is read without
+		// moving the device's position, so the stream's status
+		// is the only reliable sign of that.
+		if (stream.status() != PgnStream::ReadPastEnd)
+		{
+			qWarning("%s: Could not read game %d",
+				 qUtf8Printable(input), count + 1);
+			ok = false;
+		}
+	}
+
+	writer.close();
+	qInfo("Converted %d games from %s to %s", count,
+	      qUtf8Printable(input), qUtf8Printable(output));
+
+	return ok ? 0 : 1;
+}
+
 EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 {
 	MatchParser parser(args);
@@ -262,6 +373,8 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-each", QVariant::StringList, 1);
 	parser.addOption("-variant", QVariant::String, 1, 1);
 	parser.addOption("-concurrency", QVariant::Int, 1, 1);
+	parser.addOption("-workers", QVariant::Int, 0, 1);
+	parser.addOption("-affinity", QVariant::StringList);
 	parser.addOption("-draw", QVariant::StringList);
 	parser.addOption("-resign", QVariant::StringList);
 	parser.addOption("-maxmoves", QVariant::Int, 1, 1);
@@ -274,12 +387,17 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-sprt", QVariant::StringList);
 	parser.addOption("-ratinginterval", QVariant::Int, 1, 1);
 	parser.addOption("-outcomeinterval", QVariant::Int, 1, 1);
+	parser.addOption("-latency", QVariant::Bool, 0, 0);
+	parser.addOption("-metrics", QVariant::StringList);
+	parser.addOption("-metricsport", QVariant::Int, 1, 1);
 	parser.addOption("-resultformat", QVariant::String, 1, 1);
 	parser.addOption("-debug", QVariant::String, 0, 1);
 	parser.addOption("-openings", QVariant::StringList);
 	parser.addOption("-bookmode", QVariant::String);
 	parser.addOption("-pgnout", QVariant::StringList, 1, 3);
 	parser.addOption("-epdout", QVariant::String, 1, 1);
+	parser.addOption("-gameout", QVariant::String, 1, 1);
+	parser.addOption("-outputbatch", QVariant::StringList);
 	parser.addOption("-repeat", QVariant::Int, 0, 1);
 	parser.addOption("-noswap", QVariant::Bool, 0, 0);
 	parser.addOption("-reverse", QVariant::Bool, 0, 0);
@@ -287,6 +405,7 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-site", QVariant::String, 1, 1);
 	parser.addOption("-wait", QVariant::Int, 1, 1);
 	parser.addOption("-seeds", QVariant::UInt, 1, 1);
+	parser.addOption("-resume", QVariant::String, 1, 1);
 	if (!parser.parse())
 		return nullptr;
 
@@ -304,9 +423,48 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 
 	EngineMatch* match = new EngineMatch(tournament, parent);
 
+	// The random seed is set before any other option so that
+	// the same seed always gives the same opening order
+	QVariant srand = parser.takeOption("-srand");
+	if (srand.isValid())
+	{
+		bool ok = false;
+		uint seed = srand.toUInt(&ok);
+		if (!ok)
+		{
+			qWarning("Invalid value for option \"-srand\": \"%s\"",
+				 qUtf8Printable(srand.toString()));
+			delete match;
+			delete tournament;
+			return nullptr;
+		}
+		Mersenne::initialize(seed);
+	}
+
+	// Tournament journal. A resumed tournament reuses the random
+	// seed of the original run.
+	QString journalFile = parser.takeOption("-resume").toString();
+	if (!journalFile.isEmpty())
+	{
+		auto journal = new TournamentJournal(journalFile);
+		if (!journal->open())
+		{
+			qWarning("%s", qUtf8Printable(journal->errorString()));
+			delete journal;
+			delete match;
+			delete tournament;
+			return nullptr;
+		}
+		if (!journal->isEmpty())
+			Mersenne::initialize(journal->header().value("seed").toUInt());
+		tournament->setJournal(journal);
+	}
+
 	QList<EngineData> engines;
 	QStringList eachOptions;
 	GameAdjudicator adjudicator;
+	CoreSlots coreSlots;
+	bool useCoreSlots = false;
 
 	const auto options = parser.options();
 	for (const auto& option : options)
@@ -341,6 +499,40 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 			if (ok)
 				manager->setConcurrency(value.toInt());
 		}
+		// Host the games in a pool of worker threads
+		else if (name == "-workers")
+		{
+			int count = -1; // default: one worker per logical CPU
+			if (option.value.type() != QVariant::Bool)
+				count = value.toInt(&ok);
+			ok = ok && count != 0;
+			if (ok)
+				manager->setWorkerCount(count);
+		}
+		// Pin the engines of each concurrent game to their own CPUs
+		else if (name == "-affinity")
+		{
+			QMap<QString, QString> params =
+				option.toMap("cpus=0|smt=on|numa=on");
+			ok = !params.isEmpty();
+
+			int cpus = params["cpus"].toInt();
+			if (ok && cpus < 0)
+				ok = false;
+
+			const QStringList toggles = QStringList() << "on" << "off";
+			if (ok && (!toggles.contains(params["smt"])
+			       ||  !toggles.contains(params["numa"])))
+				ok = false;
+
+			if (ok)
+			{
+				useCoreSlots = true;
+				coreSlots.setCpusPerSlot(cpus);
+				coreSlots.setAvoidSmtSiblings(params["smt"] == "off");
+				coreSlots.setNumaAware(params["numa"] == "on");
+			}
+		}
 		// Threshold for draw adjudication
 		else if (name == "-draw")
 		{
@@ -431,7 +623,7 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		// SPRT-based stopping rule
 		else if (name == "-sprt")
 		{
-			QMap<QString, QString> params = option.toMap("elo0|elo1|alpha|beta");
+			QMap<QString, QString> params = option.toMap("elo0|elo1|alpha|beta|model=bayes");
 			bool sprtOk[4];
 			double elo0 = params["elo0"].toDouble(sprtOk);
 			double elo1 = params["elo1"].toDouble(sprtOk + 1);
@@ -439,8 +631,24 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 			double beta = params["beta"].toDouble(sprtOk + 3);
 
 			ok = (sprtOk[0] && sprtOk[1] && sprtOk[2] && sprtOk[3]);
+
+			Sprt::EloModel model = Sprt::BayesianElo;
+			if (params["model"] == "bayes")
+				model = Sprt::BayesianElo;
+			else if (params["model"] == "logistic")
+				model = Sprt::LogisticElo;
+			else if (params["model"] == "normalized")
+				model = Sprt::NormalizedElo;
+			else if (ok)
+			{
+				qWarning("Invalid SPRT Elo model: \"%s\"",
+					 qUtf8Printable(params["model"]));
+				ok = false;
+			}
+
 			if (ok)
-				tournament->sprt()->initialize(elo0, elo1, alpha, beta);
+				tournament->sprt()->initialize(elo0, elo1, alpha, beta,
+							       model);
 		}
 		// Interval for rating list updates
 		else if (name == "-ratinginterval")
@@ -448,6 +656,33 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		// Interval for outcome updates
 		else if (name == "-outcomeinterval")
 			match->setOutcomeInterval(value.toInt());
+		// Per-move latency report at the end of the match
+		else if (name == "-latency")
+			match->setLatencyReport(true);
+		// Periodically rewritten JSON file of live metrics
+		else if (name == "-metrics")
+		{
+			QMap<QString, QString> params =
+				option.toMap("file|interval=10");
+			ok = !params.isEmpty();
+
+			bool intervalOk = false;
+			int interval = params["interval"].toInt(&intervalOk);
+			ok = ok && intervalOk && interval > 0;
+			if (ok)
+			{
+				MetricsExporter* exporter = match->metricsExporter();
+				exporter->setFileName(params["file"]);
+				exporter->setInterval(interval);
+			}
+		}
+		// Prometheus endpoint for the live metrics
+		else if (name == "-metricsport")
+		{
+			int port = value.toInt();
+			ok = port > 0 && port < 65536
+			     && match->metricsExporter()->listen(quint16(port));
+		}
 		// Format of the result list
 		else if (name == "-resultformat")
 		{
@@ -563,6 +798,8 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 				match->setBookMode(OpeningBook::Ram);
 			else if (val == "disk")
 				match->setBookMode(OpeningBook::Disk);
+			else if (val == "mapped")
+				match->setBookMode(OpeningBook::Mapped);
 			else
 				ok = false;
 		}
@@ -583,6 +820,7 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 						ok = false;
 				}
 			}
+			ok = ok && isCompressionSupported(list.at(0));
 			if (ok)
 				tournament->setPgnOutput(list.at(0), mode);
 		}
@@ -590,7 +828,55 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		else if (name == "-epdout")
 		{
 			QString fileName = value.toString();
-			tournament->setEpdOutput(fileName);
+			ok = isCompressionSupported(fileName);
+			if (ok)
+				tournament->setEpdOutput(fileName);
+		}
+		// Binary game archive where the games should be saved
+		else if (name == "-gameout")
+		{
+			QString fileName = value.toString();
+			ok = isCompressionSupported(fileName);
+			if (ok)
+				tournament->setGameOutput(fileName);
+		}
+		// Group commit and sync policy of the PGN and EPD output
+		else if (name == "-outputbatch")
+		{
+			QMap<QString, QString> params =
+				option.toMap("games=1|interval=0|queue=256|fsync=never");
+			ok = !params.isEmpty();
+
+			bool gamesOk = false;
+			bool intervalOk = false;
+			bool queueOk = false;
+			int games = params["games"].toInt(&gamesOk);
+			int interval = params["interval"].toInt(&intervalOk);
+			int queue = params["queue"].toInt(&queueOk);
+			ok = ok && gamesOk && games > 0
+			     && intervalOk && interval >= 0
+			     && queueOk && queue > 0;
+
+			OutputWriter::SyncPolicy policy = OutputWriter::NoSync;
+			if (params["fsync"] == "never")
+				policy = OutputWriter::NoSync;
+			else if (params["fsync"] == "commit")
+				policy = OutputWriter::SyncOnCommit;
+			else if (params["fsync"] == "close")
+				policy = OutputWriter::SyncOnClose;
+			else if (ok)
+			{
+				qWarning("Invalid fsync policy: \"%s\"",
+					 qUtf8Printable(params["fsync"]));
+				ok = false;
+			}
+
+			if (ok)
+			{
+				tournament->setOutputBatch(games, interval);
+				tournament->setOutputQueueLimit(queue);
+				tournament->setOutputSyncPolicy(policy);
+			}
 		}
 		// Play every opening twice (default), or multiple times
 		else if (name == "-repeat")
@@ -624,13 +910,6 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		// Site/location name
 		else if (name == "-site")
 			tournament->setSite(value.toString());
-		// Set the random seed manually
-		else if (name == "-srand")
-		{
-			uint seed = value.toUInt(&ok);
-			if (ok)
-				Mersenne::initialize(seed);
-		}
 		// Delay between games
 		else if (name == "-wait")
 		{
@@ -720,6 +999,21 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		ok = false;
 	}
 
+	// The slot count depends on -concurrency, so the slot map
+	// is built after all options have been parsed.
+	if (ok && useCoreSlots)
+	{
+		ok = coreSlots.initialize(manager->concurrency());
+		if (ok)
+		{
+			manager->setCoreSlots(coreSlots);
+			qInfo("%s", qUtf8Printable(coreSlots.toString()));
+		}
+		else
+			qWarning("Cannot set CPU affinity: %s",
+				 qUtf8Printable(coreSlots.errorString()));
+	}
+
 	if (!ok)
 	{
 		delete match;
@@ -775,6 +1069,17 @@ int main(int argc, char* argv[])
 
 			return 0;
 		}
+		else if (arg == "--convert" || arg == "-convert")
+		{
+			int i = arguments.indexOf(arg);
+			if (i + 2 >= arguments.size())
+			{
+				qWarning("Usage: cutechess-cli -convert INPUT OUTPUT");
+				return 1;
+			}
+
+			return convertGames(arguments.at(i + 1), arguments.at(i + 2));
+		}
 		else if (arg == "--help" || arg == "-help")
 		{
 			QFile file(":/help.txt");
@@ -0,0 +1,326 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "metricsexporter.h"
+#include <QTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <tournament.h>
+#include <gamemanager.h>
+#include <matchmetrics.h>
+#include <movelatency.h>
+
+namespace {
+
+const double s_quantiles[] = { 0.5, 0.9, 0.99 };
+
+QString escapeLabel(QString value)
+{
+	value.replace('\\', "\\\\");
+	value.replace('"', "\\\"");
+	value.replace('\n', "\\n");
+	return value;
+}
+
+} // anonymous namespace
+
+MetricsExporter::MetricsExporter(Tournament* tournament, QObject* parent)
+	: QObject(parent),
+	  m_tournament(tournament),
+	  m_timer(new QTimer(this)),
+	  m_server(nullptr),
+	  m_lastTime(0),
+	  m_lastStarted(0),
+	  m_lastFinished(0),
+	  m_startedRate(0.0),
+	  m_finishedRate(0.0)
+{
+	Q_ASSERT(tournament != nullptr);
+
+	m_timer->setInterval(10000);
+	connect(m_timer, SIGNAL(timeout()), this, SLOT(update()));
+	m_elapsed.start();
+}
+
+void MetricsExporter::setFileName(const QString& fileName)
+{
+	m_fileName = fileName;
+}
+
+void MetricsExporter::setInterval(int secs)
+{
+	Q_ASSERT(secs > 0);
+	m_timer->setInterval(secs * 1000);
+}
+
+bool MetricsExporter::listen(quint16 port)
+{
+	if (m_server == nullptr)
+	{
+		m_server = new QTcpServer(this);
+		connect(m_server, SIGNAL(newConnection()),
+			this, SLOT(onNewConnection()));
+	}
+
+	if (!m_server->listen(QHostAddress::LocalHost, port))
+	{
+		qWarning("Cannot serve metrics on port %d: %s", port,
+			 qUtf8Printable(m_server->errorString()));
+		return false;
+	}
+
+	return true;
+}
+
+void MetricsExporter::start()
+{
+	m_elapsed.restart();
+	m_lastTime = 0;
+	m_timer->start();
+	writeFile();
+}
+
+void MetricsExporter::stop()
+{
+	m_timer->stop();
+	update();
+}
+
+void MetricsExporter::update()
+{
+	const MatchMetrics& metrics = m_tournament->metrics();
+	const qint64 time = m_elapsed.elapsed();
+	const qint64 started = metrics.value(MatchMetrics::GamesStarted);
+	const qint64 finished = metrics.value(MatchMetrics::GamesFinished);
+
+	// The rates cover the last update interval
+	if (time > m_lastTime)
+	{
+		const double secs = (time - m_lastTime) / 1000.0;
+		m_startedRate = (started - m_lastStarted) / secs;
+		m_finishedRate = (finished - m_lastFinished) / secs;
+	}
+	m_lastTime = time;
+	m_lastStarted = started;
+	m_lastFinished = finished;
+
+	writeFile();
+}
+
+void MetricsExporter::writeFile()
+{
+	if (m_fileName.isEmpty())
+		return;
+
+	// Readers never see a partially written file
+	QSaveFile file(m_fileName);
+	if (!file.open(QIODevice::WriteOnly)
+	||  file.write(toJson()) == -1
+	||  !file.commit())
+		qWarning("Cannot write metrics file %s: %s",
+			 qUtf8Printable(m_fileName),
+			 qUtf8Printable(file.errorString()));
+}
+
+QByteArray MetricsExporter::toJson() const
+{
+	const MatchMetrics& metrics = m_tournament->metrics();
+	const GameManager* manager = m_tournament->gameManager();
+	const double hours = m_elapsed.elapsed() / 3600000.0;
+
+	QJsonObject counters;
+	for (int i = 0; i < MatchMetrics::CounterCount; i++)
+	{
+		const auto counter = MatchMetrics::Counter(i);
+		counters[MatchMetrics::counterName(counter)] =
+			double(metrics.value(counter));
+	}
+
+	QJsonObject json;
+	json["elapsed"] = m_elapsed.elapsed() / 1000.0;
+	json["counters"] = counters;
+	json["active_games"] = manager->activeGames().size();
+	json["queued_games"] = manager->queuedGameCount();
+	json["output_backlog"] = double(m_tournament->outputBacklog());
+	json["games_started_per_second"] = m_startedRate;
+	json["games_finished_per_second"] = m_finishedRate;
+	json["games_per_hour"] = hours > 0.0
+		? metrics.value(MatchMetrics::GamesFinished) / hours : 0.0;
+	json["mean_nps"] = metrics.meanNps();
+	json["mean_depth"] = metrics.meanDepth();
+
+	QJsonArray players;
+	for (int i = 0; i < m_tournament->playerCount(); i++)
+	{
+		const TournamentPlayer& player = m_tournament->playerAt(i);
+		const MoveLatency& latency = player.moveLatency();
+
+		QJsonObject stages;
+		for (int j = 0; j < MoveLatency::StageCount; j++)
+		{
+			const auto stage = MoveLatency::Stage(j);
+			const LatencyHistogram& h = latency.histogram(stage);
+
+			QJsonObject stageJson;
+			stageJson["mean_ns"] = double(h.mean());
+			for (double q : s_quantiles)
+			{
+				const QString key = QString("p%1_ns").arg(q * 100);
+				stageJson[key] = double(h.percentile(q * 100));
+			}
+			stageJson["max_ns"] = double(h.max());
+			stages[MoveLatency::stageName(stage)] = stageJson;
+		}
+
+		QJsonObject playerJson;
+		playerJson["name"] = player.name();
+		playerJson["games"] = player.gamesFinished();
+		playerJson["moves"] = double(latency.count());
+		playerJson["latency"] = stages;
+		players.append(playerJson);
+	}
+	json["players"] = players;
+
+	return QJsonDocument(json).toJson();
+}
+
+QByteArray MetricsExporter::toPrometheus() const
+{
+	const MatchMetrics& metrics = m_tournament->metrics();
+	const GameManager* manager = m_tournament->gameManager();
+
+	QString out;
+	auto metric = [&](const QString& name, const char* type,
+			  const char* help, double value)
+	{
+		out += QString("# HELP cutechess_%1 %2\n").arg(name, help);
+		out += QString("# TYPE cutechess_%1 %2\n").arg(name, type);
+		out += QString("cutechess_%1 %2\n").arg(name).arg(value, 0, 'g', 12);
+	};
+
+	for (int i = 0; i < MatchMetrics::CounterCount; i++)
+	{
+		const auto counter = MatchMetrics::Counter(i);
+		metric(MatchMetrics::counterName(counter) + "_total",
+		       "counter", "Cumulative match counter.",
+		       metrics.value(counter));
+	}
+	metric("active_games", "gauge", "Games in progress.",
+	       manager->activeGames().size());
+	metric("queued_games", "gauge", "Games waiting for a free slot.",
+	       manager->queuedGameCount());
+	metric("output_backlog", "gauge",
+	       "Games waiting to be committed to the output files.",
+	       m_tournament->outputBacklog());
+	metric("games_started_per_second", "gauge",
+	       "Games started per second in the last interval.",
+	       m_startedRate);
+	metric("games_finished_per_second", "gauge",
+	       "Games finished per second in the last interval.",
+	       m_finishedRate);
+	metric("mean_nps", "gauge", "Mean nodes per second of the engines.",
+	       metrics.meanNps());
+	metric("mean_depth", "gauge", "Mean search depth of the engines.",
+	       metrics.meanDepth());
+
+	const QString name("cutechess_move_latency_seconds");
+	out += QString("# HELP %1 Latency of each stage of a move.\n").arg(name);
+	out += QString("# TYPE %1 summary\n").arg(name);
+	for (int i = 0; i < m_tournament->playerCount(); i++)
+	{
+		const TournamentPlayer& player = m_tournament->playerAt(i);
+		const MoveLatency& latency = player.moveLatency();
+		for (int j = 0; j < MoveLatency::StageCount; j++)
+		{
+			const auto stage = MoveLatency::Stage(j);
+			const LatencyHistogram& h = latency.histogram(stage);
+			const QString labels = QString("player=\"%1\",stage=\"%2\"")
+				.arg(escapeLabel(player.name()),
+				     MoveLatency::stageName(stage));
+
+			for (double q : s_quantiles)
+			{
+				out += QString("%1{%2,quantile=\"%3\"} %4\n")
+					.arg(name, labels)
+					.arg(q)
+					.arg(h.percentile(q * 100) / 1e9, 0, 'g', 9);
+			}
+			out += QString("%1_sum{%2} %3\n").arg(name, labels)
+				.arg(h.sum() / 1e9, 0, 'g', 12);
+			out += QString("%1_count{%2} %3\n").arg(name, labels)
+				.arg(h.count());
+		}
+	}
+
+	return out.toUtf8();
+}
+
+void MetricsExporter::onNewConnection()
+{
+	while (QTcpSocket* socket = m_server->nextPendingConnection())
+	{
+		connect(socket, SIGNAL(disconnected()),
+			socket, SLOT(deleteLater()));
+		connect(socket, &QTcpSocket::readyRead, this, [=]()
+		{
+			// Read the request line and skip the headers
+			while (socket->canReadLine())
+			{
+				const QByteArray line = socket->readLine();
+				if (!socket->property("path").isValid())
+				{
+					const QList<QByteArray> request = line.split(' ');
+					socket->setProperty("path", request.value(1));
+					continue;
+				}
+				if (line != "\r\n" && line != "\n")
+					continue;
+
+				const QByteArray path = socket->property("path").toByteArray();
+				QByteArray status("200 OK");
+				QByteArray type("text/plain; version=0.0.4");
+				QByteArray body;
+				if (path == "/" || path == "/metrics")
+					body = toPrometheus();
+				else if (path == "/metrics.json")
+				{
+					type = "application/json";
+					body = toJson();
+				}
+				else
+				{
+					status = "404 Not Found";
+					body = "Not found\n";
+				}
+
+				socket->write("HTTP/1.0 " + status + "\r\n"
+					      "Content-Type: " + type + "\r\n"
+					      "Content-Length: "
+					      + QByteArray::number(body.size())
+					      + "\r\nConnection: close\r\n\r\n"
+					      + body);
+				socket->disconnectFromHost();
+				return;
+			}
+		});
+	}
+}
@@ -0,0 +1,89 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+class QTimer;
+class QTcpServer;
+class Tournament;
+
+
+/*!
+ * \brief Exports the live metrics of a tournament
+ *
+ * MetricsExporter periodically rewrites a JSON file with the game
+ * counters, rates and engine statistics of a tournament, and can
+ * serve the same metrics in the Prometheus text format from a local
+ * HTTP endpoint.
+ *
+ * \sa MatchMetrics
+ */
+class MetricsExporter : public QObject
+{
+	Q_OBJECT
+
+	public:
+		/*! Creates a new exporter for \a tournament. */
+		MetricsExporter(Tournament* tournament, QObject* parent = nullptr);
+
+		/*! Sets the JSON output file to \a fileName. */
+		void setFileName(const QString& fileName);
+		/*! Sets the update interval to \a secs seconds. */
+		void setInterval(int secs);
+		/*!
+		 * Serves the metrics at http://127.0.0.1:\a port/metrics.
+		 * Returns false if the port can't be opened.
+		 */
+		bool listen(quint16 port);
+
+		/*! Returns the metrics as a JSON document. */
+		QByteArray toJson() const;
+		/*! Returns the metrics in the Prometheus text format. */
+		QByteArray toPrometheus() const;
+
+	public slots:
+		/*! Starts the periodic updates. */
+		void start();
+		/*! Stops the updates and writes the final metrics. */
+		void stop();
+
+	private slots:
+		void update();
+		void onNewConnection();
+
+	private:
+		void writeFile();
+
+		Tournament* m_tournament;
+		QString m_fileName;
+		QTimer* m_timer;
+		QTcpServer* m_server;
+		QElapsedTimer m_elapsed;
+		qint64 m_lastTime;
+		qint64 m_lastStarted;
+		qint64 m_lastFinished;
+		double m_startedRate;
+		double m_finishedRate;
+};
+
+#endif // METRICSEXPORTER_H
@@ -0,0 +1,24 @@
+# Converts a PGN file to a game archive and back with cutechess-cli,
+# and checks that both conversions succeed without warnings.
+#
+# Variables: CLI (the cutechess-cli executable), INPUT (a PGN file)
+# and WORK_DIR (a directory for the output files).
+
+set(archive ${WORK_DIR}/convert-test.ccg)
+set(pgn ${WORK_DIR}/convert-test.pgn)
+file(REMOVE ${archive} ${pgn})
+
+foreach(step "${INPUT};${archive}" "${archive};${pgn}")
+	list(GET step 0 from)
+	list(GET step 1 to)
+	execute_process(COMMAND ${CLI} -convert ${from} ${to}
+			RESULT_VARIABLE result
+			OUTPUT_VARIABLE output
+			ERROR_VARIABLE output)
+	if(NOT result EQUAL 0 OR output MATCHES "Could not")
+		message(FATAL_ERROR "Converting ${from} failed (${result}):\n${output}")
+	endif()
+	if(NOT output MATCHES "Converted 2 games")
+		message(FATAL_ERROR "Unexpected output:\n${output}")
+	endif()
+endforeach()
@@ -29,7 +29,7 @@
 
 #include <pgnstream.h>
 #include <pgngame.h>
-#include <pgngameentry.h>
+#include <pgngameentrystore.h>
 #include <polyglotbook.h>
 
 #include "pgndatabasemodel.h"
@@ -115,8 +115,8 @@ PgnGame PgnGameIterator::next(bool* ok, int depth)
 		return game;
 	}
 
-	const PgnGameEntry* entry = m_dlg->m_pgnGameEntryModel->entryAt(m_gameIndex++);
-	*ok = m_in.seek(entry->pos(), entry->lineNumber()) && game.read(m_in, depth);
+	const PgnGameEntry entry(m_dlg->m_pgnGameEntryModel->entryAt(m_gameIndex++));
+	*ok = m_in.seek(entry.pos(), entry.lineNumber()) && game.read(m_in, depth);
 
 	return game;
 }
@@ -289,7 +289,7 @@ GameDatabaseDialog::GameDatabaseDialog(GameDatabaseManager* dbManager, QWidget*
 	connect(ui->m_importBtn, &QPushButton::clicked, this, [=]()
 	{
 		auto dlg = new QFileDialog(this, tr("Import Game"), QString(),
-			tr("Portable Game Notation (*.pgn);;All Files (*.*)"));
+			tr("Portable Game Notation (*.pgn *.pgn.gz *.pgn.zst);;All Files (*.*)"));
 		connect(dlg, &QFileDialog::fileSelected, m_dbManager, &GameDatabaseManager::importPgnFile);
 		dlg->setAttribute(Qt::WA_DeleteOnClose);
 		dlg->open();
@@ -335,6 +335,11 @@ GameDatabaseDialog::GameDatabaseDialog(GameDatabaseManager* dbManager, QWidget*
 	connect(ui->m_advancedSearchBtn, SIGNAL(clicked()),
 		this, SLOT(onAdvancedSearch()));
 
+	connect(ui->m_positionSearchBtn, SIGNAL(clicked()),
+		this, SLOT(onPositionSearch()));
+	connect(ui->m_clearBtn, &QPushButton::clicked,
+		m_pgnGameEntryModel, &PgnGameEntryModel::clearGameFilter);
+
 	connect(m_pgnGameEntryModel, SIGNAL(modelReset()), this,
 		SLOT(updateUi()));
 	connect(m_pgnGameEntryModel, SIGNAL(rowsInserted(const QModelIndex&, int, int)),
@@ -362,17 +367,18 @@ void GameDatabaseDialog::databaseSelectionChanged(const QItemSelection& selected
 
 	if (m_selectedDatabases.isEmpty())
 	{
-		m_pgnGameEntryModel->setEntries(QList<const PgnGameEntry*>());
+		m_pgnGameEntryModel->setEntries(PgnGameEntryStore());
 		return;
 	}
 
-	QList<const PgnGameEntry*> entries;
+	PgnGameEntryStore entries;
 	QMap<int, PgnDatabase*>::const_iterator it;
 	for (it = m_selectedDatabases.constBegin(); it != m_selectedDatabases.constEnd(); ++it)
 		entries.append(it.value()->entries());
 
 	m_pgnGameEntryModel->setEntries(entries);
 	ui->m_advancedSearchBtn->setEnabled(true);
+	ui->m_positionSearchBtn->setEnabled(true);
 }
 
 void GameDatabaseDialog::gameSelectionChanged(const QModelIndex& current,
@@ -390,7 +396,7 @@ void GameDatabaseDialog::gameSelectionChanged(const QModelIndex& current,
 	PgnDatabase* selectedDatabase = m_dbManager->databases().at(databaseIndex);
 
 	PgnDatabase::Status status;
-	const PgnGameEntry* entry = m_pgnGameEntryModel->entryAt(current.row());
+	const PgnGameEntry entry(m_pgnGameEntryModel->entryAt(current.row()));
 
 	if ((status = selectedDatabase->game(entry, &m_game)) != PgnDatabase::Ok)
 	{
@@ -479,6 +485,44 @@ void GameDatabaseDialog::onAdvancedSearch()
 	ui->m_clearBtn->setEnabled(true);
 }
 
+void GameDatabaseDialog::onPositionSearch()
+{
+	const Chess::Board* board = m_gameViewer->board();
+	if (board == nullptr || m_selectedDatabases.isEmpty())
+		return;
+
+	// The game numbers of each index are relative to its database
+	const quint64 key = board->key();
+	QVector<int> games;
+	int offset = 0;
+	bool indexed = false;
+	for (const PgnDatabase* db : qAsConst(m_selectedDatabases))
+	{
+		const PositionIndex& index = db->positionIndex();
+		if (!index.isEmpty())
+		{
+			indexed = true;
+			const auto dbGames = index.games(key);
+			for (quint32 game : dbGames)
+				games.append(offset + int(game));
+		}
+		offset += db->entries().count();
+	}
+
+	if (!indexed)
+	{
+		QMessageBox::information(this, tr("Position Search"),
+			tr("The selected databases have no position index.\n"
+			   "Import the databases again to build the index."));
+		return;
+	}
+
+	ui->m_searchEdit->setText(tr("[Position search]"));
+	ui->m_searchEdit->setEnabled(false);
+	m_pgnGameEntryModel->setGameFilter(games);
+	ui->m_clearBtn->setEnabled(true);
+}
+
 int GameDatabaseDialog::databaseIndexFromGame(int game) const
 {
 	if (m_selectedDatabases.isEmpty())
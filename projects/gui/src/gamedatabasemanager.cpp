@@ -21,8 +21,12 @@
 #include <QFileInfo>
 #include <QDataStream>
 #include <QThreadPool>
+#include <QSettings>
+#include <QDir>
+#include <QSet>
+#include <QTemporaryFile>
 
-#include <pgngameentry.h>
+#include <pgngameentrystore.h>
 
 #include "pgndatabase.h"
 #include "pgnimporter.h"
@@ -30,7 +34,17 @@
 #include "cutechessapp.h"
 
 #define GAME_DATABASE_STATE_MAGIC   0xDEADD00D
-#define GAME_DATABASE_STATE_VERSION 1
+#define GAME_DATABASE_STATE_VERSION 3
+
+namespace {
+
+QString cacheDirectory(const QString& stateFileName)
+{
+	const QFileInfo info(stateFileName);
+	return info.absoluteDir().filePath(info.completeBaseName() + "_cache");
+}
+
+} // anonymous namespace
 
 GameDatabaseManager::GameDatabaseManager(QObject* parent)
 	: QObject(parent),
@@ -50,6 +64,33 @@ QList<PgnDatabase*> GameDatabaseManager::databases() const
 
 bool GameDatabaseManager::writeState(const QString& fileName)
 {
+	// Write a cache file for each new database. The cache files
+	// are never overwritten because they may be mapped to memory.
+	QDir cacheDir(cacheDirectory(fileName));
+	if (!cacheDir.mkpath("."))
+		return false;
+
+	QSet<QString> cacheFiles;
+	for (PgnDatabase* db : qAsConst(m_databases))
+	{
+		if (db->cacheFileName().isEmpty())
+		{
+			QTemporaryFile file(cacheDir.filePath("XXXXXX.ccdb"));
+			file.setAutoRemove(false);
+			if (!file.open())
+				return false;
+			const QString cacheFileName(file.fileName());
+			file.close();
+
+			if (!db->writeCache(cacheFileName))
+			{
+				QFile::remove(cacheFileName);
+				return false;
+			}
+		}
+		cacheFiles << QFileInfo(db->cacheFileName()).fileName();
+	}
+
 	QFile stateFile(fileName);
 
 	if (!stateFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
@@ -71,11 +112,16 @@ bool GameDatabaseManager::writeState(const QString& fileName)
 		out << db->fileName();
 		out << db->lastModified();
 		out << db->displayName();
-		out << (qint32)db->entries().count();
+		out << QFileInfo(db->cacheFileName()).fileName();
+	}
 
-		const auto entries = db->entries();
-		for (const PgnGameEntry* entry : entries)
-			entry->write(out);
+	// Remove the cache files of removed databases
+	const auto oldFiles = cacheDir.entryList(QStringList() << "*.ccdb",
+						 QDir::Files);
+	for (const QString& oldFile : oldFiles)
+	{
+		if (!cacheFiles.contains(oldFile))
+			cacheDir.remove(oldFile);
 	}
 
 	m_modified = false;
@@ -107,10 +153,11 @@ bool GameDatabaseManager::readState(const QString& fileName)
 	quint32 version;
 	in >> version;
 
-	if (version < GAME_DATABASE_STATE_VERSION ||
+	// Version 1 has no position indexes, and versions 1 and 2 store
+	// the entries in the state file instead of cache files
+	if (version < 1 ||
 	    version > GAME_DATABASE_STATE_VERSION)
 	{
-		// TODO: Add backward compatibility
 		qWarning("GameDatabaseManager: state file version mismatch");
 		return false;
 	}
@@ -120,10 +167,12 @@ bool GameDatabaseManager::readState(const QString& fileName)
 	in >> dbCount;
 
 	// Read the contents of the databases
+	const QDir cacheDir(cacheDirectory(fileName));
 	QString dbFileName;
 	QDateTime dbLastModified;
 	QString dbDisplayName;
 	QList<PgnDatabase*> readDatabases;
+	bool modified = version < GAME_DATABASE_STATE_VERSION;
 
 	for (int i = 0; i < dbCount; i++)
 	{
@@ -131,43 +180,76 @@ bool GameDatabaseManager::readState(const QString& fileName)
 		in >> dbLastModified;
 		in >> dbDisplayName;
 
+		PgnDatabase* db = new PgnDatabase(dbFileName);
+		db->setLastModified(dbLastModified);
+		db->setDisplayName(dbDisplayName);
+
+		bool ok = true;
+		if (version >= 3)
+		{
+			QString cacheFileName;
+			in >> cacheFileName;
+			ok = !cacheFileName.isEmpty()
+			  && db->openCache(cacheDir.filePath(cacheFileName));
+		}
+		else
+		{
+			qint32 dbEntryCount;
+			in >> dbEntryCount;
+
+			// Read the entries
+			PgnGameEntryStore entries;
+			PgnGameEntry entry;
+			for (int j = 0; j < dbEntryCount; j++)
+			{
+				entry.read(in);
+				entries.append(entry);
+			}
+
+			PositionIndex index;
+			if (version >= 2 && !index.read(in))
+			{
+				qWarning("GameDatabaseManager: invalid position index");
+				delete db;
+				qDeleteAll(readDatabases);
+				return false;
+			}
+
+			db->setEntries(entries);
+			db->setPositionIndex(index);
+		}
+
+		if (in.status() != QDataStream::Ok)
+		{
+			qWarning("GameDatabaseManager: invalid state file");
+			delete db;
+			qDeleteAll(readDatabases);
+			return false;
+		}
+
 		// Check if the database exists
 		QFileInfo fileInfo(dbFileName);
 		if (!fileInfo.exists())
 		{
-			m_modified = true;
+			modified = true;
+			delete db;
 			continue;
 		}
 
-		// Check if the database has been modified
-		if (fileInfo.lastModified() > dbLastModified)
+		// Check if the database has been modified or if its
+		// cache file is missing
+		if (!ok || fileInfo.lastModified() > dbLastModified)
 		{
-			m_modified = true;
+			modified = true;
+			delete db;
 			importPgnFile(dbFileName);
 			continue;
 		}
 
-		qint32 dbEntryCount;
-		in >> dbEntryCount;
-
-		// Read the entries
-		QList<const PgnGameEntry*> entries;
-		for (int j = 0; j < dbEntryCount; j++)
-		{
-			PgnGameEntry* entry = new PgnGameEntry;
-			entry->read(in);
-			entries << entry;
-		}
-
-		PgnDatabase* db = new PgnDatabase(dbFileName);
-		db->setEntries(entries);
-		db->setLastModified(dbLastModified);
-		db->setDisplayName(dbDisplayName);
-
 		readDatabases << db;
 	}
 
-	m_modified = false;
+	m_modified = modified;
 
 	m_databases = readDatabases;
 	emit databasesReset();
@@ -178,6 +260,8 @@ bool GameDatabaseManager::readState(const QString& fileName)
 void GameDatabaseManager::importPgnFile(const QString& fileName)
 {
 	PgnImporter* pgnImporter = new PgnImporter(fileName);
+	pgnImporter->setPositionIndexEnabled(
+		QSettings().value("database/position_index", true).toBool());
 	connect(pgnImporter, SIGNAL(databaseRead(PgnDatabase*)),
 		this, SLOT(addDatabase(PgnDatabase*)));
 
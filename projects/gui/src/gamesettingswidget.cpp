@@ -25,6 +25,7 @@
 #include <board/syzygytablebase.h>
 #include <engineconfiguration.h>
 #include <openingsuite.h>
+#include <compressiondevice.h>
 #include <polyglotbook.h>
 #include "timecontroldlg.h"
 #include "pairtimecontroldlg.h"
@@ -57,7 +58,7 @@ GameSettingsWidget::GameSettingsWidget(QWidget* parent)
 	connect(ui->m_browseOpeningSuiteBtn, &QPushButton::clicked, this, [=]()
 	{
 		auto dlg = new QFileDialog(this, tr("Select opening suite"), QString(),
-			tr("PGN/EPD files (*.pgn *.epd)"));
+			tr("PGN/EPD files (*.pgn *.epd *.pgn.gz *.epd.gz *.pgn.zst *.epd.zst)"));
 		connect(dlg, &QFileDialog::fileSelected,
 			ui->m_openingSuiteEdit, &QLineEdit::setText);
 		dlg->setAttribute(Qt::WA_DeleteOnClose);
@@ -177,8 +178,13 @@ OpeningSuite* GameSettingsWidget::openingSuite() const
 	if (file.isEmpty())
 		return nullptr;
 
+	// Ignore the suffix of a compressed file
+	QString name(file);
+	if (CompressionDevice::codecForFileName(name) != CompressionDevice::NoCodec)
+		name.truncate(name.lastIndexOf('.'));
+
 	OpeningSuite::Format format = OpeningSuite::PgnFormat;
-	if (file.endsWith(".epd", Qt::CaseInsensitive))
+	if (name.endsWith(".epd", Qt::CaseInsensitive))
 		format = OpeningSuite::EpdFormat;
 
 	OpeningSuite::Order order = OpeningSuite::SequentialOrder;
@@ -72,9 +72,13 @@ void ImportProgressDialog::updateImportStatus(const QTime& startTime,
 	ui->m_importProgressBar->setMaximum(100);
 	ui->m_importProgressBar->setValue(int((double(numReadBytes) / m_totalFileSize) * 100));
 
-	int remainingSecs = (m_totalFileSize - numReadBytes) / (numReadBytes / elapsed);
+	// The throughput is the aggregate of all import threads
+	qint64 bytesPerSec = qMax(numReadBytes / elapsed, qint64(1));
+	int remainingSecs = (m_totalFileSize - numReadBytes) / bytesPerSec;
 
-	ui->m_statusLabel->setText(QString(tr("%1 games/sec - %2")).arg((int)numReadGames / elapsed)
+	ui->m_statusLabel->setText(QString(tr("%1 games/sec, %2 MB/s - %3"))
+	    .arg((int)numReadGames / elapsed)
+	    .arg(double(bytesPerSec) / (1024 * 1024), 0, 'f', 1)
 	    .arg(humaniseTime(remainingSecs)));
 }
 
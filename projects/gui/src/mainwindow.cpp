@@ -30,6 +30,7 @@
 #include <QClipboard>
 #include <QWindow>
 #include <QSettings>
+#include <QTextStream>
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 #include <QDesktopWidget>
 #endif
@@ -18,10 +18,15 @@
 
 #include "pgndatabase.h"
 #include <pgnstream.h>
+#include <compressiondevice.h>
 #include <QFileInfo>
+#include <QScopedPointer>
+#include <QDataStream>
+#include <QSaveFile>
 
 PgnDatabase::PgnDatabase(const QString& fileName, QObject* parent)
 	: QObject(parent),
+	  m_positionIndexPos(-1),
 	  m_fileName(fileName),
 	  m_displayName(QFileInfo(fileName).completeBaseName())
 {
@@ -29,20 +34,81 @@ PgnDatabase::PgnDatabase(const QString& fileName, QObject* parent)
 
 PgnDatabase::~PgnDatabase()
 {
-	qDeleteAll(m_entries);
 }
 
-void PgnDatabase::setEntries(const QList<const PgnGameEntry*>& entries)
+void PgnDatabase::setEntries(const PgnGameEntryStore& entries)
 {
-	qDeleteAll(m_entries);
 	m_entries = entries;
 }
 
-QList<const PgnGameEntry*> PgnDatabase::entries() const
+const PgnGameEntryStore& PgnDatabase::entries() const
 {
 	return m_entries;
 }
 
+const PositionIndex& PgnDatabase::positionIndex() const
+{
+	if (m_positionIndexPos != -1)
+	{
+		QFile file(m_cacheFileName);
+		if (file.open(QIODevice::ReadOnly) && file.seek(m_positionIndexPos))
+		{
+			QDataStream in(&file);
+			in.setVersion(QDataStream::Qt_4_6);
+			if (!m_positionIndex.read(in))
+				qWarning("PgnDatabase: invalid position index in %s",
+					 qUtf8Printable(m_cacheFileName));
+		}
+		m_positionIndexPos = -1;
+	}
+
+	return m_positionIndex;
+}
+
+void PgnDatabase::setPositionIndex(const PositionIndex& index)
+{
+	m_positionIndex = index;
+	m_positionIndexPos = -1;
+}
+
+QString PgnDatabase::cacheFileName() const
+{
+	return m_cacheFileName;
+}
+
+bool PgnDatabase::openCache(const QString& fileName)
+{
+	PgnGameEntryStore entries;
+	qint64 end = 0;
+	if (!entries.map(fileName, 0, &end))
+		return false;
+
+	m_entries = entries;
+	m_positionIndex = PositionIndex();
+	m_positionIndexPos = end;
+	m_cacheFileName = fileName;
+
+	return true;
+}
+
+bool PgnDatabase::writeCache(const QString& fileName)
+{
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_4_6);
+	if (!m_entries.write(&file))
+		return false;
+	positionIndex().write(out);
+	if (out.status() != QDataStream::Ok || !file.commit())
+		return false;
+
+	m_cacheFileName = fileName;
+	return true;
+}
+
 QString PgnDatabase::fileName() const
 {
 	return m_fileName;
@@ -82,22 +148,22 @@ void PgnDatabase::setDisplayName(const QString& displayName)
 	m_displayName = displayName;
 }
 
-PgnDatabase::Status PgnDatabase::game(const PgnGameEntry* entry,
+PgnDatabase::Status PgnDatabase::game(const PgnGameEntry& entry,
 				      PgnGame* game)
 {
-	Q_ASSERT(entry != nullptr);
 	Q_ASSERT(game != nullptr);
 
 	Status status = this->status();
 	if (status != Ok)
 		return status;
 
-	QFile file(m_fileName);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	QScopedPointer<QIODevice> file(CompressionDevice::openFile(m_fileName,
+		QIODevice::ReadOnly | QIODevice::Text));
+	if (!file)
 		return Unreadable;
 
-	PgnStream in(&file);
-	if (!in.seek(entry->pos(), entry->lineNumber()) || !game->read(in))
+	PgnStream in(file.data());
+	if (!in.seek(entry.pos(), entry.lineNumber()) || !game->read(in))
 		return Corrupted;
 
 	return Ok;
@@ -24,7 +24,8 @@
 #include <QDateTime>
 #include <QFile>
 #include <pgngame.h>
-#include <pgngameentry.h>
+#include <pgngameentrystore.h>
+#include <positionindex.h>
 class PgnStream;
 
 /*!
@@ -54,25 +55,56 @@ class PgnDatabase : public QObject
 		 * the underlying database.
 		 */
 		PgnDatabase(const QString& fileName, QObject* parent = nullptr);
-		/*! Destroys the database and the game entries it contains. */
+		/*! Destroys the database. */
 		virtual ~PgnDatabase();
 
+		/*! Set the game entries found in this database to \a entries. */
+		void setEntries(const PgnGameEntryStore& entries);
 		/*!
-		 * Set the game entries found in this database to \a entries.
-		 *
-		 * The database takes ownership of the PgnGameEntry objects
-		 * in \a entries.
-		 */
-		void setEntries(const QList<const PgnGameEntry*>& entries);
-		/*!
-		 * Returns the list of game entries in this database.
+		 * Returns the game entries in this database.
 		 *
 		 * Game entries are light-weight "pointers" to the database. The game()
 		 * method can be used to read the move information.
 		 *
 		 * \sa game()
 		 */
-		QList<const PgnGameEntry*> entries() const;
+		const PgnGameEntryStore& entries() const;
+
+		/*!
+		 * Returns the position index of this database.
+		 *
+		 * The game numbers of the index refer to entries(). The
+		 * index is empty if it wasn't built during the import.
+		 *
+		 * \note If the database was opened from a cache file, the
+		 * index is read from the file on the first call.
+		 */
+		const PositionIndex& positionIndex() const;
+		/*! Sets the position index of this database to \a index. */
+		void setPositionIndex(const PositionIndex& index);
+
+		/*!
+		 * Returns the name of the cache file of this database, or
+		 * an empty string if the database has no cache file.
+		 *
+		 * \sa openCache(), writeCache()
+		 */
+		QString cacheFileName() const;
+		/*!
+		 * Opens the entries and the position index of this database
+		 * from cache file \a fileName.
+		 *
+		 * The entries are memory-mapped, so opening the cache takes
+		 * constant time regardless of the number of games.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool openCache(const QString& fileName);
+		/*!
+		 * Writes the entries and the position index of this database
+		 * to cache file \a fileName.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool writeCache(const QString& fileName);
 
 		/*! Returns the file name of this database. */
 		QString fileName() const;
@@ -119,10 +151,13 @@ class PgnDatabase : public QObject
 		 *
 		 * \note \a game must be allocated by the caller and must not be NULL.
 		 */
-		Status game(const PgnGameEntry* entry, PgnGame* game);
+		Status game(const PgnGameEntry& entry, PgnGame* game);
 
 	private:
-		QList<const PgnGameEntry*> m_entries;
+		PgnGameEntryStore m_entries;
+		mutable PositionIndex m_positionIndex;
+		mutable qint64 m_positionIndexPos;
+		QString m_cacheFileName;
 		QDateTime m_lastModified;
 		QString m_fileName;
 		QString m_displayName;
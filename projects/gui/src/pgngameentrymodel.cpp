@@ -17,70 +17,89 @@
 */
 
 #include "pgngameentrymodel.h"
-#include <QtConcurrentFilter>
-#include <pgngameentry.h>
+#include <QtConcurrentMap>
+#include <QSharedPointer>
+#include <algorithm>
+#include <iterator>
 
+namespace {
 
-struct EntryContains
+// The number of entries filtered by a single task
+const int s_blockSize = 1 << 16;
+
+struct BlockFilter
 {
-	EntryContains(const QList<const PgnGameEntry*>& entries,
-		      const PgnGameFilter& filter)
-		: m_entries(entries), m_filter(filter) { }
+	BlockFilter(const PgnGameEntryStore& entries,
+		    const PgnGameFilter& filter,
+		    const QVector<int>* games)
+		: m_matcher(new PgnGameEntryStore::Matcher(entries, filter)),
+		  m_games(games ? *games : QVector<int>()),
+		  m_gameFilter(games != nullptr) { }
 
-	typedef bool result_type;
+	typedef QVector<int> result_type;
 
-	inline bool operator()(int index)
+	QVector<int> operator()(const QPair<int, int>& block) const
 	{
-		return m_entries.at(index)->match(m_filter);
+		QVector<int> rows(m_matcher->filter(block.first, block.second));
+		if (!m_gameFilter)
+			return rows;
+
+		QVector<int> ret;
+		std::set_intersection(rows.constBegin(), rows.constEnd(),
+				      m_games.constBegin(), m_games.constEnd(),
+				      std::back_inserter(ret));
+		return ret;
 	}
 
-	const QList<const PgnGameEntry*>& m_entries;
-	PgnGameFilter m_filter;
+	QSharedPointer<const PgnGameEntryStore::Matcher> m_matcher;
+	QVector<int> m_games;
+	bool m_gameFilter;
 };
 
+} // anonymous namespace
+
 
 PgnGameEntryModel::PgnGameEntryModel(QObject* parent)
 	: QAbstractItemModel(parent),
-	  m_entryCount(0)
+	  m_readyBlocks(0),
+	  m_entryCount(0),
+	  m_gameFilterEnabled(false)
 {
 	connect(&m_watcher, SIGNAL(resultsReadyAt(int,int)),
 		this, SLOT(onResultsReady()));
 }
 
-const PgnGameEntry* PgnGameEntryModel::entryAt(int row) const
+PgnGameEntry PgnGameEntryModel::entryAt(int row) const
 {
-	return m_entries.at(m_filtered.resultAt(row));
+	return m_entries.entry(m_rows.at(row));
 }
 
 int PgnGameEntryModel::sourceIndex(int row) const
 {
-	return m_filtered.resultAt(row);
+	return m_rows.at(row);
 }
 
 int PgnGameEntryModel::entryCount() const
 {
-	return m_filtered.resultCount();
+	return m_rows.size();
 }
 
-void PgnGameEntryModel::setEntries(const QList<const PgnGameEntry*>& entries)
+void PgnGameEntryModel::setEntries(const PgnGameEntryStore& entries)
 {
 	m_watcher.cancel();
 	m_watcher.waitForFinished();
 
 	m_entries = entries;
-
-	if (entries.size() > m_indexes.size())
-	{
-		m_indexes.reserve(entries.size());
-		for (int i = m_indexes.size(); i < entries.size(); i++)
-			m_indexes.append(i);
-	}
-
 	applyFilter(m_filter);
 }
 
 void PgnGameEntryModel::onResultsReady()
 {
+	// Collect the blocks in order
+	const int readyBlocks = m_filtered.resultCount();
+	for (; m_readyBlocks < readyBlocks; m_readyBlocks++)
+		m_rows += m_filtered.resultAt(m_readyBlocks);
+
 	if (m_entryCount < 1024)
 		fetchMore(QModelIndex());
 }
@@ -89,10 +108,18 @@ void PgnGameEntryModel::applyFilter(const PgnGameFilter& filter)
 {
 	beginResetModel();
 	m_entryCount = 0;
+	m_readyBlocks = 0;
+	m_rows.clear();
+
+	const int count = m_entries.count();
+	m_blocks.clear();
+	for (int i = 0; i < count; i += s_blockSize)
+		m_blocks.append(qMakePair(i, qMin(i + s_blockSize, count)));
 
-	m_filtered = QtConcurrent::filtered(m_indexes.constBegin(),
-					    m_indexes.constBegin() + m_entries.size(),
-					    EntryContains(m_entries, filter));
+	m_filtered = QtConcurrent::mapped(m_blocks,
+					  BlockFilter(m_entries, filter,
+						m_gameFilterEnabled ? &m_gameFilter
+								    : nullptr));
 
 	m_watcher.setFuture(m_filtered);
 	endResetModel();
@@ -107,6 +134,29 @@ void PgnGameEntryModel::setFilter(const PgnGameFilter& filter)
 	applyFilter(filter);
 }
 
+void PgnGameEntryModel::setGameFilter(const QVector<int>& games)
+{
+	m_watcher.cancel();
+	m_watcher.waitForFinished();
+
+	m_gameFilter = games;
+	m_gameFilterEnabled = true;
+	applyFilter(m_filter);
+}
+
+void PgnGameEntryModel::clearGameFilter()
+{
+	if (!m_gameFilterEnabled)
+		return;
+
+	m_watcher.cancel();
+	m_watcher.waitForFinished();
+
+	m_gameFilter.clear();
+	m_gameFilterEnabled = false;
+	applyFilter(m_filter);
+}
+
 QModelIndex PgnGameEntryModel::index(int row, int column,
 				 const QModelIndex& parent) const
 {
@@ -128,7 +178,7 @@ int PgnGameEntryModel::rowCount(const QModelIndex& parent) const
 	if (parent.isValid())
 		return 0;
 
-	return qMin(m_entryCount, m_filtered.resultCount());
+	return qMin(m_entryCount, m_rows.size());
 }
 
 int PgnGameEntryModel::columnCount(const QModelIndex& parent) const
@@ -144,13 +194,13 @@ QVariant PgnGameEntryModel::data(const QModelIndex& index, int role) const
 	if (!index.isValid())
 		return QVariant();
 
-	if (index.row() >= m_filtered.resultCount() || index.row() < 0)
+	if (index.row() >= m_rows.size() || index.row() < 0)
 		return QVariant();
 
 	if (role == Qt::DisplayRole || role == Qt::EditRole)
 	{
 		PgnGameEntry::TagType tagType = PgnGameEntry::TagType(index.column());
-		return entryAt(index.row())->tagValue(tagType);
+		return m_entries.tagValue(m_rows.at(index.row()), tagType);
 	}
 
 	return QVariant();
@@ -189,14 +239,14 @@ bool PgnGameEntryModel::canFetchMore(const QModelIndex& parent) const
 {
 	Q_UNUSED(parent);
 
-	return m_entryCount < m_filtered.resultCount();
+	return m_entryCount < m_rows.size();
 }
 
 void PgnGameEntryModel::fetchMore(const QModelIndex& parent)
 {
 	Q_UNUSED(parent);
 
-	int remainder = m_filtered.resultCount() - m_entryCount;
+	int remainder = m_rows.size() - m_entryCount;
 	int entriesToFetch = qMin(1024, remainder);
 	if (entriesToFetch <= 0)
 		return;
@@ -20,14 +20,19 @@
 #define PGN_GAME_ENTRY_MODEL_H
 
 #include <QAbstractItemModel>
-#include <QList>
+#include <QVector>
+#include <QPair>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <pgngamefilter.h>
-class PgnGameEntry;
+#include <pgngameentrystore.h>
 
 /*!
  * \brief Supplies PGN game entry information to views.
+ *
+ * The entries are filtered in blocks on the global thread pool, and
+ * the rows are added to the model as soon as the first blocks are
+ * ready.
  */
 class PgnGameEntryModel : public QAbstractItemModel
 {
@@ -38,7 +43,7 @@ class PgnGameEntryModel : public QAbstractItemModel
 		PgnGameEntryModel(QObject* parent = nullptr);
 
 		/*! Returns the PGN entry at \a row. */
-		const PgnGameEntry* entryAt(int row) const;
+		PgnGameEntry entryAt(int row) const;
 		/*!
 		 * Returns the total number of PGN game entries matching the
 		 * current filter.
@@ -52,8 +57,8 @@ class PgnGameEntryModel : public QAbstractItemModel
 		 * \a row in the model.
 		 */
 		int sourceIndex(int row) const;
-		/*! Associates a list of PGN game entries with this model. */
-		void setEntries(const QList<const PgnGameEntry*>& entries);
+		/*! Associates a collection of PGN game entries with this model. */
+		void setEntries(const PgnGameEntryStore& entries);
 
 		// Inherited from QAbstractItemModel
 		virtual QModelIndex index(int row, int column,
@@ -68,6 +73,15 @@ class PgnGameEntryModel : public QAbstractItemModel
 	public slots:
 		/*! Sets the filter for filtering the contents of the database. */
 		void setFilter(const PgnGameFilter& filter);
+		/*!
+		 * Limits the model to the entries at source indexes \a games,
+		 * which must be in ascending order.
+		 *
+		 * The tag filter set by setFilter() is applied too.
+		 */
+		void setGameFilter(const QVector<int>& games);
+		/*! Removes the filter set by setGameFilter(). */
+		void clearGameFilter();
 
 	protected:
 		// Inherited from QAbstractItemModel
@@ -80,12 +94,16 @@ class PgnGameEntryModel : public QAbstractItemModel
 	private:
 		void applyFilter(const PgnGameFilter& filter);
 
-		QList<const PgnGameEntry*> m_entries;
-		QVector<int> m_indexes;
+		PgnGameEntryStore m_entries;
+		QVector<QPair<int, int>> m_blocks;
+		QVector<int> m_rows;
+		int m_readyBlocks;
 		int m_entryCount;
-		QFuture<int> m_filtered;
-		QFutureWatcher<int> m_watcher;
+		QFuture<QVector<int>> m_filtered;
+		QFutureWatcher<QVector<int>> m_watcher;
 		PgnGameFilter m_filter;
+		QVector<int> m_gameFilter;
+		bool m_gameFilterEnabled;
 };
 
 #endif // PGN_GAME_ENTRY_MODEL_H
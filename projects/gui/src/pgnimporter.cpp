@@ -20,14 +20,116 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QScopedPointer>
+#include <QVector>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <cstring>
 
 #include <pgnstream.h>
-#include <pgngameentry.h>
+#include <compressiondevice.h>
+#include <pgngameentrystore.h>
+#include <pgngame.h>
+#include <positionindex.h>
+#include <board/board.h>
 #include "pgndatabase.h"
 
+namespace {
+
+// Files smaller than this are read sequentially
+const qint64 s_minParallelSize = 16 * 1024 * 1024;
+// Limits for the size of the chunks parsed in parallel
+const qint64 s_minChunkSize = 4 * 1024 * 1024;
+const qint64 s_maxChunkSize = 64 * 1024 * 1024;
+
+struct Chunk
+{
+	qint64 start;
+	qint64 end;
+	qint64 lineCount;
+	qint64 lineNumber;
+	PgnGameEntryStore games;
+	PositionIndexBuilder index;
+	bool done;
+};
+
+// Run size of the position index of a single chunk
+const int s_chunkIndexRunSize = 1 << 20;
+
+/*
+ * Returns the position of the first game that starts at or after
+ * \a from, or \a size if there are no more games. A game starts with
+ * an "Event" tag on the line after a blank line.
+ */
+qint64 findGameStart(const char* data, qint64 size, qint64 from)
+{
+	static const char tag[] = "[Event ";
+	static const qint64 tagLength = sizeof(tag) - 1;
+
+	if (from >= size)
+		return size;
+
+	const char* end = data + size;
+	const char* p = data + qMax(from - 1, qint64(0));
+	while ((p = static_cast<const char*>(memchr(p, '\n', end - p))))
+	{
+		const char* line = ++p;
+		if (end - line < tagLength)
+			break;
+		if (memcmp(line, tag, tagLength) != 0)
+			continue;
+
+		// The previous line must be empty
+		const char* q = line - 2;
+		while (q >= data && *q == '\r')
+			q--;
+		if (q >= data && *q == '\n')
+			return line - data;
+	}
+
+	return size;
+}
+
+qint64 countLines(const char* data, qint64 size)
+{
+	qint64 count = 0;
+	const char* end = data + size;
+	while ((data = static_cast<const char*>(memchr(data, '\n', end - data))))
+	{
+		count++;
+		data++;
+	}
+
+	return count;
+}
+
+/*
+ * Reads the moves of \a entry from stream \a in and adds its
+ * positions to \a index as game number \a number.
+ */
+void indexGame(PgnStream& in,
+	       const PgnGameEntry& entry,
+	       quint32 number,
+	       PositionIndexBuilder* index)
+{
+	PgnGame game;
+	if (!in.seek(entry.pos(), entry.lineNumber())
+	||  !game.read(in, INT_MAX - 1, false))
+		return;
+
+	index->addGame(number, game);
+	if (!game.moves().isEmpty() && in.board() != nullptr)
+		index->addPosition(in.board()->key(), number);
+}
+
+} // anonymous namespace
+
 PgnImporter::PgnImporter(const QString& fileName)
 	: Worker(QString("PGN import: %1").arg(fileName)),
-	  m_fileName(fileName)
+	  m_fileName(fileName),
+	  m_positionIndexEnabled(false)
 {
 }
 
@@ -36,12 +138,14 @@ QString PgnImporter::fileName() const
 	return m_fileName;
 }
 
+void PgnImporter::setPositionIndexEnabled(bool enabled)
+{
+	m_positionIndexEnabled = enabled;
+}
+
 void PgnImporter::work()
 {
-	QFile file(m_fileName);
 	QFileInfo fileInfo(m_fileName);
-	static const int updateInterval = 1024;
-	int numReadGames = 0;
 
 	if (!fileInfo.exists())
 	{
@@ -49,34 +153,183 @@ void PgnImporter::work()
 		return;
 	}
 
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	QScopedPointer<QIODevice> file(CompressionDevice::openFile(m_fileName,
+		QIODevice::ReadOnly | QIODevice::Text));
+	if (!file)
 	{
 		emit error(PgnImporter::IoError);
 		return;
 	}
 
-	PgnStream pgnStream(&file);
-	QList<const PgnGameEntry*> games;
+	QScopedPointer<PositionIndexBuilder> index;
+	if (m_positionIndexEnabled)
+		index.reset(new PositionIndexBuilder);
+
+	// Compressed files can't be split, so they're read sequentially
+	PgnGameEntryStore games;
+	auto plainFile = qobject_cast<QFile*>(file.data());
+	if (plainFile == nullptr
+	||  plainFile->size() < s_minParallelSize
+	||  QThread::idealThreadCount() < 2
+	||  !readParallel(plainFile, games, index.data()))
+		readSequential(file.data(), games, index.data());
+
+	PgnDatabase* db = new PgnDatabase(m_fileName);
+	db->setEntries(games);
+	if (index && !cancelRequested())
+		db->setPositionIndex(index->build());
+	db->setLastModified(fileInfo.lastModified());
+
+	emit databaseRead(db);
+}
 
-	for (;;)
+void PgnImporter::readSequential(QIODevice* device,
+				 PgnGameEntryStore& games,
+				 PositionIndexBuilder* index)
+{
+	static const int updateInterval = 1024;
+	int numReadGames = 0;
+
+	// The progress is measured in bytes of the file on disk
+	auto compressed = qobject_cast<CompressionDevice*>(device);
+
+	PgnStream pgnStream(device);
+
+	// The moves are read from a second device which follows the
+	// first one, so compressed files don't need to be rewound
+	QScopedPointer<QIODevice> gameDevice;
+	QScopedPointer<PgnStream> gameStream;
+	if (index != nullptr)
 	{
-		PgnGameEntry* game = new PgnGameEntry;
-		if (cancelRequested() || !game->read(pgnStream))
-		{
-			delete game;
-			break;
-		}
+		gameDevice.reset(CompressionDevice::openFile(m_fileName,
+			QIODevice::ReadOnly | QIODevice::Text));
+		if (gameDevice)
+			gameStream.reset(new PgnStream(gameDevice.data()));
+	}
+
+	PgnGameEntry game;
+	while (!cancelRequested() && game.read(pgnStream))
+	{
+		if (gameStream)
+			indexGame(*gameStream, game, quint32(numReadGames), index);
 
-		games << game;
+		games.append(game);
 		numReadGames++;
 
 		if (numReadGames % updateInterval == 0)
 			emit databaseReadStatus(startTime(), numReadGames,
-			    pgnStream.pos());
+			    compressed ? compressed->device()->pos()
+				       : pgnStream.pos());
 	}
-	PgnDatabase* db = new PgnDatabase(m_fileName);
-	db->setEntries(games);
-	db->setLastModified(fileInfo.lastModified());
+}
 
-	emit databaseRead(db);
+bool PgnImporter::readParallel(QFile* file,
+			       PgnGameEntryStore& games,
+			       PositionIndexBuilder* index)
+{
+	const qint64 size = file->size();
+	uchar* map = file->map(0, size);
+	if (map == nullptr)
+		return false;
+	const char* data = reinterpret_cast<const char*>(map);
+
+	// Split the file into a few chunks per thread
+	const int threadCount = QThread::idealThreadCount();
+	const qint64 chunkSize = qBound(s_minChunkSize,
+					size / (threadCount * 8),
+					s_maxChunkSize);
+	QVector<Chunk> chunkList;
+	for (qint64 start = 0; start < size; )
+	{
+		qint64 end = findGameStart(data, size, start + chunkSize);
+		chunkList.append({start, end, 0, 1, {},
+				  PositionIndexBuilder(s_chunkIndexRunSize),
+				  false});
+		start = end;
+	}
+	Chunk* chunks = chunkList.data();
+	const int chunkCount = chunkList.size();
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(threadCount);
+
+	// Count the lines first so that the games get correct
+	// line numbers, which also reads the file into memory
+	for (int i = 0; i < chunkCount; i++)
+	{
+		pool.start([chunks, data, i]()
+		{
+			Chunk& chunk = chunks[i];
+			chunk.lineCount = countLines(data + chunk.start,
+						     chunk.end - chunk.start);
+		});
+	}
+	pool.waitForDone();
+
+	qint64 lineNumber = 1;
+	for (int i = 0; i < chunkCount; i++)
+	{
+		chunks[i].lineNumber = lineNumber;
+		lineNumber += chunks[i].lineCount;
+	}
+
+	QMutex mutex;
+	QWaitCondition chunkDone;
+	for (int i = 0; i < chunkCount; i++)
+	{
+		pool.start([this, chunks, i, index, &mutex, &chunkDone]()
+		{
+			Chunk& chunk = chunks[i];
+			QFile chunkFile(m_fileName);
+			QFile gameFile(m_fileName);
+			if (!cancelRequested()
+			&&  chunkFile.open(QIODevice::ReadOnly | QIODevice::Text))
+			{
+				PgnStream in(&chunkFile);
+				in.seek(chunk.start, chunk.lineNumber);
+
+				QScopedPointer<PgnStream> gameIn;
+				if (index != nullptr
+				&&  gameFile.open(QIODevice::ReadOnly | QIODevice::Text))
+					gameIn.reset(new PgnStream(&gameFile));
+
+				PgnGameEntry game;
+				while (!cancelRequested()
+				&&     game.read(in) && game.pos() < chunk.end)
+				{
+					if (gameIn)
+						indexGame(*gameIn, game,
+							  quint32(chunk.games.count()),
+							  &chunk.index);
+					chunk.games.append(game);
+				}
+			}
+
+			QMutexLocker locker(&mutex);
+			chunk.done = true;
+			chunkDone.wakeAll();
+		});
+	}
+
+	// Merge the results in file order
+	int numReadGames = 0;
+	for (int i = 0; i < chunkCount && !cancelRequested(); i++)
+	{
+		Chunk& chunk = chunks[i];
+		mutex.lock();
+		while (!chunk.done)
+			chunkDone.wait(&mutex);
+		mutex.unlock();
+
+		if (index != nullptr)
+			index->addIndex(chunk.index, quint32(numReadGames));
+		games.append(chunk.games);
+		numReadGames += chunk.games.count();
+		chunk.games.clear();
+		emit databaseReadStatus(startTime(), numReadGames, chunk.end);
+	}
+	pool.waitForDone();
+
+	file->unmap(map);
+	return true;
 }
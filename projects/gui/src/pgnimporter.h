@@ -21,11 +21,25 @@
 
 #include <worker.h>
 
+class QFile;
+class QIODevice;
 class PgnDatabase;
+class PgnGameEntryStore;
+class PgnStream;
+class PositionIndexBuilder;
 
 /*!
  * \brief Reads PGN database in a separate thread.
  *
+ * Large uncompressed files are split into chunks at game boundaries
+ * (a blank line followed by an "Event" tag), and the chunks are
+ * parsed concurrently on a private thread pool. The entries are
+ * merged in file order, so the result is the same as when reading
+ * the file sequentially.
+ *
+ * If enabled with setPositionIndexEnabled(), the moves of each game
+ * are also parsed to build a PositionIndex for position searches.
+ *
  * \sa PgnDatabase
  */
 class PgnImporter : public Worker
@@ -48,6 +62,15 @@ class PgnImporter : public Worker
 		/*! Returns the file name of the database to be imported. */
 		QString fileName() const;
 
+		/*!
+		 * If \a enabled is true, a position index is built for
+		 * the database. The default is false.
+		 *
+		 * \note Building the index requires parsing every move,
+		 * which makes the import several times slower.
+		 */
+		void setPositionIndexEnabled(bool enabled);
+
 	protected:
 		void work() override;
 
@@ -58,12 +81,20 @@ class PgnImporter : public Worker
 		 * Emitted periodically to give progress information about the import.
 		 *
 		 * The import was initiated at \a started and so far \a numReadGames games
-		 * and \a numReadBytes bytes have been read.
+		 * and \a numReadBytes bytes have been read by all import threads.
 		 */
 		void databaseReadStatus(const QTime& started, int numReadGames, qint64 numReadBytes);
 
 	private:
+		void readSequential(QIODevice* device,
+				    PgnGameEntryStore& games,
+				    PositionIndexBuilder* index);
+		bool readParallel(QFile* file,
+				  PgnGameEntryStore& games,
+				  PositionIndexBuilder* index);
+
 		QString m_fileName;
+		bool m_positionIndexEnabled;
 
 };
 
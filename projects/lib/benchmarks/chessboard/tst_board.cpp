@@ -0,0 +1,229 @@
+#include <QtTest/QtTest>
+#include <QScopedPointer>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+
+class tst_Board: public QObject
+{
+	Q_OBJECT
+
+	public:
+		tst_Board();
+
+	private slots:
+		void repeatCount_data() const;
+		void repeatCount();
+		void perft_data() const;
+		void perft();
+		void moveStrings_data() const;
+		void moveStrings();
+		void fenRoundTrip_data() const;
+		void fenRoundTrip();
+
+		void cleanupTestCase();
+
+	private:
+		void playMoves(const QStringList& moves);
+		Chess::Board* m_board;
+};
+
+
+tst_Board::tst_Board()
+	: m_board(Chess::BoardFactory::create("standard"))
+{
+}
+
+void tst_Board::cleanupTestCase()
+{
+	delete m_board;
+}
+
+void tst_Board::playMoves(const QStringList& moves)
+{
+	for (const auto& moveStr : moves)
+	{
+		Chess::Move move = m_board->moveFromString(moveStr);
+		QVERIFY(m_board->isLegalMove(move));
+		m_board->makeMove(move);
+	}
+}
+
+void tst_Board::repeatCount_data() const
+{
+	QTest::addColumn<int>("plies");
+
+	QTest::newRow("100 plies") << 100;
+	QTest::newRow("1000 plies") << 1000;
+	QTest::newRow("10000 plies") << 10000;
+}
+
+void tst_Board::repeatCount()
+{
+	QFETCH(int, plies);
+
+	// A long shuffling game followed by a pawn move on both sides and
+	// a few more shuffles. Only the plies after the last irreversible
+	// move should affect the cost of repetition detection, so the
+	// per-ply cost should stay the same regardless of game length.
+	const QStringList shuffle = QStringList()
+		<< "a1b1" << "a8b8" << "b1a1" << "b8a8";
+
+	QVERIFY(m_board->setFenString("r3k3/7p/8/8/8/8/7P/R3K3 w - - 0 1"));
+	for (int i = 0; i < plies / shuffle.size(); i++)
+		playMoves(shuffle);
+	playMoves(QStringList() << "h2h3" << "h7h6");
+	for (int i = 0; i < 5; i++)
+		playMoves(shuffle);
+
+	Chess::Move move = m_board->moveFromString("a1b1");
+	QVERIFY(!move.isNull());
+
+	QBENCHMARK
+	{
+		m_board->isRepetition(move);
+		m_board->repeatCount();
+	}
+	QCOMPARE(m_board->repeatCount(), 5);
+}
+
+static quint64 perftVal(Chess::Board* board, int depth)
+{
+	quint64 nodeCount = 0;
+	const auto moves = board->legalMoves();
+	if (depth == 1 || moves.isEmpty())
+		return moves.size();
+
+	for (const auto& move : moves)
+	{
+		board->makeMove(move);
+		nodeCount += perftVal(board, depth - 1);
+		board->undoMove();
+	}
+
+	return nodeCount;
+}
+
+void tst_Board::perft_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<int>("depth");
+
+	const auto variants = Chess::BoardFactory::variants();
+	for (const auto& variant : variants)
+	{
+		// Random variants would make the results irreproducible
+		QScopedPointer<Chess::Board> board(Chess::BoardFactory::create(variant));
+		if (board->isRandomVariant())
+			continue;
+
+		// Keep games with huge branching factors (eg. gomoku) fast
+		board->setFenString(board->defaultFenString());
+		int depth = board->legalMoves().size() < 100 ? 3 : 2;
+
+		QTest::newRow(qPrintable(variant)) << variant << depth;
+	}
+}
+
+void tst_Board::perft()
+{
+	QFETCH(QString, variant);
+	QFETCH(int, depth);
+
+	QScopedPointer<Chess::Board> board(Chess::BoardFactory::create(variant));
+	QVERIFY(!board.isNull());
+	QVERIFY(board->setFenString(board->defaultFenString()));
+
+	quint64 nodeCount = 0;
+	QBENCHMARK
+	{
+		nodeCount = perftVal(board.data(), depth);
+	}
+	QVERIFY(nodeCount > 0);
+}
+
+void tst_Board::moveStrings_data() const
+{
+	QTest::addColumn<QString>("fen");
+	QTest::addColumn<int>("notation");
+
+	const QString middlegame(
+		"r1bq1rk1/pp2nppp/2n1p3/3pP3/1b1P4/2NB1N2/PP3PPP/R1BQK2R w KQ - 4 9");
+	const QString promotions(
+		"1r2k3/2P3P1/8/8/8/8/1p6/R3K2R w KQ - 0 1");
+
+	QTest::newRow("san middlegame")
+		<< middlegame << int(Chess::Board::StandardAlgebraic);
+	QTest::newRow("lan middlegame")
+		<< middlegame << int(Chess::Board::LongAlgebraic);
+	QTest::newRow("san promotions")
+		<< promotions << int(Chess::Board::StandardAlgebraic);
+	QTest::newRow("lan promotions")
+		<< promotions << int(Chess::Board::LongAlgebraic);
+}
+
+void tst_Board::moveStrings()
+{
+	QFETCH(QString, fen);
+	QFETCH(int, notation);
+
+	QVERIFY(m_board->setFenString(fen));
+	const auto moves = m_board->legalMoves();
+	QVERIFY(!moves.isEmpty());
+
+	// Print every legal move and parse it back
+	const auto moveNotation = Chess::Board::MoveNotation(notation);
+	QBENCHMARK
+	{
+		for (const auto& move : moves)
+		{
+			const QString str(m_board->moveString(move, moveNotation));
+			if (m_board->moveFromString(str) != move)
+				QFAIL(qPrintable("Can't parse move string " + str));
+		}
+	}
+}
+
+void tst_Board::fenRoundTrip_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QString>("fen");
+
+	QTest::newRow("standard")
+		<< "standard"
+		<< "r1bq1rk1/pp2nppp/2n1p3/3pP3/1b1P4/2NB1N2/PP3PPP/R1BQK2R w KQ - 4 9";
+	QTest::newRow("capablanca")
+		<< "capablanca"
+		<< "r1abqkbcnr/pppp1ppppp/2n7/4p5/4P5/7N2/PPPP1PPPPP/RNABQKBC1R w KQkq - 2 3";
+	QTest::newRow("crazyhouse")
+		<< "crazyhouse"
+		<< "r1bqkbnr/pp3ppp/2ppp3/8/2BQP3/2N5/PPP2PPP/R1B2RK1[NPn] b kq - 0 1";
+	QTest::newRow("shogi startpos")
+		<< "shogi"
+		<< QString();
+}
+
+void tst_Board::fenRoundTrip()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, fen);
+
+	QScopedPointer<Chess::Board> board(Chess::BoardFactory::create(variant));
+	QVERIFY(!board.isNull());
+	if (fen.isEmpty())
+		fen = board->defaultFenString();
+
+	// Use the board's own output as the reference so that the
+	// benchmark doesn't depend on how eg. hand pieces are ordered
+	QVERIFY(board->setFenString(fen));
+	const QString expected(board->fenString());
+
+	QBENCHMARK
+	{
+		QVERIFY(board->setFenString(expected));
+		QCOMPARE(board->fenString(), expected);
+	}
+}
+
+QTEST_MAIN(tst_Board)
+#include "tst_board.moc"
@@ -0,0 +1,98 @@
+#include <QtTest/QtTest>
+#include <QProcess>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <engineprocess.h>
+
+class tst_EngineProcess: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+
+		void spawn_data() const;
+		void spawn();
+		void roundTrip_data() const;
+		void roundTrip();
+
+	private:
+		template <typename Process>
+		void spawnProcess();
+		template <typename Process>
+		void roundTripProcess();
+};
+
+void tst_EngineProcess::initTestCase()
+{
+	if (QStandardPaths::findExecutable("cat").isEmpty())
+		QSKIP("cat is not available");
+}
+
+template <typename Process>
+void tst_EngineProcess::spawnProcess()
+{
+	QBENCHMARK
+	{
+		Process process;
+		process.start("cat", QStringList());
+		QVERIFY(process.waitForStarted());
+		process.close();
+	}
+}
+
+template <typename Process>
+void tst_EngineProcess::roundTripProcess()
+{
+	Process process;
+	QSignalSpy spy(&process, SIGNAL(readyRead()));
+	process.start("cat", QStringList());
+	QVERIFY(process.waitForStarted());
+
+	const QByteArray line("info depth 20 score cp 31 pv e2e4 e7e5\n");
+	QBENCHMARK
+	{
+		QCOMPARE(process.write(line), qint64(line.size()));
+		while (!process.canReadLine())
+			QVERIFY(spy.wait(5000));
+		QCOMPARE(process.readLine(), line);
+	}
+
+	process.close();
+}
+
+void tst_EngineProcess::spawn_data() const
+{
+	QTest::addColumn<bool>("native");
+
+	QTest::newRow("EngineProcess") << true;
+	QTest::newRow("QProcess") << false;
+}
+
+void tst_EngineProcess::spawn()
+{
+	QFETCH(bool, native);
+
+	if (native)
+		spawnProcess<EngineProcess>();
+	else
+		spawnProcess<QProcess>();
+}
+
+void tst_EngineProcess::roundTrip_data() const
+{
+	spawn_data();
+}
+
+void tst_EngineProcess::roundTrip()
+{
+	QFETCH(bool, native);
+
+	if (native)
+		roundTripProcess<EngineProcess>();
+	else
+		roundTripProcess<QProcess>();
+}
+
+QTEST_MAIN(tst_EngineProcess)
+#include "tst_engineprocess.moc"
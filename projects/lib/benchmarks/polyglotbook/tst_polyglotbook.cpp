@@ -0,0 +1,72 @@
+#include <QtTest/QtTest>
+#include <polyglotbook.h>
+#include <board/standardboard.h>
+
+class tst_PolyglotBook: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+
+		void probe_data() const;
+		void probe();
+
+	private:
+		QVector<quint64> m_keys;
+};
+
+void tst_PolyglotBook::initTestCase()
+{
+	// Keys of positions found in the book and a few that aren't
+	const QStringList lines = QStringList()
+		<< ""
+		<< "e2e4"
+		<< "d2d4"
+		<< "e2e4 e7e5"
+		<< "d2d4 g8f6 c2c4"
+		<< "a2a3 h7h6 h2h3";
+
+	Chess::StandardBoard board;
+	for (const auto& line : lines)
+	{
+		QVERIFY(board.setFenString(board.defaultFenString()));
+		const auto moves = line.split(' ', Qt::SkipEmptyParts);
+		for (const auto& moveStr : moves)
+		{
+			Chess::Move move = board.moveFromString(moveStr);
+			QVERIFY(board.isLegalMove(move));
+			board.makeMove(move);
+		}
+		m_keys << board.key();
+	}
+}
+
+void tst_PolyglotBook::probe_data() const
+{
+	QTest::addColumn<int>("mode");
+
+	QTest::newRow("ram") << int(OpeningBook::Ram);
+	QTest::newRow("disk") << int(OpeningBook::Disk);
+	QTest::newRow("mapped") << int(OpeningBook::Mapped);
+}
+
+void tst_PolyglotBook::probe()
+{
+	QFETCH(int, mode);
+
+	PolyglotBook book(OpeningBook::AccessMode(mode));
+	QVERIFY(book.read(QStringLiteral(CUTECHESS_TEST_DATA_DIR).append("/book_small.bin")));
+
+	int count = 0;
+	QBENCHMARK
+	{
+		count = 0;
+		for (quint64 key : qAsConst(m_keys))
+			count += book.entries(key).size();
+	}
+	QVERIFY(count > 0);
+}
+
+QTEST_MAIN(tst_PolyglotBook)
+#include "tst_polyglotbook.moc"
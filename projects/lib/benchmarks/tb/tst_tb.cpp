@@ -0,0 +1,82 @@
+#include <QtTest/QtTest>
+#include <QDir>
+#include <board/standardboard.h>
+#include <board/syzygytablebase.h>
+
+
+class tst_Tb: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+
+		void probe_data() const;
+		void probe();
+		void probeWdl_data() const;
+		void probeWdl();
+
+	private:
+		Chess::StandardBoard m_board;
+};
+
+
+void tst_Tb::initTestCase()
+{
+	const auto path = QLatin1String("tb_path");
+	QDir dir(path);
+	if (!dir.exists())
+		QSKIP("Syzygy tablebases not available");
+
+	SyzygyTablebase::initialize(path);
+	if (!SyzygyTablebase::tbAvailable(4))
+		QSKIP("4-piece tablebases not available");
+}
+
+void tst_Tb::probe_data() const
+{
+	QTest::addColumn<QString>("fen");
+
+	QTest::newRow("KPK win")
+		<< "7k/8/8/8/5KP1/8/8/8 w - - 0 1";
+	QTest::newRow("KPK draw")
+		<< "7k/8/8/6P1/5K2/8/8/8 w - - 0 1";
+	QTest::newRow("KRKN")
+		<< "1n6/8/8/8/8/8/6R1/2K1k3 w - - 0 1";
+	QTest::newRow("KBKP")
+		<< "2B5/8/8/8/8/2K2k2/6p1/8 b - - 0 1";
+}
+
+void tst_Tb::probe()
+{
+	QFETCH(QString, fen);
+
+	QVERIFY(m_board.setFenString(fen));
+
+	unsigned int dtz = 0;
+	QBENCHMARK
+	{
+		QVERIFY(!m_board.tablebaseResult(&dtz).isNone());
+	}
+}
+
+void tst_Tb::probeWdl_data() const
+{
+	probe_data();
+}
+
+void tst_Tb::probeWdl()
+{
+	QFETCH(QString, fen);
+
+	QVERIFY(m_board.setFenString(fen));
+
+	// Without DTZ the result usually comes from the WDL cache
+	QBENCHMARK
+	{
+		QVERIFY(!m_board.tablebaseResult().isNone());
+	}
+}
+
+QTEST_MAIN(tst_Tb)
+#include "tst_tb.moc"
@@ -0,0 +1,90 @@
+#include <QtTest/QtTest>
+#include <QScopedPointer>
+#include <uciengine.h>
+#include <pvconverter.h>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+class tst_UciEngine: public UciEngine
+{
+	Q_OBJECT
+
+	public:
+		tst_UciEngine();
+
+	private slots:
+		void parseInfo_data() const;
+		void parseInfo();
+		void sanPv_data() const;
+		void sanPv();
+};
+
+tst_UciEngine::tst_UciEngine()
+	: UciEngine()
+{
+}
+
+void tst_UciEngine::parseInfo_data() const
+{
+	QTest::addColumn<QString>("line");
+
+	QTest::newRow("currmove")
+		<< "info depth 24 currmove e2e4 currmovenumber 1";
+	QTest::newRow("score")
+		<< "info depth 24 seldepth 33 multipv 1 score cp 31 nodes 5843194 "
+		   "nps 2453891 hashfull 211 tbhits 0 time 2381";
+	QTest::newRow("pv")
+		<< "info depth 24 seldepth 33 multipv 1 score cp 31 nodes 5843194 "
+		   "nps 2453891 hashfull 211 tbhits 0 time 2381 pv e2e4 e7e5 "
+		   "g1f3 b8c6 f1b5 g8f6 e1g1 f6e4 f1e1 e4d6 f3e5 f8e7 b5f1 "
+		   "c6e5 e1e5 e8g8 d2d4 e7f6 e5e1 f8e8 c2c3 e8e1 d1e1 d6e8";
+	QTest::newRow("string")
+		<< "info string NNUE evaluation using nn-0000000000a0.nnue enabled";
+}
+
+void tst_UciEngine::parseInfo()
+{
+	QFETCH(QString, line);
+
+	const QByteArray data(line.toUtf8());
+	QBENCHMARK
+	{
+		parseLine(data);
+	}
+}
+
+void tst_UciEngine::sanPv_data() const
+{
+	QTest::addColumn<bool>("cached");
+
+	QTest::newRow("cold") << false;
+	QTest::newRow("cached") << true;
+}
+
+void tst_UciEngine::sanPv()
+{
+	QFETCH(bool, cached);
+
+	const QString moves(" e2e4 e7e5");
+	const QString pv("g1f3 b8c6 f1b5 g8f6 e1g1 f6e4 f1e1 e4d6 f3e5 "
+			 "f8e7 b5f1 c6e5 e1e5 e8g8 d2d4 e7f6 e5e1 f8e8");
+
+	QScopedPointer<Chess::Board> board(Chess::BoardFactory::create("standard"));
+	const QString startFen(board->defaultFenString());
+	QVERIFY(board->setFenString(startFen));
+
+	QScopedPointer<PvConverter> converter(new PvConverter(board.data()));
+	QString san(converter->sanPv(startFen, moves, pv));
+	QCOMPARE(san.count(' '), pv.count(' '));
+
+	QBENCHMARK
+	{
+		if (!cached)
+			converter.reset(new PvConverter(board.data()));
+		san = converter->sanPv(startFen, moves, pv);
+	}
+	QCOMPARE(san.count(' '), pv.count(' '));
+}
+
+QTEST_MAIN(tst_UciEngine)
+#include "tst_uciengine.moc"
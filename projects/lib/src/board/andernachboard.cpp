@@ -95,6 +95,12 @@ bool AndernachBoard::switchesSides(const Move& move) const
 	&&     pieceAt(move.sourceSquare()).type() != King;
 }
 
+bool AndernachBoard::supportsCheckMasks() const
+{
+	// A piece that switches sides can give check to its old king
+	return false;
+}
+
 
 
 AntiAndernachBoard::AntiAndernachBoard()
@@ -47,6 +47,12 @@ bool AntiBoard::hasCastling() const
 	return false;
 }
 
+bool AntiBoard::supportsCheckMasks() const
+{
+	// There are no checks and captures are compulsory
+	return false;
+}
+
 bool AntiBoard::kingsCountAssertion( int whiteKings,
 				     int blackKings) const
 {
@@ -50,6 +50,11 @@ bool AtomicBoard::kingCanCapture() const
 	return false;
 }
 
+bool AtomicBoard::supportsBitboards() const
+{
+	return true;
+}
+
 void AtomicBoard::vInitialize()
 {
 	int arwidth = width() + 2;
@@ -48,6 +48,7 @@ class LIB_EXPORT AtomicBoard : public WesternBoard
 		virtual void vInitialize();
 		virtual bool inCheck(Side side, int square = 0) const;
 		virtual bool kingCanCapture() const;
+		virtual bool supportsBitboards() const;
 		virtual bool vSetFenString(const QStringList& fen);
 		virtual bool vIsLegalMove(const Move& move);
 		virtual void vMakeMove(const Move& move,
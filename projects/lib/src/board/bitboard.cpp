@@ -0,0 +1,282 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bitboard.h"
+#include <QMutex>
+#include <QMutexLocker>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct Magic
+{
+	quint64 mask;
+	quint64 magic;
+	quint64* attacks;
+	unsigned shift;
+
+	unsigned index(quint64 occupied) const
+	{
+#if defined(__BMI2__)
+		return unsigned(_pext_u64(occupied, mask));
+#else
+		return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+	}
+};
+
+struct Direction
+{
+	int file;
+	int rank;
+};
+
+const Direction s_bishopDirections[] =
+	{ { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } };
+const Direction s_rookDirections[] =
+	{ { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+
+quint64 s_knightAttacks[64];
+quint64 s_kingAttacks[64];
+Magic s_bishopMagics[64];
+Magic s_rookMagics[64];
+quint64 s_bishopTable[0x1480];
+quint64 s_rookTable[0x19000];
+
+bool s_initialized = false;
+QMutex s_mutex;
+
+inline quint64 squareBit(int file, int rank)
+{
+	if (file < 0 || file > 7 || rank < 0 || rank > 7)
+		return 0;
+	return Q_UINT64_C(1) << (rank * 8 + file);
+}
+
+quint64 slidingAttacks(const Direction* directions,
+		       int square,
+		       quint64 occupied)
+{
+	quint64 attacks = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		int file = square % 8 + directions[i].file;
+		int rank = square / 8 + directions[i].rank;
+		quint64 bit;
+		while ((bit = squareBit(file, rank)) != 0)
+		{
+			attacks |= bit;
+			if (occupied & bit)
+				break;
+			file += directions[i].file;
+			rank += directions[i].rank;
+		}
+	}
+
+	return attacks;
+}
+
+/*
+ * The magic bitboard initialization below (the xorshift64* generator,
+ * the per-rank seeds and the epoch-based verification of candidate
+ * magics) is adapted from Stockfish's bitboard.cpp and misc.h:
+ *
+ *   Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+ *   Copyright (C) 2004-2023 The Stockfish developers (see AUTHORS file)
+ *
+ * Stockfish is free software distributed under the terms of the GNU
+ * General Public License version 3 or later.
+ * See https://github.com/official-stockfish/Stockfish
+ */
+
+#if !defined(__BMI2__)
+/*!
+ * A xorshift64* pseudo-random number generator for finding magics.
+ * The per-rank seeds are known to find magics quickly.
+ */
+quint64 random64(quint64& state)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * Q_UINT64_C(2685821657736338717);
+}
+#endif
+
+void initMagics(const Direction* directions,
+		Magic* magics,
+		quint64* table)
+{
+	quint64 occupancy[4096];
+	quint64 reference[4096];
+	int epoch[4096] = {};
+	int attempt = 0;
+	int size = 0;
+	static const quint64 seeds[8] =
+		{ 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+
+	for (int sq = 0; sq < 64; sq++)
+	{
+		// Squares on the board's edge don't block anything,
+		// unless the piece is on the same edge.
+		quint64 rankEdges = Q_UINT64_C(0xFF000000000000FF)
+				    & ~(Q_UINT64_C(0xFF) << (sq / 8 * 8));
+		quint64 fileEdges = Q_UINT64_C(0x8181818181818181)
+				    & ~(Q_UINT64_C(0x0101010101010101) << (sq % 8));
+
+		Magic& m = magics[sq];
+		m.mask = slidingAttacks(directions, sq, 0) & ~(rankEdges | fileEdges);
+		m.shift = 64 - Chess::Bitboard::count(m.mask);
+		m.attacks = (sq == 0) ? table : magics[sq - 1].attacks + size;
+
+		// Enumerate all subsets of the mask with the
+		// Carry-Rippler trick
+		quint64 b = 0;
+		size = 0;
+		do
+		{
+			occupancy[size] = b;
+			reference[size] = slidingAttacks(directions, sq, b);
+#if defined(__BMI2__)
+			m.attacks[m.index(b)] = reference[size];
+#endif
+			size++;
+			b = (b - m.mask) & m.mask;
+		} while (b != 0);
+
+#if !defined(__BMI2__)
+		quint64 state = seeds[sq / 8];
+
+		// Try sparse random numbers until one of them maps every
+		// subset to a slot that is either unused or has the same
+		// attacks.
+		for (int i = 0; i < size; )
+		{
+			m.magic = 0;
+			while (Chess::Bitboard::count((m.magic * m.mask) >> 56) < 6)
+				m.magic = random64(state) & random64(state) & random64(state);
+
+			for (attempt++, i = 0; i < size; i++)
+			{
+				unsigned idx = m.index(occupancy[i]);
+				if (epoch[idx] < attempt)
+				{
+					epoch[idx] = attempt;
+					m.attacks[idx] = reference[i];
+				}
+				else if (m.attacks[idx] != reference[i])
+					break;
+			}
+		}
+#else
+		Q_UNUSED(occupancy);
+		Q_UNUSED(epoch);
+		Q_UNUSED(attempt);
+		Q_UNUSED(seeds);
+#endif
+	}
+}
+
+} // anonymous namespace
+
+namespace Chess {
+namespace Bitboard {
+
+void initialize()
+{
+	QMutexLocker locker(&s_mutex);
+
+	if (s_initialized)
+		return;
+
+	static const Direction knightSteps[] =
+	{
+		{ -2, -1 }, { -2, 1 }, { -1, -2 }, { -1, 2 },
+		{ 1, -2 }, { 1, 2 }, { 2, -1 }, { 2, 1 }
+	};
+	for (int sq = 0; sq < 64; sq++)
+	{
+		int file = sq % 8;
+		int rank = sq / 8;
+
+		s_knightAttacks[sq] = 0;
+		s_kingAttacks[sq] = 0;
+		for (const Direction& d : knightSteps)
+			s_knightAttacks[sq] |= squareBit(file + d.file, rank + d.rank);
+		for (int df = -1; df <= 1; df++)
+		{
+			for (int dr = -1; dr <= 1; dr++)
+			{
+				if (df != 0 || dr != 0)
+					s_kingAttacks[sq] |= squareBit(file + df, rank + dr);
+			}
+		}
+	}
+
+	initMagics(s_bishopDirections, s_bishopMagics, s_bishopTable);
+	initMagics(s_rookDirections, s_rookMagics, s_rookTable);
+
+	s_initialized = true;
+}
+
+quint64 knightAttacks(int square)
+{
+	Q_ASSERT(s_initialized);
+	Q_ASSERT(square >= 0 && square < 64);
+	return s_knightAttacks[square];
+}
+
+quint64 kingAttacks(int square)
+{
+	Q_ASSERT(s_initialized);
+	Q_ASSERT(square >= 0 && square < 64);
+	return s_kingAttacks[square];
+}
+
+quint64 bishopAttacks(int square, quint64 occupied)
+{
+	Q_ASSERT(s_initialized);
+	Q_ASSERT(square >= 0 && square < 64);
+	const Magic& m = s_bishopMagics[square];
+	return m.attacks[m.index(occupied)];
+}
+
+quint64 rookAttacks(int square, quint64 occupied)
+{
+	Q_ASSERT(s_initialized);
+	Q_ASSERT(square >= 0 && square < 64);
+	const Magic& m = s_rookMagics[square];
+	return m.attacks[m.index(occupied)];
+}
+
+quint64 betweenSquares(int from, int to)
+{
+	quint64 fromBit = Q_UINT64_C(1) << from;
+	quint64 toBit = Q_UINT64_C(1) << to;
+
+	if (rookAttacks(from, 0) & toBit)
+		return rookAttacks(from, toBit) & rookAttacks(to, fromBit);
+	if (bishopAttacks(from, 0) & toBit)
+		return bishopAttacks(from, toBit) & bishopAttacks(to, fromBit);
+	return 0;
+}
+
+} // namespace Bitboard
+} // namespace Chess
@@ -0,0 +1,86 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+namespace Chess {
+
+/*!
+ * \brief Attack tables for 8x8 bitboards.
+ *
+ * Bit 0 of a bitboard is square a1, bit 7 is h1 and bit 63 is h8.
+ * Sliding piece attacks are looked up from magic bitboard tables, or
+ * with the PEXT instruction if the library is compiled with BMI2
+ * support.
+ *
+ * \note initialize() must be called before any of the attack functions.
+ * \sa Board::hasBitboards()
+ */
+namespace Bitboard {
+
+/*! Initializes the attack tables. Safe to call more than once. */
+LIB_EXPORT void initialize();
+
+/*! Returns the squares attacked by a knight on \a square. */
+LIB_EXPORT quint64 knightAttacks(int square);
+/*! Returns the squares attacked by a king on \a square. */
+LIB_EXPORT quint64 kingAttacks(int square);
+/*!
+ * Returns the squares attacked by a bishop on \a square when
+ * the squares in \a occupied are occupied.
+ */
+LIB_EXPORT quint64 bishopAttacks(int square, quint64 occupied);
+/*!
+ * Returns the squares attacked by a rook on \a square when
+ * the squares in \a occupied are occupied.
+ */
+LIB_EXPORT quint64 rookAttacks(int square, quint64 occupied);
+/*!
+ * Returns the squares between \a from and \a to, excluding both.
+ * Returns 0 if the squares are not on the same rank, file or diagonal.
+ */
+LIB_EXPORT quint64 betweenSquares(int from, int to);
+
+/*! Returns the index of the least significant set bit in \a bb. */
+inline int lsb(quint64 bb)
+{
+	Q_ASSERT(bb != 0);
+	return qCountTrailingZeroBits(bb);
+}
+
+/*! Clears the least significant set bit in \a bb and returns its index. */
+inline int popLsb(quint64& bb)
+{
+	int square = lsb(bb);
+	bb &= bb - 1;
+	return square;
+}
+
+/*! Returns the number of set bits in \a bb. */
+inline int count(quint64 bb)
+{
+	return qPopulationCount(bb);
+}
+
+} // namespace Bitboard
+} // namespace Chess
+#endif // BITBOARD_H
@@ -23,6 +23,7 @@
 #endif
 #include <QRegularExpression>
 #include "zobrist.h"
+#include "bitboard.h"
 
 
 namespace Chess {
@@ -58,6 +59,7 @@ QDebug operator<<(QDebug dbg, const Board* board)
 
 Board::Board(Zobrist* zobrist)
 	: m_initialized(false),
+	  m_hasBitboards(false),
 	  m_width(0),
 	  m_height(0),
 	  m_side(Side::White),
@@ -69,6 +71,8 @@ Board::Board(Zobrist* zobrist)
 {
 	Q_ASSERT(zobrist != nullptr);
 
+	m_sideBitboards[Side::White] = 0;
+	m_sideBitboards[Side::Black] = 0;
 	setPieceType(Piece::NoPiece, QString(), QString());
 }
 
@@ -91,6 +95,11 @@ bool Board::variantHasWallSquares() const
 	return false;
 }
 
+bool Board::supportsBitboards() const
+{
+	return false;
+}
+
 QList<Piece> Board::reservePieceTypes() const
 {
 	return QList<Piece>();
@@ -131,6 +140,17 @@ void Board::initialize()
 			m_maxPieceSymbolLength = pd.symbol.length();
 
 	m_zobrist->initialize((m_width + 2) * (m_height + 4), m_pieceData.size());
+
+	m_hasBitboards = (m_width == 8 && m_height == 8
+			  && !variantHasWallSquares()
+			  && supportsBitboards());
+	if (m_hasBitboards)
+	{
+		Bitboard::initialize();
+		m_pieceBitboards.resize(m_pieceData.size());
+		for (int i = 0; i < m_pieceBitboards.size(); i++)
+			m_pieceBitboards[i] = 0;
+	}
 }
 
 int Board::maxPieceSymbolLength() const
@@ -245,6 +265,20 @@ void Board::removeFromReserve(const Piece& piece)
 	xorKey(m_zobrist->reservePiece(piece, --count));
 }
 
+quint64 Board::movementBitboard(unsigned movement) const
+{
+	Q_ASSERT(m_hasBitboards);
+
+	quint64 bb = 0;
+	for (int i = 1; i < m_pieceData.size(); i++)
+	{
+		if (m_pieceData[i].movement & movement)
+			bb |= m_pieceBitboards[i];
+	}
+
+	return bb;
+}
+
 Square Board::chessSquare(int index) const
 {
 	int arwidth = m_width + 2;
@@ -538,6 +572,10 @@ bool Board::setFenString(const QString& fen)
 	for (int i = 0; i < m_squares.size(); i++)
 		m_squares[i] = Piece::WallPiece;
 	m_key = 0;
+	m_sideBitboards[Side::White] = 0;
+	m_sideBitboards[Side::Black] = 0;
+	for (int i = 0; i < m_pieceBitboards.size(); i++)
+		m_pieceBitboards[i] = 0;
 
 	// Get the board contents (squares)
 	int handPieceIndex = -1;
@@ -857,8 +895,17 @@ int Board::repeatCount() const
 	if (plyCount() < 4)
 		return 0;
 
+	// Positions reached before the last irreversible move can't be
+	// repeated. In variants with piece drops captured material goes
+	// back into play, so the whole history has to be searched.
+	int first = 0;
+	int reversibleCount = reversibleMoveCount();
+	if (reversibleCount >= 0 && !variantHasDrops())
+		first = qMax(0, plyCount() - reversibleCount);
+
+	// Only positions with the same side to move can match
 	int repeatCount = 0;
-	for (int i = plyCount() - 1; i >= 0; i--)
+	for (int i = plyCount() - 2; i >= first; i -= 2)
 	{
 		if (m_moveHistory.at(i).key == m_key)
 			repeatCount++;
@@ -897,19 +944,29 @@ bool Board::canMove()
 	return false;
 }
 
+void Board::generateLegalMoves(QVarLengthArray<Move>& moves)
+{
+	generateMoves(moves);
+
+	int count = 0;
+	for (int i = 0; i < moves.size(); i++)
+	{
+		if (vIsLegalMove(moves[i]))
+			moves[count++] = moves[i];
+	}
+	moves.resize(count);
+}
+
 QVector<Move> Board::legalMoves()
 {
 	QVarLengthArray<Move> moves;
 	QVector<Move> legalMoves;
 
-	generateMoves(moves);
+	generateLegalMoves(moves);
 	legalMoves.reserve(moves.size());
 
 	for (int i = moves.size() - 1; i >= 0; i--)
-	{
-		if (vIsLegalMove(moves[i]))
-			legalMoves << moves[i];
-	}
+		legalMoves << moves[i];
 
 	return legalMoves;
 }
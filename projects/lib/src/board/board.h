@@ -437,6 +437,14 @@ class LIB_EXPORT Board
 		virtual void generateMovesForPiece(QVarLengthArray<Move>& moves,
 						   int pieceType,
 						   int square) const = 0;
+		/*!
+		 * Generates legal moves in the current position.
+		 *
+		 * This function is called by legalMoves(). The default
+		 * implementation generates pseudo-legal moves and filters
+		 * them with vIsLegalMove().
+		 */
+		virtual void generateLegalMoves(QVarLengthArray<Move>& moves);
 		/*!
 		 * Generates hopping moves for a piece.
 		 *
@@ -487,8 +495,14 @@ class LIB_EXPORT Board
 		 * \sa isLegalMove()
 		 */
 		bool moveExists(const Move& move) const;
-		/*! Returns true if the side to move has any legal moves. */
-		bool canMove();
+		/*!
+		 * Returns true if the side to move has any legal moves.
+		 *
+		 * The default implementation generates all pseudo-legal moves
+		 * and returns as soon as one of them is legal. Subclasses
+		 * can reimplement this function to avoid full move generation.
+		 */
+		virtual bool canMove();
 		/*!
 		 * Returns the size of the board array, including the padding
 		 * (the inaccessible wall squares).
@@ -520,6 +534,45 @@ class LIB_EXPORT Board
 		/*! Removes a piece of type \a piece from the reserve. */
 		void removeFromReserve(const Piece& piece);
 
+		/*!
+		 * Returns true if the variant can keep bitboards of the
+		 * piece placement in addition to the square array.
+		 *
+		 * Bitboards are only used on 8x8 boards without wall squares.
+		 * Subclasses that change how pieces move or capture depending
+		 * on their square must not enable them.
+		 * The default value is false.
+		 *
+		 * \sa hasBitboards(), Bitboard
+		 */
+		virtual bool supportsBitboards() const;
+		/*! Returns true if the board keeps bitboards up to date. */
+		bool hasBitboards() const;
+		/*!
+		 * Returns a bitboard of the squares occupied by \a side.
+		 *
+		 * \note Only valid if hasBitboards() returns true.
+		 */
+		quint64 sideBitboard(Side side) const;
+		/*!
+		 * Returns a bitboard of the squares occupied by pieces of
+		 * type \a pieceType of either side.
+		 *
+		 * \note Only valid if hasBitboards() returns true.
+		 */
+		quint64 pieceBitboard(int pieceType) const;
+		/*!
+		 * Returns a bitboard of the squares occupied by pieces of
+		 * either side whose type can move like \a movement.
+		 *
+		 * \note Only valid if hasBitboards() returns true.
+		 */
+		quint64 movementBitboard(unsigned movement) const;
+		/*! Converts a square index of an 8x8 board into a bit index. */
+		static int bitboardSquare(int square);
+		/*! Converts a bit index into a square index of an 8x8 board. */
+		static int squareFromBitboard(int bit);
+
 	private:
 		struct PieceData
 		{
@@ -536,6 +589,7 @@ class LIB_EXPORT Board
 		friend LIB_EXPORT QDebug operator<<(QDebug dbg, const Board* board);
 
 		bool m_initialized;
+		bool m_hasBitboards;
 		int m_width;
 		int m_height;
 		Side m_side;
@@ -549,6 +603,8 @@ class LIB_EXPORT Board
 		QVarLengthArray<Piece> m_squares;
 		QVector<MoveData> m_moveHistory;
 		QVector<int> m_reserve[2];
+		quint64 m_sideBitboards[2];
+		QVarLengthArray<quint64> m_pieceBitboards;
 };
 
 
@@ -597,9 +653,54 @@ inline void Board::setSquare(int square, Piece piece)
 	if (piece.isValid())
 		xorKey(m_zobrist->piece(piece, square));
 
+	if (m_hasBitboards && (old.isValid() || piece.isValid()))
+	{
+		quint64 bit = Q_UINT64_C(1) << bitboardSquare(square);
+		if (old.isValid())
+		{
+			m_sideBitboards[old.side()] ^= bit;
+			m_pieceBitboards[old.type()] ^= bit;
+		}
+		if (piece.isValid())
+		{
+			m_sideBitboards[piece.side()] ^= bit;
+			m_pieceBitboards[piece.type()] ^= bit;
+		}
+	}
+
 	old = piece;
 }
 
+inline bool Board::hasBitboards() const
+{
+	return m_hasBitboards;
+}
+
+inline quint64 Board::sideBitboard(Side side) const
+{
+	Q_ASSERT(m_hasBitboards);
+	return m_sideBitboards[side];
+}
+
+inline quint64 Board::pieceBitboard(int pieceType) const
+{
+	Q_ASSERT(m_hasBitboards);
+	Q_ASSERT(pieceType >= 0 && pieceType < m_pieceBitboards.size());
+	return m_pieceBitboards[pieceType];
+}
+
+inline int Board::bitboardSquare(int square)
+{
+	// The square array of an 8x8 board is 10 squares wide and
+	// starts with two ranks of wall squares above rank 8.
+	return (9 - square / 10) * 8 + square % 10 - 1;
+}
+
+inline int Board::squareFromBitboard(int bit)
+{
+	return (9 - bit / 8) * 10 + bit % 8 + 1;
+}
+
 inline int Board::plyCount() const
 {
 	return m_moveHistory.size();
@@ -59,6 +59,16 @@ bool CrazyhouseBoard::variantHasDrops() const
 	return true;
 }
 
+bool CrazyhouseBoard::supportsBitboards() const
+{
+	return true;
+}
+
+bool CrazyhouseBoard::supportsCheckMasks() const
+{
+	return true;
+}
+
 QString CrazyhouseBoard::defaultFenString() const
 {
 	return "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR[-] w KQkq - 0 1";
@@ -50,6 +50,12 @@ bool ExtinctionBoard::kingsCountAssertion(int, int) const
 	||     extinctPiece(Side::Black).isEmpty();
 }
 
+bool ExtinctionBoard::supportsCheckMasks() const
+{
+	// Kings can be left in check
+	return false;
+}
+
 void ExtinctionBoard::addPromotions(int sourceSquare,
 				int targetSquare,
 				QVarLengthArray<Move>& moves) const
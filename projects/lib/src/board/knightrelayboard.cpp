@@ -40,6 +40,18 @@ bool KnightRelayBoard::hasEnPassantCaptures() const
 	return false;
 }
 
+bool KnightRelayBoard::supportsBitboards() const
+{
+	// Relayed knight moves depend on the square
+	return false;
+}
+
+bool KnightRelayBoard::supportsCheckMasks() const
+{
+	// Relayed knights can't capture or give check
+	return false;
+}
+
 bool KnightRelayBoard::pieceHasCaptureMovement(Piece piece, int square, unsigned movement) const
 {
 	if (piece.type() == Knight)
@@ -45,6 +45,8 @@ class LIB_EXPORT KnightRelayBoard : public StandardBoard
 
 	protected:
 		// Inherited from StandardBoard
+		virtual bool supportsBitboards() const;
+		virtual bool supportsCheckMasks() const;
 		virtual bool pieceHasMovement(Piece piece, int square, unsigned movement) const;
 		virtual bool pieceHasCaptureMovement(Piece piece, int square, unsigned movement) const;
 		virtual bool vIsLegalMove(const Move& move);
@@ -1072,6 +1072,16 @@ QString StandardBoard::defaultFenString() const
 	return "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 }
 
+bool StandardBoard::supportsBitboards() const
+{
+	return true;
+}
+
+bool StandardBoard::supportsCheckMasks() const
+{
+	return true;
+}
+
 Result StandardBoard::tablebaseResult(unsigned int* dtz) const
 {
 	SyzygyTablebase::PieceList pieces;
@@ -18,6 +18,7 @@
 
 #include "syzygytablebase.h"
 #include <QDir>
+#include <QHash>
 #include <QMutex>
 #include <QStringList>
 #include <tbprobe.h>
@@ -25,9 +26,118 @@
 
 namespace {
 
+/*
+ * The input of a WDL probe. Unlike DTZ probes, WDL probes don't
+ * depend on the halfmove clock, so their results can be cached.
+ */
+struct ProbeKey
+{
+	uint64_t white;
+	uint64_t black;
+	uint64_t kings;
+	uint64_t queens;
+	uint64_t rooks;
+	uint64_t bishops;
+	uint64_t knights;
+	uint64_t pawns;
+	unsigned ep;
+	bool wtm;
+
+	bool operator==(const ProbeKey& other) const
+	{
+		return white == other.white
+		    && black == other.black
+		    && kings == other.kings
+		    && queens == other.queens
+		    && rooks == other.rooks
+		    && bishops == other.bishops
+		    && knights == other.knights
+		    && pawns == other.pawns
+		    && ep == other.ep
+		    && wtm == other.wtm;
+	}
+
+	quint64 hash() const
+	{
+		const uint64_t fields[] =
+		{
+			white, black, kings, queens, rooks, bishops,
+			knights, pawns, ep, uint64_t(wtm)
+		};
+
+		uint64_t h = 0;
+		for (uint64_t field : fields)
+		{
+			h ^= field;
+			h *= Q_UINT64_C(0xff51afd7ed558ccd);
+			h ^= h >> 33;
+		}
+		return h;
+	}
+};
+
+/*
+ * A WDL result cache shared by all game threads.
+ *
+ * The cache is split into shards with their own locks so that
+ * concurrent games rarely wait for each other. A shard is simply
+ * cleared when it gets full.
+ */
+class ProbeCache
+{
+	public:
+		bool find(const ProbeKey& key, unsigned* wdl)
+		{
+			const quint64 hash = key.hash();
+			Shard& shard = m_shards[hash >> (64 - ShardBits)];
+
+			QMutexLocker locker(&shard.mutex);
+			auto it = shard.entries.constFind(hash);
+			if (it == shard.entries.constEnd() || !(it->key == key))
+				return false;
+
+			*wdl = it->wdl;
+			return true;
+		}
+
+		void insert(const ProbeKey& key, unsigned wdl)
+		{
+			const quint64 hash = key.hash();
+			Shard& shard = m_shards[hash >> (64 - ShardBits)];
+
+			QMutexLocker locker(&shard.mutex);
+			if (shard.entries.size() >= MaxShardSize)
+				shard.entries.clear();
+			shard.entries.insert(hash, { key, wdl });
+		}
+
+	private:
+		enum
+		{
+			ShardBits = 6,
+			MaxShardSize = 4096
+		};
+
+		struct Entry
+		{
+			ProbeKey key;
+			unsigned wdl;
+		};
+
+		struct Shard
+		{
+			QMutex mutex;
+			QHash<quint64, Entry> entries;
+		};
+
+		Shard m_shards[1 << ShardBits];
+};
+
 bool s_initialized = false, s_initOK = false, s_noRule50 = false;
 int s_pieces = INT_MAX;
+// tb_probe_root() isn't thread-safe
 QMutex s_mutex;
+ProbeCache s_cache;
 
 int tbSquare(const Chess::Square& square)
 {
@@ -36,6 +146,29 @@ int tbSquare(const Chess::Square& square)
 	return square.rank() * 8 + square.file();
 }
 
+Chess::Side wdlWinner(unsigned wdl, bool wtm)
+{
+	switch (wdl)
+	{
+	case TB_BLESSED_LOSS:
+		if (!s_noRule50)
+			break;
+		// Fallthrough
+	case TB_LOSS:
+		return (wtm? Chess::Side::Black: Chess::Side::White);
+	case TB_DRAW:
+		break;
+	case TB_CURSED_WIN:
+		if (!s_noRule50)
+			break;
+		// Fallthrough
+	case TB_WIN:
+		return (wtm? Chess::Side::White: Chess::Side::Black);
+	}
+
+	return Chess::Side::NoSide;
+}
+
 } // anonymous namespace
 
 bool SyzygyTablebase::initialize(const QString& path)
@@ -113,6 +246,36 @@ Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 		}
 	}
 
+	// The WDL tables are probed first. They are thread-safe and
+	// the result doesn't depend on the halfmove clock.
+	const ProbeKey key = {
+		white, black, kings, queens, rooks, bishops, knights, pawns,
+		ep, wtm
+	};
+	unsigned wdl = TB_RESULT_FAILED;
+	if (!s_cache.find(key, &wdl))
+	{
+		wdl = tb_probe_wdl(white, black, kings, queens, rooks,
+				   bishops, knights, pawns, 0, 0, ep, wtm);
+		s_cache.insert(key, wdl);
+	}
+	if (wdl == TB_RESULT_FAILED)
+		return Chess::Result();
+
+	// DTZ is only needed if the halfmove clock could turn a win
+	// into a draw, or if the caller wants to know it.
+	bool needDtz = (dtz != nullptr && wdl != TB_DRAW);
+	if ((wdl == TB_WIN || wdl == TB_LOSS) && rule50 > 0 && !s_noRule50)
+		needDtz = true;
+	if (!needDtz)
+	{
+		if (dtz != nullptr)
+			*dtz = 0;
+		return Chess::Result(Chess::Result::Adjudication,
+				     wdlWinner(wdl, wtm),
+				     "SyzygyTB");
+	}
+
 	s_mutex.lock();
 	unsigned result = tb_probe_root(white, black, kings, queens, rooks,
 		bishops, knights, pawns, rule50, 0, ep, wtm, nullptr);
@@ -126,27 +289,7 @@ Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 	else if (result == TB_RESULT_STALEMATE)
 		winner = Chess::Side::NoSide;
 	else
-	{
-		switch (TB_GET_WDL(result))
-		{
-		case TB_BLESSED_LOSS:
-			if (!s_noRule50)
-				break;
-			// Fallthrough
-		case TB_LOSS:
-			winner = (wtm? Chess::Side::Black: Chess::Side::White);
-			break;
-		case TB_DRAW:
-			break;
-		case TB_CURSED_WIN:
-			if (!s_noRule50)
-				break;
-			// Fallthrough
-		case TB_WIN:
-			winner = (wtm? Chess::Side::White: Chess::Side::Black);
-			break;
-		}
-	}
+		winner = wdlWinner(TB_GET_WDL(result), wtm);
 	if (dtz != nullptr)
 		*dtz = TB_GET_DTZ(result);
 	return Chess::Result(Chess::Result::Adjudication, winner, "SyzygyTB");
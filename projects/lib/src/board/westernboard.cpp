@@ -19,6 +19,7 @@
 #include <QStringList>
 #include "westernzobrist.h"
 #include "boardtransition.h"
+#include "bitboard.h"
 
 
 namespace Chess {
@@ -35,6 +36,7 @@ WesternBoard::WesternBoard(WesternZobrist* zobrist)
 	  m_hasCastling(true),
 	  m_pawnHasDoubleStep(true),
 	  m_hasEnPassantCaptures(true),
+	  m_supportsCheckMasks(false),
 	  m_pawnAmbiguous(false),
 	  m_multiDigitNotation(false),
 	  m_zobrist(zobrist)
@@ -86,6 +88,11 @@ bool WesternBoard::hasEnPassantCaptures() const
 	return pawnHasDoubleStep();
 }
 
+bool WesternBoard::supportsCheckMasks() const
+{
+	return false;
+}
+
 bool WesternBoard::variantHasChanneling(Side, int) const
 {
 	return false;
@@ -97,6 +104,7 @@ void WesternBoard::vInitialize()
 	m_hasCastling = hasCastling();
 	m_pawnHasDoubleStep = pawnHasDoubleStep();
 	m_hasEnPassantCaptures = hasEnPassantCaptures();
+	m_supportsCheckMasks = supportsCheckMasks();
 
 	m_arwidth = width() + 2;
 
@@ -1123,12 +1131,39 @@ void WesternBoard::generateMovesForPiece(QVarLengthArray<Move>& moves,
 	}
 	if (pieceType == King)
 	{
-		generateHoppingMoves(square, m_bishopOffsets, moves);
-		generateHoppingMoves(square, m_rookOffsets, moves);
+		if (hasBitboards() && square != 0)
+		{
+			addBitboardMoves(square,
+					 Bitboard::kingAttacks(bitboardSquare(square)),
+					 moves);
+		}
+		else
+		{
+			generateHoppingMoves(square, m_bishopOffsets, moves);
+			generateHoppingMoves(square, m_rookOffsets, moves);
+		}
 		generateCastlingMoves(moves);
 		return;
 	}
 
+	if (hasBitboards() && square != 0)
+	{
+		int sq = bitboardSquare(square);
+		quint64 occupied = sideBitboard(Side::White)
+				 | sideBitboard(Side::Black);
+		quint64 targets = 0;
+
+		if (pieceHasMovement(pieceType, square, KnightMovement))
+			targets |= Bitboard::knightAttacks(sq);
+		if (pieceHasMovement(pieceType, square, BishopMovement))
+			targets |= Bitboard::bishopAttacks(sq, occupied);
+		if (pieceHasMovement(pieceType, square, RookMovement))
+			targets |= Bitboard::rookAttacks(sq, occupied);
+
+		addBitboardMoves(square, targets, moves);
+		return;
+	}
+
 	if (pieceHasMovement(pieceType, square, KnightMovement))
 		generateHoppingMoves(square, m_knightOffsets, moves);
 	if (pieceHasMovement(pieceType, square, BishopMovement))
@@ -1137,6 +1172,18 @@ void WesternBoard::generateMovesForPiece(QVarLengthArray<Move>& moves,
 		generateSlidingMoves(square, m_rookOffsets, moves);
 }
 
+void WesternBoard::addBitboardMoves(int sourceSquare,
+				    quint64 targets,
+				    QVarLengthArray<Move>& moves) const
+{
+	targets &= ~sideBitboard(sideToMove());
+	while (targets != 0)
+	{
+		int target = squareFromBitboard(Bitboard::popLsb(targets));
+		moves.append(Move(sourceSquare, target));
+	}
+}
+
 bool WesternBoard::defendedByKnight(Side side, int square) const
 {
 	for (int i = 0; i < m_knightOffsets.size(); i++)
@@ -1174,6 +1221,27 @@ bool WesternBoard::inCheck(Side side, int square) const
 		}
 	}
 
+	if (hasBitboards())
+	{
+		int sq = bitboardSquare(square);
+		quint64 occupied = sideBitboard(Side::White)
+				 | sideBitboard(Side::Black);
+		quint64 attackers = sideBitboard(opSide);
+
+		if (m_kingCanCapture
+		&&  (Bitboard::kingAttacks(sq) & attackers & pieceBitboard(King)))
+			return true;
+
+		quint64 bb = Bitboard::knightAttacks(sq)
+			   & movementBitboard(KnightMovement);
+		bb |= Bitboard::bishopAttacks(sq, occupied)
+		    & movementBitboard(BishopMovement);
+		bb |= Bitboard::rookAttacks(sq, occupied)
+		    & movementBitboard(RookMovement);
+
+		return (bb & attackers) != 0;
+	}
+
 	Piece opKing(opSide, King);
 	Piece piece;
 	
@@ -1287,6 +1355,206 @@ bool WesternBoard::vIsLegalMove(const Move& move)
 	return Board::vIsLegalMove(move);
 }
 
+bool WesternBoard::hasCheckMasks() const
+{
+	return m_supportsCheckMasks
+	&&     hasBitboards()
+	&&     m_kingSquare[sideToMove()] != 0;
+}
+
+quint64 WesternBoard::attackers(Side side, int square, quint64 occupied) const
+{
+	int sq = bitboardSquare(square);
+	quint64 bb = 0;
+
+	// Pawn attacks
+	int sign = (side == Side::White) ? -1 : 1;
+	Piece pawn(side, Pawn);
+	for (const PawnStep& pStep: m_pawnSteps)
+	{
+		if (pStep.type != CaptureStep)
+			continue;
+		int fromSquare = square - pawnPushOffset(pStep, -sign);
+		if (pieceAt(fromSquare) == pawn)
+			bb |= Q_UINT64_C(1) << bitboardSquare(fromSquare);
+	}
+
+	if (m_kingCanCapture)
+		bb |= Bitboard::kingAttacks(sq) & pieceBitboard(King);
+	bb |= Bitboard::knightAttacks(sq) & movementBitboard(KnightMovement);
+	bb |= Bitboard::bishopAttacks(sq, occupied)
+	    & movementBitboard(BishopMovement);
+	bb |= Bitboard::rookAttacks(sq, occupied)
+	    & movementBitboard(RookMovement);
+
+	return bb & sideBitboard(side);
+}
+
+void WesternBoard::updateCheckInfo(CheckInfo& info) const
+{
+	Side side = sideToMove();
+	Side opSide = side.opposite();
+	int king = bitboardSquare(m_kingSquare[side]);
+	quint64 occupied = sideBitboard(Side::White) | sideBitboard(Side::Black);
+
+	quint64 checkers = attackers(opSide, m_kingSquare[side], occupied);
+	info.checkerCount = Bitboard::count(checkers);
+	if (info.checkerCount == 0)
+		info.checkMask = ~Q_UINT64_C(0);
+	else if (info.checkerCount == 1)
+		info.checkMask = checkers
+			       | Bitboard::betweenSquares(king, Bitboard::lsb(checkers));
+	else
+		info.checkMask = 0;
+
+	// Sliders that would attack the king if exactly one of our
+	// pieces didn't stand in the way
+	quint64 snipers = sideBitboard(opSide)
+		& ((Bitboard::bishopAttacks(king, 0) & movementBitboard(BishopMovement))
+		 | (Bitboard::rookAttacks(king, 0) & movementBitboard(RookMovement)));
+
+	info.pinned = 0;
+	info.pinCount = 0;
+	while (snipers)
+	{
+		int sniper = Bitboard::popLsb(snipers);
+		quint64 between = Bitboard::betweenSquares(king, sniper);
+		quint64 blockers = between & occupied;
+
+		if (Bitboard::count(blockers) == 1
+		&&  (blockers & sideBitboard(side)) != 0)
+		{
+			info.pinned |= blockers;
+			info.pinSquare[info.pinCount] = Bitboard::lsb(blockers);
+			info.pinRay[info.pinCount] = between
+						   | (Q_UINT64_C(1) << sniper);
+			info.pinCount++;
+		}
+	}
+}
+
+bool WesternBoard::isLegalWithCheckInfo(const Move& move,
+					const CheckInfo& info)
+{
+	Side side(sideToMove());
+	int source = move.sourceSquare();
+	int target = move.targetSquare();
+	quint64 targetBit = Q_UINT64_C(1) << bitboardSquare(target);
+
+	// Piece drops can only block a check
+	if (source == 0)
+		return (info.checkMask & targetBit) != 0;
+
+	if (source == m_kingSquare[side])
+	{
+		// Castling moves are encoded as a king capturing its own
+		// rook. They're rare enough to be tested the slow way.
+		if (pieceAt(target).side() == side)
+			return vIsLegalMove(move);
+
+		quint64 occupied = sideBitboard(Side::White)
+				 | sideBitboard(Side::Black);
+		occupied ^= Q_UINT64_C(1) << bitboardSquare(source);
+		return attackers(side.opposite(), target, occupied) == 0;
+	}
+
+	if (info.checkerCount > 1)
+		return false;
+
+	// En passant captures remove a piece from a third square,
+	// which can expose the king along a rank.
+	if (target == m_enpassantSquare && pieceAt(source).type() == Pawn)
+		return vIsLegalMove(move);
+
+	if ((info.checkMask & targetBit) == 0)
+		return false;
+
+	int sq = bitboardSquare(source);
+	if (info.pinned & (Q_UINT64_C(1) << sq))
+	{
+		for (int i = 0; i < info.pinCount; i++)
+		{
+			if (info.pinSquare[i] == sq)
+				return (info.pinRay[i] & targetBit) != 0;
+		}
+	}
+
+	return true;
+}
+
+void WesternBoard::generateLegalMoves(QVarLengthArray<Move>& moves)
+{
+	if (!hasCheckMasks())
+	{
+		Board::generateLegalMoves(moves);
+		return;
+	}
+
+	CheckInfo info;
+	updateCheckInfo(info);
+
+	// Only the king can move out of a double check
+	if (info.checkerCount > 1)
+		generateMoves(moves, King);
+	else
+		generateMoves(moves);
+
+	int count = 0;
+	for (int i = 0; i < moves.size(); i++)
+	{
+		if (isLegalWithCheckInfo(moves[i], info))
+			moves[count++] = moves[i];
+	}
+	moves.resize(count);
+}
+
+bool WesternBoard::canMove()
+{
+	if (!hasCheckMasks())
+		return Board::canMove();
+
+	CheckInfo info;
+	updateCheckInfo(info);
+
+	Side side(sideToMove());
+	QVarLengthArray<Move> moves;
+	int i = 0;
+
+	// Generate the moves one piece at a time and stop at the
+	// first legal one. The king goes first because it's the only
+	// piece that can move in a double check.
+	generateMovesForPiece(moves, King, m_kingSquare[side]);
+	for (; i < moves.size(); i++)
+	{
+		if (isLegalWithCheckInfo(moves[i], info))
+			return true;
+	}
+	if (info.checkerCount > 1)
+		return false;
+
+	quint64 pieces = sideBitboard(side)
+		       & ~(Q_UINT64_C(1) << bitboardSquare(m_kingSquare[side]));
+	while (pieces)
+	{
+		int square = squareFromBitboard(Bitboard::popLsb(pieces));
+		generateMovesForPiece(moves, pieceAt(square).type(), square);
+		for (; i < moves.size(); i++)
+		{
+			if (isLegalWithCheckInfo(moves[i], info))
+				return true;
+		}
+	}
+
+	generateDropMoves(moves, Piece::NoPiece);
+	for (; i < moves.size(); i++)
+	{
+		if (isLegalWithCheckInfo(moves[i], info))
+			return true;
+	}
+
+	return false;
+}
+
 void WesternBoard::addPromotions(int sourceSquare,
 				 int targetSquare,
 				 QVarLengthArray<Move>& moves) const
@@ -135,6 +135,19 @@ class LIB_EXPORT WesternBoard : public Board
 		 * The default value is the value of pawnHasDoubleStep().
 		 */
 		virtual bool hasEnPassantCaptures() const;
+		/*!
+		 * Returns true if a move is legal exactly when it doesn't
+		 * leave the side's own king in check, as in standard chess.
+		 *
+		 * If true and the board has bitboards, legal moves are found
+		 * with pin and check masks instead of making each
+		 * pseudo-legal move. Variants that change the legality rules
+		 * or the consequences of a capture must not enable this.
+		 * The default value is false.
+		 *
+		 * \sa Board::supportsBitboards()
+		 */
+		virtual bool supportsCheckMasks() const;
 		/*!
 		 * Returns true if a rule provides \a side to insert a reserve
 		 * piece at a vacated source \a square immediately after a move.
@@ -221,9 +234,11 @@ class LIB_EXPORT WesternBoard : public Board
 		virtual void generateMovesForPiece(QVarLengthArray<Move>& moves,
 						   int pieceType,
 						   int square) const;
+		virtual void generateLegalMoves(QVarLengthArray<Move>& moves);
 		virtual bool vIsLegalMove(const Move& move);
 		virtual bool isLegalPosition();
 		virtual int captureType(const Move& move) const;
+		virtual bool canMove();
 
 	private:
 		struct CastlingRights
@@ -244,7 +259,27 @@ class LIB_EXPORT WesternBoard : public Board
 			int reversibleMoveCount;
 		};
 
+		// Checks and pins against the side to move's king
+		struct CheckInfo
+		{
+			int checkerCount;
+			// Target squares that resolve a single check
+			quint64 checkMask;
+			quint64 pinned;
+			int pinCount;
+			// Pinned pieces and the squares they can move to
+			int pinSquare[8];
+			quint64 pinRay[8];
+		};
+
+		bool hasCheckMasks() const;
+		quint64 attackers(Side side, int square, quint64 occupied) const;
+		void updateCheckInfo(CheckInfo& info) const;
+		bool isLegalWithCheckInfo(const Move& move, const CheckInfo& info);
 		void generateCastlingMoves(QVarLengthArray<Move>& moves) const;
+		void addBitboardMoves(int sourceSquare,
+				      quint64 targets,
+				      QVarLengthArray<Move>& moves) const;
 		void generatePawnMoves(int sourceSquare,
 				       QVarLengthArray<Move>& moves) const;
 
@@ -273,6 +308,7 @@ class LIB_EXPORT WesternBoard : public Board
 		bool m_hasCastling;
 		bool m_pawnHasDoubleStep;
 		bool m_hasEnPassantCaptures;
+		bool m_supportsCheckMasks;
 		bool m_pawnAmbiguous;
 		bool m_multiDigitNotation;
 		QVector<MoveData> m_history;
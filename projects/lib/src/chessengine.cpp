@@ -18,11 +18,18 @@
 
 #include "chessengine.h"
 #include <QIODevice>
+#include <QMetaMethod>
+#include <QProcess>
 #include <QTimer>
 #include <QStringRef>
 #include <QtAlgorithms>
 #include "engineoption.h"
+#include "engineprocess.h"
+#include "coreslots.h"
 #include <QSettings>
+#include <climits>
+#include <cctype>
+#include <cstring>
 
 int ChessEngine::s_count = 0;
 
@@ -80,6 +87,123 @@ QStringRef ChessEngine::firstToken(const QString& str, bool untilEnd)
 	return nextToken(QStringRef(&str, 0, 0), untilEnd);
 }
 
+ChessEngine::Token::Token()
+	: data(nullptr),
+	  size(0),
+	  lineEnd(nullptr)
+{
+}
+
+bool ChessEngine::Token::isNull() const
+{
+	return data == nullptr;
+}
+
+bool ChessEngine::Token::operator==(const char* str) const
+{
+	return data != nullptr
+	    && qstrlen(str) == uint(size)
+	    && memcmp(data, str, size_t(size)) == 0;
+}
+
+bool ChessEngine::Token::operator!=(const char* str) const
+{
+	return !(*this == str);
+}
+
+QString ChessEngine::Token::toString() const
+{
+	return QString::fromUtf8(data, size);
+}
+
+int ChessEngine::Token::toInt() const
+{
+	int i = 0;
+	bool negative = false;
+	if (size > 0 && (data[0] == '-' || data[0] == '+'))
+	{
+		negative = (data[0] == '-');
+		i++;
+	}
+	if (i >= size)
+		return 0;
+
+	qint64 value = 0;
+	for (; i < size; i++)
+	{
+		if (data[i] < '0' || data[i] > '9')
+			return 0;
+		value = value * 10 + (data[i] - '0');
+		if (value > qint64(INT_MAX) + 1)
+			return 0;
+	}
+	if (negative)
+		value = -value;
+	if (value > INT_MAX)
+		return 0;
+
+	return int(value);
+}
+
+quint64 ChessEngine::Token::toULongLong() const
+{
+	if (size <= 0)
+		return 0;
+
+	quint64 value = 0;
+	for (int i = 0; i < size; i++)
+	{
+		if (data[i] < '0' || data[i] > '9')
+			return 0;
+		const quint64 digit = quint64(data[i] - '0');
+		if (value > (ULLONG_MAX - digit) / 10)
+			return 0;
+		value = value * 10 + digit;
+	}
+
+	return value;
+}
+
+ChessEngine::Token ChessEngine::nextToken(const Token& previous, bool untilEnd)
+{
+	Token token;
+	if (previous.isNull())
+		return token;
+
+	const char* end = previous.lineEnd;
+	const char* start = previous.data + previous.size;
+	while (start < end && isspace(uchar(*start)))
+		start++;
+	if (start == end)
+		return token;
+
+	const char* i = start;
+	if (untilEnd)
+	{
+		i = end;
+		while (isspace(uchar(i[-1])))
+			i--;
+	}
+	else
+	{
+		while (i < end && !isspace(uchar(*i)))
+			i++;
+	}
+
+	token.data = start;
+	token.size = int(i - start);
+	token.lineEnd = end;
+	return token;
+}
+
+ChessEngine::Token ChessEngine::firstToken(const QByteArray& line, bool untilEnd)
+{
+	Token token;
+	token.data = line.constData();
+	token.lineEnd = token.data + line.size();
+	return nextToken(token, untilEnd);
+}
+
 
 ChessEngine::ChessEngine(QObject* parent)
 	: ChessPlayer(parent),
@@ -95,6 +219,10 @@ ChessEngine::ChessEngine(QObject* parent)
 	  m_idleTimer(new QTimer(this)),
 	  m_protocolStartTimer(new QTimer(this)),
 	  m_ioDevice(nullptr),
+	  m_readSize(0),
+	  m_readTime(0),
+	  m_lineTime(0),
+	  m_reading(false),
 	  m_restartMode(EngineConfiguration::RestartAuto)
 {
 	m_pingTimer->setSingleShot(true);
@@ -136,6 +264,22 @@ void ChessEngine::setDevice(QIODevice* device)
 	connect(m_ioDevice, SIGNAL(readChannelFinished()), this, SLOT(onCrashed()));
 }
 
+bool ChessEngine::setCpuAffinity(const QList<int>& cpus)
+{
+#ifdef Q_OS_WIN32
+	// The process id isn't available from EngineProcess on Windows
+	auto process = qobject_cast<QProcess*>(m_ioDevice);
+	if (process == nullptr || process->state() != QProcess::Running)
+		return false;
+#else
+	auto process = qobject_cast<EngineProcess*>(m_ioDevice);
+	if (process == nullptr || process->state() != EngineProcess::Running)
+		return false;
+#endif
+
+	return CoreSlots::setProcessAffinity(process->processId(), cpus);
+}
+
 void ChessEngine::applyConfiguration(const EngineConfiguration& configuration)
 {
 	if (!configuration.name().isEmpty())
@@ -471,33 +615,103 @@ void ChessEngine::write(const QString& data, WriteMode mode)
 	}
 
 	Q_ASSERT(m_ioDevice->isWritable());
-	emit debugMessage(QString(">%1(%2): %3")
-			  .arg(name())
-			  .arg(m_id)
-			  .arg(data));
+	if (hasDebugListener())
+		emit debugMessage(QString(">%1(%2): %3")
+				  .arg(name())
+				  .arg(m_id)
+				  .arg(data));
+
+	// Reuse the same buffer for every command
+	const int size = data.size();
+	m_writeData.resize(size + 1);
+	char* out = m_writeData.data();
+	const QChar* in = data.constData();
+	for (int i = 0; i < size; i++)
+	{
+		const ushort c = in[i].unicode();
+		out[i] = c > 0xff ? '?' : char(c);
+	}
+	out[size] = '\n';
 
-	if (m_ioDevice->write(data.toLatin1() + "\n") == -1)
+	if (m_ioDevice->write(m_writeData) == -1)
 		qWarning("Writing to engine %s(%d) failed",
 			 qUtf8Printable(name()), m_id);
 }
 
+bool ChessEngine::hasDebugListener() const
+{
+	static const QMetaMethod signal =
+		QMetaMethod::fromSignal(&ChessPlayer::debugMessage);
+	return isSignalConnected(signal);
+}
+
 void ChessEngine::onReadyRead()
 {
-	while (m_ioDevice->isReadable() && m_ioDevice->canReadLine())
+	// Lines are parsed straight from the read buffer, so the buffer
+	// must not change if parseLine() ends up here again
+	if (m_reading)
+		return;
+	m_reading = true;
+
+	while (m_ioDevice->isReadable())
+	{
+		const qint64 available = m_ioDevice->bytesAvailable();
+		if (available <= 0)
+			break;
+
+		// A line that started in an earlier read keeps its time
+		m_readTime = MoveLatency::timestamp();
+		if (m_readSize == 0)
+			m_lineTime = m_readTime;
+
+		if (m_readBuffer.size() < m_readSize + available)
+			m_readBuffer.resize(int(m_readSize + available));
+		const qint64 n = m_ioDevice->read(m_readBuffer.data() + m_readSize,
+						  available);
+		if (n <= 0)
+			break;
+		m_readSize += int(n);
+
+		parseBufferedLines();
+	}
+
+	m_reading = false;
+}
+
+void ChessEngine::parseBufferedLines()
+{
+	const char* data = m_readBuffer.constData();
+	const char* end = data + m_readSize;
+	const char* start = data;
+
+	while (start < end)
 	{
-		QString line = QString(m_ioDevice->readLine());
-		if (line.endsWith('\n'))
-			line.chop(1);
-		if (line.endsWith('\r'))
-			line.chop(1);
-		if (line.isEmpty())
+		const char* newline = static_cast<const char*>(
+			memchr(start, '\n', size_t(end - start)));
+		if (newline == nullptr)
+			break;
+
+		const char* lineEnd = newline;
+		if (lineEnd > start && lineEnd[-1] == '\r')
+			lineEnd--;
+		const int size = int(lineEnd - start);
+		const char* lineStart = start;
+		start = newline + 1;
+
+		// Only the first line can have started in an earlier read
+		const qint64 lineTime = m_lineTime;
+		m_lineTime = m_readTime;
+		if (size == 0)
 			continue;
 
-		emit debugMessage(QString("<%1(%2): %3")
-				  .arg(name())
-				  .arg(m_id)
-				  .arg(line));
-		parseLine(line);
+		m_line.setRawData(lineStart, uint(size));
+		if (hasDebugListener())
+			emit debugMessage(QString("<%1(%2): %3")
+					  .arg(name())
+					  .arg(m_id)
+					  .arg(QString::fromUtf8(m_line)));
+		setMoveReceivedTime(lineTime);
+		parseLine(m_line);
 
 		if (m_idleTimer->isActive())
 		{
@@ -506,7 +720,19 @@ void ChessEngine::onReadyRead()
 			else
 				m_idleTimer->stop();
 		}
+
+		// The engine may have been disconnected by the last line
+		if (!m_ioDevice->isReadable())
+		{
+			start = end;
+			break;
+		}
 	}
+
+	// Keep the incomplete last line for the next read
+	m_readSize = int(end - start);
+	if (m_readSize > 0 && start != data)
+		memmove(m_readBuffer.data(), start, size_t(m_readSize));
 }
 
 void ChessEngine::flushWriteBuffer()
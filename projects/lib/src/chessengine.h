@@ -68,6 +68,14 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		QIODevice* device() const;
 		/*! Sets the current device to \a device. */
 		void setDevice(QIODevice* device);
+		/*!
+		 * Pins the engine process to the logical CPUs in \a cpus.
+		 *
+		 * Returns true if successful; otherwise returns false, eg.
+		 * if the device is not a process or the platform doesn't
+		 * support CPU affinity.
+		 */
+		bool setCpuAffinity(const QList<int>& cpus);
 
 		// Inherited from ChessPlayer
 		virtual void endGame(const Chess::Result& result);
@@ -131,6 +139,45 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		virtual void kill();
 		
 	protected:
+		/*!
+		 * \brief A whitespace-delimited token in a line of engine output.
+		 *
+		 * A Token refers to the bytes of a line passed to parseLine()
+		 * without copying them, so it must not be used after
+		 * parseLine() returns.
+		 */
+		struct LIB_EXPORT Token
+		{
+			/*! Creates a null token. */
+			Token();
+
+			/*! Returns true if the token is null. */
+			bool isNull() const;
+			/*! Returns true if the token is equal to \a str. */
+			bool operator==(const char* str) const;
+			/*! Returns true if the token is not equal to \a str. */
+			bool operator!=(const char* str) const;
+			/*! Returns the UTF-8 decoded token. */
+			QString toString() const;
+			/*!
+			 * Returns the token as an integer, or 0 if the token
+			 * isn't a valid integer.
+			 */
+			int toInt() const;
+			/*!
+			 * Returns the token as an unsigned integer, or 0 if
+			 * the token isn't a valid unsigned integer.
+			 */
+			quint64 toULongLong() const;
+
+			/*! The first byte of the token. */
+			const char* data;
+			/*! The size of the token in bytes. */
+			int size;
+			/*! The end of the line that contains the token. */
+			const char* lineEnd;
+		};
+
 		/*!
 		 * Reads the first whitespace-delimited token from a string
 		 * and returns a pair with the token in the first element
@@ -172,6 +219,23 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		 */
 		static QStringRef nextToken(const QStringRef& previous,
 					    bool readToEnd = false);
+		/*!
+		 * Reads the first whitespace-delimited token from \a line.
+		 *
+		 * This is the byte-oriented version of firstToken() for
+		 * parsing the lines passed to parseLine().
+		 */
+		static Token firstToken(const QByteArray& line,
+					bool readToEnd = false);
+		/*!
+		 * Reads the first whitespace-delimited token after the
+		 * token \a previous.
+		 *
+		 * This is the byte-oriented version of nextToken() for
+		 * parsing the lines passed to parseLine().
+		 */
+		static Token nextToken(const Token& previous,
+				       bool readToEnd = false);
 
 		// Inherited from ChessPlayer
 		virtual void startGame() = 0;
@@ -182,8 +246,14 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		 */
 		virtual void startProtocol() = 0;
 
-		/*! Parses a line of input from the engine. */
-		virtual void parseLine(const QString& line) = 0;
+		/*!
+		 * Parses a line of input from the engine.
+		 *
+		 * \a line is UTF-8 encoded and has no line terminator. It
+		 * refers to the engine's read buffer, so it's valid only
+		 * until the function returns.
+		 */
+		virtual void parseLine(const QByteArray& line) = 0;
 
 		/*!
 		 * Sends a ping command to the engine.
@@ -311,6 +381,9 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		void onProtocolStartTimeout();
 
 	private:
+		bool hasDebugListener() const;
+		void parseBufferedLines();
+
 		static int s_count;
 
 		int m_id;
@@ -325,6 +398,13 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		QTimer* m_idleTimer;
 		QTimer* m_protocolStartTimer;
 		QIODevice *m_ioDevice;
+		QByteArray m_readBuffer;
+		int m_readSize;
+		qint64 m_readTime;
+		qint64 m_lineTime;
+		bool m_reading;
+		QByteArray m_line;
+		QByteArray m_writeData;
 		QStringList m_writeBuffer;
 		QStringList m_variants;
 		QList<EngineOption*> m_options;
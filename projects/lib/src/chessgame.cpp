@@ -20,6 +20,7 @@
 #include <QTimer>
 #include "board/board.h"
 #include "chessplayer.h"
+#include "matchmetrics.h"
 #include "openingbook.h"
 #include "timecontrol.h"
 
@@ -64,6 +65,7 @@ ChessGame::ChessGame(Chess::Board* board, PgnGame* pgn, QObject* parent)
 	  m_pgnInitialized(false),
 	  m_bookOwnership(false),
 	  m_boardShouldBeFlipped(false),
+	  m_metrics(nullptr),
 	  m_pgn(pgn)
 {
 	Q_ASSERT(pgn != nullptr);
@@ -139,6 +141,12 @@ const QMap<int,int>& ChessGame::scores() const
 	return m_scores;
 }
 
+const MoveLatency& ChessGame::moveLatency(Chess::Side side) const
+{
+	Q_ASSERT(!side.isNull());
+	return m_latency[side];
+}
+
 Chess::Result ChessGame::result() const
 {
 	return m_result;
@@ -262,6 +270,8 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 	}
 
 	m_scores[m_moves.size()] = sender->evaluation().score();
+	if (m_metrics != nullptr)
+		m_metrics->addMove(sender->evaluation());
 	m_moves.append(move);
 	addPgnMove(move, evalString(sender->evaluation()));
 
@@ -284,6 +294,12 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 		player->addTime(sender->timeControl()->lastMoveTime());
 
 	player->makeMove(move);
+
+	MoveLatency::Timestamps times(sender->moveTimestamps());
+	times.opponentNotified = MoveLatency::timestamp();
+	if (times.isValid())
+		m_latency[m_board->sideToMove()].add(times);
+
 	m_board->makeMove(move);
 
 	if (m_result.isNone())
@@ -534,6 +550,11 @@ void ChessGame::setBookOwnership(bool enabled)
 	m_bookOwnership = enabled;
 }
 
+void ChessGame::setMetrics(MatchMetrics* metrics)
+{
+	m_metrics = metrics;
+}
+
 void ChessGame::pauseThread()
 {
 	m_pauseSem.release();
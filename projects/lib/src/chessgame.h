@@ -28,11 +28,13 @@
 #include "board/move.h"
 #include "timecontrol.h"
 #include "gameadjudicator.h"
+#include "movelatency.h"
 
 namespace Chess { class Board; }
 class ChessPlayer;
 class OpeningBook;
 class MoveEvaluation;
+class MatchMetrics;
 
 
 class LIB_EXPORT ChessGame : public QObject
@@ -56,6 +58,7 @@ class LIB_EXPORT ChessGame : public QObject
 		QString startingFen() const;
 		const QVector<Chess::Move>& moves() const;
 		const QMap<int,int>& scores() const;
+		const MoveLatency& moveLatency(Chess::Side side) const;
 		Chess::Result result() const;
 
 		void setError(const QString& message);
@@ -71,6 +74,7 @@ class LIB_EXPORT ChessGame : public QObject
 		void setAdjudicator(const GameAdjudicator& adjudicator);
 		void setStartDelay(int time);
 		void setBookOwnership(bool enabled);
+		void setMetrics(MatchMetrics* metrics);
 
 		void generateOpening();
 
@@ -139,6 +143,8 @@ class LIB_EXPORT ChessGame : public QObject
 		Chess::Result m_result;
 		QVector<Chess::Move> m_moves;
 		QMap<int,int> m_scores;
+		MoveLatency m_latency[2];
+		MatchMetrics* m_metrics;
 		PgnGame* m_pgn;
 		QSemaphore m_pauseSem;
 		QSemaphore m_resumeSem;
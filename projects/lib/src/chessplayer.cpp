@@ -100,8 +100,10 @@ void ChessPlayer::go()
 	Q_ASSERT(m_board != nullptr);
 	m_side = m_board->sideToMove();
 	
+	m_moveTimes = MoveLatency::Timestamps();
 	startClock();
 	startThinking();
+	m_moveTimes.goSent = MoveLatency::timestamp();
 }
 
 void ChessPlayer::quit()
@@ -115,6 +117,11 @@ const MoveEvaluation& ChessPlayer::evaluation() const
 	return m_eval;
 }
 
+const MoveLatency::Timestamps& ChessPlayer::moveTimestamps() const
+{
+	return m_moveTimes;
+}
+
 void ChessPlayer::startClock()
 {
 	if (m_state != Thinking)
@@ -126,6 +133,7 @@ void ChessPlayer::startClock()
 		emit startedThinking(m_timeControl.timeLeft());
 
 	m_timeControl.startTimer();
+	m_moveTimes.clockStarted = MoveLatency::timestamp();
 
 	if (!m_timeControl.isInfinite())
 	{
@@ -136,6 +144,7 @@ void ChessPlayer::startClock()
 
 void ChessPlayer::makeBookMove(const Chess::Move& move)
 {
+	m_moveTimes = MoveLatency::Timestamps();
 	m_timeControl.startTimer();
 	makeMove(move);
 	m_timeControl.update(false);
@@ -284,6 +293,18 @@ void ChessPlayer::emitMove(const Chess::Move& move)
 		setState(Observing);
 
 	m_timeControl.update();
+	if (m_moveTimes.goSent > 0)
+	{
+		m_moveTimes.moveParsed = MoveLatency::timestamp();
+		// Players that don't report when the move arrived
+		// received it when it was parsed
+		if (m_moveTimes.moveReceived == 0)
+			m_moveTimes.moveReceived = m_moveTimes.moveParsed;
+		else
+			m_moveTimes.moveReceived = qBound(m_moveTimes.goSent,
+							  m_moveTimes.moveReceived,
+							  m_moveTimes.moveParsed);
+	}
 	m_eval.setTime(m_timeControl.lastMoveTime());
 	m_eval.setIsTrusted(!areClaimsValidated());
 
@@ -297,6 +318,11 @@ void ChessPlayer::emitMove(const Chess::Move& move)
 	emit moveMade(move);
 }
 
+void ChessPlayer::setMoveReceivedTime(qint64 time)
+{
+	m_moveTimes.moveReceived = time;
+}
+
 void ChessPlayer::kill()
 {
 	setState(Disconnected);
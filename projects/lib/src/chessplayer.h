@@ -26,6 +26,7 @@
 #include "board/move.h"
 #include "timecontrol.h"
 #include "moveevaluation.h"
+#include "movelatency.h"
 class QTimer;
 namespace Chess { class Board; }
 
@@ -99,6 +100,15 @@ class LIB_EXPORT ChessPlayer : public QObject
 		/*! Returns the player's evaluation of the current position. */
 		const MoveEvaluation& evaluation() const;
 
+		/*!
+		 * Returns the timestamps of the player's last move.
+		 *
+		 * The opponentNotified timestamp is left for the game to
+		 * set. All timestamps are zero if the last move wasn't
+		 * preceded by go(), eg. if it was a book move.
+		 */
+		const MoveLatency::Timestamps& moveTimestamps() const;
+
 		/*! Returns the player's time control. */
 		const TimeControl* timeControl() const;
 
@@ -279,6 +289,16 @@ class LIB_EXPORT ChessPlayer : public QObject
 		 * move came too late.
 		 */
 		void emitMove(const Chess::Move& move);
+		/*!
+		 * Sets the time when the first byte of the player's next
+		 * move was received to \a time.
+		 *
+		 * If this function isn't called, the move is considered
+		 * received when emitMove() is called.
+		 *
+		 * \sa MoveLatency::timestamp()
+		 */
+		void setMoveReceivedTime(qint64 time);
 		
 		/*! Returns the opposing player. */
 		const ChessPlayer* opponent() const;
@@ -312,6 +332,7 @@ class LIB_EXPORT ChessPlayer : public QObject
 		Chess::Side m_side;
 		Chess::Board* m_board;
 		ChessPlayer* m_opponent;
+		MoveLatency::Timestamps m_moveTimes;
 };
 
 #endif // CHESSPLAYER_H
@@ -0,0 +1,559 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "compressiondevice.h"
+#include <QFile>
+#include <cstring>
+#ifdef CUTECHESS_HAVE_ZLIB
+  #include <zlib.h>
+#endif
+#ifdef CUTECHESS_HAVE_ZSTD
+  #include <zstd.h>
+#endif
+
+namespace {
+
+const int ChunkSize = 64 * 1024;
+const int GzipLevel = 6;
+const int ZstdLevel = 3;
+
+} // anonymous namespace
+
+struct CompressionDevice::State
+{
+#ifdef CUTECHESS_HAVE_ZLIB
+	z_stream zstream;
+#endif
+#ifdef CUTECHESS_HAVE_ZSTD
+	ZSTD_CCtx* cctx = nullptr;
+	ZSTD_DCtx* dctx = nullptr;
+#endif
+	bool writing = false;
+};
+
+CompressionDevice::CompressionDevice(QIODevice* device,
+				     Codec codec,
+				     QObject* parent)
+	: QIODevice(parent),
+	  m_device(device),
+	  m_codec(codec),
+	  m_state(nullptr),
+	  m_inPos(0),
+	  m_bufferPos(0),
+	  m_bufferStart(0),
+	  m_streamOpen(false),
+	  m_eof(false),
+	  m_uncommitted(false)
+{
+	Q_ASSERT(device != nullptr);
+}
+
+CompressionDevice::~CompressionDevice()
+{
+	close();
+}
+
+CompressionDevice::Codec CompressionDevice::codec() const
+{
+	return m_codec;
+}
+
+QIODevice* CompressionDevice::device() const
+{
+	return m_device;
+}
+
+bool CompressionDevice::isSupported(Codec codec)
+{
+	switch (codec)
+	{
+	case NoCodec:
+		return true;
+	case GzipCodec:
+#ifdef CUTECHESS_HAVE_ZLIB
+		return true;
+#else
+		return false;
+#endif
+	case ZstdCodec:
+#ifdef CUTECHESS_HAVE_ZSTD
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+QString CompressionDevice::codecName(Codec codec)
+{
+	switch (codec)
+	{
+	case GzipCodec:
+		return "gzip";
+	case ZstdCodec:
+		return "zstd";
+	default:
+		return QString();
+	}
+}
+
+CompressionDevice::Codec CompressionDevice::codecForFileName(const QString& fileName)
+{
+	if (fileName.endsWith(".gz", Qt::CaseInsensitive))
+		return GzipCodec;
+	if (fileName.endsWith(".zst", Qt::CaseInsensitive)
+	||  fileName.endsWith(".zstd", Qt::CaseInsensitive))
+		return ZstdCodec;
+	return NoCodec;
+}
+
+CompressionDevice::Codec CompressionDevice::detectCodec(QIODevice* device)
+{
+	const QByteArray magic = device->peek(4);
+	if (magic.startsWith("\x1f\x8b"))
+		return GzipCodec;
+	if (magic == QByteArray("\x28\xb5\x2f\xfd", 4))
+		return ZstdCodec;
+	return NoCodec;
+}
+
+QIODevice* CompressionDevice::openFile(const QString& fileName,
+				       OpenMode mode,
+				       QString* error)
+{
+	QFile* file = new QFile(fileName);
+
+	// The compressed data must not go through text mode conversion
+	if (!file->open(QIODevice::ReadOnly))
+	{
+		if (error != nullptr)
+			*error = file->errorString();
+		delete file;
+		return nullptr;
+	}
+
+	Codec codec = detectCodec(file);
+	if (codec == NoCodec)
+	{
+		file->setTextModeEnabled(mode.testFlag(QIODevice::Text));
+		return file;
+	}
+
+	CompressionDevice* device = new CompressionDevice(file, codec);
+	file->setParent(device);
+	if (!device->open(mode))
+	{
+		if (error != nullptr)
+			*error = device->errorString();
+		delete device;
+		return nullptr;
+	}
+
+	return device;
+}
+
+bool CompressionDevice::initState()
+{
+	if (!isSupported(m_codec) || m_codec == NoCodec)
+	{
+		setErrorString(tr("Unsupported compression format"));
+		return false;
+	}
+
+	m_state = new State;
+	m_state->writing = openMode().testFlag(WriteOnly);
+	bool ok = false;
+
+#ifdef CUTECHESS_HAVE_ZLIB
+	if (m_codec == GzipCodec)
+	{
+		z_stream& z = m_state->zstream;
+		z.zalloc = Z_NULL;
+		z.zfree = Z_NULL;
+		z.opaque = Z_NULL;
+		z.next_in = Z_NULL;
+		z.avail_in = 0;
+
+		// Window bits 15 + 16 writes a gzip header, and 15 + 32
+		// accepts both gzip and zlib headers.
+		if (m_state->writing)
+			ok = deflateInit2(&z, GzipLevel, Z_DEFLATED, 15 + 16,
+					  8, Z_DEFAULT_STRATEGY) == Z_OK;
+		else
+			ok = inflateInit2(&z, 15 + 32) == Z_OK;
+	}
+#endif
+#ifdef CUTECHESS_HAVE_ZSTD
+	if (m_codec == ZstdCodec)
+	{
+		if (m_state->writing)
+		{
+			m_state->cctx = ZSTD_createCCtx();
+			ok = m_state->cctx != nullptr
+			&&   !ZSTD_isError(ZSTD_CCtx_setParameter(m_state->cctx,
+				ZSTD_c_compressionLevel, ZstdLevel));
+		}
+		else
+		{
+			m_state->dctx = ZSTD_createDCtx();
+			ok = m_state->dctx != nullptr;
+		}
+	}
+#endif
+
+	if (!ok)
+	{
+		setErrorString(tr("Cannot initialize %1 stream")
+			       .arg(codecName(m_codec)));
+		freeState();
+	}
+
+	return ok;
+}
+
+void CompressionDevice::freeState()
+{
+	if (m_state == nullptr)
+		return;
+
+#ifdef CUTECHESS_HAVE_ZLIB
+	if (m_codec == GzipCodec)
+	{
+		if (m_state->writing)
+			deflateEnd(&m_state->zstream);
+		else
+			inflateEnd(&m_state->zstream);
+	}
+#endif
+#ifdef CUTECHESS_HAVE_ZSTD
+	ZSTD_freeCCtx(m_state->cctx);
+	ZSTD_freeDCtx(m_state->dctx);
+#endif
+
+	delete m_state;
+	m_state = nullptr;
+}
+
+bool CompressionDevice::open(OpenMode mode)
+{
+	// Either read or write, but not both
+	if (mode.testFlag(ReadOnly) == mode.testFlag(WriteOnly))
+	{
+		setErrorString(tr("Invalid open mode"));
+		return false;
+	}
+	if (mode.testFlag(ReadOnly) && !m_device->isReadable())
+	{
+		setErrorString(tr("The device is not readable"));
+		return false;
+	}
+	if (mode.testFlag(WriteOnly) && !m_device->isWritable())
+	{
+		setErrorString(tr("The device is not writable"));
+		return false;
+	}
+
+	// The device keeps its own buffer of decompressed data
+	if (!QIODevice::open(mode | Unbuffered))
+		return false;
+
+	m_in.clear();
+	m_inPos = 0;
+	m_buffer.clear();
+	m_bufferPos = 0;
+	m_bufferStart = 0;
+	m_streamOpen = false;
+	m_eof = false;
+	m_uncommitted = false;
+
+	if (!initState())
+	{
+		QIODevice::close();
+		return false;
+	}
+
+	return true;
+}
+
+void CompressionDevice::close()
+{
+	if (!isOpen())
+		return;
+
+	if (isWritable())
+		commit();
+
+	freeState();
+	m_in.clear();
+	m_buffer.clear();
+	QIODevice::close();
+}
+
+bool CompressionDevice::isSequential() const
+{
+	// Reading supports seeking by decompressing the data again
+	return openMode().testFlag(WriteOnly);
+}
+
+bool CompressionDevice::restart()
+{
+	if (!m_device->seek(0))
+		return false;
+
+	freeState();
+	if (!initState())
+		return false;
+
+	m_in.clear();
+	m_inPos = 0;
+	m_buffer.clear();
+	m_bufferPos = 0;
+	m_bufferStart = 0;
+	m_streamOpen = false;
+	m_eof = false;
+
+	return true;
+}
+
+bool CompressionDevice::seek(qint64 pos)
+{
+	if (isSequential() || m_state == nullptr || !QIODevice::seek(pos))
+		return false;
+
+	// QIODevice may still hold characters returned by ungetChar()
+	qint64 target = pos + QIODevice::bytesAvailable();
+	if (target < m_bufferStart && !restart())
+		return false;
+
+	// Skip forward to the buffer that contains the target
+	while (target > m_bufferStart + m_buffer.size())
+	{
+		m_bufferPos = m_buffer.size();
+		if (!fillBuffer())
+			return false;
+	}
+	m_bufferPos = target - m_bufferStart;
+
+	return true;
+}
+
+bool CompressionDevice::atEnd() const
+{
+	if (QIODevice::bytesAvailable() > 0 || !isReadable())
+		return QIODevice::atEnd();
+
+	if (m_bufferPos < m_buffer.size())
+		return false;
+
+	// Find out if there's more data without moving the position
+	return !const_cast<CompressionDevice*>(this)->fillBuffer();
+}
+
+qint64 CompressionDevice::bytesAvailable() const
+{
+	return m_buffer.size() - m_bufferPos + QIODevice::bytesAvailable();
+}
+
+bool CompressionDevice::fillBuffer()
+{
+	Q_ASSERT(m_bufferPos >= m_buffer.size());
+
+	m_bufferStart += m_buffer.size();
+	m_buffer.clear();
+	m_bufferPos = 0;
+
+	while (m_buffer.isEmpty() && !m_eof && m_state != nullptr)
+	{
+		if (m_inPos >= m_in.size())
+		{
+			m_in = m_device->read(ChunkSize);
+			m_inPos = 0;
+			if (m_in.isEmpty())
+			{
+				// The writer may have crashed in the middle
+				// of a member or frame.
+				auto file = qobject_cast<QFile*>(m_device);
+				if (m_streamOpen && file != nullptr)
+					qWarning("Compressed file %s is truncated",
+						 qUtf8Printable(file->fileName()));
+				m_eof = true;
+				break;
+			}
+		}
+
+		m_buffer.resize(ChunkSize);
+		qint64 inSize = m_in.size() - m_inPos;
+		qint64 outSize = 0;
+		bool ok = false;
+
+#ifdef CUTECHESS_HAVE_ZLIB
+		if (m_codec == GzipCodec)
+		{
+			z_stream& z = m_state->zstream;
+			z.next_in = reinterpret_cast<Bytef*>(m_in.data() + m_inPos);
+			z.avail_in = uInt(inSize);
+			z.next_out = reinterpret_cast<Bytef*>(m_buffer.data());
+			z.avail_out = uInt(ChunkSize);
+
+			int ret = inflate(&z, Z_NO_FLUSH);
+			m_inPos += inSize - z.avail_in;
+			outSize = ChunkSize - z.avail_out;
+			m_streamOpen = true;
+
+			if (ret == Z_STREAM_END)
+			{
+				// Another member may follow
+				m_streamOpen = false;
+				ok = inflateReset(&z) == Z_OK;
+			}
+			else
+				ok = (ret == Z_OK || ret == Z_BUF_ERROR);
+		}
+#endif
+#ifdef CUTECHESS_HAVE_ZSTD
+		if (m_codec == ZstdCodec)
+		{
+			ZSTD_inBuffer in = { m_in.constData() + m_inPos, size_t(inSize), 0 };
+			ZSTD_outBuffer out = { m_buffer.data(), size_t(ChunkSize), 0 };
+
+			size_t ret = ZSTD_decompressStream(m_state->dctx, &out, &in);
+			m_inPos += in.pos;
+			outSize = out.pos;
+			ok = !ZSTD_isError(ret);
+
+			// A return value of 0 means that a frame is complete
+			m_streamOpen = (ok && ret != 0);
+		}
+#endif
+
+		m_buffer.resize(int(outSize));
+		if (!ok)
+		{
+			setErrorString(tr("Invalid %1 data")
+				       .arg(codecName(m_codec)));
+			qWarning("%s", qUtf8Printable(errorString()));
+			m_eof = true;
+		}
+	}
+
+	return !m_buffer.isEmpty();
+}
+
+qint64 CompressionDevice::readData(char* data, qint64 maxSize)
+{
+	qint64 count = 0;
+	while (count < maxSize)
+	{
+		if (m_bufferPos >= m_buffer.size() && !fillBuffer())
+			break;
+
+		qint64 n = qMin(maxSize - count, qint64(m_buffer.size() - m_bufferPos));
+		memcpy(data + count, m_buffer.constData() + m_bufferPos, size_t(n));
+		m_bufferPos += n;
+		count += n;
+	}
+
+	return count;
+}
+
+bool CompressionDevice::compress(const char* data, qint64 size, bool end)
+{
+	if (m_state == nullptr)
+		return false;
+
+	QByteArray out(ChunkSize, Qt::Uninitialized);
+	bool ok = false;
+
+#ifdef CUTECHESS_HAVE_ZLIB
+	if (m_codec == GzipCodec)
+	{
+		z_stream& z = m_state->zstream;
+		z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+		z.avail_in = uInt(size);
+
+		int ret = Z_OK;
+		do
+		{
+			z.next_out = reinterpret_cast<Bytef*>(out.data());
+			z.avail_out = uInt(ChunkSize);
+			ret = deflate(&z, end ? Z_FINISH : Z_NO_FLUSH);
+			if (ret == Z_STREAM_ERROR)
+				break;
+
+			qint64 n = ChunkSize - z.avail_out;
+			if (n > 0 && m_device->write(out.constData(), n) != n)
+				break;
+		} while (end ? ret != Z_STREAM_END
+			     : (z.avail_in > 0 || z.avail_out == 0));
+
+		ok = end ? (ret == Z_STREAM_END && deflateReset(&z) == Z_OK)
+			 : (ret != Z_STREAM_ERROR && z.avail_in == 0);
+	}
+#endif
+#ifdef CUTECHESS_HAVE_ZSTD
+	if (m_codec == ZstdCodec)
+	{
+		ZSTD_inBuffer in = { data, size_t(size), 0 };
+		size_t ret = 0;
+		do
+		{
+			ZSTD_outBuffer zout = { out.data(), size_t(ChunkSize), 0 };
+			ret = ZSTD_compressStream2(m_state->cctx, &zout, &in,
+						   end ? ZSTD_e_end : ZSTD_e_continue);
+			if (ZSTD_isError(ret))
+				break;
+
+			qint64 n = qint64(zout.pos);
+			if (n > 0 && m_device->write(out.constData(), n) != n)
+				break;
+		} while (end ? ret != 0 : in.pos < in.size);
+
+		ok = !ZSTD_isError(ret) && (end ? ret == 0 : in.pos == in.size);
+	}
+#endif
+
+	if (!ok)
+		setErrorString(tr("Cannot write %1 data")
+			       .arg(codecName(m_codec)));
+
+	return ok;
+}
+
+qint64 CompressionDevice::writeData(const char* data, qint64 maxSize)
+{
+	if (maxSize <= 0)
+		return 0;
+	if (!compress(data, maxSize, false))
+		return -1;
+
+	m_uncommitted = true;
+	return maxSize;
+}
+
+bool CompressionDevice::commit()
+{
+	if (!isWritable())
+		return false;
+	if (!m_uncommitted)
+		return true;
+
+	m_uncommitted = false;
+	return compress(nullptr, 0, true);
+}
@@ -0,0 +1,147 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPRESSIONDEVICE_H
+#define COMPRESSIONDEVICE_H
+
+#include <QIODevice>
+#include <QByteArray>
+
+/*!
+ * \brief A device that compresses or decompresses another device
+ *
+ * CompressionDevice reads gzip or zstd compressed data from another
+ * device and returns it decompressed, or compresses everything written
+ * to it. The compressed data can have multiple gzip members or zstd
+ * frames, and a stream that was cut short (eg. when the writer
+ * crashed) can be read up to the last complete block.
+ *
+ * In write mode the stream is ended by commit(), so that everything
+ * written so far forms a complete member or frame which any gzip or
+ * zstd tool can decompress. Writing after that starts a new one.
+ *
+ * In read mode the device supports seeking, but seeking backwards
+ * means decompressing the data again from the start.
+ *
+ * \note Gzip and zstd support depend on the libraries available at
+ * build time. See isSupported().
+ */
+class LIB_EXPORT CompressionDevice : public QIODevice
+{
+	Q_OBJECT
+
+	public:
+		/*! The compression format. */
+		enum Codec
+		{
+			NoCodec,	//!< Uncompressed data
+			GzipCodec,	//!< Gzip (deflate) compression
+			ZstdCodec	//!< Zstandard compression
+		};
+
+		/*!
+		 * Creates a new device that compresses or decompresses
+		 * data in \a device using \a codec.
+		 *
+		 * \a device must be open, and it is not owned by the
+		 * new object.
+		 */
+		CompressionDevice(QIODevice* device,
+				  Codec codec,
+				  QObject* parent = nullptr);
+		/*! Closes the device. */
+		virtual ~CompressionDevice();
+
+		/*! Returns the compression format. */
+		Codec codec() const;
+		/*! Returns the underlying (compressed) device. */
+		QIODevice* device() const;
+
+		/*!
+		 * Ends the current gzip member or zstd frame and writes
+		 * it to the underlying device.
+		 *
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool commit();
+
+		/*!
+		 * Returns true if \a codec is supported by this build;
+		 * otherwise returns false.
+		 */
+		static bool isSupported(Codec codec);
+		/*! Returns the name of \a codec, eg. "gzip". */
+		static QString codecName(Codec codec);
+		/*!
+		 * Returns the codec implied by the suffix of \a fileName
+		 * (".gz" or ".zst"), or NoCodec.
+		 */
+		static Codec codecForFileName(const QString& fileName);
+		/*!
+		 * Returns the codec of the data in \a device, detected from
+		 * its first bytes without consuming them.
+		 */
+		static Codec detectCodec(QIODevice* device);
+		/*!
+		 * Opens file \a fileName for reading in \a mode.
+		 *
+		 * If the file is compressed, returns a CompressionDevice
+		 * which decompresses it; otherwise returns a QFile.
+		 * Returns a null pointer and sets \a error if the file
+		 * can't be opened. The caller takes ownership of the device.
+		 */
+		static QIODevice* openFile(const QString& fileName,
+					   OpenMode mode = ReadOnly,
+					   QString* error = nullptr);
+
+		// Inherited from QIODevice
+		virtual bool open(OpenMode mode);
+		virtual void close();
+		virtual bool isSequential() const;
+		virtual bool seek(qint64 pos);
+		virtual bool atEnd() const;
+		virtual qint64 bytesAvailable() const;
+
+	protected:
+		// Inherited from QIODevice
+		virtual qint64 readData(char* data, qint64 maxSize);
+		virtual qint64 writeData(const char* data, qint64 maxSize);
+
+	private:
+		struct State;
+
+		bool initState();
+		void freeState();
+		bool restart();
+		bool fillBuffer();
+		bool compress(const char* data, qint64 size, bool end);
+
+		QIODevice* m_device;
+		Codec m_codec;
+		State* m_state;
+		QByteArray m_in;
+		qint64 m_inPos;
+		QByteArray m_buffer;
+		qint64 m_bufferPos;
+		qint64 m_bufferStart;
+		bool m_streamOpen;
+		bool m_eof;
+		bool m_uncommitted;
+};
+
+#endif // COMPRESSIONDEVICE_H
@@ -0,0 +1,321 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "coreslots.h"
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+#ifdef Q_OS_LINUX
+  #include <sched.h>
+#endif
+
+namespace {
+
+QList<int> parseCpuList(const QString& str)
+{
+	QList<int> cpus;
+	const auto ranges = str.split(',', Qt::SkipEmptyParts);
+	for (const auto& range : ranges)
+	{
+		bool ok = false;
+		int first = range.section('-', 0, 0).toInt(&ok);
+		if (!ok)
+			return QList<int>();
+
+		int last = first;
+		if (range.contains('-'))
+		{
+			last = range.section('-', 1, 1).toInt(&ok);
+			if (!ok)
+				return QList<int>();
+		}
+
+		for (int i = first; i <= last; i++)
+			cpus.append(i);
+	}
+
+	return cpus;
+}
+
+QString cpuListString(const QList<int>& cpus)
+{
+	QStringList ranges;
+	for (int i = 0; i < cpus.size(); )
+	{
+		int j = i;
+		while (j + 1 < cpus.size() && cpus.at(j + 1) == cpus.at(j) + 1)
+			j++;
+
+		if (j == i)
+			ranges.append(QString::number(cpus.at(i)));
+		else
+			ranges.append(QString("%1-%2").arg(cpus.at(i)).arg(cpus.at(j)));
+		i = j + 1;
+	}
+
+	return ranges.join(',');
+}
+
+#ifdef Q_OS_LINUX
+QString readSysFile(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return QString();
+	return QString::fromLatin1(file.readAll()).trimmed();
+}
+#endif
+
+} // anonymous namespace
+
+CoreSlots::CoreSlots()
+	: m_cpusPerSlot(0),
+	  m_avoidSmt(false),
+	  m_numaAware(true)
+{
+}
+
+void CoreSlots::setCpusPerSlot(int count)
+{
+	m_cpusPerSlot = count;
+}
+
+void CoreSlots::setAvoidSmtSiblings(bool enabled)
+{
+	m_avoidSmt = enabled;
+}
+
+void CoreSlots::setNumaAware(bool enabled)
+{
+	m_numaAware = enabled;
+}
+
+QVector<CoreSlots::Cpu> CoreSlots::topology()
+{
+	QVector<Cpu> cpus;
+
+#ifdef Q_OS_LINUX
+	cpu_set_t mask;
+	CPU_ZERO(&mask);
+	bool hasMask = (sched_getaffinity(0, sizeof(mask), &mask) == 0);
+
+	const QString base("/sys/devices/system/cpu/");
+	const auto online = parseCpuList(readSysFile(base + "online"));
+	for (int id : online)
+	{
+		// Respect restrictions set by eg. taskset or cgroups
+		if (hasMask && (id >= CPU_SETSIZE || !CPU_ISSET(id, &mask)))
+			continue;
+
+		const QString dir(base + QString("cpu%1/").arg(id));
+		Cpu cpu = { id, id, 0 };
+
+		// SMT siblings share the lowest CPU number of the core
+		const auto siblings = parseCpuList(
+			readSysFile(dir + "topology/thread_siblings_list"));
+		if (!siblings.isEmpty())
+			cpu.core = *std::min_element(siblings.begin(), siblings.end());
+
+		const auto nodes = QDir(dir).entryList(QStringList() << "node*",
+						       QDir::Dirs);
+		if (!nodes.isEmpty())
+			cpu.node = nodes.first().mid(4).toInt();
+
+		cpus.append(cpu);
+	}
+#endif
+
+	if (cpus.isEmpty())
+	{
+		for (int i = 0; i < QThread::idealThreadCount(); i++)
+		{
+			Cpu cpu = { i, i, 0 };
+			cpus.append(cpu);
+		}
+	}
+
+	return cpus;
+}
+
+bool CoreSlots::initialize(int slotCount)
+{
+#ifndef Q_OS_LINUX
+	Q_UNUSED(slotCount);
+	m_slots.clear();
+	m_error = "CPU affinity is not supported on this platform";
+	return false;
+#else
+	return initialize(slotCount, topology());
+#endif
+}
+
+bool CoreSlots::initialize(int slotCount, const QVector<Cpu>& available)
+{
+	m_slots.clear();
+	m_error.clear();
+
+	if (slotCount < 1)
+	{
+		m_error = "Invalid number of game slots";
+		return false;
+	}
+
+	// Keep the siblings of a core (and the cores of a node) together
+	QVector<Cpu> cpus = available;
+	const bool numaAware = m_numaAware;
+	std::sort(cpus.begin(), cpus.end(), [=](const Cpu& a, const Cpu& b)
+	{
+		if (numaAware && a.node != b.node)
+			return a.node < b.node;
+		if (a.core != b.core)
+			return a.core < b.core;
+		return a.id < b.id;
+	});
+
+	if (m_avoidSmt)
+	{
+		QVector<Cpu> tmp;
+		QList<int> cores;
+		for (const Cpu& cpu : qAsConst(cpus))
+		{
+			if (cores.contains(cpu.core))
+				continue;
+			cores.append(cpu.core);
+			tmp.append(cpu);
+		}
+		cpus = tmp;
+	}
+
+	int perSlot = m_cpusPerSlot;
+	if (perSlot <= 0)
+		perSlot = cpus.size() / slotCount;
+	if (perSlot < 1 || perSlot * slotCount > cpus.size())
+	{
+		m_error = QString("Not enough CPUs for %1 game slots: %2 available")
+			  .arg(slotCount).arg(cpus.size());
+		return false;
+	}
+
+	if (m_numaAware)
+	{
+		// Fill the nodes one by one without splitting slots
+		int i = 0;
+		while (i < cpus.size() && m_slots.size() < slotCount)
+		{
+			int end = i;
+			while (end < cpus.size() && cpus.at(end).node == cpus.at(i).node)
+				end++;
+			for (; i + perSlot <= end && m_slots.size() < slotCount; i += perSlot)
+				m_slots.append(cpus.mid(i, perSlot));
+			i = end;
+		}
+
+		if (m_slots.size() < slotCount)
+			m_slots.clear();
+	}
+
+	if (m_slots.isEmpty())
+	{
+		for (int i = 0; i < slotCount; i++)
+			m_slots.append(cpus.mid(i * perSlot, perSlot));
+	}
+
+	return true;
+}
+
+QString CoreSlots::errorString() const
+{
+	return m_error;
+}
+
+int CoreSlots::slotCount() const
+{
+	return m_slots.size();
+}
+
+QList<int> CoreSlots::cpus(int slot) const
+{
+	QList<int> ret;
+	for (const Cpu& cpu : m_slots.at(slot))
+		ret.append(cpu.id);
+
+	return ret;
+}
+
+QString CoreSlots::toString() const
+{
+	QStringList lines;
+	for (int i = 0; i < m_slots.size(); i++)
+	{
+		QList<int> nodes;
+		for (const Cpu& cpu : m_slots.at(i))
+		{
+			if (!nodes.contains(cpu.node))
+				nodes.append(cpu.node);
+		}
+		std::sort(nodes.begin(), nodes.end());
+
+		QList<int> ids(cpus(i));
+		std::sort(ids.begin(), ids.end());
+		lines.append(QString("Game slot %1: CPU %2, NUMA node %3")
+			     .arg(i + 1)
+			     .arg(cpuListString(ids))
+			     .arg(cpuListString(nodes)));
+	}
+
+	return lines.join('\n');
+}
+
+bool CoreSlots::setProcessAffinity(qint64 pid, const QList<int>& cpus)
+{
+#ifdef Q_OS_LINUX
+	if (pid <= 0 || cpus.isEmpty())
+		return false;
+
+	cpu_set_t mask;
+	CPU_ZERO(&mask);
+	for (int cpu : cpus)
+	{
+		if (cpu >= 0 && cpu < CPU_SETSIZE)
+			CPU_SET(cpu, &mask);
+	}
+
+	// sched_setaffinity() only affects one thread, so every
+	// existing thread of the process must be pinned separately.
+	// Threads created later inherit the affinity.
+	auto tasks = QDir(QString("/proc/%1/task").arg(pid))
+		     .entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+	if (tasks.isEmpty())
+		tasks.append(QString::number(pid));
+
+	bool ok = true;
+	for (const auto& task : qAsConst(tasks))
+	{
+		if (sched_setaffinity(task.toInt(), sizeof(mask), &mask) != 0)
+			ok = false;
+	}
+
+	return ok;
+#else
+	Q_UNUSED(pid);
+	Q_UNUSED(cpus);
+	return false;
+#endif
+}
@@ -0,0 +1,114 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CORESLOTS_H
+#define CORESLOTS_H
+
+#include <QList>
+#include <QVector>
+#include <QString>
+
+/*!
+ * \brief A map of game slots to logical CPUs
+ *
+ * CoreSlots assigns a fixed set of logical CPUs to each concurrent
+ * game slot, so that the engines of different games don't compete
+ * for the same cores or migrate between them. Optionally only one
+ * logical CPU (SMT sibling) per physical core is used, and the slots
+ * are kept within NUMA nodes.
+ *
+ * The topology is read from sysfs, so CPU affinity is currently only
+ * supported on Linux.
+ *
+ * \sa GameManager::setCoreSlots()
+ */
+class LIB_EXPORT CoreSlots
+{
+	public:
+		/*! A logical CPU and its place in the topology. */
+		struct Cpu
+		{
+			int id;		//!< Logical CPU number
+			int core;	//!< Lowest CPU number of the physical core
+			int node;	//!< NUMA node
+		};
+
+		/*! Creates a new, empty slot map. */
+		CoreSlots();
+
+		/*!
+		 * Sets the number of logical CPUs per slot to \a count.
+		 *
+		 * If \a count is 0 (the default), the available CPUs are
+		 * divided evenly between the slots.
+		 */
+		void setCpusPerSlot(int count);
+		/*!
+		 * If \a enabled is true, only one logical CPU of every
+		 * physical core is used. The default is false.
+		 */
+		void setAvoidSmtSiblings(bool enabled);
+		/*!
+		 * If \a enabled is true (the default), slots don't span
+		 * NUMA nodes unless there isn't enough room otherwise.
+		 */
+		void setNumaAware(bool enabled);
+
+		/*!
+		 * Builds a map of \a slotCount slots from the CPUs the
+		 * process is allowed to run on.
+		 *
+		 * Returns true if successful; otherwise returns false and
+		 * sets an error string.
+		 */
+		bool initialize(int slotCount);
+		/*!
+		 * Builds a map of \a slotCount slots from the CPUs in
+		 * \a available instead of the system's CPUs.
+		 *
+		 * Returns true if successful; otherwise returns false and
+		 * sets an error string.
+		 */
+		bool initialize(int slotCount, const QVector<Cpu>& available);
+		/*! Returns a description of the last error. */
+		QString errorString() const;
+
+		/*! Returns the number of slots, or 0 if the map is empty. */
+		int slotCount() const;
+		/*! Returns the logical CPUs of \a slot. */
+		QList<int> cpus(int slot) const;
+		/*! Returns a human-readable description of the slot map. */
+		QString toString() const;
+
+		/*!
+		 * Pins all threads of process \a pid to \a cpus.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		static bool setProcessAffinity(qint64 pid, const QList<int>& cpus);
+
+	private:
+		static QVector<Cpu> topology();
+
+		int m_cpusPerSlot;
+		bool m_avoidSmt;
+		bool m_numaAware;
+		QString m_error;
+		QVector< QVector<Cpu> > m_slots;
+};
+
+#endif // CORESLOTS_H
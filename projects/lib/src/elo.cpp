@@ -6,8 +6,10 @@ Elo::Elo(int wins, int losses, int draws)
 	m_wins = wins;
 	m_losses = losses;
 	m_draws = draws;
+	m_pairs = false;
 
 	qreal n = wins + losses + draws;
+	m_games = n;
 	qreal w = wins / n;
 	qreal l = losses / n;
 	qreal d = draws / n;
@@ -16,11 +18,39 @@ Elo::Elo(int wins, int losses, int draws)
 	qreal devW = w * std::pow(1.0 - m_mu, 2.0);
 	qreal devL = l * std::pow(0.0 - m_mu, 2.0);
 	qreal devD = d * std::pow(0.5 - m_mu, 2.0);
-	m_stdev = std::sqrt(devW + devL + devD) / std::sqrt(n);
+	m_sigma = std::sqrt(devW + devL + devD);
+	m_stdev = m_sigma / std::sqrt(n);
+}
+
+Elo::Elo(int lossLoss, int lossDraw, int drawDraw, int winDraw, int winWin)
+{
+	m_wins = winDraw + winWin;
+	m_losses = lossLoss + lossDraw;
+	m_draws = drawDraw;
+	m_pairs = true;
+
+	const int counts[] = { lossLoss, lossDraw, drawDraw, winDraw, winWin };
+	qreal n = lossLoss + lossDraw + drawDraw + winDraw + winWin;
+	m_games = n * 2;
+
+	// Mean and variance of the pairs' average game score
+	m_mu = 0.0;
+	for (int i = 0; i < 5; i++)
+		m_mu += counts[i] / n * i / 4.0;
+
+	qreal var = 0.0;
+	for (int i = 0; i < 5; i++)
+		var += counts[i] / n * std::pow(i / 4.0 - m_mu, 2.0);
+
+	m_sigma = std::sqrt(2.0 * var);
+	m_stdev = std::sqrt(var) / std::sqrt(n);
 }
 
 qreal Elo::pointRatio() const
 {
+	if (m_pairs)
+		return m_mu;
+
 	qreal total = (m_wins + m_losses + m_draws) * 2;
 	return ((m_wins * 2) + m_draws) / total;
 }
@@ -70,5 +100,19 @@ qreal Elo::phiInv(qreal p)
 
 qreal Elo::LOS() const
 {
+	if (m_pairs)
+		return 100 * (0.5 + 0.5 * std::erf((m_mu - 0.5) / (std::sqrt(2.0) * m_stdev)));
 	return 100 * (0.5 + 0.5 * std::erf((m_wins - m_losses) / std::sqrt(2.0 * (m_wins + m_losses))));
 }
+
+qreal Elo::normalizedDiff() const
+{
+	if (m_sigma <= 0.0)
+		return 0.0;
+	return (m_mu - 0.5) / m_sigma * 800.0 / std::log(10.0);
+}
+
+qreal Elo::normalizedErrorMargin() const
+{
+	return phiInv(0.975) / std::sqrt(m_games) * 800.0 / std::log(10.0);
+}
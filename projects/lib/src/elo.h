@@ -29,12 +29,25 @@
  * suitable for matches between two players but not that accurate when
  * there are more than 2 players in a tournament. This is because the ratings
  * are calculated as if each player's results were against a single opponent.
+ *
+ * The statistics can also be calculated from the pentanomial distribution
+ * of game pairs played from the same opening. Because the games of a pair
+ * are correlated, this gives a more accurate error margin.
  */
 class LIB_EXPORT Elo
 {
 	public:
 		/*! Creates a new Elo object. */
 		Elo(int wins, int losses, int draws);
+		/*!
+		 * Creates a new Elo object from game pair statistics.
+		 *
+		 * The arguments are the numbers of pairs that scored 0,
+		 * 0.5, 1, 1.5 and 2 points. \a drawDraw includes the
+		 * pairs with a win and a loss.
+		 */
+		Elo(int lossLoss, int lossDraw, int drawDraw,
+		    int winDraw, int winWin);
 
 		/*! Returns the Elo difference. */
 		qreal diff() const;
@@ -42,17 +55,33 @@ class LIB_EXPORT Elo
 		qreal errorMargin() const;
 		/*! Returns the ratio of points won. */
 		qreal pointRatio() const;
-		/*! Returns the ratio of drawn games. */
+		/*!
+		 * Returns the ratio of drawn games, or the ratio of
+		 * pairs that scored one point for game pair statistics.
+		 */
 		qreal drawRatio() const;
 		/*! Returns the likelihood of superiority. */
 		qreal LOS() const;
+		/*!
+		 * Returns the normalized Elo difference.
+		 *
+		 * Normalized Elo scales the score's deviation from 0.5 by
+		 * the per-game standard deviation, so it doesn't depend
+		 * on the draw ratio.
+		 */
+		qreal normalizedDiff() const;
+		/*! Returns the error margin in normalized Elo points. */
+		qreal normalizedErrorMargin() const;
 
 	private:
 		int m_wins;
 		int m_losses;
 		int m_draws;
+		bool m_pairs;
+		qreal m_games;
 		qreal m_mu;
 		qreal m_stdev;
+		qreal m_sigma;
 
 		// Elo difference
 		static qreal diff(qreal p);
@@ -21,11 +21,13 @@
 
 #include <QtGlobal>
 
-#ifdef Q_OS_WIN32
+#if defined(Q_OS_WIN32)
   #include "engineprocess_win.h"
-#else // not Q_OS_WIN32
+#elif defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+  #include "engineprocess_linux.h"
+#else
   #include <QProcess>
   #define EngineProcess QProcess
-#endif // not Q_OS_WIN32
+#endif
 
 #endif // ENGINEPROCESS_H
@@ -0,0 +1,701 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "engineprocess_linux.h"
+#include <QFile>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QVector>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// posix_spawn_file_actions_addchdir_np() is needed for setting the
+// working directory of a spawned process
+#if defined(__GLIBC__) \
+ && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+  #define ENGINEPROCESS_SPAWN_CHDIR
+#endif
+
+extern char** environ;
+
+namespace {
+
+const int s_readChunkSize = 0x10000;
+// Exit polling interval when process file descriptors aren't supported
+const int s_exitPollInterval = 50;
+
+void ignoreSigPipe()
+{
+	// Writing to an engine that has exited must not kill us. The
+	// children get the default handler back in spawn().
+	static const bool ignored = []()
+	{
+		struct sigaction action;
+		if (sigaction(SIGPIPE, nullptr, &action) == 0
+		&&  action.sa_handler == SIG_DFL)
+		{
+			memset(&action, 0, sizeof(action));
+			action.sa_handler = SIG_IGN;
+			sigemptyset(&action.sa_mask);
+			sigaction(SIGPIPE, &action, nullptr);
+		}
+		return true;
+	}();
+	Q_UNUSED(ignored);
+}
+
+int openPidFd(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+	return int(syscall(SYS_pidfd_open, pid, 0));
+#else
+	Q_UNUSED(pid);
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+bool setNonBlocking(int fd)
+{
+	const int flags = fcntl(fd, F_GETFL);
+	return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+} // anonymous namespace
+
+
+EngineProcess::EngineProcess(QObject* parent)
+	: QIODevice(parent),
+	  m_state(NotRunning),
+	  m_pid(0),
+	  m_exitCode(0),
+	  m_exitStatus(EngineProcess::NormalExit),
+	  m_stdErrFileMode(Truncate),
+	  m_inWrite(-1),
+	  m_outRead(-1),
+	  m_pidFd(-1),
+	  m_readNotifier(nullptr),
+	  m_writeNotifier(nullptr),
+	  m_exitNotifier(nullptr),
+	  m_exitTimer(nullptr),
+	  m_readPos(0)
+{
+	// A reserved buffer keeps its capacity when it's emptied
+	m_readBuffer.reserve(s_readChunkSize);
+}
+
+EngineProcess::~EngineProcess()
+{
+	if (m_state != NotRunning)
+	{
+		qWarning("EngineProcess: Destroyed while process is still running.");
+		kill();
+		waitForFinished(-1);
+	}
+	cleanup();
+}
+
+int EngineProcess::exitCode() const
+{
+	return m_exitCode;
+}
+
+EngineProcess::ExitStatus EngineProcess::exitStatus() const
+{
+	return m_exitStatus;
+}
+
+EngineProcess::ProcessState EngineProcess::state() const
+{
+	return m_state;
+}
+
+qint64 EngineProcess::processId() const
+{
+	if (m_state == NotRunning)
+		return 0;
+	return qint64(m_pid);
+}
+
+qint64 EngineProcess::bytesAvailable() const
+{
+	return m_readBuffer.size() - m_readPos + QIODevice::bytesAvailable();
+}
+
+qint64 EngineProcess::bytesToWrite() const
+{
+	return m_writeBuffer.size() + QIODevice::bytesToWrite();
+}
+
+bool EngineProcess::canReadLine() const
+{
+	const int size = m_readBuffer.size() - m_readPos;
+	if (size > 0 && memchr(m_readBuffer.constData() + m_readPos,
+			       '\n', size_t(size)) != nullptr)
+		return true;
+	return QIODevice::canReadLine();
+}
+
+void EngineProcess::closeFd(int* fd)
+{
+	if (*fd == -1)
+		return;
+	::close(*fd);
+	*fd = -1;
+}
+
+void EngineProcess::cleanup()
+{
+	// The notifiers may be cleaned up from their own signals
+	QSocketNotifier* notifiers[] =
+	{
+		m_readNotifier, m_writeNotifier, m_exitNotifier
+	};
+	for (QSocketNotifier* notifier : notifiers)
+	{
+		if (notifier == nullptr)
+			continue;
+		notifier->setEnabled(false);
+		notifier->deleteLater();
+	}
+	m_readNotifier = nullptr;
+	m_writeNotifier = nullptr;
+	m_exitNotifier = nullptr;
+
+	if (m_exitTimer != nullptr)
+		m_exitTimer->stop();
+
+	closeFd(&m_inWrite);
+	closeFd(&m_outRead);
+	closeFd(&m_pidFd);
+	m_writeBuffer.clear();
+}
+
+void EngineProcess::close()
+{
+	if (m_state != NotRunning)
+	{
+		kill();
+		waitForFinished(-1);
+	}
+
+	cleanup();
+	QIODevice::close();
+}
+
+bool EngineProcess::isSequential() const
+{
+	return true;
+}
+
+QString EngineProcess::workingDirectory() const
+{
+	return m_workDir;
+}
+
+void EngineProcess::setWorkingDirectory(const QString& dir)
+{
+	m_workDir = dir;
+}
+
+void EngineProcess::setStandardErrorFile(const QString& fileName, OpenMode mode)
+{
+	m_stdErrFile = fileName;
+	m_stdErrFileMode = mode;
+}
+
+bool EngineProcess::spawn(const QString& program, const QStringList& arguments)
+{
+	QVector<QByteArray> args;
+	args.reserve(arguments.size() + 1);
+	args.append(QFile::encodeName(program));
+	for (const QString& arg : arguments)
+		args.append(arg.toLocal8Bit());
+
+	QVector<char*> argv;
+	argv.reserve(args.size() + 1);
+	for (QByteArray& arg : args)
+		argv.append(arg.data());
+	argv.append(nullptr);
+	char* const* argvData = argv.data();
+
+	const QByteArray workDir(QFile::encodeName(m_workDir));
+
+	// The pipes are created with close-on-exec so that engines
+	// started at the same time by other threads don't inherit them
+	int inPipe[2];
+	int outPipe[2];
+	if (pipe2(inPipe, O_CLOEXEC) == -1)
+	{
+		setErrorString(QString::fromLocal8Bit(strerror(errno)));
+		return false;
+	}
+	if (pipe2(outPipe, O_CLOEXEC) == -1)
+	{
+		setErrorString(QString::fromLocal8Bit(strerror(errno)));
+		closeFd(&inPipe[0]);
+		closeFd(&inPipe[1]);
+		return false;
+	}
+
+	int errFd = -1;
+	if (!m_stdErrFile.isEmpty())
+	{
+		int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+		flags |= (m_stdErrFileMode & Append) ? O_APPEND : O_TRUNC;
+		errFd = ::open(QFile::encodeName(m_stdErrFile).constData(),
+			       flags, 0666);
+		if (errFd == -1)
+			qWarning("EngineProcess: cannot open %s: %s",
+				 qUtf8Printable(m_stdErrFile), strerror(errno));
+	}
+	if (errFd == -1)
+		errFd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+	pid_t pid = -1;
+	int error = 0;
+
+#ifdef ENGINEPROCESS_SPAWN_CHDIR
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions, inPipe[0], STDIN_FILENO);
+	posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+	if (errFd != -1)
+		posix_spawn_file_actions_adddup2(&actions, errFd, STDERR_FILENO);
+	if (!workDir.isEmpty())
+		posix_spawn_file_actions_addchdir_np(&actions, workDir.constData());
+
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigset_t defaultSignals;
+	sigemptyset(&defaultSignals);
+	sigaddset(&defaultSignals, SIGPIPE);
+
+	posix_spawnattr_t attr;
+	posix_spawnattr_init(&attr);
+	posix_spawnattr_setsigmask(&attr, &mask);
+	posix_spawnattr_setsigdefault(&attr, &defaultSignals);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK
+				      | POSIX_SPAWN_SETSIGDEF);
+
+	error = posix_spawnp(&pid, argvData[0], &actions, &attr,
+			     argvData, environ);
+
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
+#else // not ENGINEPROCESS_SPAWN_CHDIR
+	// The working directory can only be changed in a forked child.
+	// Exec errors are reported through a close-on-exec pipe.
+	int errPipe[2];
+	if (pipe2(errPipe, O_CLOEXEC) == -1)
+		error = errno;
+	else if ((pid = fork()) == 0)
+	{
+		// Only async-signal-safe functions from here on
+		if (workDir.isEmpty() || chdir(workDir.constData()) == 0)
+		{
+			dup2(inPipe[0], STDIN_FILENO);
+			dup2(outPipe[1], STDOUT_FILENO);
+			if (errFd != -1)
+				dup2(errFd, STDERR_FILENO);
+
+			signal(SIGPIPE, SIG_DFL);
+			sigset_t mask;
+			sigemptyset(&mask);
+			sigprocmask(SIG_SETMASK, &mask, nullptr);
+
+			execvp(argvData[0], argvData);
+		}
+
+		const int childError = errno;
+		const ssize_t n = write(errPipe[1], &childError, sizeof(childError));
+		Q_UNUSED(n);
+		_exit(127);
+	}
+	else
+	{
+		if (pid == -1)
+			error = errno;
+		closeFd(&errPipe[1]);
+
+		int childError = 0;
+		ssize_t n;
+		do
+			n = read(errPipe[0], &childError, sizeof(childError));
+		while (n == -1 && errno == EINTR);
+		if (n == sizeof(childError))
+		{
+			error = childError;
+			waitpid(pid, nullptr, 0);
+		}
+		closeFd(&errPipe[0]);
+	}
+#endif // not ENGINEPROCESS_SPAWN_CHDIR
+
+	// Close the child process' ends of the pipes to make sure that
+	// reading returns end-of-file when the child terminates
+	closeFd(&inPipe[0]);
+	closeFd(&outPipe[1]);
+	closeFd(&errFd);
+
+	if (error != 0
+	||  !setNonBlocking(inPipe[1])
+	||  !setNonBlocking(outPipe[0]))
+	{
+		if (error != 0)
+			setErrorString(QString::fromLocal8Bit(strerror(error)));
+		closeFd(&inPipe[1]);
+		closeFd(&outPipe[0]);
+		if (error == 0)
+		{
+			::kill(pid, SIGKILL);
+			waitpid(pid, nullptr, 0);
+		}
+		return false;
+	}
+
+	m_pid = pid;
+	m_inWrite = inPipe[1];
+	m_outRead = outPipe[0];
+
+	return true;
+}
+
+void EngineProcess::start(const QString& program,
+			  const QStringList& arguments,
+			  OpenMode mode)
+{
+	if (m_state != NotRunning)
+		close();
+
+	ignoreSigPipe();
+
+	m_exitCode = 0;
+	m_exitStatus = NormalExit;
+	m_readBuffer.resize(0);
+	m_readPos = 0;
+	m_writeBuffer.clear();
+
+	m_state = Starting;
+	if (!spawn(program, arguments))
+	{
+		m_state = NotRunning;
+		cleanup();
+		return;
+	}
+	m_state = Running;
+
+	m_readNotifier = new QSocketNotifier(m_outRead, QSocketNotifier::Read, this);
+	connect(m_readNotifier, &QSocketNotifier::activated,
+		this, &EngineProcess::onReadActivated);
+
+	m_writeNotifier = new QSocketNotifier(m_inWrite, QSocketNotifier::Write, this);
+	m_writeNotifier->setEnabled(false);
+	connect(m_writeNotifier, &QSocketNotifier::activated,
+		this, &EngineProcess::onWriteActivated);
+
+	// Fall back to polling if the kernel doesn't support pidfd_open()
+	m_pidFd = openPidFd(m_pid);
+	if (m_pidFd != -1)
+	{
+		m_exitNotifier = new QSocketNotifier(m_pidFd, QSocketNotifier::Read, this);
+		connect(m_exitNotifier, &QSocketNotifier::activated,
+			this, &EngineProcess::onExitActivated);
+	}
+	else
+	{
+		if (m_exitTimer == nullptr)
+		{
+			m_exitTimer = new QTimer(this);
+			m_exitTimer->setInterval(s_exitPollInterval);
+			connect(m_exitTimer, &QTimer::timeout,
+				this, &EngineProcess::onExitActivated);
+		}
+		m_exitTimer->start();
+	}
+
+	// The data is buffered by EngineProcess itself
+	QIODevice::open(mode | Unbuffered);
+}
+
+void EngineProcess::start(const QString& program,
+			  OpenMode mode)
+{
+	QStringList args(QProcess::splitCommand(program));
+	if (args.isEmpty())
+		return;
+
+	QString prog = args.first();
+	args.removeFirst();
+	start(prog, args, mode);
+}
+
+void EngineProcess::kill()
+{
+	if (m_state != NotRunning)
+		::kill(m_pid, SIGKILL);
+}
+
+void EngineProcess::onReadActivated()
+{
+	if (m_outRead == -1)
+		return;
+
+	// Move unread data to the start of the buffer
+	if (m_readPos > 0)
+	{
+		const int size = m_readBuffer.size() - m_readPos;
+		if (size > 0)
+			memmove(m_readBuffer.data(),
+				m_readBuffer.constData() + m_readPos,
+				size_t(size));
+		m_readBuffer.resize(size);
+		m_readPos = 0;
+	}
+
+	bool eof = false;
+	qint64 total = 0;
+	for (;;)
+	{
+		const int size = m_readBuffer.size();
+		m_readBuffer.resize(size + s_readChunkSize);
+		const ssize_t n = ::read(m_outRead, m_readBuffer.data() + size,
+					 s_readChunkSize);
+		m_readBuffer.resize(size + int(qMax(n, ssize_t(0))));
+
+		if (n > 0)
+		{
+			total += n;
+			// A short read means that the pipe is empty
+			if (n < s_readChunkSize)
+				break;
+		}
+		else if (n == 0)
+		{
+			eof = true;
+			break;
+		}
+		else if (errno != EINTR)
+		{
+			eof = (errno != EAGAIN && errno != EWOULDBLOCK);
+			break;
+		}
+	}
+
+	if (total > 0)
+		emit readyRead();
+	if (eof && m_outRead != -1)
+		closeReadChannel();
+}
+
+void EngineProcess::closeReadChannel()
+{
+	if (m_readNotifier != nullptr)
+	{
+		m_readNotifier->setEnabled(false);
+		m_readNotifier->deleteLater();
+		m_readNotifier = nullptr;
+	}
+	closeFd(&m_outRead);
+
+	emit readChannelFinished();
+}
+
+qint64 EngineProcess::readData(char* data, qint64 maxSize)
+{
+	const qint64 n = qMin(maxSize, qint64(m_readBuffer.size() - m_readPos));
+	if (n <= 0)
+		return 0;
+
+	memcpy(data, m_readBuffer.constData() + m_readPos, size_t(n));
+	m_readPos += int(n);
+	if (m_readPos == m_readBuffer.size())
+	{
+		m_readBuffer.resize(0);
+		m_readPos = 0;
+	}
+
+	return n;
+}
+
+qint64 EngineProcess::writeData(const char* data, qint64 maxSize)
+{
+	if (m_inWrite == -1)
+		return -1;
+
+	// Write directly to the pipe if nothing is waiting for it.
+	// Whatever doesn't fit is written when the pipe has room.
+	qint64 written = 0;
+	if (m_writeBuffer.isEmpty())
+	{
+		while (written < maxSize)
+		{
+			const ssize_t n = ::write(m_inWrite, data + written,
+						  size_t(maxSize - written));
+			if (n >= 0)
+				written += n;
+			else if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			else if (errno != EINTR)
+			{
+				setErrorString(QString::fromLocal8Bit(strerror(errno)));
+				return -1;
+			}
+		}
+	}
+
+	if (written < maxSize)
+	{
+		m_writeBuffer.append(data + written, int(maxSize - written));
+		m_writeNotifier->setEnabled(true);
+	}
+
+	return maxSize;
+}
+
+bool EngineProcess::flushWriteBuffer()
+{
+	int written = 0;
+	while (written < m_writeBuffer.size())
+	{
+		const ssize_t n = ::write(m_inWrite,
+					  m_writeBuffer.constData() + written,
+					  size_t(m_writeBuffer.size() - written));
+		if (n >= 0)
+			written += int(n);
+		else if (errno == EAGAIN || errno == EWOULDBLOCK)
+			break;
+		else if (errno != EINTR)
+		{
+			setErrorString(QString::fromLocal8Bit(strerror(errno)));
+			m_writeBuffer.clear();
+			return false;
+		}
+	}
+
+	m_writeBuffer.remove(0, written);
+	if (written > 0)
+		emit bytesWritten(written);
+	return true;
+}
+
+void EngineProcess::onWriteActivated()
+{
+	if (m_inWrite == -1)
+		return;
+
+	if (!flushWriteBuffer() || m_writeBuffer.isEmpty())
+		m_writeNotifier->setEnabled(false);
+}
+
+void EngineProcess::onExitActivated()
+{
+	reap(false);
+}
+
+bool EngineProcess::reap(bool block)
+{
+	if (m_state == NotRunning)
+		return false;
+
+	int status = 0;
+	pid_t ret;
+	do
+		ret = waitpid(m_pid, &status, block ? 0 : WNOHANG);
+	while (ret == -1 && errno == EINTR);
+	if (ret != m_pid)
+		return false;
+
+	if (WIFEXITED(status))
+	{
+		m_exitCode = WEXITSTATUS(status);
+		m_exitStatus = NormalExit;
+	}
+	else
+	{
+		m_exitCode = WIFSIGNALED(status) ? WTERMSIG(status) : -1;
+		m_exitStatus = CrashExit;
+	}
+	m_state = NotRunning;
+	m_pid = 0;
+
+	// Read whatever the process wrote before it exited
+	if (m_outRead != -1)
+	{
+		onReadActivated();
+		if (m_outRead != -1)
+			closeReadChannel();
+	}
+	cleanup();
+
+	emit finished(m_exitCode, m_exitStatus);
+	return true;
+}
+
+bool EngineProcess::waitForFinished(int msecs)
+{
+	if (m_state == NotRunning)
+		return false;
+
+	if (m_pidFd != -1)
+	{
+		pollfd pfd;
+		pfd.fd = m_pidFd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+
+		QElapsedTimer timer;
+		timer.start();
+		int ret;
+		for (;;)
+		{
+			int timeout = -1;
+			if (msecs != -1)
+				timeout = int(qMax(qint64(0), msecs - timer.elapsed()));
+			ret = poll(&pfd, 1, timeout);
+			if (ret != -1 || errno != EINTR)
+				break;
+		}
+		return ret > 0 && reap(true);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	while (!reap(false))
+	{
+		if (msecs != -1 && timer.elapsed() >= msecs)
+			return false;
+		usleep(1000);
+	}
+	return true;
+}
+
+bool EngineProcess::waitForStarted(int msecs)
+{
+	Q_UNUSED(msecs);
+	return m_state == Running;
+}
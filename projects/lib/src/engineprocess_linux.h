@@ -0,0 +1,208 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENGINEPROCESS_LINUX_H
+#define ENGINEPROCESS_LINUX_H
+
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <sys/types.h>
+class QSocketNotifier;
+class QTimer;
+
+
+/*!
+ * \brief A replacement for QProcess on Linux
+ *
+ * EngineProcess starts the child process with posix_spawn(), which
+ * doesn't copy the parent's page tables like fork() does, and returns
+ * as soon as the program has been executed. Starting hundreds of
+ * engines from a large process is therefore cheap, and waitForStarted()
+ * never has to wait.
+ *
+ * The pipes to the child are non-blocking and they are watched by
+ * socket notifiers in the thread that owns the EngineProcess, so no
+ * helper threads are needed. The exit of the child is detected with a
+ * process file descriptor when the kernel supports it.
+ *
+ * The interface is the same as QProcess' with some unneeded features
+ * left out.
+ *
+ * \sa QProcess
+ */
+class LIB_EXPORT EngineProcess : public QIODevice
+{
+	Q_OBJECT
+
+	public:
+		/*! The process' exit status. */
+		enum ExitStatus
+		{
+			NormalExit,	//!< The process exited normally
+			CrashExit	//!< The process crashed
+		};
+		Q_ENUM(ExitStatus)
+
+		/*! The state of the process. */
+		enum ProcessState
+		{
+			NotRunning,	//!< The process is not running
+			Starting,	//!< The process is starting
+			Running		//!< The process is running
+		};
+		Q_ENUM(ProcessState)
+
+		/*! Creates a new EngineProcess. */
+		explicit EngineProcess(QObject* parent = nullptr);
+		/*!
+		 * Destructs the EngineProcess and frees all resources.
+		 * If the process is still running, it is killed.
+		 */
+		virtual ~EngineProcess();
+
+		// Inherited from QIODevice
+		virtual qint64 bytesAvailable() const;
+		virtual qint64 bytesToWrite() const;
+		virtual bool canReadLine() const;
+		virtual void close();
+		virtual bool isSequential() const;
+
+		/*! Returns the exit code of the last process that finished. */
+		int exitCode() const;
+		/*! Returns the exit status of the last process that finished. */
+		ExitStatus exitStatus() const;
+		/*! Returns the current state of the process. */
+		ProcessState state() const;
+		/*!
+		 * Returns the native process identifier of the running
+		 * process, or 0 if no process is running.
+		 */
+		qint64 processId() const;
+
+		/*!
+		 * Returns the process' working directory.
+		 * Returns an empty string if the working directory wasn't
+		 * set with setWorkingDirectory().
+		 */
+		QString workingDirectory() const;
+		/*!
+		 * Sets the working directory to dir.
+		 * EngineProcess will start the process in this directory.
+		 */
+		void setWorkingDirectory(const QString& dir);
+		/*!
+		 * Redirects the process' standard error to the file fileName.
+		 * The file will be appended to if mode is Append; otherwise
+		 * it will be truncated.
+		 *
+		 * If no file is set, the standard error is discarded.
+		 */
+		void setStandardErrorFile(const QString& fileName,
+					  OpenMode mode = Truncate);
+
+		/*!
+		 * Starts the program \a program in a new process, passing the
+		 * command line arguments in \a arguments. The OpenMode is set
+		 * to \a mode.
+		 *
+		 * If \a program doesn't contain a slash, it is searched for
+		 * in the directories of the PATH environment variable.
+		 *
+		 * \note Unlike the same function in QProcess, this one
+		 * returns only after the program has been executed or
+		 * failed to execute. It doesn't wait for anything else.
+		 *
+		 * \note To check if the process started successfully, call
+		 * the waitForStarted() method.
+		 */
+		void start(const QString& program,
+			   const QStringList& arguments,
+			   OpenMode mode = ReadWrite);
+		/*! Starts the program \a program with OpenMode \a mode. */
+		void start(const QString& program,
+			   OpenMode mode = ReadWrite);
+
+		/*!
+		 * Blocks until the process has finished and the finished()
+		 * signal has been emitted.
+		 *
+		 * Times out after \a msecs milliseconds. If \a msecs is -1
+		 * the function will not time out.
+		 *
+		 * \return true if the process finished.
+		 */
+		bool waitForFinished(int msecs = 30000);
+
+		/*!
+		 * Returns true if the process started successfully.
+		 * Doesn't really wait for anything since the start() method
+		 * already did the waiting.
+		 */
+		bool waitForStarted(int msecs = 30000);
+
+	public slots:
+		/*! Kills the process, causing it to exit immediately. */
+		void kill();
+
+	signals:
+		/*!
+		 * Emitted when the process finishes.
+		 * \param exitCode exit code of the process
+		 * \param exitStatus exit status of the process
+		 */
+		void finished(int exitCode, EngineProcess::ExitStatus exitStatus);
+
+	protected:
+		// Inherited from QIODevice
+		virtual qint64 readData(char* data, qint64 maxSize);
+		virtual qint64 writeData(const char* data, qint64 maxSize);
+
+	private slots:
+		void onReadActivated();
+		void onWriteActivated();
+		void onExitActivated();
+
+	private:
+		bool spawn(const QString& program, const QStringList& arguments);
+		bool flushWriteBuffer();
+		void closeReadChannel();
+		bool reap(bool block);
+		void cleanup();
+		static void closeFd(int* fd);
+
+		ProcessState m_state;
+		pid_t m_pid;
+		int m_exitCode;
+		ExitStatus m_exitStatus;
+		QString m_workDir;
+		QString m_stdErrFile;
+		OpenMode m_stdErrFileMode;
+		int m_inWrite;
+		int m_outRead;
+		int m_pidFd;
+		QSocketNotifier* m_readNotifier;
+		QSocketNotifier* m_writeNotifier;
+		QSocketNotifier* m_exitNotifier;
+		QTimer* m_exitTimer;
+		QByteArray m_readBuffer;
+		int m_readPos;
+		QByteArray m_writeBuffer;
+};
+
+#endif // ENGINEPROCESS_LINUX_H
@@ -0,0 +1,417 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gamearchive.h"
+#include <QIODevice>
+#include <QHash>
+#include <QVector>
+#include <climits>
+#include "pgngame.h"
+#include "compressiondevice.h"
+
+namespace {
+
+// "CCGA" followed by the format version and three reserved bytes
+const char s_magic[] = "CCGA";
+const int s_version = 1;
+const int s_headerSize = 8;
+
+// Flags of a game record
+const quint64 BlackStartsFlag = 0x1;
+const quint64 InitialCommentFlag = 0x2;
+
+// The squares are packed as "1 + file + rank * 16", and 0 is a null
+// square (eg. the source square of a piece drop).
+const int s_maxFiles = 16;
+
+void putVarint(QByteArray& out, quint64 value)
+{
+	while (value >= 0x80)
+	{
+		out.append(char((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.append(char(value));
+}
+
+quint64 packSquare(const Chess::Square& square)
+{
+	if (!square.isValid())
+		return 0;
+	return 1 + square.file() + quint64(square.rank()) * s_maxFiles;
+}
+
+Chess::Square unpackSquare(quint64 value)
+{
+	if (value == 0)
+		return Chess::Square();
+	value--;
+	return Chess::Square(int(value % s_maxFiles), int(value / s_maxFiles));
+}
+
+class StringTable
+{
+	public:
+		quint64 index(const QString& str)
+		{
+			auto it = m_indexes.constFind(str);
+			if (it != m_indexes.constEnd())
+				return it.value();
+
+			quint64 i = m_indexes.size();
+			m_indexes.insert(str, i);
+			const QByteArray utf8(str.toUtf8());
+			putVarint(m_data, utf8.size());
+			m_data.append(utf8);
+			return i;
+		}
+
+		int size() const
+		{
+			return m_indexes.size();
+		}
+
+		const QByteArray& data() const
+		{
+			return m_data;
+		}
+
+	private:
+		QHash<QString, quint64> m_indexes;
+		QByteArray m_data;
+};
+
+class Decoder
+{
+	public:
+		explicit Decoder(const QByteArray& data)
+			: m_pos(reinterpret_cast<const uchar*>(data.constData())),
+			  m_end(m_pos + data.size()),
+			  m_ok(true)
+		{
+		}
+
+		bool isOk() const
+		{
+			return m_ok;
+		}
+
+		bool atEnd() const
+		{
+			return m_pos == m_end;
+		}
+
+		uchar peekByte() const
+		{
+			return (m_pos != m_end) ? *m_pos : 0;
+		}
+
+		quint64 varint()
+		{
+			quint64 value = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				if (m_pos == m_end)
+					break;
+				uchar c = *m_pos++;
+				value |= quint64(c & 0x7f) << shift;
+				if (!(c & 0x80))
+					return value;
+			}
+			m_ok = false;
+			return 0;
+		}
+
+		QString readString(quint64 size)
+		{
+			if (size > quint64(m_end - m_pos))
+			{
+				m_ok = false;
+				m_pos = m_end;
+				return QString();
+			}
+			const char* str = reinterpret_cast<const char*>(m_pos);
+			m_pos += size;
+			return QString::fromUtf8(str, int(size));
+		}
+
+		// Reads a string table index, where \a base is the
+		// index of the first string
+		QString tableString(const QVector<QString>& table,
+				    quint64 base = 0)
+		{
+			quint64 i = varint() - base;
+			if (i >= quint64(table.size()))
+			{
+				m_ok = false;
+				return QString();
+			}
+			return table.at(int(i));
+		}
+
+	private:
+		const uchar* m_pos;
+		const uchar* m_end;
+		bool m_ok;
+};
+
+} // anonymous namespace
+
+GameArchiveReader::GameArchiveReader(QIODevice* device)
+	: m_device(device),
+	  m_status(Ok),
+	  m_headerRead(false)
+{
+	Q_ASSERT(device != nullptr);
+}
+
+QIODevice* GameArchiveReader::device() const
+{
+	return m_device;
+}
+
+GameArchiveReader::Status GameArchiveReader::status() const
+{
+	return m_status;
+}
+
+QString GameArchiveReader::errorString() const
+{
+	return m_errorString;
+}
+
+bool GameArchiveReader::isArchiveFileName(const QString& fileName)
+{
+	QString name(fileName);
+	if (CompressionDevice::codecForFileName(name) != CompressionDevice::NoCodec)
+		name.truncate(name.lastIndexOf('.'));
+
+	return name.endsWith(".ccg", Qt::CaseInsensitive);
+}
+
+bool GameArchiveReader::setError(Status status, const QString& error)
+{
+	m_status = status;
+	m_errorString = error;
+	return false;
+}
+
+bool GameArchiveReader::readHeader()
+{
+	const QByteArray header(m_device->read(s_headerSize));
+	if (header.size() != s_headerSize || !header.startsWith(s_magic))
+		return setError(InvalidData, "Not a game archive");
+	if (header.at(4) != char(s_version))
+		return setError(InvalidData,
+			QString("Unsupported game archive version: %1")
+			.arg(int(uchar(header.at(4)))));
+
+	m_headerRead = true;
+	return true;
+}
+
+bool GameArchiveReader::read(PgnGame& game, int maxMoves, bool addEco)
+{
+	if (m_status != Ok)
+		return false;
+	if (!m_headerRead && !readHeader())
+		return false;
+
+	// Record size
+	quint64 size = 0;
+	char c;
+	for (int shift = 0; ; shift += 7)
+	{
+		if (!m_device->getChar(&c))
+		{
+			if (shift == 0)
+				return setError(ReadPastEnd, QString());
+			return setError(ReadPastEnd, "Truncated game record");
+		}
+		size |= quint64(uchar(c) & 0x7f) << shift;
+		if (!(c & 0x80))
+			break;
+		if (shift >= 28)
+			return setError(InvalidData, "Invalid game record size");
+	}
+
+	// A damaged size must not be allocated or read into a buffer
+	// that's too small for it
+	if (size > quint64(INT_MAX))
+		return setError(InvalidData, "Invalid game record size");
+	if (!m_device->isSequential()
+	&&  qint64(size) > m_device->bytesAvailable())
+		return setError(ReadPastEnd, "Truncated game record");
+
+	// The record buffer is reused to avoid an allocation per game
+	m_record.resize(int(size));
+	if (m_device->read(m_record.data(), qint64(size)) != qint64(size))
+		return setError(ReadPastEnd, "Truncated game record");
+
+	game.clear();
+	Decoder in(m_record);
+
+	const quint64 stringCount = in.varint();
+	if (stringCount > size)
+		return setError(InvalidData, "Invalid string table");
+	QVector<QString> strings;
+	strings.reserve(int(stringCount));
+	for (quint64 i = 0; i < stringCount && in.isOk(); i++)
+		strings.append(in.readString(in.varint()));
+
+	const quint64 flags = in.varint();
+	Chess::Side startingSide = (flags & BlackStartsFlag)
+		? Chess::Side::Black : Chess::Side::White;
+	if (flags & InitialCommentFlag)
+		game.m_initialComment = in.tableString(strings);
+
+	const quint64 tagCount = in.varint();
+	for (quint64 i = 0; i < tagCount && in.isOk(); i++)
+	{
+		const QString tag(in.tableString(strings));
+		game.setTag(tag, in.tableString(strings));
+	}
+
+	// The tags must be set before the moves for ECO detection
+	const quint64 moveCount = in.varint();
+	for (quint64 i = 0; i < moveCount && in.isOk(); i++)
+	{
+		PgnGame::MoveData md;
+		md.key = 0;
+		md.moveString = in.tableString(strings);
+		const Chess::Square source(unpackSquare(in.varint()));
+		const Chess::Square target(unpackSquare(in.varint()));
+		md.move = Chess::GenericMove(source, target, int(in.varint()));
+		// Comment indexes start from 1, and 0 means no comment
+		if (in.peekByte() == 0)
+			in.varint();
+		else
+			md.comment = in.tableString(strings, 1);
+
+		if (int(i) < maxMoves)
+			game.addMove(md, addEco);
+	}
+
+	if (!in.isOk() || !in.atEnd())
+	{
+		game.clear();
+		return setError(InvalidData, "Invalid game record");
+	}
+
+	game.setStartingSide(startingSide);
+	game.setTag("PlyCount", QString::number(game.moves().size()));
+
+	return true;
+}
+
+
+GameArchiveWriter::GameArchiveWriter(QIODevice* device)
+	: m_device(device),
+	  m_headerWritten(false)
+{
+	Q_ASSERT(device != nullptr);
+}
+
+QIODevice* GameArchiveWriter::device() const
+{
+	return m_device;
+}
+
+QByteArray GameArchiveWriter::fileHeader()
+{
+	QByteArray header(s_magic);
+	header.append(char(s_version));
+	header.append(s_headerSize - header.size(), '\0');
+	return header;
+}
+
+QByteArray GameArchiveWriter::encode(const PgnGame& game)
+{
+	if (game.m_tags.isEmpty())
+		return QByteArray();
+
+	StringTable strings;
+	QByteArray body;
+
+	quint64 flags = 0;
+	if (game.m_startingSide == Chess::Side::Black)
+		flags |= BlackStartsFlag;
+	const bool initialComment = game.m_moves.isEmpty()
+				 && !game.m_initialComment.isEmpty();
+	if (initialComment)
+		flags |= InitialCommentFlag;
+	putVarint(body, flags);
+	if (initialComment)
+		putVarint(body, strings.index(game.m_initialComment));
+
+	putVarint(body, game.m_tags.size());
+	for (auto it = game.m_tags.constBegin(); it != game.m_tags.constEnd(); ++it)
+	{
+		putVarint(body, strings.index(it.key()));
+		putVarint(body, strings.index(it.value()));
+	}
+
+	putVarint(body, game.m_moves.size());
+	for (const PgnGame::MoveData& md : game.m_moves)
+	{
+		const Chess::Square source(md.move.sourceSquare());
+		const Chess::Square target(md.move.targetSquare());
+		if (source.file() >= s_maxFiles || target.file() >= s_maxFiles
+		||  md.move.promotion() < 0)
+			return QByteArray();
+
+		putVarint(body, strings.index(md.moveString));
+		putVarint(body, packSquare(source));
+		putVarint(body, packSquare(target));
+		putVarint(body, quint64(md.move.promotion()));
+		if (md.comment.isEmpty())
+			putVarint(body, 0);
+		else
+			putVarint(body, strings.index(md.comment) + 1);
+	}
+
+	QByteArray payload;
+	putVarint(payload, strings.size());
+	payload.append(strings.data());
+	payload.append(body);
+
+	QByteArray record;
+	putVarint(record, payload.size());
+	record.append(payload);
+	return record;
+}
+
+bool GameArchiveWriter::write(const PgnGame& game)
+{
+	const QByteArray record(encode(game));
+	if (record.isEmpty())
+		return false;
+
+	if (!m_headerWritten)
+	{
+		if (m_device->pos() == 0)
+		{
+			const QByteArray header(fileHeader());
+			if (m_device->write(header) != header.size())
+				return false;
+		}
+		m_headerWritten = true;
+	}
+
+	return m_device->write(record) == record.size();
+}
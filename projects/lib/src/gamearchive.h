@@ -0,0 +1,146 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMEARCHIVE_H
+#define GAMEARCHIVE_H
+
+#include <QByteArray>
+#include <QString>
+#include <climits>
+class QIODevice;
+class PgnGame;
+
+/*!
+ * \brief A class for reading games from a binary game archive.
+ *
+ * A game archive (".ccg") is a compact binary alternative to PGN.
+ * The file starts with a short header, followed by one record for
+ * each game. A record has its own string table which holds the tag
+ * names and values, the moves in Standard Algebraic Notation and the
+ * comments, so repeated strings are stored only once per game. The
+ * moves are stored as string table indices and as packed source
+ * square, target square and promotion.
+ *
+ * Because the moves are stored in both the "generic" and SAN format,
+ * loading a game doesn't need any move generation, and reading an
+ * archive is much faster than parsing the same games from PGN.
+ *
+ * \note The zobrist keys of the moves (PgnGame::MoveData::key) are
+ * not stored, so they are zero in the games read from an archive.
+ *
+ * \sa GameArchiveWriter
+ * \sa PgnGame
+ */
+class LIB_EXPORT GameArchiveReader
+{
+	public:
+		/*! The current status of the reader. */
+		enum Status
+		{
+			Ok,		//!< The reader is operating normally
+			ReadPastEnd,	//!< There are no more complete games
+			InvalidData	//!< The data is not a valid archive
+		};
+
+		/*!
+		 * Creates a reader which reads games from \a device.
+		 *
+		 * \a device must be open, and it is not owned by the
+		 * reader.
+		 */
+		explicit GameArchiveReader(QIODevice* device);
+
+		/*! Returns the device that the games are read from. */
+		QIODevice* device() const;
+		/*! Returns the status of the reader. */
+		Status status() const;
+		/*! Returns a description of the last error. */
+		QString errorString() const;
+
+		/*!
+		 * Reads the next game from the archive to \a game.
+		 *
+		 * \param maxMoves The maximum number of halfmoves to read.
+		 * \param addEco Adds opening information if true.
+		 *
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool read(PgnGame& game,
+			  int maxMoves = INT_MAX - 1,
+			  bool addEco = true);
+
+		/*!
+		 * Returns true if \a fileName is the name of a game
+		 * archive (".ccg", optionally followed by a compression
+		 * suffix); otherwise returns false.
+		 */
+		static bool isArchiveFileName(const QString& fileName);
+
+	private:
+		bool readHeader();
+		bool setError(Status status, const QString& error);
+
+		QIODevice* m_device;
+		Status m_status;
+		QString m_errorString;
+		bool m_headerRead;
+		QByteArray m_record;
+};
+
+/*!
+ * \brief A class for writing games to a binary game archive.
+ *
+ * \sa GameArchiveReader
+ */
+class LIB_EXPORT GameArchiveWriter
+{
+	public:
+		/*!
+		 * Creates a writer which writes games to \a device.
+		 *
+		 * \a device must be open, and it is not owned by the
+		 * writer. If the device is at the start, the archive
+		 * header is written before the first game; otherwise
+		 * the games are appended to an existing archive.
+		 */
+		explicit GameArchiveWriter(QIODevice* device);
+
+		/*! Returns the device that the games are written to. */
+		QIODevice* device() const;
+
+		/*!
+		 * Writes \a game to the archive.
+		 *
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool write(const PgnGame& game);
+
+		/*! Returns the header that starts every archive. */
+		static QByteArray fileHeader();
+		/*!
+		 * Returns \a game encoded as an archive record, or an
+		 * empty byte array if the game can't be encoded.
+		 */
+		static QByteArray encode(const PgnGame& game);
+
+	private:
+		QIODevice* m_device;
+		bool m_headerWritten;
+};
+
+#endif // GAMEARCHIVE_H
@@ -18,10 +18,54 @@
 
 #include "gamemanager.h"
 #include <QThread>
-#include <algorithm>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include <ctime>
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#endif
 #include "playerbuilder.h"
 #include "chessgame.h"
 #include "chessplayer.h"
+#include "chessengine.h"
+
+namespace {
+
+// Interval for sampling the CPU time of worker threads
+const int s_workerSampleInterval = 1000;
+
+/*!
+ * Returns the CPU time used by the current thread in nanoseconds,
+ * or -1 if it's not available.
+ */
+qint64 threadCpuTime()
+{
+#if defined(Q_OS_WIN32)
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime,
+			    &kernelTime, &userTime))
+		return -1;
+
+	ULARGE_INTEGER kernel, user;
+	kernel.LowPart = kernelTime.dwLowDateTime;
+	kernel.HighPart = kernelTime.dwHighDateTime;
+	user.LowPart = userTime.dwLowDateTime;
+	user.HighPart = userTime.dwHighDateTime;
+	return qint64(kernel.QuadPart + user.QuadPart) * 100;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return -1;
+	return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+	return -1;
+#endif
+}
+
+} // anonymous namespace
+
+class GameThread;
 
 class GameInitializer : public QObject
 {
@@ -29,16 +73,19 @@ class GameInitializer : public QObject
 
 	public:
 		GameInitializer(const PlayerBuilder* white,
-				const PlayerBuilder* black);
+				const PlayerBuilder* black,
+				GameThread* gameThread);
 		virtual ~GameInitializer();
 
 		const PlayerBuilder* whiteBuilder() const;
 		const PlayerBuilder* blackBuilder() const;
-		void swapPlayers();
+		void setPlayer(int side, ChessPlayer* player);
 		void setGame(ChessGame* game);
+		void setCpus(const QList<int>& cpus);
 
 	public slots:
 		void initializeGame();
+		void releasePlayers();
 		void finish();
 
 	signals:
@@ -54,21 +101,28 @@ class GameInitializer : public QObject
 		int m_playerCount;
 		bool m_finishing;
 		const PlayerBuilder* m_builder[2];
+		quint64 m_builderId[2];
 		ChessPlayer* m_player[2];
 		ChessGame* m_game;
+		GameThread* m_gameThread;
+		QList<int> m_cpus;
 };
 
 GameInitializer::GameInitializer(const PlayerBuilder* white,
-				 const PlayerBuilder* black)
+				 const PlayerBuilder* black,
+				 GameThread* gameThread)
 	: m_playerCount(0),
 	  m_finishing(false),
-	  m_game(nullptr)
+	  m_game(nullptr),
+	  m_gameThread(gameThread)
 {
 	Q_ASSERT(white != nullptr);
 	Q_ASSERT(black != nullptr);
 
 	m_builder[Chess::Side::White] = white;
 	m_builder[Chess::Side::Black] = black;
+	m_builderId[Chess::Side::White] = white->id();
+	m_builderId[Chess::Side::Black] = black->id();
 	m_player[0] = nullptr;
 	m_player[1] = nullptr;
 }
@@ -95,10 +149,14 @@ const PlayerBuilder* GameInitializer::blackBuilder() const
 	return m_builder[Chess::Side::Black];
 }
 
-void GameInitializer::swapPlayers()
+void GameInitializer::setPlayer(int side, ChessPlayer* player)
 {
-	std::swap(m_builder[0], m_builder[1]);
-	std::swap(m_player[0], m_player[1]);
+	Q_ASSERT(m_player[side] == nullptr);
+	Q_ASSERT(player->parent() == nullptr);
+
+	// Called in the game manager's thread before the game starts
+	player->moveToThread(thread());
+	m_player[side] = player;
 }
 
 void GameInitializer::setGame(ChessGame* game)
@@ -106,6 +164,11 @@ void GameInitializer::setGame(ChessGame* game)
 	m_game = game;
 }
 
+void GameInitializer::setCpus(const QList<int>& cpus)
+{
+	m_cpus = cpus;
+}
+
 void GameInitializer::deletePlayer(int index)
 {
 	ChessPlayer* player = m_player[index];
@@ -135,10 +198,14 @@ void GameInitializer::initializeGame()
 			deletePlayer(i);
 		}
 
+		// A player from the player pool
+		if (m_player[i] != nullptr && m_player[i]->parent() == nullptr)
+			m_player[i]->setParent(this);
+
 		if (m_player[i] == nullptr)
 		{
 			QString error;
-			m_player[i] = m_builder[i]->create(thread()->parent(),
+			m_player[i] = m_builder[i]->create(m_gameThread->parent(),
 							   SIGNAL(debugMessage(QString)),
 							   this, &error);
 			m_game->setError(error);
@@ -153,6 +220,14 @@ void GameInitializer::initializeGame()
 			}
 		}
 		m_game->setPlayer(Chess::Side::Type(i), m_player[i]);
+
+		// Pooled engines may come from another slot, so they're
+		// pinned again for every game.
+		auto engine = qobject_cast<ChessEngine*>(m_player[i]);
+		if (engine != nullptr && !m_cpus.isEmpty()
+		&&  !engine->setCpuAffinity(m_cpus))
+			qWarning("Cannot set the CPU affinity of %s",
+				 qUtf8Printable(engine->name()));
 	}
 	m_playerCount = 2;
 
@@ -190,6 +265,96 @@ void GameInitializer::onPlayerQuit()
 }
 
 
+class GameWorker : public QThread
+{
+	Q_OBJECT
+
+	public:
+		explicit GameWorker(QObject* parent);
+
+		int gameCount() const;
+		int totalGameCount() const;
+		double utilization() const;
+		void addGame();
+		void removeGame();
+
+	protected:
+		virtual void run();
+
+	private:
+		int m_gameCount;
+		int m_totalGameCount;
+		std::atomic<qint64> m_cpuTime;
+		std::atomic<qint64> m_wallTime;
+};
+
+GameWorker::GameWorker(QObject* parent)
+	: QThread(parent),
+	  m_gameCount(0),
+	  m_totalGameCount(0),
+	  m_cpuTime(0),
+	  m_wallTime(0)
+{
+}
+
+int GameWorker::gameCount() const
+{
+	return m_gameCount;
+}
+
+int GameWorker::totalGameCount() const
+{
+	return m_totalGameCount;
+}
+
+double GameWorker::utilization() const
+{
+	const qint64 wallTime = m_wallTime.load();
+	if (wallTime <= 0)
+		return 0.0;
+	return qBound(0.0, double(m_cpuTime.load()) / wallTime, 1.0);
+}
+
+void GameWorker::addGame()
+{
+	m_gameCount++;
+	m_totalGameCount++;
+}
+
+void GameWorker::removeGame()
+{
+	Q_ASSERT(m_gameCount > 0);
+	m_gameCount--;
+}
+
+void GameWorker::run()
+{
+	// The CPU time is sampled in the worker itself because the time
+	// of another thread can't be queried portably
+	QElapsedTimer wallTimer;
+	wallTimer.start();
+	const qint64 startCpuTime = threadCpuTime();
+	if (startCpuTime < 0)
+	{
+		exec();
+		return;
+	}
+
+	auto sample = [&]()
+	{
+		m_cpuTime = threadCpuTime() - startCpuTime;
+		m_wallTime = wallTimer.nsecsElapsed();
+	};
+	QTimer timer;
+	timer.setInterval(s_workerSampleInterval);
+	connect(&timer, &QTimer::timeout, sample);
+	timer.start();
+
+	exec();
+	sample();
+}
+
+
 class GameThread : public QThread
 {
 	Q_OBJECT
@@ -197,46 +362,67 @@ class GameThread : public QThread
 	public:
 		GameThread(const PlayerBuilder* white,
 			   const PlayerBuilder* black,
+			   GameWorker* worker,
 			   QObject* parent);
 		virtual ~GameThread();
 
+		QThread* host();
+		bool isActive() const;
 		bool isReady() const;
 		void newGame(ChessGame* game);
+		void releasePlayers();
 		void finish();
 		void finishAndDelete();
+		void stopHosting();
 
 		GameInitializer* initializer() const;
 		ChessGame* game() const;
 		GameManager::StartMode startMode() const;
 		GameManager::CleanupMode cleanupMode() const;
+		int coreSlot() const;
 
+		void setCoreSlot(int slot);
 		void setStartMode(GameManager::StartMode mode);
 		void setCleanupMode(GameManager::CleanupMode mode);
 
 	signals:
 		void gameInitialized(bool success);
 		void ready();
+		void playerReleased(quint64 builderId, ChessPlayer* player);
+		void playersReleased();
+		void stopped();
 
 	private slots:
 		void onGameDestroyed();
+		void onInitializerDestroyed();
 
 	private:
+		GameWorker* m_worker;
+		bool m_stopped;
 		bool m_ready;
+		int m_coreSlot;
 		GameManager::StartMode m_startMode;
 		GameManager::CleanupMode m_cleanupMode;
 		ChessGame* m_game;
 		GameInitializer* m_initializer;
+		QPointer<ChessGame> m_hostedGame;
+		QPointer<GameInitializer> m_hostedInitializer;
 };
 
 GameThread::GameThread(const PlayerBuilder* white,
 		       const PlayerBuilder* black,
+		       GameWorker* worker,
 		       QObject* parent)
 	: QThread(parent),
+	  m_worker(worker),
+	  m_stopped(false),
 	  m_ready(true),
+	  m_coreSlot(-1),
 	  m_startMode(GameManager::StartImmediately),
 	  m_cleanupMode(GameManager::DeletePlayers),
 	  m_game(nullptr),
-	  m_initializer(new GameInitializer(white, black))
+	  m_initializer(new GameInitializer(white, black, this)),
+	  m_hostedInitializer(m_initializer)
 {
 	connect(m_initializer, SIGNAL(gameInitialized(bool)),
 		this, SIGNAL(gameInitialized(bool)));
@@ -244,15 +430,36 @@ GameThread::GameThread(const PlayerBuilder* white,
 		m_initializer, SLOT(deleteLater()),
 		Qt::QueuedConnection);
 	connect(m_initializer, SIGNAL(destroyed()),
-		this, SLOT(quit()),
+		this, SLOT(onInitializerDestroyed()),
 		Qt::QueuedConnection);
-	m_initializer->moveToThread(this);
+
+	// A thread of its own stops when the initializer is destroyed.
+	// A worker thread keeps running and hosting other games.
+	if (m_worker != nullptr)
+		m_worker->addGame();
+	else
+		connect(this, SIGNAL(finished()), this, SIGNAL(stopped()));
+	m_initializer->moveToThread(host());
 }
 
 GameThread::~GameThread()
 {
 }
 
+QThread* GameThread::host()
+{
+	if (m_worker != nullptr)
+		return m_worker;
+	return this;
+}
+
+bool GameThread::isActive() const
+{
+	if (m_worker != nullptr)
+		return !m_stopped;
+	return isRunning();
+}
+
 bool GameThread::isReady() const
 {
 	return m_ready;
@@ -262,6 +469,7 @@ void GameThread::newGame(ChessGame* game)
 {
 	m_ready = false;
 	m_game = game;
+	m_hostedGame = game;
 	connect(game, SIGNAL(destroyed()),
 		this, SLOT(onGameDestroyed()),
 		Qt::QueuedConnection);
@@ -271,6 +479,13 @@ void GameThread::newGame(ChessGame* game)
 				  Qt::QueuedConnection);
 }
 
+void GameThread::releasePlayers()
+{
+	Q_ASSERT(m_initializer != nullptr);
+	QMetaObject::invokeMethod(m_initializer, "releasePlayers",
+				  Qt::QueuedConnection);
+}
+
 void GameThread::finish()
 {
 	if (m_initializer == nullptr)
@@ -289,10 +504,36 @@ void GameThread::finish()
 
 void GameThread::finishAndDelete()
 {
-	connect(this, SIGNAL(finished()), this, SLOT(deleteLater()));
+	connect(this, SIGNAL(stopped()), this, SLOT(deleteLater()));
 	finish();
 }
 
+void GameThread::stopHosting()
+{
+	if (m_worker == nullptr || !m_worker->isRunning())
+		return;
+
+	QPointer<GameInitializer> initializer(m_hostedInitializer);
+	QPointer<ChessGame> game(m_hostedGame);
+	QObject* context = initializer;
+	if (context == nullptr)
+		context = game;
+	if (context == nullptr)
+		return;
+
+	// The game is handed back to its owner's thread, and the
+	// players are killed when the worker deletes the initializer
+	// on its way out.
+	QThread* target = thread();
+	QMetaObject::invokeMethod(context, [=]()
+	{
+		if (game != nullptr && game->thread() == QThread::currentThread())
+			game->moveToThread(target);
+		if (initializer != nullptr)
+			initializer->deleteLater();
+	}, Qt::BlockingQueuedConnection);
+}
+
 GameInitializer* GameThread::initializer() const
 {
 	return m_initializer;
@@ -313,6 +554,16 @@ GameManager::CleanupMode GameThread::cleanupMode() const
 	return m_cleanupMode;
 }
 
+int GameThread::coreSlot() const
+{
+	return m_coreSlot;
+}
+
+void GameThread::setCoreSlot(int slot)
+{
+	m_coreSlot = slot;
+}
+
 void GameThread::setStartMode(GameManager::StartMode mode)
 {
 	m_startMode = mode;
@@ -329,20 +580,95 @@ void GameThread::onGameDestroyed()
 	emit ready();
 }
 
+void GameThread::onInitializerDestroyed()
+{
+	if (m_worker == nullptr)
+	{
+		quit();
+		return;
+	}
+
+	m_worker->removeGame();
+	m_stopped = true;
+	emit stopped();
+}
+
+
+void GameInitializer::releasePlayers()
+{
+	GameThread* gameThread = m_gameThread;
+	Q_ASSERT(gameThread != nullptr);
+
+	// Hand the players over to the game manager's thread. The
+	// GameThread object lives there, so it can announce them.
+	for (int i = 0; i < 2; i++)
+	{
+		ChessPlayer* player = m_player[i];
+		if (player == nullptr)
+			continue;
+
+		if (m_builder[i]->isHuman()
+		||  player->state() == ChessPlayer::Disconnected)
+		{
+			deletePlayer(i);
+			continue;
+		}
+
+		m_player[i] = nullptr;
+		player->setParent(nullptr);
+		player->moveToThread(gameThread->thread());
+
+		const quint64 builderId = m_builderId[i];
+		QMetaObject::invokeMethod(gameThread, [=]()
+		{
+			emit gameThread->playerReleased(builderId, player);
+		}, Qt::QueuedConnection);
+	}
+	m_playerCount = 0;
+
+	QMetaObject::invokeMethod(gameThread, [=]()
+	{
+		emit gameThread->playersReleased();
+	}, Qt::QueuedConnection);
+}
+
 
 GameManager::GameManager(QObject* parent)
 	: QObject(parent),
 	  m_finishing(false),
+	  m_poolClosed(false),
 	  m_concurrency(1),
-	  m_activeQueuedGameCount(0)
+	  m_activeQueuedGameCount(0),
+	  m_playerPoolLimit(-1),
+	  m_poolHits(0),
+	  m_poolMisses(0),
+	  m_quittingPlayerCount(0),
+	  m_workerCount(0)
 {
 }
 
+GameManager::~GameManager()
+{
+	// Games and players that still live in the workers must be
+	// moved out or destroyed before the workers stop
+	for (GameThread* thread : qAsConst(m_threads))
+	{
+		if (thread != nullptr)
+			thread->stopHosting();
+	}
+	stopWorkers(false);
+}
+
 QList<ChessGame*> GameManager::activeGames() const
 {
 	return m_activeGames;
 }
 
+int GameManager::queuedGameCount() const
+{
+	return m_gameEntries.size();
+}
+
 int GameManager::concurrency() const
 {
 	return m_concurrency;
@@ -353,6 +679,214 @@ void GameManager::setConcurrency(int concurrency)
 	m_concurrency = concurrency;
 }
 
+int GameManager::playerPoolLimit() const
+{
+	if (m_playerPoolLimit < 0)
+		return m_concurrency * 2;
+	return m_playerPoolLimit;
+}
+
+void GameManager::setPlayerPoolLimit(int limit)
+{
+	m_playerPoolLimit = limit;
+	trimPlayerPool(playerPoolLimit());
+}
+
+int GameManager::playerPoolSize() const
+{
+	return m_playerPool.size();
+}
+
+int GameManager::playerPoolHits() const
+{
+	return m_poolHits;
+}
+
+int GameManager::playerPoolMisses() const
+{
+	return m_poolMisses;
+}
+
+int GameManager::workerCount() const
+{
+	return m_workerCount;
+}
+
+void GameManager::setWorkerCount(int count)
+{
+	if (count < 0)
+		count = QThread::idealThreadCount();
+	if (count == m_workerCount)
+		return;
+
+	m_workerCount = count;
+	stopWorkers(true);
+}
+
+QList<GameManager::WorkerLoad> GameManager::workerLoads() const
+{
+	QList<WorkerLoad> loads;
+	for (const GameWorker* worker : m_workers)
+	{
+		loads.append({ worker->gameCount(),
+			       worker->totalGameCount(),
+			       worker->utilization() });
+	}
+
+	return loads;
+}
+
+GameWorker* GameManager::leastLoadedWorker()
+{
+	if (m_workerCount <= 0)
+		return nullptr;
+
+	// Workers that are no longer needed are left alone
+	GameWorker* worker = nullptr;
+	for (int i = 0; i < qMin(m_workerCount, m_workers.size()); i++)
+	{
+		GameWorker* candidate = m_workers.at(i);
+		if (worker == nullptr
+		||  candidate->gameCount() < worker->gameCount())
+			worker = candidate;
+	}
+
+	if (m_workers.size() < m_workerCount
+	&&  (worker == nullptr || worker->gameCount() > 0))
+	{
+		worker = new GameWorker(this);
+		worker->setObjectName(QString("GameWorker %1")
+				      .arg(m_workers.size() + 1));
+		worker->start();
+		m_workers.append(worker);
+	}
+
+	return worker;
+}
+
+void GameManager::stopWorkers(bool idleOnly)
+{
+	for (int i = m_workers.size() - 1; i >= 0; i--)
+	{
+		GameWorker* worker = m_workers.at(i);
+		if (idleOnly && worker->gameCount() > 0)
+			continue;
+
+		worker->quit();
+		worker->wait();
+		delete worker;
+		m_workers.removeAt(i);
+	}
+}
+
+CoreSlots GameManager::coreSlots() const
+{
+	return m_coreSlots;
+}
+
+void GameManager::setCoreSlots(const CoreSlots& map)
+{
+	m_coreSlots = map;
+	m_freeCoreSlots.clear();
+	for (int i = 0; i < map.slotCount(); i++)
+		m_freeCoreSlots.append(i);
+}
+
+void GameManager::releaseCoreSlot(GameThread* thread)
+{
+	int slot = thread->coreSlot();
+	if (slot < 0)
+		return;
+
+	thread->setCoreSlot(-1);
+	if (slot < m_coreSlots.slotCount() && !m_freeCoreSlots.contains(slot))
+		m_freeCoreSlots.append(slot);
+}
+
+ChessPlayer* GameManager::takePooledPlayer(const PlayerBuilder* builder)
+{
+	// Prefer the most recently used player
+	for (int i = m_playerPool.size() - 1; i >= 0; i--)
+	{
+		if (m_playerPool.at(i).builderId != builder->id())
+			continue;
+
+		ChessPlayer* player = m_playerPool.takeAt(i).player;
+		if (player->state() == ChessPlayer::Disconnected)
+		{
+			player->deleteLater();
+			continue;
+		}
+
+		m_poolHits++;
+		return player;
+	}
+
+	m_poolMisses++;
+	return nullptr;
+}
+
+void GameManager::addPooledPlayer(quint64 builderId, ChessPlayer* player)
+{
+	if (m_poolClosed)
+	{
+		quitPlayer(player);
+		return;
+	}
+
+	m_playerPool.append({ builderId, player });
+	trimPlayerPool(playerPoolLimit());
+}
+
+void GameManager::trimPlayerPool(int limit)
+{
+	while (m_playerPool.size() > qMax(limit, 0))
+		quitPlayer(m_playerPool.takeFirst().player);
+}
+
+void GameManager::purgePlayerPool(const PlayerBuilder* builder)
+{
+	Q_ASSERT(builder != nullptr);
+
+	for (int i = m_playerPool.size() - 1; i >= 0; i--)
+	{
+		if (m_playerPool.at(i).builderId == builder->id())
+			quitPlayer(m_playerPool.takeAt(i).player);
+	}
+}
+
+void GameManager::quitPlayer(ChessPlayer* player)
+{
+	if (player->state() == ChessPlayer::Disconnected)
+	{
+		player->deleteLater();
+		return;
+	}
+
+	m_quittingPlayerCount++;
+	connect(player, SIGNAL(disconnected()),
+		this, SLOT(onPooledPlayerQuit()));
+	player->quit();
+}
+
+void GameManager::onPooledPlayerQuit()
+{
+	sender()->deleteLater();
+	m_quittingPlayerCount--;
+	emitFinishedIfDone();
+}
+
+void GameManager::emitFinishedIfDone()
+{
+	if (!m_poolClosed
+	||  !m_threads.isEmpty()
+	||  m_quittingPlayerCount > 0)
+		return;
+
+	m_poolClosed = false;
+	emit finished();
+}
+
 void GameManager::cleanupIdleThreads()
 {
 	QList<GameThread*>::iterator it = m_activeThreads.begin();
@@ -369,17 +903,21 @@ void GameManager::cleanupIdleThreads()
 		else
 			++it;
 	}
+
+	trimPlayerPool(0);
 }
 
 void GameManager::cleanup()
 {
 	m_finishing = false;
+	m_poolClosed = true;
+	trimPlayerPool(0);
 
 	// Remove terminated threads from the list
 	QList< QPointer<GameThread> >::iterator it = m_threads.begin();
 	while (it != m_threads.end())
 	{
-		if (*it == nullptr || !(*it)->isRunning())
+		if (*it == nullptr || !(*it)->isActive())
 			it = m_threads.erase(it);
 		else
 			++it;
@@ -387,14 +925,14 @@ void GameManager::cleanup()
 
 	if (m_threads.isEmpty())
 	{
-		emit finished();
+		emitFinishedIfDone();
 		return;
 	}
 
 	// Terminate running threads
 	for (GameThread* thread : qAsConst(m_threads))
 	{
-		connect(thread, SIGNAL(finished()), this, SLOT(onThreadQuit()),
+		connect(thread, SIGNAL(stopped()), this, SLOT(onThreadQuit()),
 			Qt::QueuedConnection);
 		thread->finish();
 	}
@@ -445,7 +983,7 @@ void GameManager::onThreadQuit()
 	if (m_threads.isEmpty())
 	{
 		m_finishing = false;
-		emit finished();
+		emitFinishedIfDone();
 	}
 }
 
@@ -457,22 +995,32 @@ void GameManager::onThreadReady()
 
 	m_activeGames.removeOne(game);
 	m_threads.removeAll(nullptr);
+	m_activeThreads.removeOne(thread);
 
-	if (thread->cleanupMode() == DeletePlayers)
+	if (thread->cleanupMode() == ReusePlayers)
 	{
-		m_activeThreads.removeOne(thread);
-		thread->finishAndDelete();
+		// The game slot is freed and the game announced destroyed
+		// when the players are in the pool
+		thread->releasePlayers();
+		return;
 	}
 
+	finishGameThread(thread);
+	emit gameDestroyed(game);
+	if (m_finishing && m_activeGames.isEmpty())
+		cleanup();
+}
+
+void GameManager::finishGameThread(GameThread* thread)
+{
+	releaseCoreSlot(thread);
+	thread->finishAndDelete();
+
 	if (thread->startMode() == Enqueue)
 	{
 		m_activeQueuedGameCount--;
 		startQueuedGame();
 	}
-
-	emit gameDestroyed(game);
-	if (m_finishing && m_activeGames.isEmpty())
-		cleanup();
 }
 
 void GameManager::onGameInitialized(bool success)
@@ -485,6 +1033,7 @@ void GameManager::onGameInitialized(bool success)
 	{
 		if (gameThread->startMode() == Enqueue)
 			m_activeQueuedGameCount--;
+		releaseCoreSlot(gameThread);
 
 		m_threads.removeOne(gameThread);
 		m_activeThreads.removeOne(gameThread);
@@ -497,10 +1046,8 @@ void GameManager::onGameInitialized(bool success)
 	}
 
 	m_activeGames << game;
-	if (gameThread->startMode() == Enqueue)
-		cleanupIdleThreads();
 
-	game->moveToThread(gameThread);
+	game->moveToThread(gameThread->host());
 	connect(game, SIGNAL(started(ChessGame*)),
 		this, SIGNAL(gameStarted(ChessGame*)),
 		Qt::QueuedConnection);
@@ -510,25 +1057,25 @@ void GameManager::onGameInitialized(bool success)
 }
 
 GameThread* GameManager::getThread(const PlayerBuilder* white,
-				   const PlayerBuilder* black)
+				   const PlayerBuilder* black,
+				   CleanupMode cleanupMode)
 {
 	Q_ASSERT(white != nullptr);
 	Q_ASSERT(black != nullptr);
 
-	for (GameThread* thread : qAsConst(m_activeThreads))
+	GameThread* gameThread = new GameThread(white, black,
+						leastLoadedWorker(), this);
+	if (cleanupMode == ReusePlayers)
 	{
-		if (!thread->isReady())
-			continue;
-
-		GameInitializer* tmp = thread->initializer();
-		if (tmp->whiteBuilder() == black
-		&&  tmp->blackBuilder() == white)
-			tmp->swapPlayers();
-		if (tmp->whiteBuilder() == white && tmp->blackBuilder() == black)
-			return thread;
+		const PlayerBuilder* builders[2] = { white, black };
+		for (int i = 0; i < 2; i++)
+		{
+			ChessPlayer* player = takePooledPlayer(builders[i]);
+			if (player != nullptr)
+				gameThread->initializer()->setPlayer(i, player);
+		}
 	}
 
-	GameThread* gameThread = new GameThread(white, black, this);
 	m_threads << gameThread;
 	m_activeThreads << gameThread;
 	connect(gameThread, SIGNAL(ready()),
@@ -536,18 +1083,37 @@ GameThread* GameManager::getThread(const PlayerBuilder* white,
 	connect(gameThread, SIGNAL(gameInitialized(bool)),
 		this, SLOT(onGameInitialized(bool)),
 		Qt::QueuedConnection);
-
-	gameThread->start();
+	connect(gameThread, &GameThread::playerReleased,
+		this, &GameManager::addPooledPlayer);
+	connect(gameThread, &GameThread::playersReleased, this, [=]()
+	{
+		ChessGame* game = gameThread->game();
+		finishGameThread(gameThread);
+		emit gameDestroyed(game);
+		if (m_finishing && m_activeGames.isEmpty())
+			cleanup();
+	});
+
+	if (gameThread->host() == gameThread)
+		gameThread->start();
 	return gameThread;
 }
 
 void GameManager::startGame(const GameEntry& entry)
 {
-	GameThread* gameThread = getThread(entry.white, entry.black);
+	GameThread* gameThread = getThread(entry.white, entry.black,
+					   entry.cleanupMode);
 	Q_ASSERT(gameThread != nullptr);
 
 	gameThread->setStartMode(entry.startMode);
 	gameThread->setCleanupMode(entry.cleanupMode);
+
+	if (entry.startMode == Enqueue && !m_freeCoreSlots.isEmpty())
+	{
+		int slot = m_freeCoreSlots.takeFirst();
+		gameThread->setCoreSlot(slot);
+		gameThread->initializer()->setCpus(m_coreSlots.cpus(slot));
+	}
 	gameThread->newGame(entry.game);
 }
 
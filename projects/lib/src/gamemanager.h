@@ -22,10 +22,12 @@
 #include <QObject>
 #include <QList>
 #include <QPointer>
+#include "coreslots.h"
 class ChessGame;
 class ChessPlayer;
 class PlayerBuilder;
 class GameThread;
+class GameWorker;
 
 
 /*!
@@ -35,6 +37,16 @@ class GameThread;
  * multiple games concurrently, and queue games to be
  * run when a game slot/thread is free.
  *
+ * By default each game gets a thread of its own. With a positive
+ * worker count (see setWorkerCount()) the games are hosted by a
+ * fixed pool of worker threads instead, each running one event loop
+ * for many games and their engines.
+ *
+ * Players of games started in \a ReusePlayers mode are returned
+ * to a pool of idle players when the game ends. Any later game
+ * that uses the same PlayerBuilder takes a player from the pool
+ * instead of constructing a new one, regardless of the opponent.
+ *
  * \sa ChessGame, PlayerBuilder
  */
 class LIB_EXPORT GameManager : public QObject
@@ -62,15 +74,37 @@ class LIB_EXPORT GameManager : public QObject
 			 */
 			DeletePlayers,
 			/*!
-			 * The players are left alive after the game is deleted.
-			 * If a new game with the same builder objects is started,
-			 * the players are reused for that game.
+			 * The players are left alive in the player pool after
+			 * the game is deleted. If a new game uses the same
+			 * builder object, the pooled player is reused for that
+			 * game.
 			 */
 			ReusePlayers
 		};
 
+		/*! \brief The load of a worker thread. */
+		struct WorkerLoad
+		{
+			/*! The number of games hosted by the worker. */
+			int games;
+			/*! The total number of games hosted by the worker. */
+			int totalGames;
+			/*!
+			 * The fraction of time that the worker has been busy
+			 * since it was started, from 0 to 1.
+			 */
+			double utilization;
+		};
+
 		/*! Creates a new game manager. */
 		GameManager(QObject* parent = nullptr);
+		/*!
+		 * Stops the worker threads and destroys the game manager.
+		 *
+		 * Games that are still hosted by the workers are moved to
+		 * the game manager's thread, and their players are killed.
+		 */
+		virtual ~GameManager();
 
 		/*!
 		 * Returns the list of active games.
@@ -81,6 +115,8 @@ class LIB_EXPORT GameManager : public QObject
 		 * The game loses its active status only when it's deleted.
 		 */
 		QList<ChessGame*> activeGames() const;
+		/*! Returns the number of games waiting in the queue. */
+		int queuedGameCount() const;
 
 		/*!
 		 * Returns the maximum allowed number of concurrent games.
@@ -98,18 +134,103 @@ class LIB_EXPORT GameManager : public QObject
 		 */
 		void setConcurrency(int concurrency);
 
+		/*!
+		 * Returns the maximum number of idle players kept in
+		 * the player pool.
+		 *
+		 * The default limit is twice the concurrency limit, ie.
+		 * the number of players that the running games can use.
+		 *
+		 * \sa setPlayerPoolLimit()
+		 */
+		int playerPoolLimit() const;
+		/*!
+		 * Sets the player pool limit to \a limit.
+		 *
+		 * When the pool is full, the players that have been idle
+		 * for the longest time are terminated first. A negative
+		 * \a limit restores the default limit.
+		 */
+		void setPlayerPoolLimit(int limit);
+		/*! Returns the number of idle players in the player pool. */
+		int playerPoolSize() const;
+		/*!
+		 * Returns the number of players that were taken from
+		 * the player pool instead of being constructed.
+		 */
+		int playerPoolHits() const;
+		/*!
+		 * Returns the number of players of \a ReusePlayers games
+		 * that had to be constructed because the player pool
+		 * didn't have one.
+		 */
+		int playerPoolMisses() const;
+
+		/*!
+		 * Returns the number of worker threads that host the games,
+		 * or 0 if each game runs in a thread of its own.
+		 *
+		 * \sa setWorkerCount()
+		 */
+		int workerCount() const;
+		/*!
+		 * Sets the number of worker threads to \a count.
+		 *
+		 * If \a count is positive, the games are hosted by a pool of
+		 * \a count threads, and each new game is assigned to the
+		 * worker with the fewest games. A negative \a count creates
+		 * one worker per logical CPU. If \a count is 0 (the default),
+		 * each game gets a thread of its own.
+		 *
+		 * \note The change applies to games started after the call.
+		 * Idle workers are stopped immediately; busy ones when the
+		 * game manager is destroyed.
+		 */
+		void setWorkerCount(int count);
+		/*!
+		 * Returns the load of each worker thread.
+		 *
+		 * A worker whose utilization is close to 1 can't keep up
+		 * with its games, and the games are slowed down by the game
+		 * manager instead of the engines.
+		 */
+		QList<WorkerLoad> workerLoads() const;
+
+		/*! Returns the CPU slot map of queued games. */
+		CoreSlots coreSlots() const;
+		/*!
+		 * Sets the CPU slot map of queued games to \a map.
+		 *
+		 * Each concurrently running queued game gets a slot of its
+		 * own, and the processes of both engines are pinned to the
+		 * slot's CPUs. An empty map (the default) disables pinning.
+		 *
+		 * \note The map should have at least concurrency() slots;
+		 * games that don't get a slot are not pinned.
+		 */
+		void setCoreSlots(const CoreSlots& map);
+
 		/*!
 		 * Cleans up and deletes all idle game threads
 		 *
 		 * This function cleans up and removes all resources used by
 		 * game threads that are waiting for new games. The resources
-		 * include the players and the thread they're living in. The
-		 * PlayerBuilder objects will not be deleted.
+		 * include the players and the thread they're living in, and
+		 * the idle players in the player pool. The PlayerBuilder
+		 * objects will not be deleted.
 		 *
 		 * Generally this function should be called after a tournament
 		 * has ended.
 		 */
 		void cleanupIdleThreads();
+		/*!
+		 * Terminates the idle players of \a builder in the player
+		 * pool.
+		 *
+		 * This function should be called before \a builder is
+		 * deleted or when its players are not needed anymore.
+		 */
+		void purgePlayerPool(const PlayerBuilder* builder);
 
 		/*!
 		 * Adds a new game to the game manager.
@@ -122,9 +243,9 @@ class LIB_EXPORT GameManager : public QObject
 		 * game manager free the game slot used by the game.
 		 *
 		 * Construction of the players is delayed to the moment when the
-		 * game starts. If the same builder objects (\a white and \a black)
-		 * were used in a previous game, the players are reused instead of
-		 * constructing new players.
+		 * game starts. If the player pool has idle players from the
+		 * same builder objects (\a white and \a black), they are reused
+		 * instead of constructing new players.
 		 *
 		 * If \a mode is StartImmediately, the game starts immediately
 		 * even if the number of active games is over the \a concurrency
@@ -187,6 +308,7 @@ class LIB_EXPORT GameManager : public QObject
 		void onThreadReady();
 		void onThreadQuit();
 		void onGameInitialized(bool success);
+		void onPooledPlayerQuit();
 
 	private:
 		struct GameEntry
@@ -198,15 +320,41 @@ class LIB_EXPORT GameManager : public QObject
 			CleanupMode cleanupMode;
 		};
 
+		struct PooledPlayer
+		{
+			quint64 builderId;
+			ChessPlayer* player;
+		};
+
 		GameThread* getThread(const PlayerBuilder* white,
-				      const PlayerBuilder* black);
+				      const PlayerBuilder* black,
+				      CleanupMode cleanupMode);
 		void startGame(const GameEntry& entry);
 		void startQueuedGame();
 		void cleanup();
+		void finishGameThread(GameThread* thread);
+		ChessPlayer* takePooledPlayer(const PlayerBuilder* builder);
+		void addPooledPlayer(quint64 builderId, ChessPlayer* player);
+		void trimPlayerPool(int limit);
+		void quitPlayer(ChessPlayer* player);
+		void emitFinishedIfDone();
+		void releaseCoreSlot(GameThread* thread);
+		GameWorker* leastLoadedWorker();
+		void stopWorkers(bool idleOnly);
 
 		bool m_finishing;
+		bool m_poolClosed;
 		int m_concurrency;
 		int m_activeQueuedGameCount;
+		int m_playerPoolLimit;
+		int m_poolHits;
+		int m_poolMisses;
+		int m_quittingPlayerCount;
+		int m_workerCount;
+		QList<GameWorker*> m_workers;
+		QList<PooledPlayer> m_playerPool;
+		CoreSlots m_coreSlots;
+		QList<int> m_freeCoreSlots;
 		QList< QPointer<GameThread> > m_threads;
 		QList<GameThread*> m_activeThreads;
 		QList<GameEntry> m_gameEntries;
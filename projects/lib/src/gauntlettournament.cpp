@@ -84,3 +84,24 @@ bool GauntletTournament::hasGauntletRatingsOrder() const
 {
 	return true;
 }
+
+QVariant GauntletTournament::pairingState() const
+{
+	QVariantMap map;
+	map["currentPlayer"] = m_currentPlayer;
+	map["opponent"] = m_opponent;
+
+	return map;
+}
+
+bool GauntletTournament::setPairingState(const QVariant& state)
+{
+	const QVariantMap map = state.toMap();
+	if (!map.contains("currentPlayer") || !map.contains("opponent"))
+		return false;
+
+	m_currentPlayer = map.value("currentPlayer").toInt();
+	m_opponent = map.value("opponent").toInt();
+
+	return true;
+}
@@ -46,6 +46,8 @@ class LIB_EXPORT GauntletTournament : public Tournament
 		virtual void initializePairing();
 		virtual int gamesPerCycle() const;
 		virtual TournamentPair* nextPair(int gameNumber);
+		virtual QVariant pairingState() const;
+		virtual bool setPairingState(const QVariant& state);
 		virtual bool hasGauntletRatingsOrder() const;
 
 	private:
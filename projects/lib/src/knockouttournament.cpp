@@ -234,6 +234,51 @@ TournamentPair* KnockoutTournament::nextPair(int gameNumber)
 	return nullptr;
 }
 
+QVariant KnockoutTournament::pairingState() const
+{
+	QVariantList rounds;
+	for (const auto& round : m_rounds)
+	{
+		// Pairs are identified by their players in original order
+		QVariantList pairs;
+		for (const TournamentPair* pair : round)
+		{
+			int player1 = pair->firstPlayer();
+			int player2 = pair->secondPlayer();
+			if (!pair->hasOriginalOrder())
+				std::swap(player1, player2);
+			pairs << QVariant(QVariantList() << player1 << player2);
+		}
+		rounds << QVariant(pairs);
+	}
+
+	return rounds;
+}
+
+bool KnockoutTournament::setPairingState(const QVariant& state)
+{
+	const QVariantList rounds = state.toList();
+	if (rounds.isEmpty())
+		return false;
+
+	m_rounds.clear();
+	for (const QVariant& round : rounds)
+	{
+		QList<TournamentPair*> pairs;
+		const QVariantList list = round.toList();
+		for (const QVariant& players : list)
+		{
+			const QVariantList p = players.toList();
+			if (p.size() != 2)
+				return false;
+			pairs << pair(p.at(0).toInt(), p.at(1).toInt());
+		}
+		m_rounds << pairs;
+	}
+
+	return true;
+}
+
 QString KnockoutTournament::results() const
 {
 	QStringList lines;
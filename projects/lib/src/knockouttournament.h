@@ -47,6 +47,8 @@ class LIB_EXPORT KnockoutTournament : public Tournament
 		virtual void initializePairing();
 		virtual int gamesPerCycle() const;
 		virtual TournamentPair* nextPair(int gameNumber);
+		virtual QVariant pairingState() const;
+		virtual bool setPairingState(const QVariant& state);
 		virtual void addScore(int player, Chess::Side side, int score);
 		virtual bool areAllGamesFinished() const;
 
@@ -0,0 +1,126 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "matchmetrics.h"
+#include "moveevaluation.h"
+#include "board/result.h"
+
+
+MatchMetrics::MatchMetrics()
+{
+	for (auto& counter : m_counters)
+		counter.store(0, std::memory_order_relaxed);
+}
+
+qint64 MatchMetrics::value(Counter counter) const
+{
+	Q_ASSERT(counter >= 0 && counter < CounterCount);
+	return m_counters[counter].load(std::memory_order_relaxed);
+}
+
+QString MatchMetrics::counterName(Counter counter)
+{
+	switch (counter)
+	{
+	case GamesStarted:
+		return "games_started";
+	case GamesFinished:
+		return "games_finished";
+	case Crashes:
+		return "crashes";
+	case Stalls:
+		return "stalls";
+	case TimeForfeits:
+		return "time_forfeits";
+	case Moves:
+		return "moves";
+	case SearchedMoves:
+		return "searched_moves";
+	case Nodes:
+		return "nodes";
+	case SearchTime:
+		return "search_time_ms";
+	case DepthMoves:
+		return "depth_moves";
+	case Depth:
+		return "depth";
+	default:
+		return QString();
+	}
+}
+
+double MatchMetrics::meanNps() const
+{
+	const qint64 time = value(SearchTime);
+	if (time <= 0)
+		return 0.0;
+	return value(Nodes) * 1000.0 / time;
+}
+
+double MatchMetrics::meanDepth() const
+{
+	const qint64 moves = value(DepthMoves);
+	if (moves <= 0)
+		return 0.0;
+	return double(value(Depth)) / moves;
+}
+
+void MatchMetrics::add(Counter counter, qint64 amount)
+{
+	Q_ASSERT(counter >= 0 && counter < CounterCount);
+	m_counters[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void MatchMetrics::addMove(const MoveEvaluation& eval)
+{
+	add(Moves);
+	if (eval.isBookEval())
+		return;
+
+	if (eval.nodeCount() > 0 && eval.time() > 0)
+	{
+		add(SearchedMoves);
+		add(Nodes, qint64(eval.nodeCount()));
+		add(SearchTime, eval.time());
+	}
+	if (eval.depth() > 0)
+	{
+		add(DepthMoves);
+		add(Depth, eval.depth());
+	}
+}
+
+void MatchMetrics::addResult(const Chess::Result& result)
+{
+	add(GamesFinished);
+
+	switch (result.type())
+	{
+	case Chess::Result::Disconnection:
+		add(Crashes);
+		break;
+	case Chess::Result::StalledConnection:
+		add(Stalls);
+		break;
+	case Chess::Result::Timeout:
+		add(TimeForfeits);
+		break;
+	default:
+		break;
+	}
+}
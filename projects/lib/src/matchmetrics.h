@@ -0,0 +1,90 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATCHMETRICS_H
+#define MATCHMETRICS_H
+
+#include <QString>
+#include <atomic>
+class MoveEvaluation;
+namespace Chess { class Result; }
+
+
+/*!
+ * \brief Live counters of a match
+ *
+ * MatchMetrics keeps cumulative counters of the games and moves of a
+ * tournament. The counters are relaxed atomic integers, so the game
+ * threads can update them without locking and any thread can read
+ * them at any time. Each counter is consistent on its own, but a set
+ * of values read one by one isn't an atomic snapshot.
+ *
+ * \sa Tournament::metrics()
+ */
+class LIB_EXPORT MatchMetrics
+{
+	public:
+		/*! The counters. */
+		enum Counter
+		{
+			GamesStarted,	//!< Games started
+			GamesFinished,	//!< Games finished
+			Crashes,	//!< Games lost by an engine crash
+			Stalls,		//!< Games lost by a stalled connection
+			TimeForfeits,	//!< Games lost on time
+			Moves,		//!< Moves made
+			SearchedMoves,	//!< Moves with a node count and time
+			Nodes,		//!< Nodes searched in SearchedMoves
+			SearchTime,	//!< Milliseconds spent in SearchedMoves
+			DepthMoves,	//!< Moves with a search depth
+			Depth,		//!< Total search depth of DepthMoves
+			CounterCount
+		};
+
+		/*! Creates a new object with all counters at zero. */
+		MatchMetrics();
+
+		/*! Returns the value of \a counter. */
+		qint64 value(Counter counter) const;
+		/*! Returns a short snake_case name for \a counter. */
+		static QString counterName(Counter counter);
+		/*!
+		 * Returns the mean nodes per second of the searched moves,
+		 * or 0 if there are none.
+		 */
+		double meanNps() const;
+		/*!
+		 * Returns the mean search depth of the moves, or 0 if
+		 * there are none.
+		 */
+		double meanDepth() const;
+
+		/*! Adds \a amount to \a counter. */
+		void add(Counter counter, qint64 amount = 1);
+		/*! Adds a move with evaluation \a eval. */
+		void addMove(const MoveEvaluation& eval);
+		/*! Adds a finished game with result \a result. */
+		void addResult(const Chess::Result& result);
+
+	private:
+		Q_DISABLE_COPY(MatchMetrics)
+
+		std::atomic<qint64> m_counters[CounterCount];
+};
+
+#endif // MATCHMETRICS_H
@@ -22,6 +22,7 @@
 namespace {
 
 int s_index = 0;
+quint32 s_seed = 0;
 quint32 s_mt[624];
 
 void generateNumbers()
@@ -40,12 +41,18 @@ void generateNumbers()
 
 void Mersenne::initialize(quint32 seed)
 {
+	s_seed = seed;
 	s_mt[0] = seed;
 
 	for (int i = 1; i < 624; i++)
 		s_mt[i] = (0x6C078965 * (s_mt[i - 1] ^ (s_mt[i - 1] >> 30)) + i) & 0xFFFFFFFF;
 }
 
+quint32 Mersenne::seed()
+{
+	return s_seed;
+}
+
 quint32 Mersenne::random()
 {
 	static QMutex mutex;
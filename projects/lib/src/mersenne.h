@@ -34,6 +34,8 @@ class LIB_EXPORT Mersenne
 	public:
 		/*! Initializes the PRNG with \a seed. */
 		static void initialize(quint32 seed);
+		/*! Returns the seed that the PRNG was last initialized with. */
+		static quint32 seed();
 		/*!
 		 * Returns a pseudorandom number between 0 and 0xFFFFFFFF -1.
 		 *
@@ -17,6 +17,23 @@
 */
 
 #include "moveevaluation.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include "pvconverter.h"
+
+/*!
+ * A PV waiting for SAN conversion. It's shared by the copies of an
+ * evaluation, which may live in different threads, so the conversion
+ * is guarded by a mutex.
+ */
+struct MoveEvaluation::LazyPv
+{
+	QMutex mutex;
+	QSharedPointer<PvConverter> converter;
+	QString startFen;
+	QString moves;
+	QString san;
+};
 
 MoveEvaluation::MoveEvaluation()
 	: m_isBookEval(false),
@@ -182,7 +199,23 @@ QString MoveEvaluation::ponderMove() const
 
 QString MoveEvaluation::pv() const
 {
-	return m_pv;
+	if (m_lazyPv.isNull())
+		return m_pv;
+
+	QMutexLocker locker(&m_lazyPv->mutex);
+	if (m_lazyPv->converter)
+	{
+		m_lazyPv->san = m_lazyPv->converter->sanPv(m_lazyPv->startFen,
+							   m_lazyPv->moves,
+							   m_lanPv);
+		m_lazyPv->converter.clear();
+	}
+	return m_lazyPv->san;
+}
+
+QString MoveEvaluation::lanPv() const
+{
+	return m_lanPv;
 }
 
 int MoveEvaluation::pvNumber() const
@@ -204,6 +237,8 @@ void MoveEvaluation::clear()
 	m_hashUsage = 0;
 	m_ponderhitRate = 0;
 	m_pv.clear();
+	m_lanPv.clear();
+	m_lazyPv.clear();
 	m_ponderMove.clear();
 }
 
@@ -270,6 +305,21 @@ void MoveEvaluation::setPonderMove(const QString& san)
 void MoveEvaluation::setPv(const QString& pv)
 {
 	m_pv = pv;
+	m_lanPv.clear();
+	m_lazyPv.clear();
+}
+
+void MoveEvaluation::setLanPv(const QString& pv,
+			      const QSharedPointer<PvConverter>& converter,
+			      const QString& startFen,
+			      const QString& moves)
+{
+	m_pv.clear();
+	m_lanPv = pv;
+	m_lazyPv.reset(new LazyPv);
+	m_lazyPv->converter = converter;
+	m_lazyPv->startFen = startFen;
+	m_lazyPv->moves = moves;
 }
 
 void MoveEvaluation::setPvNumber(int number)
@@ -296,8 +346,12 @@ void MoveEvaluation::merge(const MoveEvaluation& other)
 		m_ponderhitRate = other.m_ponderhitRate;
 	if (!other.m_ponderMove.isEmpty())
 		m_ponderMove = other.m_ponderMove;
-	if (!other.m_pv.isEmpty())
+	if (!other.m_pv.isEmpty() || !other.m_lanPv.isEmpty())
+	{
 		m_pv = other.m_pv;
+		m_lanPv = other.m_lanPv;
+		m_lazyPv = other.m_lazyPv;
+	}
 	if (other.m_pvNumber)
 		m_pvNumber = other.m_pvNumber;
 	if (other.m_score != NULL_SCORE)
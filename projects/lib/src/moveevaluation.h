@@ -21,6 +21,8 @@
 
 #include <QString>
 #include <QMetaType>
+#include <QSharedPointer>
+class PvConverter;
 
 /*!
  * \brief Evaluation data for a chess move.
@@ -124,10 +126,22 @@ class LIB_EXPORT MoveEvaluation
 		 * The principal variation.
 		 * This is a sequence of moves that an engine
 		 * expects to be played next.
+		 *
+		 * If the PV was set with setLanPv(), it's converted into
+		 * SAN when this function is called the first time. Copies
+		 * of the evaluation share the conversion, and it's safe to
+		 * call this function from several threads.
+		 *
 		 * \note For human players this is always empty.
 		 */
 		QString pv() const;
 
+		/*!
+		 * The principal variation in long algebraic notation.
+		 * \note This is empty unless the PV was set with setLanPv().
+		 */
+		QString lanPv() const;
+
 		/*!
 		 * Returns the principal variation number (default 0).
 		 * \note For human players this is always 0.
@@ -177,6 +191,19 @@ class LIB_EXPORT MoveEvaluation
 		/*! Sets the principal variation to \a pv. */
 		void setPv(const QString& pv);
 
+		/*!
+		 * Sets the principal variation to \a pv, a space-separated
+		 * list of moves in long algebraic notation.
+		 *
+		 * The PV starts from the position reached by playing
+		 * \a moves from \a startFen. It's converted into SAN by
+		 * \a converter only if pv() is called.
+		 */
+		void setLanPv(const QString& pv,
+			      const QSharedPointer<PvConverter>& converter,
+			      const QString& startFen,
+			      const QString& moves);
+
 		/*! Sets the principal variation number to \a number. */
 		void setPvNumber(int number);
 
@@ -184,6 +211,8 @@ class LIB_EXPORT MoveEvaluation
 		void merge(const MoveEvaluation& other);
 
 	private:
+		struct LazyPv;
+
 		bool m_isBookEval;
 		bool m_isTrusted;
 		int m_depth;
@@ -197,6 +226,8 @@ class LIB_EXPORT MoveEvaluation
 		quint64 m_nps;
 		quint64 m_tbHits;
 		QString m_pv;
+		QString m_lanPv;
+		QSharedPointer<LazyPv> m_lazyPv;
 		QString m_ponderMove;
 };
 
@@ -0,0 +1,222 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "movelatency.h"
+#include <QtAlgorithms>
+#include <QDeadlineTimer>
+#include <cmath>
+
+
+LatencyHistogram::LatencyHistogram()
+	: m_count(0),
+	  m_sum(0),
+	  m_min(0),
+	  m_max(0)
+{
+}
+
+bool LatencyHistogram::isEmpty() const
+{
+	return m_count == 0;
+}
+
+quint64 LatencyHistogram::count() const
+{
+	return m_count;
+}
+
+qint64 LatencyHistogram::min() const
+{
+	return m_min;
+}
+
+qint64 LatencyHistogram::max() const
+{
+	return m_max;
+}
+
+qint64 LatencyHistogram::sum() const
+{
+	return m_sum;
+}
+
+qint64 LatencyHistogram::mean() const
+{
+	if (m_count == 0)
+		return 0;
+	return m_sum / qint64(m_count);
+}
+
+qint64 LatencyHistogram::percentile(double percent) const
+{
+	if (m_count == 0)
+		return 0;
+
+	quint64 rank = quint64(std::ceil(percent / 100.0 * m_count));
+	rank = qBound(quint64(1), rank, m_count);
+
+	quint64 total = 0;
+	for (int i = 0; i < m_buckets.size(); i++)
+	{
+		total += m_buckets.at(i);
+		if (total >= rank)
+			return qBound(m_min, bucketLimit(i), m_max);
+	}
+
+	return m_max;
+}
+
+void LatencyHistogram::add(qint64 nsecs)
+{
+	nsecs = qMax(nsecs, qint64(0));
+
+	const int i = bucket(nsecs);
+	if (i >= m_buckets.size())
+		m_buckets.resize(i + 1);
+	m_buckets[i]++;
+
+	if (m_count == 0 || nsecs < m_min)
+		m_min = nsecs;
+	if (m_count == 0 || nsecs > m_max)
+		m_max = nsecs;
+	m_count++;
+	m_sum += nsecs;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+	if (other.m_count == 0)
+		return;
+
+	if (m_buckets.size() < other.m_buckets.size())
+		m_buckets.resize(other.m_buckets.size());
+	for (int i = 0; i < other.m_buckets.size(); i++)
+		m_buckets[i] += other.m_buckets.at(i);
+
+	if (m_count == 0 || other.m_min < m_min)
+		m_min = other.m_min;
+	if (m_count == 0 || other.m_max > m_max)
+		m_max = other.m_max;
+	m_count += other.m_count;
+	m_sum += other.m_sum;
+}
+
+void LatencyHistogram::clear()
+{
+	m_buckets.clear();
+	m_count = 0;
+	m_sum = 0;
+	m_min = 0;
+	m_max = 0;
+}
+
+int LatencyHistogram::bucket(qint64 nsecs)
+{
+	// Values below 4 get a bucket each, larger values are split by
+	// their highest bit and the two bits below it
+	if (nsecs < 4)
+		return int(nsecs);
+
+	const int msb = 63 - qCountLeadingZeroBits(quint64(nsecs));
+	const int sub = int(nsecs >> (msb - 2)) & 3;
+	return (msb - 1) * 4 + sub;
+}
+
+qint64 LatencyHistogram::bucketLimit(int bucket)
+{
+	if (bucket < 4)
+		return bucket;
+
+	const int msb = bucket / 4 + 1;
+	const int sub = bucket % 4;
+	return (qint64(5 + sub) << (msb - 2)) - 1;
+}
+
+
+bool MoveLatency::Timestamps::isValid() const
+{
+	return clockStarted > 0
+	    && goSent >= clockStarted
+	    && moveReceived >= goSent
+	    && moveParsed >= moveReceived
+	    && opponentNotified >= moveParsed;
+}
+
+qint64 MoveLatency::timestamp()
+{
+	return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+QString MoveLatency::stageName(Stage stage)
+{
+	switch (stage)
+	{
+	case GoStage:
+		return "go";
+	case ThinkStage:
+		return "think";
+	case ReadStage:
+		return "read";
+	case NotifyStage:
+		return "notify";
+	case ClockOverhead:
+		return "overhead";
+	default:
+		return QString();
+	}
+}
+
+MoveLatency::MoveLatency()
+{
+}
+
+quint64 MoveLatency::count() const
+{
+	return m_histograms[ThinkStage].count();
+}
+
+const LatencyHistogram& MoveLatency::histogram(Stage stage) const
+{
+	Q_ASSERT(stage >= 0 && stage < StageCount);
+	return m_histograms[stage];
+}
+
+void MoveLatency::add(const Timestamps& times)
+{
+	Q_ASSERT(times.isValid());
+
+	const qint64 go = times.goSent - times.clockStarted;
+	const qint64 read = times.moveParsed - times.moveReceived;
+	m_histograms[GoStage].add(go);
+	m_histograms[ThinkStage].add(times.moveReceived - times.goSent);
+	m_histograms[ReadStage].add(read);
+	m_histograms[NotifyStage].add(times.opponentNotified - times.moveParsed);
+	m_histograms[ClockOverhead].add(go + read);
+}
+
+void MoveLatency::merge(const MoveLatency& other)
+{
+	for (int i = 0; i < StageCount; i++)
+		m_histograms[i].merge(other.m_histograms[i]);
+}
+
+void MoveLatency::clear()
+{
+	for (int i = 0; i < StageCount; i++)
+		m_histograms[i].clear();
+}
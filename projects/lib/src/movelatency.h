@@ -0,0 +1,153 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MOVELATENCY_H
+#define MOVELATENCY_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QString>
+
+
+/*!
+ * \brief A histogram of latencies in nanoseconds.
+ *
+ * The buckets grow exponentially with four buckets per power of two,
+ * so a percentile is accurate to within 19% regardless of its
+ * magnitude, and adding a value is a constant-time operation.
+ */
+class LIB_EXPORT LatencyHistogram
+{
+	public:
+		/*! Creates an empty histogram. */
+		LatencyHistogram();
+
+		/*! Returns true if the histogram has no values. */
+		bool isEmpty() const;
+		/*! Returns the number of values in the histogram. */
+		quint64 count() const;
+		/*! Returns the smallest value, or 0 if the histogram is empty. */
+		qint64 min() const;
+		/*! Returns the largest value, or 0 if the histogram is empty. */
+		qint64 max() const;
+		/*! Returns the sum of the values. */
+		qint64 sum() const;
+		/*! Returns the mean value, or 0 if the histogram is empty. */
+		qint64 mean() const;
+		/*!
+		 * Returns the approximate value below which \a percent
+		 * percent of the values fall.
+		 */
+		qint64 percentile(double percent) const;
+
+		/*! Adds \a nsecs to the histogram. Negative values count as 0. */
+		void add(qint64 nsecs);
+		/*! Adds the values of \a other to the histogram. */
+		void merge(const LatencyHistogram& other);
+		/*! Removes all values from the histogram. */
+		void clear();
+
+	private:
+		static int bucket(qint64 nsecs);
+		static qint64 bucketLimit(int bucket);
+
+		QVector<quint32> m_buckets;
+		quint64 m_count;
+		qint64 m_sum;
+		qint64 m_min;
+		qint64 m_max;
+};
+
+/*!
+ * \brief Per-move latencies of a chess player.
+ *
+ * A move goes through several stages between the start of the
+ * player's clock and the opponent receiving the move. Only the
+ * \a ThinkStage is spent by the player itself; the other stages are
+ * protocol and game overhead.
+ *
+ * \sa ChessPlayer::moveTimestamps()
+ */
+class LIB_EXPORT MoveLatency
+{
+	public:
+		/*! The stages of a move. */
+		enum Stage
+		{
+			/*! From the start of the clock to sending "go". */
+			GoStage,
+			/*! From sending "go" to receiving the move. */
+			ThinkStage,
+			/*!
+			 * From the first byte of the move to the move
+			 * being parsed.
+			 */
+			ReadStage,
+			/*! From the parsed move to notifying the opponent. */
+			NotifyStage,
+			/*!
+			 * The overhead charged to the player's clock, ie.
+			 * the sum of \a GoStage and \a ReadStage.
+			 */
+			ClockOverhead,
+			StageCount
+		};
+
+		/*! Monotonic timestamps of a move in nanoseconds. */
+		struct Timestamps
+		{
+			/*! The player's clock was started. */
+			qint64 clockStarted = 0;
+			/*! The "go" command was sent to the player. */
+			qint64 goSent = 0;
+			/*! The first byte of the move was received. */
+			qint64 moveReceived = 0;
+			/*! The move was parsed. */
+			qint64 moveParsed = 0;
+			/*! The move was sent to the opponent. */
+			qint64 opponentNotified = 0;
+
+			/*! Returns true if all the timestamps are set. */
+			bool isValid() const;
+		};
+
+		/*! Returns the current monotonic time in nanoseconds. */
+		static qint64 timestamp();
+		/*! Returns a short name for \a stage. */
+		static QString stageName(Stage stage);
+
+		/*! Creates an empty MoveLatency object. */
+		MoveLatency();
+
+		/*! Returns the number of moves. */
+		quint64 count() const;
+		/*! Returns the histogram of \a stage. */
+		const LatencyHistogram& histogram(Stage stage) const;
+
+		/*! Adds a move with timestamps \a times. */
+		void add(const Timestamps& times);
+		/*! Adds the moves of \a other. */
+		void merge(const MoveLatency& other);
+		/*! Removes all moves. */
+		void clear();
+
+	private:
+		LatencyHistogram m_histograms[StageCount];
+};
+
+#endif // MOVELATENCY_H
@@ -48,7 +48,9 @@ QDataStream& operator<<(QDataStream& out, const OpeningBook* book)
 }
 
 OpeningBook::OpeningBook(AccessMode mode)
-	: m_mode(mode)
+	: m_mode(mode),
+	  m_mapData(nullptr),
+	  m_mapSize(0)
 {
 }
 
@@ -72,6 +74,8 @@ bool OpeningBook::read(const QString& filename)
 
 	if (m_mode == Disk)
 		return true;
+	if (m_mode == Mapped)
+		return mapFile(filename);
 
 	m_map.clear();
 	QDataStream in(&file);
@@ -218,15 +222,129 @@ QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
 	return entries;
 }
 
+bool OpeningBook::mapFile(const QString& filename)
+{
+	m_mapFile.clear();
+	m_mapData = nullptr;
+	m_mapSize = 0;
+
+	// The file must stay open for as long as it's mapped
+	QSharedPointer<QFile> file(new QFile(filename));
+	if (!file->open(QIODevice::ReadOnly) || file->size() == 0)
+		return false;
+
+	const uchar* data = file->map(0, file->size());
+	if (data == nullptr)
+	{
+		qWarning("Can't map opening book %s: %s",
+			 qUtf8Printable(filename),
+			 qUtf8Printable(file->errorString()));
+		return false;
+	}
+
+	m_mapSize = file->size();
+	m_mapData = data;
+	m_mapFile = file;
+
+	return true;
+}
+
+qint64 OpeningBook::lowerBound(quint64 key) const
+{
+	const int step = entrySize();
+	qint64 first = 0;
+	qint64 count = m_mapSize / step;
+
+	// Binary search for the first entry that isn't less than key
+	while (count > 0)
+	{
+		qint64 half = count / 2;
+		qint64 middle = first + half;
+		quint64 entryKey = 0;
+		entryFromData(m_mapData + middle * step, &entryKey);
+		if (entryKey < key)
+		{
+			first = middle + 1;
+			count -= half + 1;
+		}
+		else
+			count = half;
+	}
+
+	return first;
+}
+
+QList<OpeningBook::Entry> OpeningBook::entriesFromMap(quint64 key) const
+{
+	QList<Entry> entries;
+	if (m_mapData == nullptr)
+		return entries;
+
+	const int step = entrySize();
+	const qint64 n = m_mapSize / step;
+	for (qint64 i = lowerBound(key); i < n; i++)
+	{
+		quint64 entryKey = 0;
+		Entry entry = entryFromData(m_mapData + i * step, &entryKey);
+		if (entryKey != key)
+			break;
+		entries << entry;
+	}
+
+	return entries;
+}
+
+Chess::GenericMove OpeningBook::moveFromMap(quint64 key) const
+{
+	Chess::GenericMove move;
+	if (m_mapData == nullptr)
+		return move;
+
+	// Same as move() but without collecting the entries into a list
+	const int step = entrySize();
+	const qint64 n = m_mapSize / step;
+	const qint64 first = lowerBound(key);
+	qint64 last = first;
+	int totalWeight = 0;
+	for (; last < n; last++)
+	{
+		quint64 entryKey = 0;
+		Entry entry = entryFromData(m_mapData + last * step, &entryKey);
+		if (entryKey != key)
+			break;
+		totalWeight += entry.weight;
+	}
+	if (totalWeight <= 0)
+		return move;
+
+	int pick = Mersenne::random() % totalWeight;
+	int currentWeight = 0;
+	for (qint64 i = first; i < last; i++)
+	{
+		quint64 entryKey = 0;
+		Entry entry = entryFromData(m_mapData + i * step, &entryKey);
+		currentWeight += entry.weight;
+		if (currentWeight > pick)
+			return entry.move;
+	}
+
+	return move;
+}
+
 QList<OpeningBook::Entry> OpeningBook::entries(quint64 key) const
 {
 	if (m_mode == Ram)
 		return m_map.values(key);
+	if (m_mode == Mapped)
+		return entriesFromMap(key);
 	return entriesFromDisk(key);
 }
 
 Chess::GenericMove OpeningBook::move(quint64 key) const
 {
+	if (m_mode == Mapped)
+		return moveFromMap(key);
+
 	Chess::GenericMove move;
 	
 	// There can be multiple entries/moves with the same key.
@@ -21,9 +21,11 @@
 
 #include <QtGlobal>
 #include <QMultiMap>
+#include <QSharedPointer>
 #include "board/genericmove.h"
 
 class QString;
+class QFile;
 class QDataStream;
 class PgnGame;
 class PgnStream;
@@ -39,6 +41,10 @@ class PgnStream;
  * The opening book can be stored externally in a binary file. When it's needed,
  * it is loaded in memory, and positions can be found quickly by searching
  * the book for Zobrist keys that match the current board position.
+ *
+ * In \a Mapped mode the sorted book file is memory-mapped and probed in
+ * place. The mapping is read-only, so the pages are shared by all the
+ * processes that use the same book.
  */
 class LIB_EXPORT OpeningBook
 {
@@ -47,7 +53,8 @@ class LIB_EXPORT OpeningBook
 		enum AccessMode
 		{
 			Ram,	//!< Load the entire book to RAM
-			Disk	//!< Read moves directly from disk
+			Disk,	//!< Read moves directly from disk
+			Mapped	//!< Memory-map the book file
 		};
 
 		/*!
@@ -144,6 +151,15 @@ class LIB_EXPORT OpeningBook
 		 * belongs to the entry.
 		 */
 		virtual Entry readEntry(QDataStream& in, quint64* key) const = 0;
+		/*!
+		 * Reads a book entry from \a data and returns it.
+		 *
+		 * \a data points to entrySize() bytes of a book file. The
+		 * implementation must set \a key to the hash that belongs
+		 * to the entry.
+		 */
+		virtual Entry entryFromData(const uchar* data,
+					    quint64* key) const = 0;
 		
 		/*! Writes the key and entry pointed to by \a it, to \a out. */
 		virtual void writeEntry(const Map::const_iterator& it,
@@ -151,10 +167,17 @@ class LIB_EXPORT OpeningBook
 
 	private:
 		QList<Entry> entriesFromDisk(quint64 key) const;
+		QList<Entry> entriesFromMap(quint64 key) const;
+		Chess::GenericMove moveFromMap(quint64 key) const;
+		qint64 lowerBound(quint64 key) const;
+		bool mapFile(const QString& filename);
 
 		AccessMode m_mode;
 		QString m_filename;
 		Map m_map;
+		QSharedPointer<QFile> m_mapFile;
+		const uchar* m_mapData;
+		qint64 m_mapSize;
 };
 
 /*!
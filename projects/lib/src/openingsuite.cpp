@@ -18,11 +18,19 @@
 
 #include "openingsuite.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QScopedPointer>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
 #include <QTextStream>
+#include <QThread>
 #include <algorithm>
 #include "pgnstream.h"
 #include "epdrecord.h"
 #include "mersenne.h"
+#include "compressiondevice.h"
 
 OpeningSuite::OpeningSuite(const QString& fen)
 	: m_format(EpdFormat),
@@ -33,7 +41,8 @@ OpeningSuite::OpeningSuite(const QString& fen)
 	  m_fen(fen),
 	  m_file(nullptr),
 	  m_epdStream(nullptr),
-	  m_pgnStream(nullptr)
+	  m_pgnStream(nullptr),
+	  m_indexThread(nullptr)
 {
 }
 
@@ -49,12 +58,15 @@ OpeningSuite::OpeningSuite(const QString& fileName,
 	  m_fileName(fileName),
 	  m_file(nullptr),
 	  m_epdStream(nullptr),
-	  m_pgnStream(nullptr)
+	  m_pgnStream(nullptr),
+	  m_indexThread(nullptr)
 {
 }
 
 OpeningSuite::~OpeningSuite()
 {
+	stopIndexing();
+
 	if (m_epdStream != nullptr)
 	{
 		delete m_epdStream->device();
@@ -87,6 +99,7 @@ bool OpeningSuite::initialize()
 	if (!m_fen.isEmpty())
 		return true;
 
+	stopIndexing();
 	m_gamesRead = 0;
 	m_gameIndex = 0;
 	m_filePositions.clear();
@@ -104,15 +117,27 @@ bool OpeningSuite::initialize()
 		m_pgnStream = nullptr;
 	}
 
-	m_file = new QFile(m_fileName);
-	if (!m_file->open(QIODevice::ReadOnly | QIODevice::Text))
+	m_file = CompressionDevice::openFile(m_fileName,
+					     QIODevice::ReadOnly | QIODevice::Text);
+	if (m_file == nullptr)
 	{
 		qWarning("Can't open opening suite %s",
 			 qUtf8Printable(m_fileName));
-		delete m_file;
 		return false;
 	}
 
+	// Seeking backwards in a compressed file means decompressing
+	// it again, so a randomly ordered suite is kept in memory.
+	if (m_order == RandomOrder
+	&&  qobject_cast<CompressionDevice*>(m_file) != nullptr)
+	{
+		QBuffer* buffer = new QBuffer;
+		buffer->setData(m_file->readAll());
+		buffer->open(QIODevice::ReadOnly | QIODevice::Text);
+		delete m_file;
+		m_file = buffer;
+	}
+
 	if (m_format == EpdFormat)
 	{
 		m_file->reset();
@@ -124,20 +149,14 @@ bool OpeningSuite::initialize()
 	if (m_order == RandomOrder)
 	{
 		// Create a vector of file positions
-		for (;;)
+		if (!readIndex(m_fileName, m_format, m_filePositions))
 		{
-			FilePosition pos;
-			if (m_format == EpdFormat)
-				pos = getEpdPos();
-			else if (m_format == PgnFormat)
-				pos = getPgnPos();
-			else
-				return false; // should be unreachable
-
-			if (pos.pos == -1)
-				break;
-
-			m_filePositions.append(pos);
+			QFileInfo info(m_fileName);
+			qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+			if (!scanFile(m_fileName, m_format, m_filePositions))
+				return false;
+			writeIndex(m_fileName, m_format, m_filePositions,
+				   info.size(), lastModified);
 		}
 
 		// use a Knuth shuffle to generate a random permutation
@@ -154,12 +173,41 @@ bool OpeningSuite::initialize()
 	}
 	else if (m_order == SequentialOrder)
 	{
+		QVector<FilePosition> positions;
+		if (!readIndex(m_fileName, m_format, positions))
+		{
+			// Let the first games start while the index is built
+			const QString fileName(m_fileName);
+			const Format format(m_format);
+			m_indexThread = QThread::create([=]()
+			{
+				buildIndex(fileName, format);
+			});
+			m_indexThread->start(QThread::LowPriority);
+		}
+		else if (m_startIndex > 0 && !positions.isEmpty())
+		{
+			if (m_startIndex >= positions.size())
+				qWarning("Start index larger than book size, wrapping after %d.", positions.size());
+
+			const FilePosition& pos = positions.at(m_startIndex % positions.size());
+			if (m_format == EpdFormat)
+			{
+				m_epdStream->seek(pos.pos);
+				m_epdStream->resetStatus();
+			}
+			else if (m_format == PgnFormat)
+				m_pgnStream->seek(pos.pos, pos.lineNumber);
+
+			return true;
+		}
+
 		for (int i = 0; i < m_startIndex; i++)
 		{
 			FilePosition pos;
 			if (m_format == EpdFormat)
 			{
-				pos = getEpdPos();
+				pos = getEpdPos(m_file);
 				if (m_epdStream->atEnd())
 				{
 					qWarning("Start index larger than book size, wrapping after %d.", i + 1);
@@ -169,7 +217,7 @@ bool OpeningSuite::initialize()
 			}
 			else if (m_format == PgnFormat)
 			{
-				pos = getPgnPos();
+				pos = getPgnPos(m_pgnStream);
 				if (!m_pgnStream->nextGame())
 				{
 					qWarning("Start index larger than book size, wrapping after %d.", i + 1);
@@ -247,20 +295,70 @@ PgnGame OpeningSuite::nextGame(int maxPlies)
 	return game;
 }
 
-OpeningSuite::FilePosition OpeningSuite::getPgnPos()
+QVariant OpeningSuite::position() const
+{
+	QVariantMap map;
+	if (isNull())
+		return map;
+
+	map["gamesRead"] = m_gamesRead;
+	if (m_order == RandomOrder)
+		map["gameIndex"] = m_gameIndex;
+	else if (m_format == EpdFormat)
+		map["pos"] = m_epdStream->pos();
+	else if (m_format == PgnFormat)
+	{
+		map["pos"] = m_pgnStream->pos();
+		map["lineNumber"] = m_pgnStream->lineNumber();
+	}
+
+	return map;
+}
+
+bool OpeningSuite::setPosition(const QVariant& position)
+{
+	const QVariantMap map = position.toMap();
+	if (isNull())
+		return map.isEmpty();
+
+	bool ok = false;
+	m_gamesRead = map.value("gamesRead").toInt();
+	if (m_order == RandomOrder)
+	{
+		int index = map.value("gameIndex").toInt(&ok);
+		ok = ok && index >= 0 && index < m_filePositions.size();
+		if (ok)
+			m_gameIndex = index;
+	}
+	else
+	{
+		qint64 pos = map.value("pos").toLongLong(&ok);
+		if (ok && m_format == EpdFormat)
+		{
+			ok = m_epdStream->seek(pos);
+			m_epdStream->resetStatus();
+		}
+		else if (ok && m_format == PgnFormat)
+			ok = m_pgnStream->seek(pos, map.value("lineNumber").toLongLong());
+	}
+
+	return ok;
+}
+
+OpeningSuite::FilePosition OpeningSuite::getPgnPos(PgnStream* stream)
 {
 	FilePosition pos = { -1, -1 };
-	if (!m_pgnStream->nextGame())
+	if (!stream->nextGame())
 		return pos;
 
-	pos.pos = m_pgnStream->pos();
-	pos.lineNumber = m_pgnStream->lineNumber();
+	pos.pos = stream->pos();
+	pos.lineNumber = stream->lineNumber();
 
 	char c;
 	bool inTag = false;
 	bool inQuotes = false;
 
-	while ((c = m_pgnStream->readChar()) != 0)
+	while ((c = stream->readChar()) != 0)
 	{
 		if (!inTag)
 		{
@@ -268,7 +366,7 @@ OpeningSuite::FilePosition OpeningSuite::getPgnPos()
 				inTag = true;
 			else if (!isspace(c))
 			{
-				m_pgnStream->rewindChar();
+				stream->rewindChar();
 				break;
 			}
 
@@ -287,20 +385,161 @@ OpeningSuite::FilePosition OpeningSuite::getPgnPos()
 	return pos;
 }
 
-OpeningSuite::FilePosition OpeningSuite::getEpdPos()
+OpeningSuite::FilePosition OpeningSuite::getEpdPos(QIODevice* device)
 {
-	FilePosition pos = { m_file->pos(), -1 };
+	FilePosition pos = { device->pos(), -1 };
 
-	while (m_file->readLine().isEmpty())
+	while (device->readLine().isEmpty())
 	{
-		if (m_file->atEnd())
+		if (device->atEnd())
 		{
 			pos.pos = -1;
 			break;
 		}
 		else
-			pos.pos = m_file->pos();
+			pos.pos = device->pos();
 	}
 
 	return pos;
 }
+
+bool OpeningSuite::scanFile(const QString& fileName,
+			    Format format,
+			    QVector<FilePosition>& positions)
+{
+	positions.clear();
+
+	// Use the same open mode and stream as initialize() so that
+	// the file positions are valid for the suite's own streams.
+	QScopedPointer<QIODevice> file(CompressionDevice::openFile(fileName,
+		QIODevice::ReadOnly | QIODevice::Text));
+	if (!file)
+		return false;
+
+	PgnStream pgnStream;
+	if (format == PgnFormat)
+		pgnStream.setDevice(file.data());
+
+	QThread* thread = QThread::currentThread();
+	for (;;)
+	{
+		if (thread->isInterruptionRequested())
+			return false;
+
+		FilePosition pos;
+		if (format == EpdFormat)
+			pos = getEpdPos(file.data());
+		else if (format == PgnFormat)
+			pos = getPgnPos(&pgnStream);
+		else
+			return false; // should be unreachable
+
+		if (pos.pos == -1)
+			break;
+
+		positions.append(pos);
+	}
+
+	return true;
+}
+
+QString OpeningSuite::indexFileName(const QString& fileName)
+{
+	return fileName + ".index";
+}
+
+// Index file layout: magic, version, format, suite file size and
+// modification time, position count and the positions themselves
+static const quint32 s_indexMagic = 0x43434958; // "CCIX"
+static const quint32 s_indexVersion = 1;
+
+bool OpeningSuite::readIndex(const QString& fileName,
+			     Format format,
+			     QVector<FilePosition>& positions)
+{
+	positions.clear();
+
+	QFileInfo info(fileName);
+	QFile file(indexFileName(fileName));
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_6);
+
+	quint32 magic = 0;
+	quint32 version = 0;
+	qint32 indexFormat = -1;
+	qint64 fileSize = -1;
+	qint64 lastModified = -1;
+	qint32 count = -1;
+	in >> magic >> version >> indexFormat
+	   >> fileSize >> lastModified >> count;
+
+	// A stale index is silently replaced with a new one
+	if (in.status() != QDataStream::Ok
+	||  magic != s_indexMagic
+	||  version != s_indexVersion
+	||  indexFormat != format
+	||  fileSize != info.size()
+	||  lastModified != info.lastModified().toMSecsSinceEpoch()
+	||  count < 0
+	||  file.size() - file.pos() != qint64(count) * 2 * sizeof(qint64))
+		return false;
+
+	positions.resize(count);
+	for (auto& pos : positions)
+		in >> pos.pos >> pos.lineNumber;
+
+	if (in.status() != QDataStream::Ok)
+	{
+		positions.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool OpeningSuite::writeIndex(const QString& fileName,
+			      Format format,
+			      const QVector<FilePosition>& positions,
+			      qint64 fileSize,
+			      qint64 lastModified)
+{
+	// The suite's directory may well be read-only, in which
+	// case the index is just built again next time.
+	QSaveFile file(indexFileName(fileName));
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_6);
+	out << s_indexMagic << s_indexVersion << qint32(format)
+	    << fileSize << lastModified << qint32(positions.size());
+	for (const auto& pos : positions)
+		out << pos.pos << pos.lineNumber;
+
+	return out.status() == QDataStream::Ok && file.commit();
+}
+
+void OpeningSuite::buildIndex(const QString& fileName, Format format)
+{
+	QFileInfo info(fileName);
+	qint64 fileSize = info.size();
+	qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+
+	QVector<FilePosition> positions;
+	if (scanFile(fileName, format, positions))
+		writeIndex(fileName, format, positions, fileSize, lastModified);
+}
+
+void OpeningSuite::stopIndexing()
+{
+	if (m_indexThread == nullptr)
+		return;
+
+	m_indexThread->requestInterruption();
+	m_indexThread->wait();
+	delete m_indexThread;
+	m_indexThread = nullptr;
+}
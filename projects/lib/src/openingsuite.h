@@ -20,10 +20,13 @@
 #define OPENINGSUITE_H
 
 #include <QVector>
+#include <QVariant>
 #include "pgngame.h"
 class QString;
-class QFile;
+class QIODevice;
+class QIODevice;
 class QTextStream;
+class QThread;
 class PgnStream;
 
 /*!
@@ -34,6 +37,10 @@ class PgnStream;
  * reads positions and games from a text stream (eg. a text file)
  * and returns the opening as a PgnGame object.
  *
+ * The file positions of the openings are saved in an index file
+ * next to the suite file, so that they don't have to be parsed
+ * again the next time the suite is used.
+ *
  * \sa EpdRecord
  * \sa PgnGame
  */
@@ -94,8 +101,12 @@ class LIB_EXPORT OpeningSuite
 		 * If \a order is SequentialOrder, this function just opens
 		 * the opening suite file and gets ready to read data. If
 		 * \a order is RandomOrder, the file positions of all the
-		 * openings are parsed from the file, which could take some
-		 * time if the file is large.
+		 * openings are needed. They are read from the suite's index
+		 * file if it's up to date, and otherwise parsed from the
+		 * suite file, which could take some time if the file is large.
+		 *
+		 * In sequential order a missing index is built on a
+		 * background thread while openings are already being read.
 		 *
 		 * Returns true if successful; otherwise returns false.
 		 */
@@ -105,6 +116,22 @@ class LIB_EXPORT OpeningSuite
 		 * A maximum of \a maxPlies plies (halfmoves) are read.
 		 */
 		PgnGame nextGame(int maxPlies);
+		/*!
+		 * Returns the position of the next opening in the suite.
+		 *
+		 * The position can be passed to setPosition() to continue
+		 * reading openings from the same place later.
+		 */
+		QVariant position() const;
+		/*!
+		 * Moves to \a position, which was returned by position().
+		 *
+		 * The suite must be initialized with the same file, format
+		 * and order (and in random order the same random seed)
+		 * as when \a position was saved. Returns true if
+		 * successful; otherwise returns false.
+		 */
+		bool setPosition(const QVariant& position);
 
 	private:
 		struct FilePosition
@@ -113,8 +140,22 @@ class LIB_EXPORT OpeningSuite
 			qint64 lineNumber;
 		};
 
-		FilePosition getPgnPos();
-		FilePosition getEpdPos();
+		static FilePosition getPgnPos(PgnStream* stream);
+		static FilePosition getEpdPos(QIODevice* device);
+		static bool scanFile(const QString& fileName,
+				     Format format,
+				     QVector<FilePosition>& positions);
+		static QString indexFileName(const QString& fileName);
+		static bool readIndex(const QString& fileName,
+				      Format format,
+				      QVector<FilePosition>& positions);
+		static bool writeIndex(const QString& fileName,
+				       Format format,
+				       const QVector<FilePosition>& positions,
+				       qint64 fileSize,
+				       qint64 lastModified);
+		static void buildIndex(const QString& fileName, Format format);
+		void stopIndexing();
 
 		Format m_format;
 		Order m_order;
@@ -123,9 +164,10 @@ class LIB_EXPORT OpeningSuite
 		int m_startIndex;
 		QString m_fileName;
 		QString m_fen;
-		QFile* m_file;
+		QIODevice* m_file;
 		QTextStream* m_epdStream;
 		PgnStream* m_pgnStream;
+		QThread* m_indexThread;
 		QVector<FilePosition> m_filePositions;
 };
 
@@ -0,0 +1,338 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "outputwriter.h"
+#include <QFile>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include "compressiondevice.h"
+#ifdef Q_OS_WIN
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+namespace {
+
+bool syncFile(QFile& file)
+{
+	if (!file.flush())
+		return false;
+#ifdef Q_OS_WIN
+	return _commit(file.handle()) == 0;
+#else
+	return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // anonymous namespace
+
+OutputWriter::OutputWriter()
+	: m_batchSize(1),
+	  m_batchInterval(0),
+	  m_queueLimit(256),
+	  m_syncPolicy(NoSync),
+	  m_thread(nullptr),
+	  m_queuedCount(0),
+	  m_committedCount(0),
+	  m_commitRequested(false),
+	  m_quit(false)
+{
+}
+
+OutputWriter::~OutputWriter()
+{
+	close();
+}
+
+QString OutputWriter::fileName() const
+{
+	return m_fileName;
+}
+
+void OutputWriter::setFileName(const QString& fileName)
+{
+	if (fileName == m_fileName)
+		return;
+
+	close();
+	m_fileName = fileName;
+}
+
+int OutputWriter::batchSize() const
+{
+	return m_batchSize;
+}
+
+int OutputWriter::batchInterval() const
+{
+	return m_batchInterval;
+}
+
+void OutputWriter::setBatch(int size, int msecs)
+{
+	QMutexLocker locker(&m_mutex);
+	m_batchSize = qMax(size, 1);
+	m_batchInterval = qMax(msecs, 0);
+	m_queueChanged.wakeAll();
+}
+
+QByteArray OutputWriter::fileHeader() const
+{
+	return m_fileHeader;
+}
+
+void OutputWriter::setFileHeader(const QByteArray& header)
+{
+	QMutexLocker locker(&m_mutex);
+	m_fileHeader = header;
+}
+
+int OutputWriter::queueLimit() const
+{
+	return m_queueLimit;
+}
+
+void OutputWriter::setQueueLimit(int limit)
+{
+	QMutexLocker locker(&m_mutex);
+	m_queueLimit = qMax(limit, 1);
+	m_spaceAvailable.wakeAll();
+}
+
+OutputWriter::SyncPolicy OutputWriter::syncPolicy() const
+{
+	return m_syncPolicy;
+}
+
+void OutputWriter::setSyncPolicy(SyncPolicy policy)
+{
+	QMutexLocker locker(&m_mutex);
+	m_syncPolicy = policy;
+}
+
+bool OutputWriter::write(const QString& text)
+{
+	return writeData(text.toUtf8());
+}
+
+bool OutputWriter::writeData(const QByteArray& data)
+{
+	if (m_fileName.isEmpty())
+		return false;
+
+	if (m_thread == nullptr)
+	{
+		m_quit = false;
+		m_thread = QThread::create([=]() { run(); });
+		m_thread->start();
+	}
+
+	QMutexLocker locker(&m_mutex);
+	while (m_queue.size() >= m_queueLimit)
+		m_spaceAvailable.wait(&m_mutex);
+
+	m_queue.append(data);
+	m_queuedCount++;
+	m_queueChanged.wakeAll();
+
+	return true;
+}
+
+qint64 OutputWriter::backlog() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_queuedCount - m_committedCount;
+}
+
+void OutputWriter::flush()
+{
+	if (m_thread == nullptr)
+		return;
+
+	QMutexLocker locker(&m_mutex);
+	m_commitRequested = true;
+	m_queueChanged.wakeAll();
+	while (m_committedCount < m_queuedCount)
+		m_committed.wait(&m_mutex);
+}
+
+void OutputWriter::close()
+{
+	if (m_thread == nullptr)
+		return;
+
+	m_mutex.lock();
+	m_quit = true;
+	m_queueChanged.wakeAll();
+	m_mutex.unlock();
+
+	m_thread->wait();
+	delete m_thread;
+	m_thread = nullptr;
+}
+
+void OutputWriter::run()
+{
+	QFile file(m_fileName);
+	QIODevice* out = nullptr;
+	QScopedPointer<CompressionDevice> compressor;
+	const auto codec = CompressionDevice::codecForFileName(m_fileName);
+	QElapsedTimer timer;
+	int pending = 0;
+	bool ok = true;
+
+	QMutexLocker locker(&m_mutex);
+	qint64 taken = m_committedCount;
+	for (;;)
+	{
+		// Wait for more records until the group commit is due
+		while (m_queue.isEmpty() && !m_quit && !m_commitRequested)
+		{
+			if (pending >= m_batchSize)
+				break;
+			if (pending == 0 || m_batchInterval == 0)
+			{
+				m_queueChanged.wait(&m_mutex);
+				continue;
+			}
+
+			qint64 timeLeft = m_batchInterval - timer.elapsed();
+			if (timeLeft <= 0)
+				break;
+			m_queueChanged.wait(&m_mutex, timeLeft);
+		}
+
+		QList<QByteArray> batch;
+		batch.swap(m_queue);
+		m_spaceAvailable.wakeAll();
+
+		const bool quit = m_quit;
+		const bool commitRequested = m_commitRequested;
+		m_commitRequested = false;
+		const int batchSize = m_batchSize;
+		const int batchInterval = m_batchInterval;
+		const SyncPolicy syncPolicy = m_syncPolicy;
+		const QByteArray fileHeader = m_fileHeader;
+		locker.unlock();
+
+		if (!batch.isEmpty())
+		{
+			bool isOpen = file.isOpen();
+			if (!isOpen || !file.exists())
+			{
+				if (isOpen)
+				{
+					qWarning("File %s does not exist. Reopening...",
+						 qUtf8Printable(file.fileName()));
+					out = nullptr;
+					compressor.reset();
+					file.close();
+				}
+
+				// A compressed file gets a new gzip member or
+				// zstd frame, so appending to it is safe.
+				if (file.open(QIODevice::WriteOnly | QIODevice::Append)
+				&&  codec != CompressionDevice::NoCodec)
+				{
+					compressor.reset(new CompressionDevice(&file, codec));
+					if (!compressor->open(QIODevice::WriteOnly))
+					{
+						qWarning("Cannot compress file %s: %s",
+							 qUtf8Printable(file.fileName()),
+							 qUtf8Printable(compressor->errorString()));
+						compressor.reset();
+						file.close();
+						ok = false;
+					}
+				}
+
+				if (file.isOpen())
+				{
+					if (compressor)
+						out = compressor.data();
+					else
+						out = &file;
+					if (file.size() == 0 && !fileHeader.isEmpty())
+						out->write(fileHeader);
+					ok = true;
+				}
+				else if (ok)
+				{
+					ok = false;
+					qWarning("Could not open file %s",
+						 qUtf8Printable(file.fileName()));
+				}
+			}
+
+			if (file.isOpen())
+			{
+				if (pending == 0)
+					timer.start();
+				for (const QByteArray& data : qAsConst(batch))
+					out->write(data);
+				pending += batch.size();
+			}
+		}
+
+		if (pending > 0
+		&&  (quit || commitRequested || pending >= batchSize
+		     || (batchInterval > 0 && timer.elapsed() >= batchInterval)))
+		{
+			if (compressor && !compressor->commit())
+				qWarning("Could not compress file %s: %s",
+					 qUtf8Printable(file.fileName()),
+					 qUtf8Printable(compressor->errorString()));
+			file.flush();
+			if (syncPolicy == SyncOnCommit && !syncFile(file))
+				qWarning("Could not sync file %s",
+					 qUtf8Printable(file.fileName()));
+			if (file.error() != QFile::NoError)
+			{
+				qWarning("Could not write to file %s: %s",
+					 qUtf8Printable(file.fileName()),
+					 qUtf8Printable(file.errorString()));
+				file.unsetError();
+			}
+			pending = 0;
+		}
+
+		locker.relock();
+		taken += batch.size();
+		if (pending == 0)
+		{
+			m_committedCount = taken;
+			m_committed.wakeAll();
+		}
+
+		if (quit && m_queue.isEmpty())
+			break;
+	}
+	const SyncPolicy syncPolicy = m_syncPolicy;
+	locker.unlock();
+
+	compressor.reset();
+	if (file.isOpen())
+	{
+		if (syncPolicy == SyncOnClose && !syncFile(file))
+			qWarning("Could not sync file %s",
+				 qUtf8Printable(file.fileName()));
+		file.close();
+	}
+}
@@ -0,0 +1,162 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <QList>
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+class QThread;
+
+/*!
+ * \brief An asynchronous, buffered file writer
+ *
+ * OutputWriter appends records (eg. PGN games, EPD positions or
+ * binary game archive records)
+ * to a file on a dedicated I/O thread, so that a slow disk or network
+ * file system doesn't stall the caller. The records are written in
+ * the order they are queued.
+ *
+ * Writes are committed in groups: the file is flushed when batchSize()
+ * records have been written or when batchInterval() milliseconds have
+ * passed since the first uncommitted record, whichever comes first.
+ * If the queue holds queueLimit() records, write() blocks until the
+ * I/O thread catches up.
+ *
+ * If the file name ends with ".gz" or ".zst", the output is compressed
+ * and every group commit ends a gzip member or zstd frame, so that the
+ * file stays readable if the program is interrupted.
+ *
+ * Errors are reported as warnings from the I/O thread.
+ */
+class LIB_EXPORT OutputWriter
+{
+	public:
+		/*! The policy for syncing the file to the storage device. */
+		enum SyncPolicy
+		{
+			NoSync,		//!< Never sync, leave it to the OS
+			SyncOnCommit,	//!< Sync after every group commit
+			SyncOnClose	//!< Sync when the file is closed
+		};
+
+		/*! Creates a new writer without a file. */
+		OutputWriter();
+		/*! Closes the file, writing any queued records first. */
+		~OutputWriter();
+
+		/*! Returns the name of the output file. */
+		QString fileName() const;
+		/*!
+		 * Sets the output file to \a fileName.
+		 *
+		 * If another file is open, it is closed first.
+		 */
+		void setFileName(const QString& fileName);
+
+		/*! Returns the number of records per group commit. */
+		int batchSize() const;
+		/*! Returns the maximum commit delay in milliseconds. */
+		int batchInterval() const;
+		/*!
+		 * Sets the group commit limits to \a size records and
+		 * \a msecs milliseconds. If \a msecs is 0, there is no
+		 * time limit.
+		 *
+		 * The default is to commit every record immediately
+		 * (\a size 1).
+		 */
+		void setBatch(int size, int msecs);
+
+		/*! Returns the header written to the start of a new file. */
+		QByteArray fileHeader() const;
+		/*!
+		 * Sets the header of the file to \a header.
+		 *
+		 * The header is written before the first record if the
+		 * file is empty. By default there is no header.
+		 */
+		void setFileHeader(const QByteArray& header);
+
+		/*! Returns the maximum number of queued records. */
+		int queueLimit() const;
+		/*! Sets the maximum number of queued records to \a limit. */
+		void setQueueLimit(int limit);
+
+		/*! Returns the sync policy. */
+		SyncPolicy syncPolicy() const;
+		/*!
+		 * Sets the sync policy to \a policy.
+		 * The default is NoSync.
+		 */
+		void setSyncPolicy(SyncPolicy policy);
+
+		/*!
+		 * Returns the number of records that are queued or
+		 * written but not yet committed.
+		 */
+		qint64 backlog() const;
+
+		/*!
+		 * Queues \a text to be appended to the file in UTF-8.
+		 *
+		 * Returns false if no file is set; otherwise returns true.
+		 */
+		bool write(const QString& text);
+		/*!
+		 * Queues binary \a data to be appended to the file.
+		 *
+		 * Returns false if no file is set; otherwise returns true.
+		 */
+		bool writeData(const QByteArray& data);
+		/*!
+		 * Writes and commits all queued records.
+		 * Blocks until the I/O thread is done.
+		 */
+		void flush();
+		/*! Flushes and closes the file and stops the I/O thread. */
+		void close();
+
+	private:
+		Q_DISABLE_COPY(OutputWriter)
+
+		void run();
+
+		QString m_fileName;
+		QByteArray m_fileHeader;
+		int m_batchSize;
+		int m_batchInterval;
+		int m_queueLimit;
+		SyncPolicy m_syncPolicy;
+
+		QThread* m_thread;
+		mutable QMutex m_mutex;
+		QWaitCondition m_queueChanged;
+		QWaitCondition m_spaceAvailable;
+		QWaitCondition m_committed;
+		QList<QByteArray> m_queue;
+		qint64 m_queuedCount;
+		qint64 m_committedCount;
+		bool m_commitRequested;
+		bool m_quit;
+};
+
+#endif // OUTPUTWRITER_H
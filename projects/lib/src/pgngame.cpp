@@ -24,6 +24,7 @@
 #include "board/boardfactory.h"
 #include "econode.h"
 #include "pgnstream.h"
+#include "gamearchive.h"
 #include "moveevaluation.h"
 
 namespace {
@@ -269,6 +270,11 @@ bool PgnGame::read(PgnStream& in, int maxMoves, bool addEco)
 	return true;
 }
 
+bool PgnGame::read(GameArchiveReader& in, int maxMoves, bool addEco)
+{
+	return in.read(*this, maxMoves, addEco);
+}
+
 bool PgnGame::write(QTextStream& out, PgnMode mode) const
 {
 	if (m_tags.isEmpty())
@@ -350,6 +356,11 @@ bool PgnGame::write(const QString& filename, PgnMode mode) const
 	return write(out, mode);
 }
 
+bool PgnGame::write(GameArchiveWriter& out) const
+{
+	return out.write(*this);
+}
+
 bool PgnGame::isStandard() const
 {
 	return variant() == "standard" && !m_tags.contains("FEN");
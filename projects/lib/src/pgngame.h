@@ -29,6 +29,8 @@
 #include "board/result.h"
 class QTextStream;
 class PgnStream;
+class GameArchiveReader;
+class GameArchiveWriter;
 class EcoNode;
 class QObject;
 namespace Chess { class Board; }
@@ -63,7 +65,10 @@ class LIB_EXPORT PgnGame
 		/*! \brief A struct for storing the game's move history. */
 		struct MoveData
 		{
-			/*! The zobrist position key before the move. */
+			/*!
+			 * The zobrist position key before the move.
+			 * \note Zero for games read from a game archive.
+			 */
 			quint64 key;
 			/*! The move in the "generic" format. */
 			Chess::GenericMove move;
@@ -113,6 +118,17 @@ class LIB_EXPORT PgnGame
 		 */
 		bool read(PgnStream& in, int maxMoves = INT_MAX - 1,
 				  bool addEco = true);
+		/*!
+		 * Reads the next game from a binary game archive.
+		 *
+		 * This is much faster than reading PGN because the moves
+		 * don't have to be parsed.
+		 *
+		 * Returns true if successful; otherwise returns false.
+		 * \sa GameArchiveReader
+		 */
+		bool read(GameArchiveReader& in, int maxMoves = INT_MAX - 1,
+			  bool addEco = true);
 		/*!
 		 * Writes the game to a text stream.
 		 *
@@ -127,6 +143,13 @@ class LIB_EXPORT PgnGame
 		 * Returns true if successful; otherwise returns false.
 		 */
 		bool write(const QString& filename, PgnMode mode = Verbose) const;
+		/*!
+		 * Writes the game to a binary game archive.
+		 *
+		 * Returns true if successful; otherwise returns false.
+		 * \sa GameArchiveWriter
+		 */
+		bool write(GameArchiveWriter& out) const;
 		
 		/*!
 		 * Returns true if the game's variant is "standard" and it's
@@ -206,6 +229,9 @@ class LIB_EXPORT PgnGame
 		QMap<int, int> extractScores() const;
 
 	private:
+		friend class GameArchiveReader;
+		friend class GameArchiveWriter;
+
 		bool parseMove(PgnStream& in, bool addEco);
 		
 		Chess::Side m_startingSide;
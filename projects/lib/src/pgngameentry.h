@@ -78,6 +78,8 @@ class LIB_EXPORT PgnGameEntry
 		/*!
 		 * Returns true if the PGN tags match \a filter.
 		 * The matching is case insensitive.
+		 *
+		 * \note Use PgnGameEntryStore to filter many entries.
 		 */
 		bool match(const PgnGameFilter& filter) const;
 
@@ -90,6 +92,8 @@ class LIB_EXPORT PgnGameEntry
 		QString tagValue(TagType type) const;
 
 	private:
+		friend class PgnGameEntryStore;
+
 		void addTag(const QByteArray& tagValue);
 
 		QByteArray m_data;
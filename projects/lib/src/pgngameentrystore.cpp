@@ -0,0 +1,1055 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pgngameentrystore.h"
+#include <QFile>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+// Packed dates and rounds with this bit set are string IDs
+const quint32 s_stringFlag = 0x80000000;
+
+// Packed results
+enum ResultCode
+{
+	EmptyResult,
+	WhiteWinsResult,
+	BlackWinsResult,
+	DrawResult,
+	UnfinishedResult,
+	OtherResult
+};
+
+const char* const s_resultStrings[] =
+{
+	"", "1-0", "0-1", "1/2-1/2", "*"
+};
+
+int s_stringContains(const char* s1, const char* s2, int size)
+{
+	Q_ASSERT(s1 != nullptr);
+	Q_ASSERT(s2 != nullptr);
+	Q_ASSERT(size >= 0);
+
+	if (!*s2)
+		return 0;
+	if (size == 0)
+		return -1;
+
+	const char* s1_end = s1 + size;
+
+	while (s1 < s1_end)
+	{
+		if (toupper(*s1) == toupper(*s2))
+		{
+			const char* a = s1 + 1;
+			const char* b = s2 + 1;
+
+			while (*b && a < s1_end)
+			{
+				if (toupper(*a) != toupper(*b))
+					break;
+				a++;
+				b++;
+			}
+			if (!*b)
+				return b - s2;
+			if (a == s1_end)
+				return -1;
+		}
+		s1++;
+	}
+
+	return -1;
+}
+
+int s_stringToInt(const char *s, int size)
+{
+	int num = 0;
+	for (int i = 0; i < size; i++)
+	{
+		if (!isdigit(s[i]))
+			return 0;
+		num = num * 10 + (s[i] - '0');
+	}
+
+	return num;
+}
+
+/*
+ * Parses a number of exactly \a size digits, or \a size question
+ * marks as 0. Returns -1 on failure.
+ */
+int s_parseDateField(const char* s, int size)
+{
+	if (s[0] == '?')
+	{
+		for (int i = 1; i < size; i++)
+		{
+			if (s[i] != '?')
+				return -1;
+		}
+		return 0;
+	}
+
+	int num = 0;
+	for (int i = 0; i < size; i++)
+	{
+		if (!isdigit(s[i]))
+			return -1;
+		num = num * 10 + (s[i] - '0');
+	}
+
+	return num;
+}
+
+void s_formatDateField(char* out, int value, int size)
+{
+	if (value == 0)
+	{
+		memset(out, '?', size_t(size));
+		return;
+	}
+
+	for (int i = size - 1; i >= 0; i--)
+	{
+		out[i] = char('0' + value % 10);
+		value /= 10;
+	}
+}
+
+/* Writes packed date \a date to \a out and returns its length. */
+int s_formatDate(char* out, quint32 date)
+{
+	s_formatDateField(out, int(date >> 9), 4);
+	out[4] = '.';
+	s_formatDateField(out + 5, int((date >> 5) & 0xf), 2);
+	out[7] = '.';
+	s_formatDateField(out + 8, int(date & 0x1f), 2);
+
+	return 10;
+}
+
+/* Returns the date filtering key of a date with the given fields. */
+inline int s_dateKey(int year, int month, int day)
+{
+	if (year == 0)
+		return -1;
+	return year * 10000 + qMax(month, 1) * 100 + qMax(day, 1);
+}
+
+inline int s_dateKey(const QDate& date)
+{
+	return date.year() * 10000 + date.month() * 100 + date.day();
+}
+
+/*
+ * The header of a store written with PgnGameEntryStore::write().
+ * It's followed by the columns, the irregular results and the
+ * dictionaries, each aligned to 8 bytes.
+ */
+struct CacheHeader
+{
+	char magic[4];
+	quint32 version;
+	quint32 byteOrder;
+	qint32 count;
+	qint32 otherResultCount;
+	qint32 dictionarySize[5];
+	quint32 dictionaryDataSize[5];
+};
+
+const char s_cacheMagic[4] = { 'C', 'C', 'G', 'E' };
+const quint32 s_cacheVersion = 1;
+const quint32 s_byteOrderMark = 0x01020304;
+
+/*
+ * Returns the value of \a id in \a values, or \a defaultValue if
+ * the id of a damaged cache is out of range.
+ */
+template<typename T>
+inline T s_valueAt(const QVector<T>& values, quint32 id, T defaultValue)
+{
+	return id < quint32(values.size()) ? values.at(int(id)) : defaultValue;
+}
+
+inline qint64 s_align(qint64 pos)
+{
+	return (pos + 7) & ~qint64(7);
+}
+
+bool s_writeSection(QIODevice* device, const void* data, qint64 size)
+{
+	static const char padding[8] = {};
+	const qint64 pad = s_align(device->pos()) - device->pos();
+	if (pad > 0 && device->write(padding, pad) != pad)
+		return false;
+
+	return size == 0
+	    || device->write(static_cast<const char*>(data), size) == size;
+}
+
+} // anonymous namespace
+
+
+PgnGameEntryStore::Dictionary::Dictionary()
+	: mappedOffsets(nullptr),
+	  mappedData(nullptr),
+	  mappedSize(0)
+{
+}
+
+int PgnGameEntryStore::Dictionary::size() const
+{
+	return mappedOffsets ? mappedSize : strings.size();
+}
+
+QByteArray PgnGameEntryStore::Dictionary::string(int id) const
+{
+	// A mapped cache is trusted until its ids are used
+	if (id < 0 || id >= size())
+		return QByteArray();
+	if (mappedOffsets)
+		return QByteArray(mappedData + mappedOffsets[id],
+				  int(mappedOffsets[id + 1] - mappedOffsets[id]));
+	return strings.at(id);
+}
+
+quint32 PgnGameEntryStore::Dictionary::insert(const QByteArray& str)
+{
+	// Copy a mapped dictionary to memory before modifying it
+	if (mappedOffsets)
+	{
+		QVector<QByteArray> copy;
+		copy.reserve(mappedSize);
+		for (int i = 0; i < mappedSize; i++)
+			copy.append(string(i));
+		strings = copy;
+		mappedOffsets = nullptr;
+		mappedData = nullptr;
+		mappedSize = 0;
+	}
+	if (ids.size() != strings.size())
+	{
+		ids.clear();
+		ids.reserve(strings.size());
+		for (int i = 0; i < strings.size(); i++)
+			ids.insert(strings.at(i), quint32(i));
+	}
+
+	auto it = ids.constFind(str);
+	if (it != ids.constEnd())
+		return it.value();
+
+	const quint32 id = quint32(strings.size());
+	strings.append(str);
+	ids.insert(str, id);
+	return id;
+}
+
+
+PgnGameEntryStore::PgnGameEntryStore()
+{
+}
+
+int PgnGameEntryStore::count() const
+{
+	return m_pos.size();
+}
+
+bool PgnGameEntryStore::isEmpty() const
+{
+	return m_pos.isEmpty();
+}
+
+void PgnGameEntryStore::clear()
+{
+	*this = PgnGameEntryStore();
+}
+
+void PgnGameEntryStore::reserve(int size)
+{
+	m_pos.reserve(size);
+	m_lineNumber.reserve(size);
+	m_event.reserve(size);
+	m_site.reserve(size);
+	m_white.reserve(size);
+	m_black.reserve(size);
+	m_date.reserve(size);
+	m_round.reserve(size);
+	m_variant.reserve(size);
+	m_result.reserve(size);
+}
+
+quint32 PgnGameEntryStore::packDate(const QByteArray& date)
+{
+	// Complete or partial dates in "YYYY.MM.DD" format are packed
+	// into 23 bits. Zero means an unknown field.
+	if (date.size() == 10 && date.at(4) == '.' && date.at(7) == '.')
+	{
+		const char* s = date.constData();
+		int year = s_parseDateField(s, 4);
+		int month = s_parseDateField(s + 5, 2);
+		int day = s_parseDateField(s + 8, 2);
+
+		if ((year > 0 || s[0] == '?')
+		&&  month >= 0 && month <= 12 && (month > 0 || s[5] == '?')
+		&&  day >= 0 && day <= 31 && (day > 0 || s[8] == '?'))
+			return quint32(year << 9 | month << 5 | day);
+	}
+
+	return s_stringFlag | m_strings.insert(date);
+}
+
+quint32 PgnGameEntryStore::packRound(const QByteArray& round)
+{
+	// Plain round numbers are stored as integers
+	const int size = round.size();
+	if (size > 0 && size < 10 && (size == 1 || round.at(0) != '0'))
+	{
+		int value = s_stringToInt(round.constData(), size);
+		if (value > 0 || round == "0")
+			return quint32(value);
+	}
+
+	return s_stringFlag | m_strings.insert(round);
+}
+
+quint8 PgnGameEntryStore::packResult(const QByteArray& result, int index)
+{
+	for (int i = EmptyResult; i < OtherResult; i++)
+	{
+		if (result == s_resultStrings[i])
+			return quint8(i);
+	}
+
+	m_otherResults.insert(index, m_strings.insert(result));
+	return OtherResult;
+}
+
+void PgnGameEntryStore::append(const PgnGameEntry& entry)
+{
+	const int index = count();
+	const QByteArray& data = entry.m_data;
+
+	// See PgnGameEntry::addTag()
+	QByteArray tags[8];
+	for (int type = 0, i = 0; type < 8 && i < data.size(); type++)
+	{
+		int size = data.at(i++);
+		tags[type] = QByteArray(data.constData() + i, size);
+		i += size;
+	}
+
+	m_pos.append(entry.m_pos);
+	m_lineNumber.append(entry.m_lineNumber);
+	m_event.append(m_events.insert(tags[PgnGameEntry::EventTag]));
+	m_site.append(m_sites.insert(tags[PgnGameEntry::SiteTag]));
+	m_date.append(packDate(tags[PgnGameEntry::DateTag]));
+	m_round.append(packRound(tags[PgnGameEntry::RoundTag]));
+	m_white.append(m_names.insert(tags[PgnGameEntry::WhiteTag]));
+	m_black.append(m_names.insert(tags[PgnGameEntry::BlackTag]));
+	m_result.append(packResult(tags[PgnGameEntry::ResultTag], index));
+	m_variant.append(m_variants.insert(tags[PgnGameEntry::VariantTag]));
+}
+
+void PgnGameEntryStore::append(const PgnGameEntryStore& other)
+{
+	if (isEmpty())
+	{
+		*this = other;
+		return;
+	}
+
+	// Map the dictionary IDs of the other store to this one
+	auto mapIds = [](Dictionary& to, const Dictionary& from)
+	{
+		QVector<quint32> ids;
+		ids.reserve(from.size());
+		for (int i = 0; i < from.size(); i++)
+			ids.append(to.insert(from.string(i)));
+		return ids;
+	};
+	const auto events = mapIds(m_events, other.m_events);
+	const auto sites = mapIds(m_sites, other.m_sites);
+	const auto names = mapIds(m_names, other.m_names);
+	const auto variants = mapIds(m_variants, other.m_variants);
+	const auto strings = mapIds(m_strings, other.m_strings);
+
+	auto mapPacked = [&strings](quint32 value)
+	{
+		if (value & s_stringFlag)
+			return s_stringFlag | strings.at(int(value & ~s_stringFlag));
+		return value;
+	};
+
+	const int offset = count();
+	reserve(offset + other.count());
+
+	m_pos.append(other.m_pos);
+	m_lineNumber.append(other.m_lineNumber);
+	m_result.append(other.m_result);
+	for (quint32 id : other.m_event)
+		m_event.append(events.at(int(id)));
+	for (quint32 id : other.m_site)
+		m_site.append(sites.at(int(id)));
+	for (quint32 id : other.m_white)
+		m_white.append(names.at(int(id)));
+	for (quint32 id : other.m_black)
+		m_black.append(names.at(int(id)));
+	for (quint32 id : other.m_variant)
+		m_variant.append(variants.at(int(id)));
+	for (quint32 date : other.m_date)
+		m_date.append(mapPacked(date));
+	for (quint32 round : other.m_round)
+		m_round.append(mapPacked(round));
+
+	for (auto it = other.m_otherResults.constBegin();
+	     it != other.m_otherResults.constEnd(); ++it)
+		m_otherResults.insert(offset + it.key(), strings.at(int(it.value())));
+}
+
+QByteArray PgnGameEntryStore::tagData(int index,
+				      PgnGameEntry::TagType type) const
+{
+	switch (type)
+	{
+	case PgnGameEntry::EventTag:
+		return m_events.string(int(m_event.at(index)));
+	case PgnGameEntry::SiteTag:
+		return m_sites.string(int(m_site.at(index)));
+	case PgnGameEntry::DateTag:
+		{
+			const quint32 date = m_date.at(index);
+			if (date & s_stringFlag)
+				return m_strings.string(int(date & ~s_stringFlag));
+
+			char buf[10];
+			return QByteArray(buf, s_formatDate(buf, date));
+		}
+	case PgnGameEntry::RoundTag:
+		{
+			const quint32 round = m_round.at(index);
+			if (round & s_stringFlag)
+				return m_strings.string(int(round & ~s_stringFlag));
+			return QByteArray::number(round);
+		}
+	case PgnGameEntry::WhiteTag:
+		return m_names.string(int(m_white.at(index)));
+	case PgnGameEntry::BlackTag:
+		return m_names.string(int(m_black.at(index)));
+	case PgnGameEntry::ResultTag:
+		{
+			const quint8 result = m_result.at(index);
+			if (result == OtherResult)
+				return m_strings.string(int(m_otherResults.value(index)));
+			if (result > OtherResult)
+				return QByteArray();
+			return s_resultStrings[result];
+		}
+	case PgnGameEntry::VariantTag:
+		return m_variants.string(int(m_variant.at(index)));
+	default:
+		return QByteArray();
+	}
+}
+
+PgnGameEntry PgnGameEntryStore::entry(int index) const
+{
+	PgnGameEntry entry;
+	entry.m_pos = m_pos.at(index);
+	entry.m_lineNumber = m_lineNumber.at(index);
+	for (int type = 0; type < 8; type++)
+		entry.addTag(tagData(index, PgnGameEntry::TagType(type)));
+
+	return entry;
+}
+
+qint64 PgnGameEntryStore::pos(int index) const
+{
+	return m_pos.at(index);
+}
+
+qint64 PgnGameEntryStore::lineNumber(int index) const
+{
+	return m_lineNumber.at(index);
+}
+
+QString PgnGameEntryStore::tagValue(int index, PgnGameEntry::TagType type) const
+{
+	const QByteArray data(tagData(index, type));
+	if (data.isEmpty())
+		return QString();
+	return data;
+}
+
+QVector<int> PgnGameEntryStore::filter(const PgnGameFilter& filter) const
+{
+	return Matcher(*this, filter).filter(0, count());
+}
+
+bool PgnGameEntryStore::write(QIODevice* device) const
+{
+	Q_ASSERT(device != nullptr);
+
+	const Dictionary* dicts[] =
+	{
+		&m_events, &m_sites, &m_names, &m_variants, &m_strings
+	};
+	QVector<quint32> offsets[5];
+	QByteArray data[5];
+
+	CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, s_cacheMagic, sizeof(header.magic));
+	header.version = s_cacheVersion;
+	header.byteOrder = s_byteOrderMark;
+	header.count = count();
+	header.otherResultCount = m_otherResults.size();
+	for (int i = 0; i < 5; i++)
+	{
+		const Dictionary* dict = dicts[i];
+		offsets[i].append(0);
+		for (int j = 0; j < dict->size(); j++)
+		{
+			data[i] += dict->string(j);
+			offsets[i].append(quint32(data[i].size()));
+		}
+		header.dictionarySize[i] = dict->size();
+		header.dictionaryDataSize[i] = quint32(data[i].size());
+	}
+
+	QVector<qint32> resultIndexes;
+	QVector<quint32> resultIds;
+	auto keys = m_otherResults.keys();
+	std::sort(keys.begin(), keys.end());
+	for (int key : qAsConst(keys))
+	{
+		resultIndexes.append(key);
+		resultIds.append(m_otherResults.value(key));
+	}
+
+	const qint64 n = count();
+	if (device->write(reinterpret_cast<const char*>(&header),
+			  sizeof(header)) != qint64(sizeof(header))
+	||  !s_writeSection(device, m_pos.constData(), n * 8)
+	||  !s_writeSection(device, m_lineNumber.constData(), n * 8)
+	||  !s_writeSection(device, m_event.constData(), n * 4)
+	||  !s_writeSection(device, m_site.constData(), n * 4)
+	||  !s_writeSection(device, m_white.constData(), n * 4)
+	||  !s_writeSection(device, m_black.constData(), n * 4)
+	||  !s_writeSection(device, m_date.constData(), n * 4)
+	||  !s_writeSection(device, m_round.constData(), n * 4)
+	||  !s_writeSection(device, m_variant.constData(), n * 4)
+	||  !s_writeSection(device, m_result.constData(), n)
+	||  !s_writeSection(device, resultIndexes.constData(),
+			    resultIndexes.size() * 4)
+	||  !s_writeSection(device, resultIds.constData(),
+			    resultIds.size() * 4))
+		return false;
+
+	for (int i = 0; i < 5; i++)
+	{
+		if (!s_writeSection(device, offsets[i].constData(),
+				    offsets[i].size() * 4)
+		||  !s_writeSection(device, data[i].constData(), data[i].size()))
+			return false;
+	}
+
+	return true;
+}
+
+bool PgnGameEntryStore::map(const QString& fileName, qint64 offset, qint64* end)
+{
+	QSharedPointer<QFile> file(new QFile(fileName));
+	if (!file->open(QIODevice::ReadOnly))
+		return false;
+
+	const qint64 fileSize = file->size();
+	if (offset < 0 || fileSize - offset < qint64(sizeof(CacheHeader)))
+		return false;
+	const uchar* base = file->map(offset, fileSize - offset);
+	if (base == nullptr)
+		return false;
+
+	CacheHeader header;
+	memcpy(&header, base, sizeof(header));
+	if (memcmp(header.magic, s_cacheMagic, sizeof(header.magic)) != 0
+	||  header.version != s_cacheVersion
+	||  header.byteOrder != s_byteOrderMark
+	||  header.count < 0
+	||  header.otherResultCount < 0)
+		return false;
+
+	// Returns the next section of \a size bytes
+	bool ok = true;
+	qint64 pos = offset + qint64(sizeof(header));
+	auto section = [&](qint64 size) -> const uchar*
+	{
+		pos = s_align(pos);
+		if (size < 0 || pos + size > fileSize)
+		{
+			ok = false;
+			return base;
+		}
+		const uchar* data = base + (pos - offset);
+		pos += size;
+		return data;
+	};
+
+	PgnGameEntryStore store;
+	const int n = header.count;
+	store.m_pos.map(reinterpret_cast<const qint64*>(section(n * 8LL)), n);
+	store.m_lineNumber.map(reinterpret_cast<const qint64*>(section(n * 8LL)), n);
+	store.m_event.map(reinterpret_cast<const quint32*>(section(n * 4LL)), n);
+	store.m_site.map(reinterpret_cast<const quint32*>(section(n * 4LL)), n);
+	store.m_white.map(reinterpret_cast<const quint32*>(section(n * 4LL)), n);
+	store.m_black.map(reinterpret_cast<const quint32*>(section(n * 4LL)), n);
+	store.m_date.map(reinterpret_cast<const quint32*>(section(n * 4LL)), n);
+	store.m_round.map(reinterpret_cast<const quint32*>(section(n * 4LL)), n);
+	store.m_variant.map(reinterpret_cast<const quint32*>(section(n * 4LL)), n);
+	store.m_result.map(reinterpret_cast<const quint8*>(section(n)), n);
+
+	const int resultCount = header.otherResultCount;
+	auto resultIndexes = reinterpret_cast<const qint32*>(section(resultCount * 4LL));
+	auto resultIds = reinterpret_cast<const quint32*>(section(resultCount * 4LL));
+	if (!ok)
+		return false;
+
+	Dictionary* dicts[] =
+	{
+		&store.m_events, &store.m_sites, &store.m_names,
+		&store.m_variants, &store.m_strings
+	};
+	for (int i = 0; i < 5; i++)
+	{
+		const int size = header.dictionarySize[i];
+		if (size < 0)
+			return false;
+
+		auto offsets = reinterpret_cast<const quint32*>(section((size + 1) * 4LL));
+		auto data = reinterpret_cast<const char*>(section(header.dictionaryDataSize[i]));
+		if (!ok || offsets[0] != 0 || offsets[size] != header.dictionaryDataSize[i])
+			return false;
+		for (int j = 0; j < size; j++)
+		{
+			if (offsets[j] > offsets[j + 1])
+				return false;
+		}
+
+		dicts[i]->mappedOffsets = offsets;
+		dicts[i]->mappedData = data;
+		dicts[i]->mappedSize = size;
+	}
+
+	// The ids in the columns are checked when they're used, so
+	// that a large cache can be mapped without reading it
+	for (int i = 0; i < resultCount; i++)
+		store.m_otherResults.insert(resultIndexes[i], resultIds[i]);
+
+	store.m_file = file;
+	*this = store;
+	if (end != nullptr)
+		*end = pos;
+	return true;
+}
+
+bool PgnGameEntryStore::isMapped() const
+{
+	return !m_file.isNull();
+}
+
+
+PgnGameEntryStore::Matcher::Matcher(const PgnGameEntryStore& store,
+				    const PgnGameFilter& filter)
+	: m_store(store),
+	  m_filter(filter),
+	  m_minDateKey(0),
+	  m_maxDateKey(0),
+	  m_dateDigits(false),
+	  m_roundDigits(false),
+	  m_matchAll(false)
+{
+	// An empty filter matches every entry without scanning the
+	// columns, so a mapped store isn't paged in for it
+	if (filter.type() == PgnGameFilter::FixedString)
+		m_matchAll = !*filter.pattern();
+	else
+		m_matchAll = !*filter.event() && !*filter.site()
+			&& !*filter.player() && !*filter.opponent()
+			&& filter.minDate().isNull() && filter.maxDate().isNull()
+			&& filter.minRound() == 0 && filter.maxRound() == 0
+			&& filter.result() == PgnGameFilter::AnyResult;
+	if (m_matchAll)
+		return;
+
+	// Match each distinct string only once
+	auto match = [](const Dictionary& dict, const char* pattern)
+	{
+		QVector<char> ret;
+		ret.reserve(dict.size());
+		for (int i = 0; i < dict.size(); i++)
+		{
+			const QByteArray str(dict.string(i));
+			ret.append(s_stringContains(str.constData(), pattern,
+						    str.size()) != -1);
+		}
+		return ret;
+	};
+	auto length = [](const Dictionary& dict, const char* pattern)
+	{
+		QVector<int> ret;
+		ret.reserve(dict.size());
+		for (int i = 0; i < dict.size(); i++)
+		{
+			const QByteArray str(dict.string(i));
+			ret.append(s_stringContains(str.constData(), pattern,
+						    str.size()));
+		}
+		return ret;
+	};
+
+	if (filter.type() == PgnGameFilter::FixedString)
+	{
+		const char* pattern = filter.pattern();
+		m_eventMatch = match(store.m_events, pattern);
+		m_siteMatch = match(store.m_sites, pattern);
+		m_nameMatch = match(store.m_names, pattern);
+		m_variantMatch = match(store.m_variants, pattern);
+		m_stringMatch = match(store.m_strings, pattern);
+		for (int i = EmptyResult; i < OtherResult; i++)
+		{
+			const char* str = s_resultStrings[i];
+			m_resultMatch.append(s_stringContains(str, pattern,
+							      int(strlen(str))) != -1);
+		}
+
+		// Packed dates and rounds can only match patterns that
+		// have just their characters
+		const int size = int(strlen(pattern));
+		m_dateDigits = size <= 10
+			&& int(strspn(pattern, "0123456789.?")) == size;
+		m_roundDigits = size <= 10
+			&& int(strspn(pattern, "0123456789")) == size;
+		return;
+	}
+
+	if (*filter.event())
+		m_eventMatch = match(store.m_events, filter.event());
+	if (*filter.site())
+		m_siteMatch = match(store.m_sites, filter.site());
+	m_playerLength = length(store.m_names, filter.player());
+	m_opponentLength = length(store.m_names, filter.opponent());
+
+	if (!filter.minDate().isNull() || !filter.maxDate().isNull())
+	{
+		if (!filter.minDate().isNull())
+			m_minDateKey = s_dateKey(filter.minDate());
+		if (!filter.maxDate().isNull())
+			m_maxDateKey = s_dateKey(filter.maxDate());
+
+		for (int i = 0; i < store.m_strings.size(); i++)
+		{
+			const QByteArray str(store.m_strings.string(i));
+			const char* s = str.constData();
+			m_stringDateKey.append(str.size() < 10 ? -1 :
+				s_dateKey(s_stringToInt(s, 4),
+					  s_stringToInt(s + 5, 2),
+					  s_stringToInt(s + 8, 2)));
+		}
+	}
+
+	if (filter.minRound() != 0 || filter.maxRound() != 0)
+	{
+		for (int i = 0; i < store.m_strings.size(); i++)
+		{
+			const QByteArray str(store.m_strings.string(i));
+			m_stringRound.append(s_stringToInt(str.constData(),
+							   str.size()));
+		}
+	}
+
+	if (filter.result() != PgnGameFilter::AnyResult)
+	{
+		for (int i = EmptyResult; i < OtherResult; i++)
+			m_results.append(Chess::Result(
+				QString::fromLatin1(s_resultStrings[i])));
+	}
+}
+
+int PgnGameEntryStore::Matcher::dateKey(quint32 date) const
+{
+	if (date & s_stringFlag)
+		return s_valueAt(m_stringDateKey, date & ~s_stringFlag, -1);
+	return s_dateKey(int(date >> 9), int((date >> 5) & 0xf), int(date & 0x1f));
+}
+
+int PgnGameEntryStore::Matcher::roundValue(quint32 round) const
+{
+	if (round & s_stringFlag)
+		return s_valueAt(m_stringRound, round & ~s_stringFlag, 0);
+	return int(round);
+}
+
+bool PgnGameEntryStore::Matcher::matchResult(int index, int whitePlayer) const
+{
+	const quint8 code = m_store.m_result.at(index);
+	const Chess::Result result(code == OtherResult
+		? Chess::Result(QString::fromLatin1(m_store.m_strings.string(
+			int(m_store.m_otherResults.value(index)))))
+		: s_valueAt(m_results, code, Chess::Result()));
+
+	int winner = 0;
+	if (!result.winner().isNull())
+	{
+		if (whitePlayer == 1)
+			winner = result.winner() + 1;
+		else
+		{
+			if (result.winner() == Chess::Side::White)
+				winner = 2;
+			else
+				winner = 1;
+		}
+	}
+
+	bool ok;
+	switch (m_filter.result())
+	{
+	case PgnGameFilter::EitherPlayerWins:
+		ok = !result.winner().isNull();
+		break;
+	case PgnGameFilter::WhiteWins:
+		ok = result.winner() == Chess::Side::White;
+		break;
+	case PgnGameFilter::BlackWins:
+		ok = result.winner() == Chess::Side::Black;
+		break;
+	case PgnGameFilter::FirstPlayerWins:
+		ok = winner == 1;
+		break;
+	case PgnGameFilter::FirstPlayerLoses:
+		ok = winner == 2;
+		break;
+	case PgnGameFilter::Draw:
+		ok = result.isDraw();
+		break;
+	case PgnGameFilter::Unfinished:
+		ok = result.isNone();
+		break;
+	default:
+		ok = true;
+		break;
+	}
+
+	return ok != m_filter.isResultInverted();
+}
+
+void PgnGameEntryStore::Matcher::scanFixedString(int from, int count,
+						 quint8* state) const
+{
+	auto scan = [=](const Column<quint32>& column, const QVector<char>& match)
+	{
+		const quint32* ids = column.constData() + from;
+		for (int i = 0; i < count; i++)
+			state[i] |= quint8(s_valueAt(match, ids[i], char(0)));
+	};
+
+	scan(m_store.m_event, m_eventMatch);
+	scan(m_store.m_site, m_siteMatch);
+	scan(m_store.m_white, m_nameMatch);
+	scan(m_store.m_black, m_nameMatch);
+	scan(m_store.m_variant, m_variantMatch);
+
+	const quint8* results = m_store.m_result.constData() + from;
+	for (int i = 0; i < count; i++)
+	{
+		if (state[i])
+			continue;
+		if (results[i] != OtherResult)
+			state[i] = quint8(s_valueAt(m_resultMatch, results[i], char(0)));
+		else
+			state[i] = quint8(s_valueAt(m_stringMatch,
+				m_store.m_otherResults.value(from + i), char(0)));
+	}
+
+	const char* pattern = m_filter.pattern();
+	const quint32* dates = m_store.m_date.constData() + from;
+	const quint32* rounds = m_store.m_round.constData() + from;
+	for (int i = 0; i < count; i++)
+	{
+		if (state[i])
+			continue;
+
+		char buf[10];
+		if (dates[i] & s_stringFlag)
+			state[i] = quint8(s_valueAt(m_stringMatch,
+				dates[i] & ~s_stringFlag, char(0)));
+		else if (m_dateDigits)
+			state[i] = s_stringContains(buf, pattern,
+				s_formatDate(buf, dates[i])) != -1;
+		if (state[i])
+			continue;
+
+		if (rounds[i] & s_stringFlag)
+			state[i] = quint8(s_valueAt(m_stringMatch,
+				rounds[i] & ~s_stringFlag, char(0)));
+		else if (m_roundDigits)
+		{
+			const QByteArray round(QByteArray::number(rounds[i]));
+			state[i] = s_stringContains(round.constData(), pattern,
+						    round.size()) != -1;
+		}
+	}
+}
+
+void PgnGameEntryStore::Matcher::scanAdvanced(int from, int count,
+					      quint8* state) const
+{
+	// The state is 0 for rejected entries, 1 if the first player
+	// is white, and 2 if the first player is black
+	memset(state, 1, size_t(count));
+
+	if (!m_eventMatch.isEmpty())
+	{
+		const quint32* ids = m_store.m_event.constData() + from;
+		for (int i = 0; i < count; i++)
+		{
+			if (!s_valueAt(m_eventMatch, ids[i], char(0)))
+				state[i] = 0;
+		}
+	}
+
+	if (!m_siteMatch.isEmpty())
+	{
+		const quint32* ids = m_store.m_site.constData() + from;
+		for (int i = 0; i < count; i++)
+		{
+			if (!s_valueAt(m_siteMatch, ids[i], char(0)))
+				state[i] = 0;
+		}
+	}
+
+	if (!m_filter.minDate().isNull() || !m_filter.maxDate().isNull())
+	{
+		const quint32* dates = m_store.m_date.constData() + from;
+		for (int i = 0; i < count; i++)
+		{
+			if (!state[i])
+				continue;
+
+			const int key = dateKey(dates[i]);
+			if (key < 0
+			||  (m_minDateKey != 0 && key < m_minDateKey)
+			||  (m_maxDateKey != 0 && key > m_maxDateKey))
+				state[i] = 0;
+		}
+	}
+
+	if (m_filter.minRound() != 0 || m_filter.maxRound() != 0)
+	{
+		const quint32* rounds = m_store.m_round.constData() + from;
+		for (int i = 0; i < count; i++)
+		{
+			if (!state[i])
+				continue;
+
+			const int round = roundValue(rounds[i]);
+			if (round == 0
+			||  (m_filter.minRound() != 0 && round < m_filter.minRound())
+			||  (m_filter.maxRound() != 0 && round > m_filter.maxRound()))
+				state[i] = 0;
+		}
+	}
+
+	const Chess::Side side = m_filter.playerSide();
+	const quint32* whites = m_store.m_white.constData() + from;
+	const quint32* blacks = m_store.m_black.constData() + from;
+	for (int i = 0; i < count; i++)
+	{
+		if (!state[i])
+			continue;
+
+		int len1 = -1;
+		int len2 = -1;
+		const quint32 white = whites[i];
+		if (side != Chess::Side::Black)
+			len1 = s_valueAt(m_playerLength, white, -1);
+		if (side != Chess::Side::White)
+			len2 = s_valueAt(m_opponentLength, white, -1);
+		if (len1 == -1 && len2 == -1)
+		{
+			state[i] = 0;
+			continue;
+		}
+		const int whitePlayer = (len1 >= len2) ? 1 : 2;
+
+		len1 = -1;
+		len2 = -1;
+		const quint32 black = blacks[i];
+		if (side != Chess::Side::White && whitePlayer != 1)
+			len1 = s_valueAt(m_playerLength, black, -1);
+		if (side != Chess::Side::Black && whitePlayer != 2)
+			len2 = s_valueAt(m_opponentLength, black, -1);
+		state[i] = (len1 == -1 && len2 == -1) ? 0 : quint8(whitePlayer);
+	}
+
+	if (m_filter.result() != PgnGameFilter::AnyResult)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (state[i] && !matchResult(from + i, state[i]))
+				state[i] = 0;
+		}
+	}
+}
+
+QVector<int> PgnGameEntryStore::Matcher::filter(int from, int to) const
+{
+	QVector<int> indexes;
+	from = qMax(from, 0);
+	to = qMin(to, m_store.count());
+	if (from >= to)
+		return indexes;
+
+	const int count = to - from;
+	if (m_matchAll)
+	{
+		indexes.resize(count);
+		for (int i = 0; i < count; i++)
+			indexes[i] = from + i;
+		return indexes;
+	}
+
+	QVector<quint8> state(count, 0);
+	if (m_filter.type() == PgnGameFilter::FixedString)
+		scanFixedString(from, count, state.data());
+	else
+		scanAdvanced(from, count, state.data());
+
+	for (int i = 0; i < count; i++)
+	{
+		if (state.at(i))
+			indexes.append(from + i);
+	}
+
+	return indexes;
+}
@@ -0,0 +1,267 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PGNGAMEENTRYSTORE_H
+#define PGNGAMEENTRYSTORE_H
+
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <cstring>
+#include "pgngameentry.h"
+#include "pgngamefilter.h"
+class QFile;
+class QIODevice;
+
+/*!
+ * \brief A columnar collection of PGN game entries.
+ *
+ * PgnGameEntryStore keeps the entries of a large game collection in
+ * columns instead of separate PgnGameEntry objects. The player, event,
+ * site and variant names are interned into dictionaries and stored
+ * as integer IDs, and the dates, rounds and results are packed into
+ * integers. Values that can't be packed, eg. incomplete dates, are
+ * stored as IDs of a separate string dictionary.
+ *
+ * An entry takes about 50 bytes, and the filters are evaluated by
+ * scanning one column at a time. The string matching is done only
+ * once for each distinct string, not for each game.
+ *
+ * PgnGameEntryStore is implicitly shared, so copying it is cheap.
+ *
+ * A store can be saved with write() and opened again with map(), which
+ * memory-maps the columns instead of reading them. Opening a mapped
+ * store takes constant time, and the entries are paged in when they
+ * are accessed. A mapped store is copied to memory when it's modified.
+ *
+ * \sa PgnGameEntry, PgnGameFilter
+ */
+class LIB_EXPORT PgnGameEntryStore
+{
+	public:
+		class Matcher;
+
+		/*! Creates a new empty store. */
+		PgnGameEntryStore();
+
+		/*! Returns the number of entries. */
+		int count() const;
+		/*! Returns true if the store has no entries. */
+		bool isEmpty() const;
+		/*! Removes all entries. */
+		void clear();
+		/*! Reserves space for \a size entries. */
+		void reserve(int size);
+
+		/*! Appends \a entry to the store. */
+		void append(const PgnGameEntry& entry);
+		/*! Appends the entries of \a other to the store. */
+		void append(const PgnGameEntryStore& other);
+
+		/*! Returns a copy of the entry at \a index. */
+		PgnGameEntry entry(int index) const;
+		/*! Returns the stream position of the entry at \a index. */
+		qint64 pos(int index) const;
+		/*! Returns the line number of the entry at \a index. */
+		qint64 lineNumber(int index) const;
+		/*! Returns the tag value of type \a type of entry \a index. */
+		QString tagValue(int index, PgnGameEntry::TagType type) const;
+
+		/*!
+		 * Returns the indexes of the entries that match \a filter,
+		 * in ascending order.
+		 */
+		QVector<int> filter(const PgnGameFilter& filter) const;
+
+		/*!
+		 * Writes the store to \a device at its current position.
+		 * Returns true if successful; otherwise returns false.
+		 *
+		 * The data is written in the native byte order, and it
+		 * can be read only with map().
+		 */
+		bool write(QIODevice* device) const;
+		/*!
+		 * Maps a store written with write() from file \a fileName,
+		 * starting at \a offset.
+		 *
+		 * Returns true if successful; otherwise returns false and
+		 * leaves the store unchanged. If \a end isn't null, it is
+		 * set to the file position after the store.
+		 */
+		bool map(const QString& fileName,
+			 qint64 offset = 0,
+			 qint64* end = nullptr);
+		/*! Returns true if the store is backed by a mapped file. */
+		bool isMapped() const;
+
+	private:
+		/*! A column that is either in memory or in a mapped file. */
+		template <typename T>
+		class Column
+		{
+			public:
+				Column()
+					: m_data(nullptr), m_size(0), m_mapped(false) {}
+
+				int size() const
+				{ return m_mapped ? m_size : m_vector.size(); }
+				bool isEmpty() const
+				{ return size() == 0; }
+				const T* constData() const
+				{ return m_mapped ? m_data : m_vector.constData(); }
+				T at(int i) const
+				{ return constData()[i]; }
+				const T* begin() const
+				{ return constData(); }
+				const T* end() const
+				{ return constData() + size(); }
+
+				void map(const T* data, int size)
+				{
+					m_vector.clear();
+					m_data = data;
+					m_size = size;
+					m_mapped = true;
+				}
+				void reserve(int size)
+				{ detach(); m_vector.reserve(size); }
+				void append(T value)
+				{ detach(); m_vector.append(value); }
+				void append(const Column& other)
+				{
+					detach();
+					const int size = m_vector.size();
+					m_vector.resize(size + other.size());
+					if (!other.isEmpty())
+						memcpy(m_vector.data() + size, other.constData(),
+						       size_t(other.size()) * sizeof(T));
+				}
+
+			private:
+				void detach()
+				{
+					if (!m_mapped)
+						return;
+					m_vector.resize(m_size);
+					if (m_size > 0)
+						memcpy(m_vector.data(), m_data,
+						       size_t(m_size) * sizeof(T));
+					m_data = nullptr;
+					m_mapped = false;
+				}
+
+				QVector<T> m_vector;
+				const T* m_data;
+				int m_size;
+				bool m_mapped;
+		};
+
+		struct Dictionary
+		{
+			Dictionary();
+
+			int size() const;
+			QByteArray string(int id) const;
+			quint32 insert(const QByteArray& str);
+
+			QVector<QByteArray> strings;
+			QHash<QByteArray, quint32> ids;
+			// String offsets and data of a mapped dictionary
+			const quint32* mappedOffsets;
+			const char* mappedData;
+			int mappedSize;
+		};
+
+		QByteArray tagData(int index, PgnGameEntry::TagType type) const;
+		quint32 packDate(const QByteArray& date);
+		quint32 packRound(const QByteArray& round);
+		quint8 packResult(const QByteArray& result, int index);
+
+		Column<qint64> m_pos;
+		Column<qint64> m_lineNumber;
+		Column<quint32> m_event;
+		Column<quint32> m_site;
+		Column<quint32> m_white;
+		Column<quint32> m_black;
+		Column<quint32> m_date;
+		Column<quint32> m_round;
+		Column<quint32> m_variant;
+		Column<quint8> m_result;
+		QHash<int, quint32> m_otherResults;
+		QSharedPointer<QFile> m_file;
+
+		Dictionary m_events;
+		Dictionary m_sites;
+		Dictionary m_names;
+		Dictionary m_variants;
+		Dictionary m_strings;
+};
+
+/*!
+ * \brief A filter compiled for a PgnGameEntryStore.
+ *
+ * The constructor matches the filter's strings against
+ * the dictionaries of the store, so a Matcher can be used
+ * to scan parts of the store in separate threads.
+ */
+class LIB_EXPORT PgnGameEntryStore::Matcher
+{
+	public:
+		/*! Compiles \a filter for \a store. */
+		Matcher(const PgnGameEntryStore& store,
+			const PgnGameFilter& filter);
+
+		/*!
+		 * Returns the indexes of the entries in range
+		 * [\a from, \a to) that match the filter, in
+		 * ascending order.
+		 */
+		QVector<int> filter(int from, int to) const;
+
+	private:
+		void scanFixedString(int from, int count,
+				     quint8* state) const;
+		void scanAdvanced(int from, int count,
+				  quint8* state) const;
+		bool matchResult(int index, int whitePlayer) const;
+		int dateKey(quint32 date) const;
+		int roundValue(quint32 round) const;
+
+		PgnGameEntryStore m_store;
+		PgnGameFilter m_filter;
+		QVector<char> m_eventMatch;
+		QVector<char> m_siteMatch;
+		QVector<char> m_nameMatch;
+		QVector<char> m_variantMatch;
+		QVector<char> m_stringMatch;
+		QVector<char> m_resultMatch;
+		QVector<Chess::Result> m_results;
+		QVector<int> m_playerLength;
+		QVector<int> m_opponentLength;
+		QVector<int> m_stringDateKey;
+		QVector<int> m_stringRound;
+		int m_minDateKey;
+		int m_maxDateKey;
+		bool m_dateDigits;
+		bool m_roundDigits;
+		bool m_matchAll;
+};
+
+#endif // PGNGAMEENTRYSTORE_H
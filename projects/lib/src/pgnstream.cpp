@@ -20,6 +20,7 @@
 #include <cctype>
 #include <cstring>
 #include <QIODevice>
+#include <QFile>
 #include "board/boardfactory.h"
 
 namespace {
@@ -65,6 +66,10 @@ PgnStream::PgnStream(const QString& variant)
 	  m_tokenType(NoToken),
 	  m_device(nullptr),
 	  m_string(nullptr),
+	  m_mapFile(nullptr),
+	  m_data(nullptr),
+	  m_size(0),
+	  m_textMode(false),
 	  m_status(Ok),
 	  m_phase(OutOfGame)
 {
@@ -72,14 +77,16 @@ PgnStream::PgnStream(const QString& variant)
 }
 
 PgnStream::PgnStream(QIODevice* device, const QString& variant)
-	: m_board(nullptr)
+	: m_board(nullptr),
+	  m_mapFile(nullptr)
 {
 	setVariant(variant);
 	setDevice(device);
 }
 
 PgnStream::PgnStream(const QByteArray* string, const QString& variant)
-	: m_board(nullptr)
+	: m_board(nullptr),
+	  m_mapFile(nullptr)
 {
 	setVariant(variant);
 	setString(string);
@@ -87,6 +94,7 @@ PgnStream::PgnStream(const QByteArray* string, const QString& variant)
 
 PgnStream::~PgnStream()
 {
+	delete m_mapFile;
 	delete m_board;
 }
 
@@ -101,6 +109,11 @@ void PgnStream::reset()
 	m_tokenType = NoToken;
 	m_device = nullptr;
 	m_string = nullptr;
+	delete m_mapFile;
+	m_mapFile = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+	m_textMode = false;
 	m_status = Ok;
 	m_phase = OutOfGame;
 }
@@ -115,12 +128,49 @@ QIODevice* PgnStream::device() const
 	return m_device;
 }
 
-void PgnStream::setDevice(QIODevice* device)
+void PgnStream::setDevice(QIODevice* device, DeviceMode mode)
 {
 	Q_ASSERT(device != nullptr);
 
 	reset();
 	m_device = device;
+	if (mode == MappedDevice)
+		mapDevice();
+}
+
+PgnStream::DeviceMode PgnStream::deviceMode() const
+{
+	return m_data ? MappedDevice : BufferedDevice;
+}
+
+bool PgnStream::mapDevice()
+{
+	auto file = qobject_cast<QFile*>(m_device);
+	if (file == nullptr
+	||  !file->isOpen()
+	||  file->isSequential()
+	||  file->size() <= 0)
+		return false;
+
+	// Use a private handle so that the mapping outlives the device
+	m_mapFile = new QFile(file->fileName());
+	qint64 size = file->size();
+	uchar* data = nullptr;
+	if (m_mapFile->open(QIODevice::ReadOnly))
+		data = m_mapFile->map(0, size);
+	if (data == nullptr)
+	{
+		delete m_mapFile;
+		m_mapFile = nullptr;
+		return false;
+	}
+
+	m_data = reinterpret_cast<const char*>(data);
+	m_size = size;
+	m_pos = file->pos();
+	m_textMode = file->isTextModeEnabled();
+
+	return true;
 }
 
 const QByteArray* PgnStream::string() const
@@ -157,12 +207,12 @@ bool PgnStream::setVariant(const QString& variant)
 
 bool PgnStream::isOpen() const
 {
-	return (m_device && m_device->isOpen()) || m_string;
+	return m_data || (m_device && m_device->isOpen()) || m_string;
 }
 
 qint64 PgnStream::pos() const
 {
-	if (m_device)
+	if (m_device && !m_data)
 		return m_device->pos();
 	return m_pos;
 }
@@ -175,7 +225,20 @@ qint64 PgnStream::lineNumber() const
 char PgnStream::readChar()
 {
 	char c;
-	if (m_device)
+	if (m_data)
+	{
+		// Like QIODevice, skip carriage returns in text mode
+		do
+		{
+			if (m_pos >= m_size)
+			{
+				m_status = ReadPastEnd;
+				return 0;
+			}
+			c = m_data[m_pos++];
+		} while (c == '\r' && m_textMode);
+	}
+	else if (m_device)
 	{
 		if (!m_device->getChar(&m_lastChar))
 		{
@@ -210,7 +273,9 @@ void PgnStream::rewindChar()
 	Q_ASSERT(pos() > 0);
 
 	char c;
-	if (m_device)
+	if (m_data)
+		c = m_data[--m_pos];
+	else if (m_device)
 	{
 		c = m_lastChar;
 		m_device->ungetChar(m_lastChar);
@@ -231,7 +296,12 @@ bool PgnStream::seek(qint64 pos, qint64 lineNumber)
 		return false;
 
 	bool ok = false;
-	if (m_device)
+	if (m_data)
+	{
+		ok = pos <= m_size;
+		m_pos = pos;
+	}
+	else if (m_device)
 	{
 		ok = m_device->seek(pos);
 		m_pos = 0;
@@ -261,6 +331,33 @@ void PgnStream::parseUntil(const char* chars)
 {
 	Q_ASSERT(chars != nullptr);
 
+	if (m_data)
+	{
+		// Copy the token straight from the mapped data
+		qint64 start = m_pos;
+		while (m_pos < m_size)
+		{
+			char c = m_data[m_pos++];
+			if (c == '\r' && m_textMode)
+			{
+				m_tokenString.append(m_data + start, int(m_pos - start - 1));
+				start = m_pos;
+				continue;
+			}
+			if (c == '\n')
+				m_lineNumber++;
+			if (c == 0 || strchr(chars, c))
+			{
+				m_tokenString.append(m_data + start, int(m_pos - start - 1));
+				return;
+			}
+		}
+
+		m_tokenString.append(m_data + start, int(m_pos - start));
+		m_status = ReadPastEnd;
+		return;
+	}
+
 	char c;
 	while ((c = readChar()) != 0)
 	{
@@ -22,6 +22,7 @@
 #include <QtGlobal>
 #include <QString>
 class QIODevice;
+class QFile;
 namespace Chess { class Board; }
 
 
@@ -36,6 +37,10 @@ namespace Chess { class Board; }
  * be changed at any time, so it's possible to read PGN streams that
  * contain games of multiple variants.
  *
+ * By default a file device is mapped into memory and the games are
+ * parsed directly from the mapped data, which is much faster than
+ * reading the device one character at a time.
+ *
  * \sa PgnGame
  * \sa OpeningBook
  */
@@ -48,6 +53,17 @@ class LIB_EXPORT PgnStream
 			Ok,         //!< The stream is operating normally.
 			ReadPastEnd //!< The stream has read past the end of the data.
 		};
+		/*! The mode for reading from a device. */
+		enum DeviceMode
+		{
+			/*! The device is read through the QIODevice interface. */
+			BufferedDevice,
+			/*!
+			 * The device is mapped into memory if it's a file.
+			 * Other devices are read like in BufferedDevice mode.
+			 */
+			MappedDevice
+		};
 		/*! The type of a PGN token. */
 		enum TokenType
 		{
@@ -104,8 +120,22 @@ class LIB_EXPORT PgnStream
 
 		/*! Returns the assigned device, or 0 if no device is in use. */
 		QIODevice* device() const;
-		/*! Sets the current device to \a device. */
-		void setDevice(QIODevice* device);
+		/*!
+		 * Sets the current device to \a device, and reads it in
+		 * mode \a mode.
+		 *
+		 * In MappedDevice mode the stream starts at the device's
+		 * current position, but doesn't move it while reading. The
+		 * mapping stays valid even if the device is closed.
+		 */
+		void setDevice(QIODevice* device, DeviceMode mode = MappedDevice);
+		/*!
+		 * Returns the mode that the current device is read in.
+		 *
+		 * Returns MappedDevice only if the device was successfully
+		 * mapped into memory.
+		 */
+		DeviceMode deviceMode() const;
 
 		/*! Returns the assigned string, or 0 if no string is in use. */
 		const QByteArray* string() const;
@@ -200,6 +230,7 @@ class LIB_EXPORT PgnStream
 			InGame
 		};
 
+		bool mapDevice();
 		void parseUntil(const char* chars);
 		void parseTag();
 		void parseComment(char opBracket);
@@ -214,6 +245,10 @@ class LIB_EXPORT PgnStream
 		TokenType m_tokenType;
 		QIODevice* m_device;
 		const QByteArray* m_string;
+		QFile* m_mapFile;
+		const char* m_data;
+		qint64 m_size;
+		bool m_textMode;
 		Status m_status;
 		Phase m_phase;
 };
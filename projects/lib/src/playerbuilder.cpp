@@ -17,9 +17,27 @@
 */
 
 #include "playerbuilder.h"
+#include <atomic>
+
+namespace {
+
+quint64 nextBuilderId()
+{
+	static std::atomic<quint64> s_lastId(0);
+	return ++s_lastId;
+}
+
+} // anonymous namespace
 
 PlayerBuilder::PlayerBuilder(const QString& name)
-	: m_name(name)
+	: m_name(name),
+	  m_id(nextBuilderId())
+{
+}
+
+PlayerBuilder::PlayerBuilder(const PlayerBuilder& other)
+	: m_name(other.m_name),
+	  m_id(nextBuilderId())
 {
 }
 
@@ -27,6 +45,18 @@ PlayerBuilder::~PlayerBuilder()
 {
 }
 
+PlayerBuilder& PlayerBuilder::operator=(const PlayerBuilder& other)
+{
+	// The id stays with the object
+	m_name = other.m_name;
+	return *this;
+}
+
+quint64 PlayerBuilder::id() const
+{
+	return m_id;
+}
+
 QString PlayerBuilder::name() const
 {
 	return m_name;
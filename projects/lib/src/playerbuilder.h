@@ -40,14 +40,25 @@ class LIB_EXPORT PlayerBuilder
 	public:
 		/*! Creates a new player builder with name \a name. */
 		PlayerBuilder(const QString& name);
+		/*! Creates a copy of \a other with an id of its own. */
+		PlayerBuilder(const PlayerBuilder& other);
 		/*! Destroys the player builder. */
 		virtual ~PlayerBuilder();
+		/*! Copies the name of \a other but keeps the id. */
+		PlayerBuilder& operator=(const PlayerBuilder& other);
 
 		/*!
 		 * Returns true if the builder is for a human player;
 		 * otherwise returns false.
 		 */
 		virtual bool isHuman() const = 0;
+		/*!
+		 * Returns a number that identifies the builder.
+		 *
+		 * Unlike the builder's address, the id is never reused
+		 * by another builder.
+		 */
+		quint64 id() const;
 		/*! Returns the player's name. */
 		QString name() const;
 		/*! Sets the player's name to \a name. */
@@ -69,6 +80,7 @@ class LIB_EXPORT PlayerBuilder
 
 	private:
 		QString m_name;
+		quint64 m_id;
 };
 
 #endif // PLAYERBUILDER_H
@@ -18,6 +18,7 @@
 
 #include "polyglotbook.h"
 #include <QDataStream>
+#include <QtEndian>
 
 namespace {
 
@@ -77,6 +78,18 @@ OpeningBook::Entry PolyglotBook::readEntry(QDataStream& in, quint64* key) const
 	return { moveFromBits(pgMove), weight };
 }
 
+OpeningBook::Entry PolyglotBook::entryFromData(const uchar* data,
+						quint64* key) const
+{
+	// Entries are stored in big-endian order: an 8-byte key,
+	// a 2-byte move, a 2-byte weight and 4 bytes of learning data.
+	*key = qFromBigEndian<quint64>(data);
+	quint16 pgMove = qFromBigEndian<quint16>(data + 8);
+	quint16 weight = qFromBigEndian<quint16>(data + 10);
+
+	return { moveFromBits(pgMove), weight };
+}
+
 void PolyglotBook::writeEntry(const Map::const_iterator& it,
 			      QDataStream& out) const
 {
@@ -0,0 +1,438 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "positionindex.h"
+#include <QDataStream>
+#include <algorithm>
+#include <queue>
+#include <vector>
+#include "pgngame.h"
+
+namespace {
+
+// The number of keys per block
+const int s_blockSize = 64;
+
+void putVarint(QByteArray& out, quint64 value)
+{
+	while (value >= 0x80)
+	{
+		out.append(char((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.append(char(value));
+}
+
+inline bool getVarint(const char*& pos, const char* end, quint64& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && pos < end; shift += 7)
+	{
+		uchar c = uchar(*pos++);
+		value |= quint64(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return true;
+	}
+	return false;
+}
+
+} // anonymous namespace
+
+
+PositionIndex::Run::Run()
+	: keyCount(0),
+	  postingCount(0),
+	  gameOffset(0)
+{
+}
+
+PositionIndex::PositionIndex()
+{
+}
+
+bool PositionIndex::isEmpty() const
+{
+	return m_run.keyCount == 0;
+}
+
+int PositionIndex::positionCount() const
+{
+	return m_run.keyCount;
+}
+
+qint64 PositionIndex::postingCount() const
+{
+	return m_run.postingCount;
+}
+
+int PositionIndex::find(quint64 key, const char** pos, const char** end) const
+{
+	const QVector<quint64>& keys = m_run.blockKeys;
+	auto it = std::upper_bound(keys.constBegin(), keys.constEnd(), key);
+	if (it == keys.constBegin())
+		return -1;
+
+	const int block = int(it - keys.constBegin()) - 1;
+	const char* data = m_run.data.constData();
+	const char* p = data + m_run.blockOffsets.at(block);
+	const char* e = (block + 1 < keys.size())
+		? data + m_run.blockOffsets.at(block + 1)
+		: data + m_run.data.size();
+
+	quint64 current = keys.at(block);
+	quint64 value;
+	while (p < e)
+	{
+		quint64 count;
+		if (!getVarint(p, e, value) || !getVarint(p, e, count))
+			break;
+		current += value;
+
+		if (current == key)
+		{
+			*pos = p;
+			*end = e;
+			return int(count);
+		}
+		if (current > key)
+			break;
+
+		for (quint64 i = 0; i < count; i++)
+		{
+			if (!getVarint(p, e, value))
+				return -1;
+		}
+	}
+
+	return -1;
+}
+
+QVector<quint32> PositionIndex::games(quint64 key) const
+{
+	QVector<quint32> games;
+	const char* pos = nullptr;
+	const char* end = nullptr;
+	int count = find(key, &pos, &end);
+	if (count <= 0)
+		return games;
+
+	games.reserve(count);
+	quint64 game = 0;
+	quint64 delta;
+	for (int i = 0; i < count && getVarint(pos, end, delta); i++)
+	{
+		game += delta;
+		games.append(quint32(game) + m_run.gameOffset);
+	}
+
+	return games;
+}
+
+int PositionIndex::gameCount(quint64 key) const
+{
+	const char* pos = nullptr;
+	const char* end = nullptr;
+	return qMax(find(key, &pos, &end), 0);
+}
+
+void PositionIndex::write(QDataStream& out) const
+{
+	out << qint32(m_run.keyCount);
+	out << m_run.postingCount;
+	out << m_run.blockKeys;
+	out << m_run.blockOffsets;
+	out << m_run.data;
+}
+
+bool PositionIndex::read(QDataStream& in)
+{
+	Run run;
+	qint32 keyCount;
+	in >> keyCount;
+	in >> run.postingCount;
+	in >> run.blockKeys;
+	in >> run.blockOffsets;
+	in >> run.data;
+
+	run.keyCount = keyCount;
+	if (in.status() != QDataStream::Ok
+	||  run.blockKeys.size() != run.blockOffsets.size()
+	||  run.blockKeys.size() != (keyCount + s_blockSize - 1) / s_blockSize)
+		return false;
+
+	m_run = run;
+	return true;
+}
+
+
+class PositionIndexBuilder::RunWriter
+{
+	public:
+		RunWriter()
+			: m_key(0),
+			  m_prevKey(0),
+			  m_hasKey(false)
+		{
+		}
+
+		// The keys must be added in ascending order, and the
+		// games of each key in ascending order.
+		void add(quint64 key, quint32 game)
+		{
+			if (m_hasKey && key == m_key)
+			{
+				if (m_games.last() != game)
+					m_games.append(game);
+				return;
+			}
+
+			if (m_hasKey)
+				writeKey();
+			m_key = key;
+			m_hasKey = true;
+			m_games.clear();
+			m_games.append(game);
+		}
+
+		PositionIndex::Run finish()
+		{
+			if (m_hasKey)
+				writeKey();
+			m_hasKey = false;
+			return m_run;
+		}
+
+	private:
+		void writeKey()
+		{
+			if (m_run.keyCount % s_blockSize == 0)
+			{
+				m_run.blockKeys.append(m_key);
+				m_run.blockOffsets.append(quint32(m_run.data.size()));
+				m_prevKey = m_key;
+			}
+
+			putVarint(m_run.data, m_key - m_prevKey);
+			putVarint(m_run.data, quint64(m_games.size()));
+			quint32 prevGame = 0;
+			for (quint32 game : qAsConst(m_games))
+			{
+				putVarint(m_run.data, game - prevGame);
+				prevGame = game;
+			}
+
+			m_prevKey = m_key;
+			m_run.keyCount++;
+			m_run.postingCount += m_games.size();
+		}
+
+		PositionIndex::Run m_run;
+		QVector<quint32> m_games;
+		quint64 m_key;
+		quint64 m_prevKey;
+		bool m_hasKey;
+};
+
+class PositionIndexBuilder::RunReader
+{
+	public:
+		explicit RunReader(const PositionIndex::Run& run)
+			: m_run(run),
+			  m_pos(run.data.constData()),
+			  m_end(m_pos + run.data.size()),
+			  m_keyIndex(0),
+			  m_key(0),
+			  m_atEnd(false)
+		{
+			next();
+		}
+
+		bool atEnd() const
+		{
+			return m_atEnd;
+		}
+
+		quint64 key() const
+		{
+			return m_key;
+		}
+
+		const QVector<quint32>& games() const
+		{
+			return m_games;
+		}
+
+		void next()
+		{
+			if (m_keyIndex >= m_run.keyCount)
+			{
+				m_atEnd = true;
+				return;
+			}
+			if (m_keyIndex % s_blockSize == 0)
+				m_key = m_run.blockKeys.at(m_keyIndex / s_blockSize);
+
+			quint64 delta;
+			quint64 count;
+			if (!getVarint(m_pos, m_end, delta)
+			||  !getVarint(m_pos, m_end, count))
+			{
+				m_atEnd = true;
+				return;
+			}
+			m_key += delta;
+
+			m_games.resize(int(count));
+			quint64 game = 0;
+			for (int i = 0; i < m_games.size(); i++)
+			{
+				if (!getVarint(m_pos, m_end, delta))
+				{
+					m_atEnd = true;
+					return;
+				}
+				game += delta;
+				m_games[i] = quint32(game) + m_run.gameOffset;
+			}
+			m_keyIndex++;
+		}
+
+	private:
+		const PositionIndex::Run& m_run;
+		const char* m_pos;
+		const char* m_end;
+		int m_keyIndex;
+		quint64 m_key;
+		QVector<quint32> m_games;
+		bool m_atEnd;
+};
+
+
+PositionIndexBuilder::PositionIndexBuilder(int runSize)
+	: m_runSize(qMax(runSize, 1))
+{
+}
+
+void PositionIndexBuilder::addPosition(quint64 key, quint32 game)
+{
+	m_pending.append({key, game});
+	if (m_pending.size() >= m_runSize)
+		flush();
+}
+
+void PositionIndexBuilder::addGame(quint32 game, const PgnGame& pgn)
+{
+	const auto& moves = pgn.moves();
+	for (const PgnGame::MoveData& md : moves)
+	{
+		// Games read from a game archive have no keys
+		if (md.key != 0)
+			addPosition(md.key, game);
+	}
+}
+
+void PositionIndexBuilder::addIndex(PositionIndexBuilder& other,
+				     quint32 gameOffset)
+{
+	other.flush();
+	for (PositionIndex::Run& run : other.m_runs)
+	{
+		run.gameOffset += gameOffset;
+		m_runs.append(run);
+	}
+	other.m_runs.clear();
+}
+
+void PositionIndexBuilder::flush()
+{
+	if (m_pending.isEmpty())
+		return;
+
+	std::sort(m_pending.begin(), m_pending.end(),
+		  [](const Posting& a, const Posting& b)
+	{
+		return a.key < b.key || (a.key == b.key && a.game < b.game);
+	});
+
+	RunWriter writer;
+	for (const Posting& posting : qAsConst(m_pending))
+		writer.add(posting.key, posting.game);
+	m_runs.append(writer.finish());
+	m_pending.clear();
+}
+
+PositionIndex PositionIndexBuilder::build()
+{
+	flush();
+
+	PositionIndex index;
+	const QList<PositionIndex::Run> runs(m_runs);
+	m_runs.clear();
+
+	if (runs.size() == 1 && runs.first().gameOffset == 0)
+	{
+		index.m_run = runs.first();
+		return index;
+	}
+
+	// Merge the runs one key at a time, taking the readers with
+	// the smallest key from a min-heap
+	auto greaterKey = [](const RunReader* a, const RunReader* b)
+	{
+		return a->key() > b->key();
+	};
+	std::priority_queue<RunReader*, std::vector<RunReader*>,
+			    decltype(greaterKey)> heap(greaterKey);
+	QList<RunReader*> readers;
+	for (const PositionIndex::Run& run : runs)
+	{
+		RunReader* reader = new RunReader(run);
+		readers.append(reader);
+		if (!reader->atEnd())
+			heap.push(reader);
+	}
+
+	RunWriter writer;
+	QVector<quint32> games;
+	while (!heap.empty())
+	{
+		const quint64 key = heap.top()->key();
+
+		games.clear();
+		int sources = 0;
+		while (!heap.empty() && heap.top()->key() == key)
+		{
+			RunReader* reader = heap.top();
+			heap.pop();
+			games += reader->games();
+			reader->next();
+			if (!reader->atEnd())
+				heap.push(reader);
+			sources++;
+		}
+		if (sources > 1)
+			std::sort(games.begin(), games.end());
+
+		for (quint32 game : qAsConst(games))
+			writer.add(key, game);
+	}
+	qDeleteAll(readers);
+
+	index.m_run = writer.finish();
+	return index;
+}
@@ -0,0 +1,153 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POSITIONINDEX_H
+#define POSITIONINDEX_H
+
+#include <QVector>
+#include <QByteArray>
+#include <QList>
+class QDataStream;
+class PgnGame;
+
+/*!
+ * \brief An index of the positions reached in a game collection
+ *
+ * PositionIndex maps zobrist position keys (Chess::Board::key()) to
+ * the games where the position occurred. The games are identified by
+ * their index in the collection, eg. in a PGN database.
+ *
+ * The postings are stored in a compressed sorted run: the keys are
+ * sorted and delta-coded in blocks of 64 keys, and the game numbers
+ * of each key are delta-coded too. Only the first key of each block
+ * is kept uncompressed, so a lookup is a binary search followed by
+ * decoding a single block.
+ *
+ * PositionIndex objects are created with PositionIndexBuilder.
+ *
+ * \sa PositionIndexBuilder
+ */
+class LIB_EXPORT PositionIndex
+{
+	public:
+		/*! Creates a new empty index. */
+		PositionIndex();
+
+		/*! Returns true if the index has no positions. */
+		bool isEmpty() const;
+		/*! Returns the number of distinct positions. */
+		int positionCount() const;
+		/*! Returns the total number of (position, game) pairs. */
+		qint64 postingCount() const;
+
+		/*!
+		 * Returns the games where the position with zobrist key
+		 * \a key occurred, in ascending order.
+		 */
+		QVector<quint32> games(quint64 key) const;
+		/*!
+		 * Returns the number of games where the position with
+		 * zobrist key \a key occurred.
+		 *
+		 * This is faster than calling games() for the count.
+		 */
+		int gameCount(quint64 key) const;
+
+		/*! Writes the index to data stream \a out. */
+		void write(QDataStream& out) const;
+		/*!
+		 * Reads the index from data stream \a in.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool read(QDataStream& in);
+
+	private:
+		friend class PositionIndexBuilder;
+
+		struct Run
+		{
+			Run();
+
+			QVector<quint64> blockKeys;
+			QVector<quint32> blockOffsets;
+			QByteArray data;
+			int keyCount;
+			qint64 postingCount;
+			quint32 gameOffset;
+		};
+
+		int find(quint64 key, const char** pos, const char** end) const;
+
+		Run m_run;
+};
+
+/*!
+ * \brief A class for building a PositionIndex
+ *
+ * The positions are collected into a buffer, which is sorted and
+ * compressed into a run whenever it gets full. build() merges the
+ * runs into the final index, so the memory use stays low even for
+ * millions of games.
+ *
+ * \sa PositionIndex
+ */
+class LIB_EXPORT PositionIndexBuilder
+{
+	public:
+		/*!
+		 * Creates a new builder that compresses its buffer after
+		 * every \a runSize positions.
+		 */
+		explicit PositionIndexBuilder(int runSize = 1 << 22);
+
+		/*! Adds position \a key of game number \a game. */
+		void addPosition(quint64 key, quint32 game);
+		/*!
+		 * Adds the positions before each move of \a pgn as
+		 * game number \a game.
+		 */
+		void addGame(quint32 game, const PgnGame& pgn);
+		/*!
+		 * Moves the positions of \a other to this builder, adding
+		 * \a gameOffset to their game numbers.
+		 *
+		 * This can be used to merge the indexes of a collection
+		 * that was read in parts.
+		 */
+		void addIndex(PositionIndexBuilder& other, quint32 gameOffset);
+
+		/*! Builds the index and resets the builder. */
+		PositionIndex build();
+
+	private:
+		struct Posting
+		{
+			quint64 key;
+			quint32 game;
+		};
+		class RunWriter;
+		class RunReader;
+
+		void flush();
+
+		int m_runSize;
+		QVector<Posting> m_pending;
+		QList<PositionIndex::Run> m_runs;
+};
+
+#endif // POSITIONINDEX_H
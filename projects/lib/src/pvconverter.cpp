@@ -0,0 +1,152 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pvconverter.h"
+#include <QStringList>
+#include <QMutexLocker>
+#include "board/board.h"
+
+namespace {
+
+// The cache is cleared when it reaches this size. Engines rarely
+// send PVs longer than a few dozen moves, so this keeps the cache
+// for thousands of info lines.
+const int s_maxCacheSize = 0x4000;
+
+} // anonymous namespace
+
+PvConverter::PvConverter(const Chess::Board* board)
+	: m_board(board->copy()),
+	  m_engineId(0)
+{
+	Q_ASSERT(board != nullptr);
+}
+
+PvConverter::~PvConverter()
+{
+	delete m_board;
+}
+
+QString PvConverter::variant() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_board->variant();
+}
+
+void PvConverter::setEngine(const QString& name, int id)
+{
+	QMutexLocker locker(&m_mutex);
+	m_engineName = name;
+	m_engineId = id;
+}
+
+bool PvConverter::setPosition(const QString& startFen, const QString& moves)
+{
+	// Play only the moves that were made since the last call if
+	// possible. Otherwise start over from the starting position.
+	if (startFen != m_startFen
+	||  !moves.startsWith(m_moves)
+	||  (moves.size() > m_moves.size() && moves.at(m_moves.size()) != ' '))
+	{
+		m_moves.clear();
+		m_startFen.clear();
+		if (!m_board->setFenString(startFen))
+		{
+			qWarning("Invalid FEN string for PV conversion: %s",
+				 qUtf8Printable(startFen));
+			return false;
+		}
+		m_startFen = startFen;
+	}
+
+	const QStringList newMoves(moves.mid(m_moves.size())
+				   .split(' ', Qt::SkipEmptyParts));
+	for (const QString& moveString : newMoves)
+	{
+		Chess::Move move = m_board->moveFromString(moveString);
+		if (move.isNull())
+		{
+			qWarning("Illegal move for PV conversion from %s (%d): %s",
+				 qUtf8Printable(m_engineName),
+				 m_engineId,
+				 qUtf8Printable(moveString));
+			m_startFen.clear();
+			m_moves.clear();
+			return false;
+		}
+		m_board->makeMove(move);
+	}
+	m_moves = moves;
+
+	return true;
+}
+
+QString PvConverter::sanPv(const QString& startFen,
+			   const QString& moves,
+			   const QString& pv)
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (!setPosition(startFen, moves))
+		return QString();
+
+	QString san;
+	int movesMade = 0;
+	const QStringList tokens(pv.split(' ', Qt::SkipEmptyParts));
+
+	for (const QString& token : tokens)
+	{
+		CacheKey key(m_board->key(), token);
+		auto it = m_cache.constFind(key);
+		if (it == m_cache.constEnd())
+		{
+			Chess::Move move = m_board->moveFromString(token);
+			if (move.isNull())
+			{
+				qWarning("Illegal PV move %s from %s (%d)",
+					 qUtf8Printable(token),
+					 qUtf8Printable(m_engineName),
+					 m_engineId);
+				qWarning("PV: %s %s",
+					 qUtf8Printable(san),
+					 qUtf8Printable(token));
+				break;
+			}
+
+			if (m_cache.size() >= s_maxCacheSize)
+				m_cache.clear();
+			CacheEntry entry =
+			{
+				move,
+				m_board->moveString(move, Chess::Board::StandardAlgebraic)
+			};
+			it = m_cache.insert(key, entry);
+		}
+
+		if (!san.isEmpty())
+			san += ' ';
+		san += it->san;
+		m_board->makeMove(it->move);
+		movesMade++;
+	}
+
+	for (int i = 0; i < movesMade; i++)
+		m_board->undoMove();
+
+	return san;
+}
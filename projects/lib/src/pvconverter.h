@@ -0,0 +1,100 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PVCONVERTER_H
+#define PVCONVERTER_H
+
+#include <QString>
+#include <QHash>
+#include <QPair>
+#include <QMutex>
+#include "board/move.h"
+namespace Chess { class Board; }
+
+/*!
+ * \brief Converts principal variations into Standard Algebraic Notation
+ *
+ * Engines send their principal variations in long algebraic notation.
+ * Converting them into SAN is expensive because SAN needs legal move
+ * generation for disambiguation and check marks, so it's only done
+ * when the PV is actually displayed.
+ *
+ * PvConverter keeps its own copy of the game board in sync with the
+ * game, and remembers the SAN strings of recently converted moves by
+ * position key. Successive PVs usually share most of their moves, so
+ * most moves are found in the cache.
+ *
+ * \note All public functions are thread-safe.
+ * \sa MoveEvaluation::pv()
+ */
+class LIB_EXPORT PvConverter
+{
+	public:
+		/*!
+		 * Creates a new PvConverter for the variant of \a board.
+		 *
+		 * The converter uses its own copy of \a board, so \a board
+		 * can change or be deleted afterwards.
+		 */
+		explicit PvConverter(const Chess::Board* board);
+		/*! Destroys the converter. */
+		~PvConverter();
+
+		/*! Returns the name of the converter's chess variant. */
+		QString variant() const;
+		/*!
+		 * Sets the name and id of the engine whose PVs are
+		 * converted. They're used in warnings about illegal moves.
+		 */
+		void setEngine(const QString& name, int id);
+
+		/*!
+		 * Converts \a pv into SAN.
+		 *
+		 * \a pv is a space-separated list of moves in long algebraic
+		 * notation, played from the position reached by playing
+		 * \a moves from \a startFen. \a moves has the same format as
+		 * \a pv.
+		 *
+		 * Conversion stops at the first illegal move. Returns an empty
+		 * string if the starting position is invalid.
+		 */
+		QString sanPv(const QString& startFen,
+			      const QString& moves,
+			      const QString& pv);
+
+	private:
+		struct CacheEntry
+		{
+			Chess::Move move;
+			QString san;
+		};
+		typedef QPair<quint64, QString> CacheKey;
+
+		bool setPosition(const QString& startFen, const QString& moves);
+
+		mutable QMutex m_mutex;
+		Chess::Board* m_board;
+		QString m_startFen;
+		QString m_moves;
+		QString m_engineName;
+		int m_engineId;
+		QHash<CacheKey, CacheEntry> m_cache;
+};
+
+#endif // PVCONVERTER_H
@@ -65,3 +65,24 @@ TournamentPair* PyramidTournament::nextPair(int gameNumber)
 
 	return pair(white, black);
 }
+
+QVariant PyramidTournament::pairingState() const
+{
+	QVariantMap map;
+	map["pairNumber"] = m_pairNumber;
+	map["currentPlayer"] = m_currentPlayer;
+
+	return map;
+}
+
+bool PyramidTournament::setPairingState(const QVariant& state)
+{
+	const QVariantMap map = state.toMap();
+	if (!map.contains("pairNumber") || !map.contains("currentPlayer"))
+		return false;
+
+	m_pairNumber = map.value("pairNumber").toInt();
+	m_currentPlayer = map.value("currentPlayer").toInt();
+
+	return true;
+}
@@ -44,6 +44,8 @@ class LIB_EXPORT PyramidTournament : public Tournament
 		virtual void initializePairing();
 		virtual int gamesPerCycle() const;
 		virtual TournamentPair* nextPair(int gameNumber);
+		virtual QVariant pairingState() const;
+		virtual bool setPairingState(const QVariant& state);
 
 	private:
 		int m_pairNumber;
@@ -79,3 +79,39 @@ TournamentPair* RoundRobinTournament::nextPair(int gameNumber)
 	else
 		return nextPair(gameNumber);
 }
+
+QVariant RoundRobinTournament::pairingState() const
+{
+	QVariantList topHalf;
+	for (int player : m_topHalf)
+		topHalf << player;
+	QVariantList bottomHalf;
+	for (int player : m_bottomHalf)
+		bottomHalf << player;
+
+	QVariantMap map;
+	map["pairNumber"] = m_pairNumber;
+	map["topHalf"] = topHalf;
+	map["bottomHalf"] = bottomHalf;
+
+	return map;
+}
+
+bool RoundRobinTournament::setPairingState(const QVariant& state)
+{
+	const QVariantMap map = state.toMap();
+	const QVariantList topHalf = map.value("topHalf").toList();
+	const QVariantList bottomHalf = map.value("bottomHalf").toList();
+	if (topHalf.size() != m_topHalf.size()
+	||  bottomHalf.size() != m_bottomHalf.size())
+		return false;
+
+	for (int i = 0; i < topHalf.size(); i++)
+	{
+		m_topHalf[i] = topHalf.at(i).toInt();
+		m_bottomHalf[i] = bottomHalf.at(i).toInt();
+	}
+	m_pairNumber = map.value("pairNumber").toInt();
+
+	return true;
+}
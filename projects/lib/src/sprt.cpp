@@ -130,15 +130,79 @@ double SprtProbability::pDraw() const
 }
 
 
+/*
+ * Returns the log-likelihood ratio of a generalized SPRT for the score
+ * distribution given by \a scores and \a counts. The LLR is approximated
+ * from the sample's mean and variance, which are only assumed to be
+ * asymptotically normal.
+ */
+static double gsprtLlr(const double* scores,
+		       const int* counts,
+		       int size,
+		       bool pentanomial,
+		       Sprt::EloModel model,
+		       double elo0,
+		       double elo1)
+{
+	int games = 0;
+	for (int i = 0; i < size; i++)
+		games += counts[i];
+	if (games <= 0)
+		return 0.0;
+
+	// Empty classes get a tiny count to keep the variance positive
+	double n = 0.0;
+	double mu = 0.0;
+	for (int i = 0; i < size; i++)
+	{
+		const double count = counts[i] > 0 ? counts[i] : 1e-3;
+		n += count;
+		mu += count * scores[i];
+	}
+	mu /= n;
+
+	double var = 0.0;
+	for (int i = 0; i < size; i++)
+	{
+		const double count = counts[i] > 0 ? counts[i] : 1e-3;
+		var += count * (scores[i] - mu) * (scores[i] - mu);
+	}
+	var /= n;
+
+	// Expected scores under H0 and H1
+	double s0;
+	double s1;
+	if (model == Sprt::NormalizedElo)
+	{
+		// The per-game standard deviation of a pair's average
+		// score is sqrt(2) times the deviation of the average
+		const double sigma = std::sqrt(pentanomial ? 2.0 * var : var);
+		const double scale = 800.0 / std::log(10.0);
+		s0 = 0.5 + elo0 / scale * sigma;
+		s1 = 0.5 + elo1 / scale * sigma;
+	}
+	else
+	{
+		s0 = 1.0 / (1.0 + std::pow(10.0, -elo0 / 400.0));
+		s1 = 1.0 / (1.0 + std::pow(10.0, -elo1 / 400.0));
+	}
+
+	return n * (s1 - s0) * (2.0 * mu - s0 - s1) / (2.0 * var);
+}
+
+
 Sprt::Sprt()
 	: m_elo0(0),
 	  m_elo1(0),
 	  m_alpha(0),
 	  m_beta(0),
+	  m_model(BayesianElo),
 	  m_wins(0),
 	  m_losses(0),
 	  m_draws(0)
 {
+	for (int i = 0; i < 5; i++)
+		m_pairs[i] = 0;
 }
 
 bool Sprt::isNull() const
@@ -147,12 +211,19 @@ bool Sprt::isNull() const
 }
 
 void Sprt::initialize(double elo0, double elo1,
-		      double alpha, double beta)
+		      double alpha, double beta,
+		      EloModel model)
 {
 	m_elo0 = elo0;
 	m_elo1 = elo1;
 	m_alpha = alpha;
 	m_beta = beta;
+	m_model = model;
+}
+
+Sprt::EloModel Sprt::eloModel() const
+{
+	return m_model;
 }
 
 Sprt::Status Sprt::status() const
@@ -167,27 +238,43 @@ Sprt::Status Sprt::status() const
 	if (m_wins < 0 || m_losses < 0 || m_draws < 0)
 		return status;
 
-	// We add half a point to each class to regularize the model parameters.
-	// This corresponds to a Dirichlet(0.5, 0.5, 0.5) prior distribution,
-	// which is a Jeffreys' prior for the trinomial distribution:
-	const double wins = m_wins + 0.5;
-	const double losses = m_losses + 0.5;
-	const double draws = m_draws + 0.5;
-
-	// Estimate draw_elo out of sample
-	const SprtProbability p(wins, losses, draws);
-	const BayesElo b(p);
-
-	// Probability laws under H0 and H1
-	const double s = b.scale();
-	const BayesElo b0(m_elo0 / s, b.drawElo());
-	const BayesElo b1(m_elo1 / s, b.drawElo());
-	const SprtProbability p0(b0), p1(b1);
-
-	// Log-Likelyhood Ratio
-	status.llr = wins * std::log(p1.pWin() / p0.pWin()) +
-		     losses * std::log(p1.pLoss() / p0.pLoss()) +
-		     draws * std::log(p1.pDraw() / p0.pDraw());
+	if (m_model == BayesianElo)
+	{
+		// We add half a point to each class to regularize the model parameters.
+		// This corresponds to a Dirichlet(0.5, 0.5, 0.5) prior distribution,
+		// which is a Jeffreys' prior for the trinomial distribution:
+		const double wins = m_wins + 0.5;
+		const double losses = m_losses + 0.5;
+		const double draws = m_draws + 0.5;
+
+		// Estimate draw_elo out of sample
+		const SprtProbability p(wins, losses, draws);
+		const BayesElo b(p);
+
+		// Probability laws under H0 and H1
+		const double s = b.scale();
+		const BayesElo b0(m_elo0 / s, b.drawElo());
+		const BayesElo b1(m_elo1 / s, b.drawElo());
+		const SprtProbability p0(b0), p1(b1);
+
+		// Log-Likelyhood Ratio
+		status.llr = wins * std::log(p1.pWin() / p0.pWin()) +
+			     losses * std::log(p1.pLoss() / p0.pLoss()) +
+			     draws * std::log(p1.pDraw() / p0.pDraw());
+	}
+	else if (m_pairs[0] + m_pairs[1] + m_pairs[2] + m_pairs[3] + m_pairs[4] > 0)
+	{
+		static const double scores[] = { 0.0, 0.25, 0.5, 0.75, 1.0 };
+		status.llr = gsprtLlr(scores, m_pairs, 5, true,
+				      m_model, m_elo0, m_elo1);
+	}
+	else
+	{
+		static const double scores[] = { 0.0, 0.5, 1.0 };
+		const int counts[] = { m_losses, m_draws, m_wins };
+		status.llr = gsprtLlr(scores, counts, 3, false,
+				      m_model, m_elo0, m_elo1);
+	}
 
 	// Bounds based on error levels of the test
 	status.lBound = std::log(m_beta / (1.0 - m_alpha));
@@ -210,3 +297,43 @@ void Sprt::addGameResult(GameResult result)
 	else if (result == Loss)
 		m_losses++;
 }
+
+void Sprt::addGamePairResult(GameResult first, GameResult second)
+{
+	if (first == NoResult || second == NoResult)
+		return;
+
+	// The pair's score in points is also its index: LL, LD, DD/WL, WD, WW
+	auto points = [](GameResult result)
+	{
+		return result == Win ? 2 : (result == Draw ? 1 : 0);
+	};
+	m_pairs[points(first) + points(second)]++;
+}
+
+QVariant Sprt::statistics() const
+{
+	QVariantList pairs;
+	for (int count : m_pairs)
+		pairs << count;
+
+	QVariantMap map;
+	map["wins"] = m_wins;
+	map["losses"] = m_losses;
+	map["draws"] = m_draws;
+	map["pairs"] = pairs;
+
+	return map;
+}
+
+void Sprt::setStatistics(const QVariant& statistics)
+{
+	const QVariantMap map = statistics.toMap();
+	m_wins = map.value("wins").toInt();
+	m_losses = map.value("losses").toInt();
+	m_draws = map.value("draws").toInt();
+
+	const QVariantList pairs = map.value("pairs").toList();
+	for (int i = 0; i < 5; i++)
+		m_pairs[i] = pairs.value(i).toInt();
+}
@@ -19,6 +19,8 @@
 #ifndef SPRT_H
 #define SPRT_H
 
+#include <QVariant>
+
 /*!
  * \brief A Sequential Probability Ratio Test
  *
@@ -27,6 +29,14 @@
  * players when the Elo difference is known to be outside of the specified
  * interval.
  *
+ * By default the hypotheses are expressed in BayesElo and the test is
+ * based on the trinomial (win/draw/loss) distribution of single games.
+ * With the logistic and normalized Elo models the test is a generalized
+ * SPRT (GSPRT). If game pairs played from the same opening are reported
+ * with addGamePairResult(), these models use the pentanomial
+ * distribution of the pair scores (LL, LD, DD/WL, WD, WW), which
+ * accounts for the correlation between the games of a pair.
+ *
  * \sa http://en.wikipedia.org/wiki/Sequential_probability_ratio_test
  */
 class LIB_EXPORT Sprt
@@ -49,6 +59,14 @@ class LIB_EXPORT Sprt
 			Draw		//!< Game was drawn
 		};
 
+		/*! The Elo model of the hypotheses. */
+		enum EloModel
+		{
+			BayesianElo,	//!< BayesElo with an estimated draw Elo
+			LogisticElo,	//!< Logistic Elo (expected score)
+			NormalizedElo	//!< Elo normalized by the score's deviation
+		};
+
 		/*! The status of the test. */
 		struct Status
 		{
@@ -75,9 +93,14 @@ class LIB_EXPORT Sprt
 		 *
 		 * \a alpha is the maximum probability for a type I error and
 		 * \a beta for a type II error outside interval [elo0, elo1].
+		 *
+		 * \a model is the Elo model of \a elo0 and \a elo1.
 		 */
 		void initialize(double elo0, double elo1,
-				double alpha, double beta);
+				double alpha, double beta,
+				EloModel model = BayesianElo);
+		/*! Returns the Elo model of the hypotheses. */
+		EloModel eloModel() const;
 		/*! Returns the current status of the test. */
 		Status status() const;
 		/*!
@@ -87,15 +110,37 @@ class LIB_EXPORT Sprt
 		 * check if H0 or H1 can be accepted.
 		 */
 		void addGameResult(GameResult result);
+		/*!
+		 * Updates the pentanomial statistics with the results of
+		 * a game pair, \a first and \a second, played from the
+		 * same opening.
+		 *
+		 * The games of the pair must also be reported with
+		 * addGameResult(). The pair is ignored if either game
+		 * has no result. With the BayesianElo model the test
+		 * doesn't use the pair statistics.
+		 */
+		void addGamePairResult(GameResult first, GameResult second);
+		/*!
+		 * Returns the game and game pair counts of the test
+		 * as a variant.
+		 *
+		 * \sa setStatistics()
+		 */
+		QVariant statistics() const;
+		/*! Restores the game and game pair counts from \a statistics. */
+		void setStatistics(const QVariant& statistics);
 
 	private:
 		double m_elo0;
 		double m_elo1;
 		double m_alpha;
 		double m_beta;
+		EloModel m_model;
 		int m_wins;
 		int m_losses;
 		int m_draws;
+		int m_pairs[5];
 };
 
 #endif // SPRT_H
@@ -17,7 +17,7 @@
 
 
 #include "tournament.h"
-#include <QFile>
+#include <QTextStream>
 #include <QMultiMap>
 #include <QSet>
 #include "gamemanager.h"
@@ -26,8 +26,11 @@
 #include "chessplayer.h"
 #include "chessgame.h"
 #include "pgnstream.h"
+#include "gamearchive.h"
 #include "openingsuite.h"
 #include "openingbook.h"
+#include "tournamentjournal.h"
+#include "mersenne.h"
 #include "sprt.h"
 #include "elo.h"
 
@@ -57,13 +60,18 @@ Tournament::Tournament(GameManager* gameManager, QObject *parent)
 	  m_finished(false),
 	  m_bookOwnership(false),
 	  m_openingSuite(nullptr),
+	  m_journal(nullptr),
+	  m_journaledGameCount(0),
+	  m_checkpointGameCount(0),
 	  m_sprt(new Sprt),
 	  m_repetitionCounter(0),
+	  m_gamePairCount(0),
 	  m_swapSides(true),
 	  m_reverseSides(false),
 	  m_resultFormat(c_defaultFormat),
 	  m_pgnOutMode(PgnGame::Verbose),
-	  m_pair(nullptr)
+	  m_pair(nullptr),
+	  m_pentanomial(5, 0)
 {
 	Q_ASSERT(gameManager != nullptr);
 
@@ -120,6 +128,7 @@ Tournament::~Tournament()
 	for (const TournamentPlayer& player : qAsConst(m_players))
 	{
 		books.insert(player.book());
+		m_gameManager->purgePlayerPool(player.builder());
 		delete player.builder();
 	}
 
@@ -127,13 +136,8 @@ Tournament::~Tournament()
 		qDeleteAll(books);
 
 	delete m_openingSuite;
+	delete m_journal;
 	delete m_sprt;
-
-	if (m_pgnFile.isOpen())
-		m_pgnFile.close();
-
-	if (m_epdFile.isOpen())
-		m_epdFile.close();
 }
 
 GameManager* Tournament::gameManager() const
@@ -141,6 +145,11 @@ GameManager* Tournament::gameManager() const
 	return m_gameManager;
 }
 
+const MatchMetrics& Tournament::metrics() const
+{
+	return m_metrics;
+}
+
 bool Tournament::isFinished() const
 {
 	return m_finished;
@@ -278,6 +287,12 @@ void Tournament::setOpeningSuite(OpeningSuite *suite)
 	m_openingSuite = suite;
 }
 
+void Tournament::setJournal(TournamentJournal* journal)
+{
+	delete m_journal;
+	m_journal = journal;
+}
+
 void Tournament::setOpeningDepth(int plies)
 {
 	m_openingDepth = plies;
@@ -320,11 +335,7 @@ const QMap<QString,QString>& Tournament::resultFieldGroups() const
 
 void Tournament::setPgnOutput(const QString& fileName, PgnGame::PgnMode mode)
 {
-	if (fileName != m_pgnFile.fileName())
-	{
-		m_pgnFile.close();
-		m_pgnFile.setFileName(fileName);
-	}
+	m_pgnWriter.setFileName(fileName);
 	m_pgnOutMode = mode;
 }
 
@@ -340,11 +351,41 @@ void Tournament::setPgnCleanupEnabled(bool enabled)
 
 void Tournament::setEpdOutput(const QString& fileName)
 {
-	if (fileName != m_epdFile.fileName())
-	{
-		m_epdFile.close();
-		m_epdFile.setFileName(fileName);
-	}
+	m_epdWriter.setFileName(fileName);
+}
+
+void Tournament::setGameOutput(const QString& fileName)
+{
+	m_gameWriter.setFileName(fileName);
+	m_gameWriter.setFileHeader(GameArchiveWriter::fileHeader());
+}
+
+void Tournament::setOutputBatch(int games, int msecs)
+{
+	m_pgnWriter.setBatch(games, msecs);
+	m_epdWriter.setBatch(games, msecs);
+	m_gameWriter.setBatch(games, msecs);
+}
+
+void Tournament::setOutputQueueLimit(int limit)
+{
+	m_pgnWriter.setQueueLimit(limit);
+	m_epdWriter.setQueueLimit(limit);
+	m_gameWriter.setQueueLimit(limit);
+}
+
+void Tournament::setOutputSyncPolicy(OutputWriter::SyncPolicy policy)
+{
+	m_pgnWriter.setSyncPolicy(policy);
+	m_epdWriter.setSyncPolicy(policy);
+	m_gameWriter.setSyncPolicy(policy);
+}
+
+qint64 Tournament::outputBacklog() const
+{
+	return m_pgnWriter.backlog()
+	     + m_epdWriter.backlog()
+	     + m_gameWriter.backlog();
 }
 
 void Tournament::setOpeningRepetitions(int count)
@@ -415,6 +456,17 @@ bool Tournament::hasGauntletRatingsOrder() const
 	return false;
 }
 
+QVariant Tournament::pairingState() const
+{
+	return QVariant();
+}
+
+bool Tournament::setPairingState(const QVariant& state)
+{
+	Q_UNUSED(state);
+	return true;
+}
+
 void Tournament::startGame(TournamentPair* pair)
 {
 	Q_ASSERT(pair->isValid());
@@ -427,6 +479,7 @@ void Tournament::startGame(TournamentPair* pair)
 	Chess::Board* board = Chess::BoardFactory::create(m_variant);
 	Q_ASSERT(board != nullptr);
 	ChessGame* game = new ChessGame(board, new PgnGame());
+	game->setMetrics(&m_metrics);
 
 	connect(game, SIGNAL(started(ChessGame*)),
 		this, SLOT(onGameStarted(ChessGame*)));
@@ -482,8 +535,19 @@ void Tournament::startGame(TournamentPair* pair)
 	data->number = ++m_nextGameNumber;
 	data->whiteIndex = m_pair->firstPlayer();
 	data->blackIndex = m_pair->secondPlayer();
+	data->pairNumber = 0;
 	m_gameData[game] = data;
 
+	// In two-player events consecutive games from the same opening
+	// are paired for the pentanomial statistics
+	if (m_players.size() == 2)
+	{
+		if (m_repetitionCounter % 2 == 0)
+			data->pairNumber = m_gamePairCount;
+		else if (m_repetitionCounter < m_openingRepetitions)
+			data->pairNumber = ++m_gamePairCount;
+	}
+
 	// Some tournament types may require more games than expected
 	if (m_nextGameNumber > m_finalGameCount)
 		m_finalGameCount = m_nextGameNumber;
@@ -493,6 +557,12 @@ void Tournament::startGame(TournamentPair* pair)
 	if (m_swapSides)
 		m_pair->swapPlayers();
 
+	// The state of the schedule after starting this game is where
+	// a resumed tournament continues if this is the last game in
+	// the journal.
+	if (m_journal != nullptr)
+		data->schedule = schedule();
+
 	auto whiteBuilder = white.builder();
 	auto blackBuilder = black.builder();
 	onGameAboutToStart(game, whiteBuilder, blackBuilder);
@@ -560,28 +630,13 @@ bool Tournament::writePgn(PgnGame* pgn, int gameNumber)
 	Q_ASSERT(pgn != nullptr);
 	Q_ASSERT(gameNumber > 0);
 
-	if (m_pgnFile.fileName().isEmpty())
+	const bool pgnOut = !m_pgnWriter.fileName().isEmpty();
+	const bool gameOut = !m_gameWriter.fileName().isEmpty();
+	if (!pgnOut && !gameOut)
 		return true;
 
-	bool isOpen = m_pgnFile.isOpen();
-	if (!isOpen || !m_pgnFile.exists())
-	{
-		if (isOpen)
-		{
-			qWarning("PGN file %s does not exist. Reopening...",
-				 qUtf8Printable(m_pgnFile.fileName()));
-			m_pgnFile.close();
-		}
-
-		if (!m_pgnFile.open(QIODevice::WriteOnly | QIODevice::Append))
-		{
-			qWarning("Could not open PGN file %s",
-				 qUtf8Printable(m_pgnFile.fileName()));
-			return false;
-		}
-		m_pgnOut.setDevice(&m_pgnFile);
-	}
-
+	// The games are formatted here and written to the files
+	// on the writers' I/O threads in game number order.
 	bool ok = true;
 	m_pgnGames[gameNumber] = *pgn;
 	while (m_pgnGames.contains(m_savedGameCount + 1))
@@ -594,11 +649,27 @@ bool Tournament::writePgn(PgnGame* pgn, int gameNumber)
 			qWarning("Omitted incomplete game %d", m_savedGameCount);
 			continue;
 		}
-		if (!tmp.write(m_pgnOut, m_pgnOutMode)
-		||  m_pgnFile.error() != QFile::NoError)
+
+		if (pgnOut)
 		{
-			ok = false;
-			qWarning("Could not write PGN game %d", m_savedGameCount);
+			QString text;
+			QTextStream out(&text);
+			if (!tmp.write(out, m_pgnOutMode)
+			||  !m_pgnWriter.write(text))
+			{
+				ok = false;
+				qWarning("Could not write PGN game %d", m_savedGameCount);
+			}
+		}
+		if (gameOut)
+		{
+			const QByteArray record(GameArchiveWriter::encode(tmp));
+			if (record.isEmpty() || !m_gameWriter.writeData(record))
+			{
+				ok = false;
+				qWarning("Could not write game %d to the archive",
+					 m_savedGameCount);
+			}
 		}
 	}
 
@@ -609,37 +680,13 @@ bool Tournament::writeEpd(ChessGame *game)
 {
 	Q_ASSERT(game != nullptr);
 
-	if (m_epdFile.fileName().isEmpty())
+	if (m_epdWriter.fileName().isEmpty())
 		return true;
 
-	bool isOpen = m_epdFile.isOpen();
-	if (!isOpen || !m_epdFile.exists())
-	{
-		if (isOpen)
-		{
-			qWarning("EPD file %s does not exist. Reopening...",
-				 qUtf8Printable(m_epdFile.fileName()));
-			m_epdFile.close();
-		}
-
-		if (!m_epdFile.open(QIODevice::WriteOnly | QIODevice::Append))
-		{
-			qWarning("Could not open EPD file %s",
-				 qUtf8Printable(m_epdFile.fileName()));
-			return false;
-		}
-		m_epdOut.setDevice(&m_epdFile);
-	}
-
 	const QString& epdPos = game->board()->fenString();
-	m_epdOut << epdPos << "\n";
-	m_epdOut.flush();
-	bool ok = true;
-	if (m_epdFile.error() != QFile::NoError)
-	{
-		ok = false;
+	bool ok = m_epdWriter.write(epdPos + "\n");
+	if (!ok)
 		qWarning("Could not write EPD position");
-	}
 
 	return ok;
 }
@@ -722,6 +769,7 @@ void Tournament::onGameStarted(ChessGame* game)
 	int iBlack = data->blackIndex;
 	m_players[iWhite].setName(game->player(Chess::Side::White)->name());
 	m_players[iBlack].setName(game->player(Chess::Side::Black)->name());
+	m_metrics.add(MatchMetrics::GamesStarted);
 
 	emit gameStarted(game, data->number, iWhite, iBlack);
 }
@@ -744,7 +792,6 @@ void Tournament::onGameFinished(ChessGame* game)
 
 	GameData* data = m_gameData.take(game);
 	int gameNumber = data->number;
-	Sprt::GameResult sprtResult = Sprt::NoResult;
 
 	int iWhite = data->whiteIndex;
 	int iBlack = data->blackIndex;
@@ -754,46 +801,33 @@ void Tournament::onGameFinished(ChessGame* game)
 	const auto blackName = pgn->playerName(Chess::Side::Black);
 	if (!blackName.isEmpty())
 		m_players[iBlack].setName(blackName);
-
-	switch (game->result().winner())
-	{
-	case Chess::Side::White:
-		addScore(iWhite, Chess::Side::White, 2);
-		addScore(iBlack, Chess::Side::Black, 0);
-		sprtResult = (iWhite == 0) ? Sprt::Win : Sprt::Loss;
-		break;
-	case Chess::Side::Black:
-		addScore(iBlack, Chess::Side::Black, 2);
-		addScore(iWhite, Chess::Side::White, 0);
-		sprtResult = (iBlack == 0) ? Sprt::Win : Sprt::Loss;
-		break;
-	default:
-		if (game->result().isDraw())
-		{
-			addScore(iWhite,  Chess::Side::White, 1);
-			addScore(iBlack,  Chess::Side::Black, 1);
-			sprtResult = Sprt::Draw;
-		}
-		break;
-	}
+	m_players[iWhite].addMoveLatency(game->moveLatency(Chess::Side::White));
+	m_players[iBlack].addMoveLatency(game->moveLatency(Chess::Side::Black));
 
 	writeEpd(game);
 	writePgn(pgn, gameNumber);
 
-	addOutcome(iWhite, iBlack, game->result());
+	Sprt::GameResult sprtResult = addGameResult(data, game->result());
+	m_metrics.addResult(game->result());
 	Chess::Result::Type resultType(game->result().type());
 
+	// Games aborted by stop() are left out of the journal, which
+	// then ends before the first of them. A resumed tournament
+	// plays them again in their original order and colors. Only a
+	// game that could not be started is journaled as skipped.
+	const bool aborted = m_stopping
+		&& (game->result().isNone() || faulty(resultType));
+	if (m_journal != nullptr && !aborted)
+		writeJournal(data, game->result(), game->result().isNone());
+
 	bool crashed = (resultType == Chess::Result::Disconnection ||
 			resultType == Chess::Result::StalledConnection);
 	if (!m_recover && crashed)
 		stop();
 
-	if (!m_sprt->isNull() && sprtResult != Sprt::NoResult)
-	{
-		m_sprt->addGameResult(sprtResult);
-		if (m_sprt->status().result != Sprt::Continue)
-			QMetaObject::invokeMethod(this, "stop", Qt::QueuedConnection);
-	}
+	if (!m_sprt->isNull() && sprtResult != Sprt::NoResult
+	&&  m_sprt->status().result != Sprt::Continue)
+		QMetaObject::invokeMethod(this, "stop", Qt::QueuedConnection);
 
 	emit gameFinished(game, gameNumber, iWhite, iBlack);
 
@@ -834,6 +868,11 @@ void Tournament::onGameStartFailed(ChessGame* game)
 
 void Tournament::onFinished()
 {
+	m_pgnWriter.flush();
+	m_epdWriter.flush();
+	m_gameWriter.flush();
+	for (const TournamentPlayer& player : qAsConst(m_players))
+		m_gameManager->purgePlayerPool(player.builder());
 	m_gameManager->cleanupIdleThreads();
 	m_finished = true;
 	emit finished();
@@ -854,6 +893,9 @@ void Tournament::start()
 		setOpeningRepetitions(INT_MAX);
 
 	m_gameData.clear();
+	m_pairResults.clear();
+	m_pentanomial.fill(0);
+	m_gamePairCount = 0;
 	m_pgnGames.clear();
 	m_startFen.clear();
 	m_openingMoves.clear();
@@ -864,6 +906,23 @@ void Tournament::start()
 	initializePairing();
 	m_finalGameCount = gamesPerCycle() * gamesPerEncounter() * roundMultiplier();
 
+	if (m_journal != nullptr)
+	{
+		m_journalGames.clear();
+		m_journalPairs.clear();
+		m_journalSchedule.clear();
+		m_journaledGameCount = 0;
+		m_checkpointGameCount = 0;
+
+		if (!resume()
+		||  areAllGamesFinished()
+		||  (!m_sprt->isNull() && m_sprt->status().result != Sprt::Continue))
+		{
+			QMetaObject::invokeMethod(this, "stop", Qt::QueuedConnection);
+			return;
+		}
+	}
+
 	startNextGame();
 }
 
@@ -949,6 +1008,402 @@ QString Tournament::resultsForSides(int index) const
 	return ret;
 }
 
+void Tournament::addGamePair(Sprt::GameResult first, Sprt::GameResult second)
+{
+	if (first == Sprt::NoResult || second == Sprt::NoResult)
+		return;
+
+	auto points = [](Sprt::GameResult result)
+	{
+		return result == Sprt::Win ? 2 : (result == Sprt::Draw ? 1 : 0);
+	};
+	m_pentanomial[points(first) + points(second)]++;
+
+	if (!m_sprt->isNull())
+		m_sprt->addGamePairResult(first, second);
+}
+
+Sprt::GameResult Tournament::addGameResult(const GameData* data,
+					   const Chess::Result& result)
+{
+	Sprt::GameResult sprtResult = Sprt::NoResult;
+	int iWhite = data->whiteIndex;
+	int iBlack = data->blackIndex;
+
+	switch (result.winner())
+	{
+	case Chess::Side::White:
+		addScore(iWhite, Chess::Side::White, 2);
+		addScore(iBlack, Chess::Side::Black, 0);
+		sprtResult = (iWhite == 0) ? Sprt::Win : Sprt::Loss;
+		break;
+	case Chess::Side::Black:
+		addScore(iBlack, Chess::Side::Black, 2);
+		addScore(iWhite, Chess::Side::White, 0);
+		sprtResult = (iBlack == 0) ? Sprt::Win : Sprt::Loss;
+		break;
+	default:
+		if (result.isDraw())
+		{
+			addScore(iWhite,  Chess::Side::White, 1);
+			addScore(iBlack,  Chess::Side::Black, 1);
+			sprtResult = Sprt::Draw;
+		}
+		break;
+	}
+
+	addOutcome(iWhite, iBlack, result);
+
+	if (!m_sprt->isNull() && sprtResult != Sprt::NoResult)
+		m_sprt->addGameResult(sprtResult);
+
+	// The games of a pair may finish in either order
+	if (data->pairNumber != 0 && !m_pairResults.contains(data->pairNumber))
+		m_pairResults[data->pairNumber] = sprtResult;
+	else if (data->pairNumber != 0)
+	{
+		Sprt::GameResult firstResult = m_pairResults.take(data->pairNumber);
+		addGamePair(firstResult, sprtResult);
+	}
+
+	return sprtResult;
+}
+
+QVariantList Tournament::pairState(const TournamentPair* pair) const
+{
+	// Pairs are identified by their players in original order
+	int player1 = pair->firstPlayer();
+	int player2 = pair->secondPlayer();
+	if (!pair->hasOriginalOrder())
+		std::swap(player1, player2);
+
+	return QVariantList() << player1 << player2
+			      << pair->hasOriginalOrder()
+			      << pair->gamesStarted();
+}
+
+TournamentPair* Tournament::restorePair(const QVariantList& state)
+{
+	if (state.size() < 4)
+		return nullptr;
+
+	int player1 = state.at(0).toInt();
+	int player2 = state.at(1).toInt();
+	if (player1 < -1 || player1 >= m_players.size()
+	||  player2 < -1 || player2 >= m_players.size()
+	||  player1 == player2)
+		return nullptr;
+
+	TournamentPair* pair = this->pair(player1, player2);
+	if (pair->hasOriginalOrder() != state.at(2).toBool())
+		pair->swapPlayers();
+	pair->setGamesStarted(state.at(3).toInt());
+
+	// Checkpoints also have the scores in original order
+	if (state.size() >= 6)
+	{
+		int score1 = state.at(4).toInt();
+		int score2 = state.at(5).toInt();
+		if (!pair->hasOriginalOrder())
+			std::swap(score1, score2);
+		pair->addFirstScore(score1 - pair->firstScore());
+		pair->addSecondScore(score2 - pair->secondScore());
+	}
+
+	m_journalPairs[qMakePair(player1, player2)] = state.mid(0, 4);
+	return pair;
+}
+
+QVariantMap Tournament::schedule() const
+{
+	QVariantList moves;
+	for (const Chess::Move& move : m_openingMoves)
+	{
+		moves << move.sourceSquare()
+		      << move.targetSquare()
+		      << move.promotion();
+	}
+
+	QVariantMap map;
+	map["round"] = m_round;
+	map["oldRound"] = m_oldRound;
+	map["nextGameNumber"] = m_nextGameNumber;
+	map["finalGameCount"] = m_finalGameCount;
+	map["startFen"] = m_startFen;
+	map["openingMoves"] = moves;
+	map["repetitionCounter"] = m_repetitionCounter;
+	map["gamePairCount"] = m_gamePairCount;
+	map["pair"] = pairState(m_pair);
+	map["pairing"] = pairingState();
+	if (m_openingSuite != nullptr)
+		map["openings"] = m_openingSuite->position();
+
+	return map;
+}
+
+bool Tournament::setSchedule(const QVariantMap& schedule)
+{
+	const QVariantList moves = schedule.value("openingMoves").toList();
+	if (moves.size() % 3 != 0)
+		return false;
+
+	m_openingMoves.clear();
+	for (int i = 0; i < moves.size(); i += 3)
+	{
+		m_openingMoves << Chess::Move(moves.at(i).toInt(),
+					      moves.at(i + 1).toInt(),
+					      moves.at(i + 2).toInt());
+	}
+
+	m_round = schedule.value("round").toInt();
+	m_oldRound = schedule.value("oldRound").toInt();
+	m_nextGameNumber = schedule.value("nextGameNumber").toInt();
+	m_finalGameCount = schedule.value("finalGameCount").toInt();
+	m_startFen = schedule.value("startFen").toString();
+	m_repetitionCounter = schedule.value("repetitionCounter").toInt();
+	m_gamePairCount = schedule.value("gamePairCount").toInt();
+
+	m_pair = restorePair(schedule.value("pair").toList());
+	if (m_pair == nullptr
+	||  !setPairingState(schedule.value("pairing")))
+		return false;
+
+	return m_openingSuite == nullptr
+	    || m_openingSuite->setPosition(schedule.value("openings"));
+}
+
+void Tournament::writeJournal(const GameData* data,
+			      const Chess::Result& result,
+			      bool skipped)
+{
+	QVariantMap resultMap;
+	resultMap["type"] = int(result.type());
+	resultMap["winner"] = result.winner().symbol();
+	resultMap["description"] = result.description();
+
+	QVariantMap game;
+	game["number"] = data->number;
+	game["white"] = data->whiteIndex;
+	game["black"] = data->blackIndex;
+	game["pairNumber"] = data->pairNumber;
+	game["schedule"] = data->schedule;
+	if (skipped)
+		game["skipped"] = true;
+	else
+		game["result"] = resultMap;
+	m_journalGames[data->number] = game;
+
+	// Like the PGN output, the journal has the games in order so
+	// that a resumed tournament can continue from the last one
+	bool outputFlushed = false;
+	while (m_journalGames.contains(m_journaledGameCount + 1))
+	{
+		// A skipped game is only written when a later game is
+		// ready to follow it. Skipped games at the end of the
+		// journal are played again when the tournament resumes.
+		if (m_journalGames.value(m_journaledGameCount + 1).contains("skipped"))
+		{
+			bool followed = false;
+			for (const QVariantMap& next : qAsConst(m_journalGames))
+			{
+				if (!next.contains("skipped"))
+				{
+					followed = true;
+					break;
+				}
+			}
+			if (!followed)
+				break;
+		}
+
+		const QVariantMap tmp = m_journalGames.take(++m_journaledGameCount);
+		m_journalSchedule = tmp.value("schedule").toMap();
+
+		const QVariantList pair = m_journalSchedule.value("pair").toList();
+		m_journalPairs[qMakePair(pair.at(0).toInt(), pair.at(1).toInt())] = pair;
+
+		// The journal must never get ahead of the output files,
+		// or a resumed tournament would lose the games in between
+		if (!outputFlushed)
+		{
+			m_pgnWriter.flush();
+			m_epdWriter.flush();
+			m_gameWriter.flush();
+			outputFlushed = true;
+		}
+
+		if (!m_journal->append(TournamentJournal::GameRecord, tmp))
+			qWarning("%s", qUtf8Printable(m_journal->errorString()));
+	}
+
+	// A checkpoint can only be written when every finished game is
+	// in the journal
+	if (m_finishedGameCount == m_journaledGameCount
+	&&  m_journaledGameCount - m_checkpointGameCount >= 256)
+		writeCheckpoint();
+}
+
+void Tournament::writeCheckpoint()
+{
+	QVariantList players;
+	for (const TournamentPlayer& player : qAsConst(m_players))
+		players << player.statistics();
+
+	QVariantList pentanomial;
+	for (int count : qAsConst(m_pentanomial))
+		pentanomial << count;
+
+	QVariantMap pairResults;
+	for (auto it = m_pairResults.constBegin(); it != m_pairResults.constEnd(); ++it)
+		pairResults[QString::number(it.key())] = int(it.value());
+
+	// The pairs' colors and started games as they were after the
+	// last journaled game started, and their current scores
+	QVariantList pairs;
+	for (auto it = m_pairs.constBegin(); it != m_pairs.constEnd(); ++it)
+	{
+		const TournamentPair* pair = it.value();
+		QVariantList state = m_journalPairs.value(it.key());
+		if (state.isEmpty())
+			state << it.key().first << it.key().second << true << 0;
+
+		int score1 = pair->firstScore();
+		int score2 = pair->secondScore();
+		if (!pair->hasOriginalOrder())
+			std::swap(score1, score2);
+		pairs << QVariant(state << score1 << score2);
+	}
+
+	QVariantMap checkpoint;
+	checkpoint["players"] = players;
+	checkpoint["sprt"] = m_sprt->statistics();
+	checkpoint["pentanomial"] = pentanomial;
+	checkpoint["pairResults"] = pairResults;
+	checkpoint["pairs"] = pairs;
+	checkpoint["schedule"] = m_journalSchedule;
+
+	if (!m_journal->append(TournamentJournal::CheckpointRecord, checkpoint))
+		qWarning("%s", qUtf8Printable(m_journal->errorString()));
+	else
+		m_checkpointGameCount = m_journaledGameCount;
+}
+
+bool Tournament::restoreGame(const QVariantMap& game)
+{
+	const QVariantMap resultMap = game.value("result").toMap();
+	auto type = Chess::Result::Type(resultMap.value("type").toInt());
+	Chess::Side winner(resultMap.value("winner").toString());
+	QString description(resultMap.value("description").toString());
+
+	// Result::description() adds a standard description of the
+	// result type, which must not be added again
+	QString standard(Chess::Result(type, winner).description());
+	if (description == standard)
+		description.clear();
+	else if (description.startsWith(standard + ": "))
+		description.remove(0, standard.size() + 2);
+
+	GameData data;
+	data.number = game.value("number").toInt();
+	data.whiteIndex = game.value("white").toInt();
+	data.blackIndex = game.value("black").toInt();
+	data.pairNumber = game.value("pairNumber").toInt();
+
+	if (data.number != m_nextGameNumber + 1
+	||  data.whiteIndex < 0 || data.whiteIndex >= m_players.size()
+	||  data.blackIndex < 0 || data.blackIndex >= m_players.size()
+	||  !setSchedule(game.value("schedule").toMap()))
+		return false;
+
+	if (!game.contains("skipped"))
+		addGameResult(&data, Chess::Result(type, winner, description));
+	m_journalSchedule = game.value("schedule").toMap();
+
+	return true;
+}
+
+bool Tournament::restoreCheckpoint(const QVariantMap& checkpoint)
+{
+	const QVariantList players = checkpoint.value("players").toList();
+	const QVariantList pentanomial = checkpoint.value("pentanomial").toList();
+	if (players.size() != m_players.size()
+	||  pentanomial.size() != m_pentanomial.size())
+		return false;
+
+	for (int i = 0; i < players.size(); i++)
+		m_players[i].setStatistics(players.at(i));
+	for (int i = 0; i < pentanomial.size(); i++)
+		m_pentanomial[i] = pentanomial.at(i).toInt();
+	m_sprt->setStatistics(checkpoint.value("sprt"));
+
+	m_pairResults.clear();
+	const QVariantMap pairResults = checkpoint.value("pairResults").toMap();
+	for (auto it = pairResults.constBegin(); it != pairResults.constEnd(); ++it)
+		m_pairResults[it.key().toInt()] = Sprt::GameResult(it.value().toInt());
+
+	const QVariantList pairs = checkpoint.value("pairs").toList();
+	for (const QVariant& pair : pairs)
+	{
+		if (restorePair(pair.toList()) == nullptr)
+			return false;
+	}
+
+	m_journalSchedule = checkpoint.value("schedule").toMap();
+	return setSchedule(m_journalSchedule);
+}
+
+bool Tournament::resume()
+{
+	QVariantList players;
+	for (const TournamentPlayer& player : qAsConst(m_players))
+		players << player.name();
+
+	QVariantMap header;
+	header["type"] = type();
+	header["variant"] = m_variant;
+	header["players"] = players;
+	header["gamesPerEncounter"] = m_gamesPerEncounter;
+	header["roundMultiplier"] = m_roundMultiplier;
+	header["openingRepetitions"] = m_openingRepetitions;
+	header["seed"] = Mersenne::seed();
+
+	if (m_journal->isEmpty())
+	{
+		if (m_journal->append(TournamentJournal::HeaderRecord, header))
+			return true;
+		m_error = m_journal->errorString();
+		return false;
+	}
+
+	if (m_journal->header() != header)
+	{
+		m_error = tr("The tournament doesn't match journal %1")
+			  .arg(m_journal->fileName());
+		return false;
+	}
+
+	const auto records = m_journal->tail();
+	for (const auto& record : records)
+	{
+		bool ok = (record.type == TournamentJournal::CheckpointRecord)
+			? restoreCheckpoint(record.data)
+			: restoreGame(record.data);
+		if (!ok)
+		{
+			m_error = tr("Invalid record in journal %1")
+				  .arg(m_journal->fileName());
+			return false;
+		}
+	}
+
+	m_finishedGameCount = m_nextGameNumber;
+	m_savedGameCount = m_nextGameNumber;
+	m_journaledGameCount = m_nextGameNumber;
+	m_checkpointGameCount = m_nextGameNumber;
+
+	return true;
+}
+
 QString Tournament::results() const
 {
 	QMultiMap<qreal, RankingData> ranking;
@@ -973,6 +1428,17 @@ QString Tournament::results() const
 				.arg(elo.errorMargin(), 0, 'f', 1)
 				.arg(elo.LOS(), 0, 'f', 1)
 				.arg(elo.drawRatio() * 100, 0, 'f', 1);
+
+			const auto& p = m_pentanomial;
+			if (p[0] + p[1] + p[2] + p[3] + p[4] > 0)
+			{
+				Elo pairElo(p[0], p[1], p[2], p[3], p[4]);
+				ret += QString("\nPtnml(0-2): [%1, %2, %3, %4, %5], "
+					       "nElo: %6 +/- %7")
+					.arg(p[0]).arg(p[1]).arg(p[2]).arg(p[3]).arg(p[4])
+					.arg(pairElo.normalizedDiff(), 0, 'f', 1)
+					.arg(pairElo.normalizedErrorMargin(), 0, 'f', 1);
+			}
 			break;
 		}
 
@@ -23,20 +23,22 @@
 #include <QList>
 #include <QVector>
 #include <QMap>
-#include <QFile>
-#include <QTextStream>
+#include <QVariant>
 #include "board/move.h"
 #include "timecontrol.h"
 #include "pgngame.h"
 #include "gameadjudicator.h"
 #include "tournamentplayer.h"
 #include "tournamentpair.h"
+#include "sprt.h"
+#include "outputwriter.h"
+#include "matchmetrics.h"
 class GameManager;
 class PlayerBuilder;
 class ChessGame;
 class OpeningBook;
 class OpeningSuite;
-class Sprt;
+class TournamentJournal;
 
 /*!
  * \brief Base class for chess tournaments
@@ -95,6 +97,13 @@ class LIB_EXPORT Tournament : public QObject
 		virtual QString type() const = 0;
 		/*! Returns the GameManager that manages the tournament's games. */
 		GameManager* gameManager() const;
+		/*!
+		 * Returns the live counters of the tournament's games.
+		 *
+		 * The counters are updated from the game threads and
+		 * can be read from any thread.
+		 */
+		const MatchMetrics& metrics() const;
 		/*! Returns true if the tournament is finished; otherwise returns false. */
 		bool isFinished() const;
 		/*! Returns a detailed description of the error. */
@@ -195,6 +204,18 @@ class LIB_EXPORT Tournament : public QObject
 		 * The tournament takes ownership of \a suite.
 		 */
 		void setOpeningSuite(OpeningSuite* suite);
+		/*!
+		 * Uses \a journal to record the tournament's progress.
+		 *
+		 * If \a journal already has records from an earlier run of
+		 * the same tournament, the tournament is resumed from where
+		 * the journal ends when start() is called. Games that were
+		 * in progress or unfinished at that point are played again.
+		 *
+		 * \a journal must be open. The tournament takes ownership
+		 * of \a journal.
+		 */
+		void setJournal(TournamentJournal* journal);
 		/*!
 		 * Sets the maximum depth of an opening from the opening suite
 		 * to \a plies (halfmoves).
@@ -234,6 +255,48 @@ class LIB_EXPORT Tournament : public QObject
 		 */
 		void setEpdOutput(const QString& fileName);
 
+		/*!
+		 * Sets the binary game archive output file for the games
+		 * to \a fileName.
+		 *
+		 * The games are saved in the same order as in the PGN
+		 * output file. If no archive file is set (default) then
+		 * the games won't be saved in the binary format.
+		 *
+		 * \sa GameArchiveWriter
+		 */
+		void setGameOutput(const QString& fileName);
+
+		/*!
+		 * Sets the group commit limits of the PGN, EPD and game
+		 * archive output files to \a games games and \a msecs milliseconds.
+		 *
+		 * The output is written on a separate I/O thread, and the
+		 * files are flushed when \a games games have been written
+		 * or \a msecs milliseconds have passed since the first
+		 * unflushed game. If \a msecs is 0, there is no time limit.
+		 * The default is to flush after every game.
+		 *
+		 * \sa OutputWriter
+		 */
+		void setOutputBatch(int games, int msecs);
+		/*!
+		 * Sets the maximum number of games waiting to be written
+		 * to \a limit. When the limit is reached, the tournament
+		 * waits for the I/O thread. The default is 256.
+		 */
+		void setOutputQueueLimit(int limit);
+		/*!
+		 * Sets the sync policy of the PGN, EPD and game archive
+		 * output files to \a policy. The default is OutputWriter::NoSync.
+		 */
+		void setOutputSyncPolicy(OutputWriter::SyncPolicy policy);
+		/*!
+		 * Returns the number of games waiting to be committed to
+		 * the PGN, EPD and game archive output files.
+		 */
+		qint64 outputBacklog() const;
+
 		/*!
 		 * Sets the number of opening repetitions to \a count.
 		 *
@@ -499,6 +562,28 @@ class LIB_EXPORT Tournament : public QObject
 		 * The default implementation always returns false.
 		 */
 		virtual bool hasGauntletRatingsOrder() const;
+		/*!
+		 * Returns the state of the pairings, ie. the data that
+		 * nextPair() uses to choose the next pair, as a variant.
+		 *
+		 * This member function is called when the tournament is
+		 * journaled. Subclasses that keep their own pairing state
+		 * must reimplement it. The default implementation returns
+		 * an invalid QVariant.
+		 *
+		 * \sa setJournal()
+		 */
+		virtual QVariant pairingState() const;
+		/*!
+		 * Restores the pairing state from \a state, a value
+		 * returned by pairingState(), when the tournament is
+		 * resumed from a journal.
+		 *
+		 * This member function is called after initializePairing().
+		 * Returns true if successful; otherwise returns false.
+		 * The default implementation returns true.
+		 */
+		virtual bool setPairingState(const QVariant& state);
 
 	private slots:
 		void startNextGame();
@@ -642,6 +727,8 @@ class LIB_EXPORT Tournament : public QObject
 			int number;
 			int whiteIndex;
 			int blackIndex;
+			int pairNumber;
+			QVariantMap schedule;
 		};
 		struct RankingData
 		{
@@ -692,6 +779,21 @@ class LIB_EXPORT Tournament : public QObject
 		};
 
 		QString resultsForSides(int index) const;
+		void addGamePair(Sprt::GameResult first,
+				 Sprt::GameResult second);
+		Sprt::GameResult addGameResult(const GameData* data,
+					       const Chess::Result& result);
+		QVariantList pairState(const TournamentPair* pair) const;
+		TournamentPair* restorePair(const QVariantList& state);
+		QVariantMap schedule() const;
+		bool setSchedule(const QVariantMap& schedule);
+		void writeJournal(const GameData* data,
+				  const Chess::Result& result,
+				  bool skipped);
+		void writeCheckpoint();
+		bool restoreGame(const QVariantMap& game);
+		bool restoreCheckpoint(const QVariantMap& checkpoint);
+		bool resume();
 
 		GameManager* m_gameManager;
 		ChessGame* m_lastGame;
@@ -720,13 +822,18 @@ class LIB_EXPORT Tournament : public QObject
 		bool m_bookOwnership;
 		GameAdjudicator m_adjudicator;
 		OpeningSuite* m_openingSuite;
+		TournamentJournal* m_journal;
+		int m_journaledGameCount;
+		int m_checkpointGameCount;
+		QVariantMap m_journalSchedule;
 		Sprt* m_sprt;
-		QFile m_pgnFile;
-		QTextStream m_pgnOut;
-		QFile m_epdFile;
-		QTextStream m_epdOut;
+		OutputWriter m_pgnWriter;
+		OutputWriter m_epdWriter;
+		OutputWriter m_gameWriter;
+		MatchMetrics m_metrics;
 		QString m_startFen;
 		int m_repetitionCounter;
+		int m_gamePairCount;
 		int m_swapSides;
 		bool m_reverseSides;
 
@@ -736,7 +843,11 @@ class LIB_EXPORT Tournament : public QObject
 		QMap< QPair<int, int>, TournamentPair* > m_pairs;
 		QList<TournamentPlayer> m_players;
 		QMap<int, PgnGame> m_pgnGames;
+		QMap<int, QVariantMap> m_journalGames;
+		QMap< QPair<int, int>, QVariantList > m_journalPairs;
 		QMap<ChessGame*, GameData*> m_gameData;
+		QMap<int, Sprt::GameResult> m_pairResults;
+		QVector<int> m_pentanomial;
 		QVector<Chess::Move> m_openingMoves;
 		QMap<int, QString> m_headerMap;
 };
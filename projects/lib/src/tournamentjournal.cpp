@@ -0,0 +1,257 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tournamentjournal.h"
+#include <QDataStream>
+#ifdef Q_OS_WIN
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+namespace {
+
+const quint32 s_recordMarker = 0x434a524e;
+// Marker, type and data size
+const qint64 s_recordHeaderSize = 9;
+// Data size
+const qint64 s_recordTrailerSize = 4;
+
+QDataStream::Version streamVersion()
+{
+	return QDataStream::Qt_5_6;
+}
+
+bool syncFile(QFile& file)
+{
+	if (!file.flush())
+		return false;
+#ifdef Q_OS_WIN
+	return _commit(file.handle()) == 0;
+#else
+	return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // anonymous namespace
+
+TournamentJournal::TournamentJournal(const QString& fileName)
+	: m_file(fileName)
+{
+}
+
+QString TournamentJournal::fileName() const
+{
+	return m_file.fileName();
+}
+
+QString TournamentJournal::errorString() const
+{
+	return m_error;
+}
+
+bool TournamentJournal::open()
+{
+	if (!m_file.open(QIODevice::ReadWrite))
+	{
+		m_error = QString("Can't open journal %1: %2")
+			  .arg(m_file.fileName(), m_file.errorString());
+		return false;
+	}
+	if (isEmpty())
+		return true;
+
+	if (header().isEmpty())
+	{
+		m_error = QString("%1 is not a tournament journal")
+			  .arg(m_file.fileName());
+		m_file.close();
+		return false;
+	}
+
+	// Discard a record that was cut short by a crash
+	qint64 end = lastRecordEnd();
+	if (end < m_file.size())
+	{
+		qWarning("Discarding an incomplete record at the end of %s",
+			 qUtf8Printable(m_file.fileName()));
+		if (!m_file.resize(end))
+		{
+			m_error = QString("Can't repair journal %1: %2")
+				  .arg(m_file.fileName(), m_file.errorString());
+			m_file.close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool TournamentJournal::isEmpty() const
+{
+	return m_file.size() == 0;
+}
+
+QVariantMap TournamentJournal::header()
+{
+	quint32 size = 0;
+	if (!m_file.seek(s_recordHeaderSize - 4))
+		return QVariantMap();
+	QDataStream in(&m_file);
+	in >> size;
+
+	Record record;
+	qint64 start = -1;
+	qint64 end = s_recordHeaderSize + size + s_recordTrailerSize;
+	if (in.status() != QDataStream::Ok
+	||  !readRecord(end, &record, &start)
+	||  start != 0
+	||  record.type != HeaderRecord)
+		return QVariantMap();
+
+	return record.data;
+}
+
+QList<TournamentJournal::Record> TournamentJournal::tail()
+{
+	QList<Record> records;
+	qint64 end = m_file.size();
+
+	while (end > 0)
+	{
+		Record record;
+		qint64 start;
+		if (!readRecord(end, &record, &start)
+		||  record.type == HeaderRecord)
+			break;
+
+		records.prepend(record);
+		if (record.type == CheckpointRecord)
+			break;
+		end = start;
+	}
+
+	return records;
+}
+
+bool TournamentJournal::append(RecordType type, const QVariantMap& data)
+{
+	QByteArray body;
+	QDataStream bodyOut(&body, QIODevice::WriteOnly);
+	bodyOut.setVersion(streamVersion());
+	bodyOut << data;
+
+	QByteArray bytes;
+	QDataStream out(&bytes, QIODevice::WriteOnly);
+	out << s_recordMarker << quint8(type) << quint32(body.size());
+	out.writeRawData(body.constData(), body.size());
+	out << quint32(body.size());
+
+	if (!m_file.seek(m_file.size())
+	||  m_file.write(bytes) != bytes.size()
+	||  !syncFile(m_file))
+	{
+		m_error = QString("Can't write to journal %1: %2")
+			  .arg(m_file.fileName(), m_file.errorString());
+		return false;
+	}
+
+	return true;
+}
+
+bool TournamentJournal::readRecord(qint64 end, Record* record, qint64* start)
+{
+	if (end < s_recordHeaderSize + s_recordTrailerSize
+	||  end > m_file.size()
+	||  !m_file.seek(end - s_recordTrailerSize))
+		return false;
+
+	QDataStream in(&m_file);
+	in.setVersion(streamVersion());
+
+	quint32 size = 0;
+	in >> size;
+	qint64 begin = end - s_recordTrailerSize - qint64(size) - s_recordHeaderSize;
+	if (in.status() != QDataStream::Ok || begin < 0 || !m_file.seek(begin))
+		return false;
+
+	quint32 marker = 0;
+	quint8 type = 0;
+	quint32 headerSize = 0;
+	in >> marker >> type >> headerSize;
+	if (in.status() != QDataStream::Ok
+	||  marker != s_recordMarker
+	||  headerSize != size
+	||  type < HeaderRecord || type > CheckpointRecord)
+		return false;
+
+	record->type = RecordType(type);
+	record->data.clear();
+	in >> record->data;
+	if (in.status() != QDataStream::Ok
+	||  m_file.pos() != end - s_recordTrailerSize)
+		return false;
+
+	*start = begin;
+	return true;
+}
+
+qint64 TournamentJournal::nextRecordEnd(qint64 start)
+{
+	if (!m_file.seek(start))
+		return -1;
+
+	QDataStream in(&m_file);
+	quint32 marker = 0;
+	quint8 type = 0;
+	quint32 size = 0;
+	in >> marker >> type >> size;
+	const qint64 end = start + s_recordHeaderSize + size + s_recordTrailerSize;
+	if (in.status() != QDataStream::Ok
+	||  marker != s_recordMarker
+	||  type < HeaderRecord || type > CheckpointRecord
+	||  end > m_file.size()
+	||  !m_file.seek(end - s_recordTrailerSize))
+		return -1;
+
+	quint32 trailerSize = 0;
+	in >> trailerSize;
+	if (in.status() != QDataStream::Ok || trailerSize != size)
+		return -1;
+
+	return end;
+}
+
+qint64 TournamentJournal::lastRecordEnd()
+{
+	// Usually the journal ends with a complete record
+	Record record;
+	qint64 start;
+	if (readRecord(m_file.size(), &record, &start))
+		return m_file.size();
+
+	// Otherwise walk forward over the record frames to the last
+	// complete one. Only the frame headers and trailers are read,
+	// the data is skipped over by the frame's size.
+	qint64 end = 0;
+	qint64 lastValid = 0;
+	while ((end = nextRecordEnd(end)) > 0)
+		lastValid = end;
+
+	return lastValid;
+}
@@ -0,0 +1,109 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TOURNAMENTJOURNAL_H
+#define TOURNAMENTJOURNAL_H
+
+#include <QString>
+#include <QList>
+#include <QVariantMap>
+#include <QFile>
+
+/*!
+ * \brief An append-only journal of a tournament's progress
+ *
+ * A Tournament that has a journal appends a record to it each time a
+ * game finishes, and a checkpoint record with the tournament's full
+ * state every now and then. An interrupted tournament can be resumed
+ * by starting it again with the same journal.
+ *
+ * The journal is a binary file of framed records. Each record stores
+ * its size both before and after its data, so the journal can be read
+ * backwards from the end. A record that was only partially written
+ * when the program crashed is discarded by open().
+ *
+ * \sa Tournament::setJournal()
+ */
+class LIB_EXPORT TournamentJournal
+{
+	public:
+		/*! The type of a journal record. */
+		enum RecordType
+		{
+			HeaderRecord = 1,	//!< Tournament settings
+			GameRecord,		//!< A finished or skipped game
+			CheckpointRecord	//!< Full tournament state
+		};
+
+		/*! A journal record. */
+		struct Record
+		{
+			RecordType type;	//!< Type of the record
+			QVariantMap data;	//!< Contents of the record
+		};
+
+		/*! Creates a new journal for file \a fileName. */
+		explicit TournamentJournal(const QString& fileName);
+
+		/*! Returns the name of the journal file. */
+		QString fileName() const;
+		/*! Returns a detailed description of the last error. */
+		QString errorString() const;
+
+		/*!
+		 * Opens the journal file for reading and appending,
+		 * creating it if it doesn't exist.
+		 *
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool open();
+		/*! Returns true if the journal has no records. */
+		bool isEmpty() const;
+		/*!
+		 * Returns the data of the header record, which is the
+		 * first record of the journal.
+		 */
+		QVariantMap header();
+		/*!
+		 * Returns the records that follow the last checkpoint
+		 * record, starting with the checkpoint itself. If there
+		 * are no checkpoints, all records after the header are
+		 * returned.
+		 *
+		 * Only the tail of the journal is read, so the cost
+		 * doesn't grow with the length of the tournament.
+		 */
+		QList<Record> tail();
+		/*!
+		 * Appends a record of type \a type with data \a data
+		 * to the journal and syncs it to the storage device.
+		 *
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool append(RecordType type, const QVariantMap& data);
+
+	private:
+		bool readRecord(qint64 end, Record* record, qint64* start);
+		qint64 nextRecordEnd(qint64 start);
+		qint64 lastRecordEnd();
+
+		QFile m_file;
+		QString m_error;
+};
+
+#endif // TOURNAMENTJOURNAL_H
@@ -129,6 +129,11 @@ void TournamentPair::addStartedGame()
 	m_gamesStarted++;
 }
 
+void TournamentPair::setGamesStarted(int count)
+{
+	m_gamesStarted = count;
+}
+
 void TournamentPair::swapPlayers()
 {
 	std::swap(m_first, m_second);
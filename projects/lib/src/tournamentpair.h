@@ -77,6 +77,8 @@ class LIB_EXPORT TournamentPair
 		int gamesStarted() const;
 		/*! Adds a new started game to the current encounter. */
 		void addStartedGame();
+		/*! Sets the number of started games to \a count. */
+		void setGamesStarted(int count);
 		/*! Returns the number of finished games between the pair. */
 		int gamesFinished() const;
 		/*! Returns the number of ongoing between the pair. */
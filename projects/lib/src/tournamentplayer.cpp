@@ -171,3 +171,57 @@ const QMap<QString, int> & TournamentPlayer::outcomeMap() const
 {
 	return m_outcome;
 }
+
+QVariant TournamentPlayer::statistics() const
+{
+	QVariantList terminations;
+	for (int count : m_terminations)
+		terminations << count;
+
+	QVariantMap outcomes;
+	for (auto it = m_outcome.constBegin(); it != m_outcome.constEnd(); ++it)
+		outcomes[it.key()] = it.value();
+
+	QVariantMap map;
+	map["wins"] = m_wins;
+	map["draws"] = m_draws;
+	map["losses"] = m_losses;
+	map["whiteWins"] = m_whiteWins;
+	map["whiteDraws"] = m_whiteDraws;
+	map["whiteLosses"] = m_whiteLosses;
+	map["terminations"] = terminations;
+	map["outcomes"] = outcomes;
+
+	return map;
+}
+
+void TournamentPlayer::setStatistics(const QVariant& statistics)
+{
+	const QVariantMap map = statistics.toMap();
+	m_wins = map.value("wins").toInt();
+	m_draws = map.value("draws").toInt();
+	m_losses = map.value("losses").toInt();
+	m_whiteWins = map.value("whiteWins").toInt();
+	m_whiteDraws = map.value("whiteDraws").toInt();
+	m_whiteLosses = map.value("whiteLosses").toInt();
+
+	const QVariantList terminations = map.value("terminations").toList();
+	m_terminations.fill(0);
+	for (int i = 0; i < terminations.size() && i < m_terminations.size(); i++)
+		m_terminations[i] = terminations.at(i).toInt();
+
+	m_outcome.clear();
+	const QVariantMap outcomes = map.value("outcomes").toMap();
+	for (auto it = outcomes.constBegin(); it != outcomes.constEnd(); ++it)
+		m_outcome[it.key()] = it.value().toInt();
+}
+
+const MoveLatency& TournamentPlayer::moveLatency() const
+{
+	return m_moveLatency;
+}
+
+void TournamentPlayer::addMoveLatency(const MoveLatency& latency)
+{
+	m_moveLatency.merge(latency);
+}
@@ -21,9 +21,11 @@
 
 #include "playerbuilder.h"
 #include "timecontrol.h"
+#include "movelatency.h"
 #include "board/side.h"
 #include <QVector>
 #include <QMap>
+#include <QVariant>
 
 class OpeningBook;
 
@@ -118,6 +120,25 @@ class LIB_EXPORT TournamentPlayer
 		int outcomes(int type) const;
 		/*! Returns the player's game outcome statistics. */
 		const QMap<QString, int>& outcomeMap() const;
+		/*!
+		 * Returns the player's scores and outcome statistics
+		 * as a variant.
+		 *
+		 * \sa setStatistics()
+		 */
+		QVariant statistics() const;
+		/*! Restores the scores and outcome statistics from \a statistics. */
+		void setStatistics(const QVariant& statistics);
+		/*!
+		 * Returns the per-move latencies of the player's games
+		 * in the tournament.
+		 *
+		 * \note The latencies are not part of statistics(), so
+		 * they only cover games played since the last resume.
+		 */
+		const MoveLatency& moveLatency() const;
+		/*! Adds the moves of \a latency to the player's latencies. */
+		void addMoveLatency(const MoveLatency& latency);
 
 	private:
 		PlayerBuilder* m_builder;
@@ -132,6 +153,7 @@ class LIB_EXPORT TournamentPlayer
 		int m_whiteLosses;
 		QVector<int> m_terminations;
 		QMap <QString, int> m_outcome;
+		MoveLatency m_moveLatency;
 };
 
 #endif // TOURNAMENTPLAYER_H
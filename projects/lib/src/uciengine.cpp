@@ -23,6 +23,7 @@
 #include "board/board.h"
 #include "board/boardfactory.h"
 #include "timecontrol.h"
+#include "pvconverter.h"
 
 #include "enginebuttonoption.h"
 #include "enginecheckoption.h"
@@ -69,15 +70,16 @@ QString variantToUci(const QString& str, bool uciPrefix = true)
 	return tmp;
 }
 
-QStringRef joinTokens(const QVarLengthArray<QStringRef>& tokens)
+template <typename Token>
+QString joinTokens(const QVarLengthArray<Token>& tokens)
 {
 	Q_ASSERT(!tokens.isEmpty());
 
-	const QStringRef& last = tokens[tokens.size() - 1];
-	int start = tokens[0].position();
-	int end = last.position() + last.size();
+	const Token& first = tokens[0];
+	const Token& last = tokens[tokens.size() - 1];
 
-	return QStringRef(last.string(), start, end - start);
+	return QString::fromUtf8(first.data,
+				 int(last.data + last.size - first.data));
 }
 
 } // namespace
@@ -141,6 +143,12 @@ void UciEngine::startGame()
 	m_bmBuffer.clear();
 	m_moveStrings.clear();
 	m_useDirectPv = directPvList.contains(board()->variant());
+	if (!m_useDirectPv
+	&&  (m_pvConverter.isNull()
+	     || m_pvConverter->variant() != board()->variant()))
+		m_pvConverter.reset(new PvConverter(board()));
+	if (!m_pvConverter.isNull())
+		m_pvConverter->setEngine(name(), id());
 
 	if (board()->isRandomVariant())
 		m_startFen = board()->fenString(Chess::Board::ShredderFen);
@@ -333,13 +341,13 @@ void UciEngine::sendQuit()
 	write("quit");
 }
 
-QStringRef UciEngine::parseUciTokens(const QStringRef& first,
-				     const QString* types,
-				     int typeCount,
-				     QVarLengthArray<QStringRef>& tokens,
-				     int& type)
+UciEngine::Token UciEngine::parseUciTokens(const Token& first,
+					   const char* const* types,
+					   int typeCount,
+					   QVarLengthArray<Token>& tokens,
+					   int& type)
 {
-	QStringRef token(first);
+	Token token(first);
 	type = -1;
 	tokens.clear();
 
@@ -365,7 +373,7 @@ QStringRef UciEngine::parseUciTokens(const QStringRef& first,
 	return token;
 }
 
-void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
+void UciEngine::parseInfo(const QVarLengthArray<Token>& tokens,
 			  int type,
 			  MoveEvaluation* eval)
 {
@@ -395,22 +403,30 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
 	switch (type)
 	{
 	case InfoDepth:
-		eval->setDepth(tokens[0].toString().toInt());
+		eval->setDepth(tokens[0].toInt());
 		break;
 	case InfoSelDepth:
-		eval->setSelectiveDepth(tokens[0].toString().toInt());
+		eval->setSelectiveDepth(tokens[0].toInt());
 		break;
 	case InfoTime:
-		eval->setTime(tokens[0].toString().toInt());
+		eval->setTime(tokens[0].toInt());
 		break;
 	case InfoNodes:
-		eval->setNodeCount(tokens[0].toString().toULongLong());
+		eval->setNodeCount(tokens[0].toULongLong());
 		break;
 	case InfoMultiPv:
-		eval->setPvNumber(tokens[0].toString().toInt());
+		eval->setPvNumber(tokens[0].toInt());
 		break;
 	case InfoPv:
-		eval->setPv(m_useDirectPv ?  directPv(tokens) : sanPv(tokens));
+		// The PV is converted into SAN only if someone wants to see
+		// it. m_moveStrings already includes the ponder move.
+		if (m_useDirectPv)
+			eval->setPv(directPv(tokens));
+		else
+			eval->setLanPv(joinTokens(tokens),
+				       m_pvConverter,
+				       m_startFen,
+				       m_moveStrings);
 		break;
 	case InfoScore:
 		{
@@ -418,10 +434,10 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
 			for (int i = 1; i < tokens.size(); i++)
 			{
 				if (tokens[i - 1] == "cp")
-					score = tokens[i].toString().toInt();
+					score = tokens[i].toInt();
 				else if (tokens[i - 1] == "mate")
 				{
-					score = tokens[i].toString().toInt();
+					score = tokens[i].toInt();
 					if (score > 0)
 						score = eval->MATE_SCORE + 1 - score * 2;
 					else if (score < 0)
@@ -438,22 +454,22 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
 		}
 		break;
 	case InfoNps:
-		eval->setNps(tokens[0].toString().toULongLong());
+		eval->setNps(tokens[0].toULongLong());
 		break;
 	case InfoTbHits:
-		eval->setTbHits(tokens[0].toString().toULongLong());
+		eval->setTbHits(tokens[0].toULongLong());
 		break;
 	case InfoHashFull:
-		eval->setHashUsage(tokens[0].toString().toInt());
+		eval->setHashUsage(tokens[0].toInt());
 		break;
 	default:
 		break;
 	}
 }
 
-void UciEngine::parseInfo(const QStringRef& line)
+void UciEngine::parseInfo(const Token& line)
 {
-	static const QString types[] =
+	static const char* const types[] =
 	{
 		"depth",
 		"seldepth",
@@ -474,8 +490,8 @@ void UciEngine::parseInfo(const QStringRef& line)
 	};
 
 	int type = -1;
-	QStringRef token(nextToken(line));
-	QVarLengthArray<QStringRef> tokens;
+	Token token(nextToken(line));
+	QVarLengthArray<Token> tokens;
 	MoveEvaluation eval;
 
 	// The "string" info is not supported and it can't be parsed
@@ -510,7 +526,7 @@ void UciEngine::parseInfo(const QStringRef& line)
 		emit thinking(eval);
 }
 
-EngineOption* UciEngine::parseOption(const QStringRef& line)
+EngineOption* UciEngine::parseOption(const Token& line)
 {
 	enum Keyword
 	{
@@ -521,7 +537,7 @@ EngineOption* UciEngine::parseOption(const QStringRef& line)
 		OptionMax,
 		OptionVar
 	};
-	static const QString types[] =
+	static const char* const types[] =
 	{
 		"name",
 		"type",
@@ -539,8 +555,8 @@ EngineOption* UciEngine::parseOption(const QStringRef& line)
 	int max = 0;
 	
 	int keyword = -1;
-	QStringRef token(nextToken(line));
-	QVarLengthArray<QStringRef> tokens;
+	Token token(nextToken(line));
+	QVarLengthArray<Token> tokens;
 
 	while (!token.isNull())
 	{
@@ -548,7 +564,7 @@ EngineOption* UciEngine::parseOption(const QStringRef& line)
 		if (tokens.isEmpty() || keyword == -1)
 			continue;
 
-		QString str(joinTokens(tokens).toString());
+		QString str(joinTokens(tokens));
 
 		switch (keyword)
 		{
@@ -597,9 +613,9 @@ EngineOption* UciEngine::parseOption(const QStringRef& line)
 	return nullptr;
 }
 
-void UciEngine::parseLine(const QString& line)
+void UciEngine::parseLine(const QByteArray& line)
 {
-	const QStringRef command(firstToken(line));
+	const Token command(firstToken(line));
 
 	if (command == "info")
 	{
@@ -645,7 +661,7 @@ void UciEngine::parseLine(const QString& line)
 			return;
 		}
 
-		QStringRef token(nextToken(command));
+		Token token(nextToken(command));
 		QString moveString(token.toString());
 		m_moveStrings += " " + moveString;
 		Chess::Move move = board()->moveFromString(moveString);
@@ -685,7 +701,7 @@ void UciEngine::parseLine(const QString& line)
 	}
 	else if (command == "id")
 	{
-		QStringRef tag(nextToken(command));
+		Token tag(nextToken(command));
 		if (tag == "name" && name() == "UciEngine")
 			setName(nextToken(tag, true).toString());
 	}
@@ -705,7 +721,8 @@ void UciEngine::parseLine(const QString& line)
 
 		if (option == nullptr || !option->isValid())
 			qWarning("Invalid UCI option from %s: %s",
-				 qUtf8Printable(name()), qUtf8Printable(line));
+				 qUtf8Printable(name()),
+				 qUtf8Printable(QString::fromUtf8(line)));
 		else if (!(variant = variantFromUci(option->name())).isEmpty())
 			addVariant(variant);
 		else if (option->name() == "UCI_Variant")
@@ -804,7 +821,7 @@ void UciEngine::setPonderMove(const QString& moveString)
 	}
 }
 
-QString UciEngine::directPv(const QVarLengthArray<QStringRef>& tokens)
+QString UciEngine::directPv(const QVarLengthArray<Token>& tokens)
 {
 	QString pv;
 	for( auto token : tokens)
@@ -815,46 +832,6 @@ QString UciEngine::directPv(const QVarLengthArray<QStringRef>& tokens)
 	return pv;
 }
 
-QString UciEngine::sanPv(const QVarLengthArray<QStringRef>& tokens)
-{
-	Chess::Board* board = this->board();
-	QString pv;
-	int movesMade = 0;
-
-	if (pondering() && !m_ponderMove.isNull())
-	{
-		board->makeMove(m_ponderMove);
-		movesMade++;
-	}
-
-	for (auto token : tokens)
-	{
-		auto move = board->moveFromString(token.toString());
-		if (move.isNull())
-		{
-			QString tokenString(token.toString());
-			qWarning("Illegal PV move %s from %s (%d)",
-				 qUtf8Printable(tokenString),
-				 qUtf8Printable(name()),
-				 id());
-			qWarning("PV: %s %s",
-				 qUtf8Printable(pv),
-				 qUtf8Printable(tokenString));
-			break;
-		}
-		if (!pv.isEmpty())
-			pv += " ";
-		pv += board->moveString(move, Chess::Board::StandardAlgebraic);
-		board->makeMove(move);
-		movesMade++;
-	}
-
-	for (int i = 0; i < movesMade; i++)
-		board->undoMove();
-
-	return pv;
-}
-
 void UciEngine::sendOption(const QString& name, const QVariant& value)
 {
 	if (!value.isNull())
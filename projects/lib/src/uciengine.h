@@ -20,6 +20,8 @@
 
 #include "chessengine.h"
 #include <QVarLengthArray>
+#include <QSharedPointer>
+class PvConverter;
 
 
 /*!
@@ -51,7 +53,7 @@ class LIB_EXPORT UciEngine : public ChessEngine
 		virtual void startProtocol();
 		virtual void startGame();
 		virtual void startThinking();
-		virtual void parseLine(const QString& line);
+		virtual void parseLine(const QByteArray& line);
 		virtual void sendOption(const QString& name, const QVariant& value);
 		virtual bool isPondering() const;
 		
@@ -63,28 +65,28 @@ class LIB_EXPORT UciEngine : public ChessEngine
 			PonderHit
 		};
 
-		static QStringRef parseUciTokens(const QStringRef& first,
-						 const QString* types,
-						 int typeCount,
-						 QVarLengthArray<QStringRef>& tokens,
-						 int& type);
-		void parseInfo(const QVarLengthArray<QStringRef>& tokens,
+		static Token parseUciTokens(const Token& first,
+					    const char* const* types,
+					    int typeCount,
+					    QVarLengthArray<Token>& tokens,
+					    int& type);
+		void parseInfo(const QVarLengthArray<Token>& tokens,
 			       int type,
 			       MoveEvaluation* eval);
-		void parseInfo(const QStringRef& line);
-		EngineOption* parseOption(const QStringRef& line);
+		void parseInfo(const Token& line);
+		EngineOption* parseOption(const Token& line);
 		void addVariantsFromOption(const EngineOption* option);
 		void setVariant(const QString& variant);
 		QString positionString();
 		void sendPosition();
 		void setPonderMove(const QString& moveString);
-		QString directPv(const QVarLengthArray<QStringRef>& tokens);
-		QString sanPv(const QVarLengthArray<QStringRef>& tokens);
+		QString directPv(const QVarLengthArray<Token>& tokens);
 		
 		QString m_variantOption;
 		QString m_startFen;
 		QString m_moveStrings;
 		bool m_useDirectPv;
+		QSharedPointer<PvConverter> m_pvConverter;
 		// Write buffer for messages that will be flushed to the engine
 		// after it sends a "bestmove"
 		QStringList m_bmBuffer;
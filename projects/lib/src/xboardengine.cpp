@@ -601,8 +601,9 @@ int XboardEngine::adaptScore(int score) const
 	return score;
 }
 
-void XboardEngine::parseLine(const QString& line)
+void XboardEngine::parseLine(const QByteArray& data)
 {
+	const QString line(QString::fromUtf8(data));
 	auto input = tokenize(line);
 	auto command = input.first;
 	if (command.isEmpty())
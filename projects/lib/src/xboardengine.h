@@ -51,7 +51,7 @@ class LIB_EXPORT XboardEngine : public ChessEngine
 		virtual void startProtocol();
 		virtual void startGame();
 		virtual void startThinking();
-		virtual void parseLine(const QString& line);
+		virtual void parseLine(const QByteArray& line);
 		virtual void sendOption(const QString& name, const QVariant& value);
 		virtual bool restartsBetweenGames() const;
 
@@ -24,6 +24,9 @@ class tst_Board: public QObject
 		void results_data() const;
 		void results();
 
+		void repetitions_data() const;
+		void repetitions();
+
 		void perft_data() const;
 		void perft();
 
@@ -762,6 +765,18 @@ void tst_Board::results_data() const
 		<< variant
 		<< "k7/8/K7/8/1R6/8/8/8 b - - 0 1"
 		<< "1/2-1/2";
+	QTest::newRow("mate with pinned blocker")
+		<< variant
+		<< "6rk/1b6/8/8/4B3/8/7P/r6K w - - 0 1"
+		<< "0-1";
+	QTest::newRow("en passant evasion")
+		<< variant
+		<< "k3r3/8/1p6/2pP4/3K4/n6r/8/8 w - c6 0 1"
+		<< "*";
+	QTest::newRow("no en passant evasion")
+		<< variant
+		<< "k3r3/8/1p6/2pP4/3K4/n6r/8/8 w - - 0 1"
+		<< "0-1";
 	QTest::newRow("Kk")
 		<< variant
 		<< "2K5/8/2k5/8/8/8/8/8 w - - 0 1"
@@ -1157,6 +1172,71 @@ void tst_Board::results()
 	QCOMPARE(m_board->result().toShortString(), result);
 }
 
+void tst_Board::repetitions_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QString>("fen");
+	QTest::addColumn<QString>("moves");
+	QTest::addColumn<int>("repeatcount");
+
+	QString variant = "standard";
+	QString fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+	QTest::newRow("standard no repetition")
+		<< variant
+		<< fen
+		<< "g1f3 g8f6 f3g1 f6h5"
+		<< 0;
+	QTest::newRow("standard knight shuffle")
+		<< variant
+		<< fen
+		<< "g1f3 g8f6 f3g1 f6g8"
+		<< 1;
+	QTest::newRow("standard knight shuffle twice")
+		<< variant
+		<< fen
+		<< "g1f3 g8f6 f3g1 f6g8 g1f3 g8f6 f3g1 f6g8"
+		<< 2;
+	QTest::newRow("standard shuffle after pawn move")
+		<< variant
+		<< fen
+		<< "g1f3 g8f6 f3g1 f6g8 e2e4 e7e5 g1f3 g8f6 f3g1 f6g8"
+		<< 1;
+	QTest::newRow("standard halfmove clock")
+		<< variant
+		<< "4k3/8/8/8/8/8/8/R3K3 w - - 90 80"
+		<< "a1b1 e8d8 b1a1 d8e8"
+		<< 1;
+
+	variant = "crazyhouse";
+
+	QTest::newRow("crazyhouse repetition across drops")
+		<< variant
+		<< "7k/1b6/8/8/4n3/2N5/8/K7[-] w - - 0 1"
+		<< "c3e4 b7e4 N@d1 e4b7 d1c3 N@e4"
+		<< 1;
+}
+
+void tst_Board::repetitions()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, fen);
+	QFETCH(QString, moves);
+	QFETCH(int, repeatcount);
+
+	setVariant(variant);
+	QVERIFY(m_board->setFenString(fen));
+
+	const auto moveList = moves.split(' ', Qt::SkipEmptyParts);
+	for (const auto& moveStr : moveList)
+	{
+		Chess::Move move = m_board->moveFromString(moveStr);
+		QVERIFY(m_board->isLegalMove(move));
+		m_board->makeMove(move);
+	}
+	QCOMPARE(m_board->repeatCount(), repeatcount);
+}
+
 void tst_Board::perft_data() const
 {
 	QTest::addColumn<QString>("variant");
@@ -1171,6 +1251,16 @@ void tst_Board::perft_data() const
 		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
 		<< 5
 		<< Q_UINT64_C(4865609);
+	QTest::newRow("kiwipete")
+		<< variant
+		<< "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"
+		<< 4
+		<< Q_UINT64_C(4085603);
+	QTest::newRow("rook endgame")
+		<< variant
+		<< "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"
+		<< 5
+		<< Q_UINT64_C(674624);
 	QTest::newRow("pos2")
 		<< variant
 		<< "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -"
@@ -0,0 +1,177 @@
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QRegularExpression>
+#include <compressiondevice.h>
+
+class tst_CompressionDevice: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void codecForFileName();
+		void roundTrip_data() const;
+		void roundTrip();
+		void seek_data() const;
+		void seek();
+		void truncated_data() const;
+		void truncated();
+
+	private:
+		QByteArray compress(CompressionDevice::Codec codec,
+				    const QList<QByteArray>& blocks) const;
+		QByteArray decompress(CompressionDevice::Codec codec,
+				      QByteArray data) const;
+		void addCodecs() const;
+};
+
+void tst_CompressionDevice::addCodecs() const
+{
+	QTest::addColumn<int>("codec");
+
+	QTest::newRow("gzip") << int(CompressionDevice::GzipCodec);
+	QTest::newRow("zstd") << int(CompressionDevice::ZstdCodec);
+}
+
+QByteArray tst_CompressionDevice::compress(CompressionDevice::Codec codec,
+					   const QList<QByteArray>& blocks) const
+{
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+
+	CompressionDevice device(&buffer, codec);
+	if (!device.open(QIODevice::WriteOnly))
+		return QByteArray();
+	for (const QByteArray& block : blocks)
+	{
+		device.write(block);
+		device.commit();
+	}
+	device.close();
+
+	return data;
+}
+
+QByteArray tst_CompressionDevice::decompress(CompressionDevice::Codec codec,
+					     QByteArray data) const
+{
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::ReadOnly);
+	if (CompressionDevice::detectCodec(&buffer) != codec)
+		return QByteArray();
+
+	CompressionDevice device(&buffer, codec);
+	if (!device.open(QIODevice::ReadOnly))
+		return QByteArray();
+
+	return device.readAll();
+}
+
+void tst_CompressionDevice::codecForFileName()
+{
+	QCOMPARE(CompressionDevice::codecForFileName("games.pgn"),
+		 CompressionDevice::NoCodec);
+	QCOMPARE(CompressionDevice::codecForFileName("games.pgn.gz"),
+		 CompressionDevice::GzipCodec);
+	QCOMPARE(CompressionDevice::codecForFileName("games.PGN.ZST"),
+		 CompressionDevice::ZstdCodec);
+}
+
+void tst_CompressionDevice::roundTrip_data() const
+{
+	addCodecs();
+}
+
+void tst_CompressionDevice::roundTrip()
+{
+	QFETCH(int, codec);
+	auto type = CompressionDevice::Codec(codec);
+	if (!CompressionDevice::isSupported(type))
+		QSKIP("Codec not supported by this build");
+
+	QList<QByteArray> blocks;
+	QByteArray expected;
+	for (int i = 0; i < 3; i++)
+	{
+		QByteArray block;
+		for (int j = 0; j < 5000; j++)
+			block += QByteArray::number(i * 5000 + j) + " e4 e5 Nf3\n";
+		blocks << block;
+		expected += block;
+	}
+
+	// Every commit starts a new member/frame
+	QByteArray data = compress(type, blocks);
+	QVERIFY(!data.isEmpty());
+	QVERIFY(data.size() < expected.size());
+	QCOMPARE(decompress(type, data), expected);
+
+	// Concatenated streams, eg. an appended file
+	data += compress(type, blocks);
+	QCOMPARE(decompress(type, data), expected + expected);
+}
+
+void tst_CompressionDevice::seek_data() const
+{
+	addCodecs();
+}
+
+void tst_CompressionDevice::seek()
+{
+	QFETCH(int, codec);
+	auto type = CompressionDevice::Codec(codec);
+	if (!CompressionDevice::isSupported(type))
+		QSKIP("Codec not supported by this build");
+
+	QByteArray expected;
+	for (int i = 0; i < 100000; i++)
+		expected += char('a' + i % 26);
+
+	QByteArray data = compress(type, QList<QByteArray>() << expected);
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::ReadOnly);
+	CompressionDevice device(&buffer, type);
+	QVERIFY(device.open(QIODevice::ReadOnly));
+	QVERIFY(!device.isSequential());
+
+	QVERIFY(device.seek(90000));
+	QCOMPARE(device.pos(), qint64(90000));
+	QCOMPARE(device.read(10), expected.mid(90000, 10));
+
+	// Backwards, restarts the stream
+	QVERIFY(device.seek(100));
+	QCOMPARE(device.read(10), expected.mid(100, 10));
+
+	char c = 0;
+	QVERIFY(device.getChar(&c));
+	device.ungetChar(c);
+	QCOMPARE(device.readAll(), expected.mid(110));
+	QVERIFY(device.atEnd());
+}
+
+void tst_CompressionDevice::truncated_data() const
+{
+	addCodecs();
+}
+
+void tst_CompressionDevice::truncated()
+{
+	QFETCH(int, codec);
+	auto type = CompressionDevice::Codec(codec);
+	if (!CompressionDevice::isSupported(type))
+		QSKIP("Codec not supported by this build");
+
+	const QByteArray first("[Event \"first\"]\n\n1. e4 e5 1-0\n\n");
+	const QByteArray second("[Event \"second\"]\n\n1. d4 d5 0-1\n\n");
+	QByteArray data = compress(type, QList<QByteArray>() << first);
+	QByteArray tail = compress(type, QList<QByteArray>() << second);
+
+	// A crash while writing the second block
+	data += tail.left(tail.size() / 2);
+	QByteArray result = decompress(type, data);
+	QVERIFY(result.startsWith(first));
+	QVERIFY(result.size() < first.size() + second.size());
+}
+
+QTEST_MAIN(tst_CompressionDevice)
+#include "tst_compressiondevice.moc"
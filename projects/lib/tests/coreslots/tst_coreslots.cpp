@@ -0,0 +1,157 @@
+#include <QtTest/QtTest>
+#include <coreslots.h>
+
+class tst_CoreSlots: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void smtSiblings();
+		void avoidSmtSiblings();
+		void numaNodes();
+		void spanNumaNodes();
+		void notEnoughCpus();
+
+	private:
+		QVector<CoreSlots::Cpu> topology() const;
+		bool verifyDisjoint(const CoreSlots& slots) const;
+		int core(int cpu) const;
+		int node(int cpu) const;
+};
+
+/*
+ * Two NUMA nodes with four 2-way SMT cores each. Like on Linux,
+ * the second siblings of the cores are numbered after the first.
+ */
+QVector<CoreSlots::Cpu> tst_CoreSlots::topology() const
+{
+	QVector<CoreSlots::Cpu> cpus;
+	for (int id = 0; id < 16; id++)
+	{
+		CoreSlots::Cpu cpu = { id, core(id), node(id) };
+		cpus.append(cpu);
+	}
+
+	return cpus;
+}
+
+int tst_CoreSlots::core(int cpu) const
+{
+	return cpu % 8;
+}
+
+int tst_CoreSlots::node(int cpu) const
+{
+	return core(cpu) / 4;
+}
+
+bool tst_CoreSlots::verifyDisjoint(const CoreSlots& slots) const
+{
+	QSet<int> used;
+	for (int i = 0; i < slots.slotCount(); i++)
+	{
+		for (int cpu : slots.cpus(i))
+		{
+			if (used.contains(cpu))
+				return false;
+			used.insert(cpu);
+		}
+	}
+
+	return true;
+}
+
+void tst_CoreSlots::smtSiblings()
+{
+	CoreSlots slots;
+	QVERIFY(slots.initialize(4, topology()));
+	QCOMPARE(slots.slotCount(), 4);
+	QVERIFY(verifyDisjoint(slots));
+
+	// Both siblings of a core are in the same slot
+	for (int i = 0; i < slots.slotCount(); i++)
+	{
+		const auto cpus = slots.cpus(i);
+		QCOMPARE(cpus.size(), 4);
+		for (int cpu : cpus)
+			QVERIFY(cpus.contains(cpu < 8 ? cpu + 8 : cpu - 8));
+	}
+}
+
+void tst_CoreSlots::avoidSmtSiblings()
+{
+	CoreSlots slots;
+	slots.setAvoidSmtSiblings(true);
+	QVERIFY(slots.initialize(4, topology()));
+	QCOMPARE(slots.slotCount(), 4);
+	QVERIFY(verifyDisjoint(slots));
+
+	// No two slots, or CPUs of a slot, share a physical core
+	QSet<int> cores;
+	for (int i = 0; i < slots.slotCount(); i++)
+	{
+		const auto cpus = slots.cpus(i);
+		QCOMPARE(cpus.size(), 2);
+		for (int cpu : cpus)
+		{
+			QVERIFY(!cores.contains(core(cpu)));
+			cores.insert(core(cpu));
+		}
+	}
+
+	// Only eight cores are available
+	QVERIFY(!slots.initialize(5, topology()));
+	QVERIFY(!slots.errorString().isEmpty());
+}
+
+void tst_CoreSlots::numaNodes()
+{
+	CoreSlots slots;
+	slots.setCpusPerSlot(6);
+	QVERIFY(slots.initialize(2, topology()));
+	QCOMPARE(slots.slotCount(), 2);
+	QVERIFY(verifyDisjoint(slots));
+
+	for (int i = 0; i < slots.slotCount(); i++)
+	{
+		const auto cpus = slots.cpus(i);
+		QCOMPARE(cpus.size(), 6);
+		for (int cpu : cpus)
+			QCOMPARE(node(cpu), node(cpus.first()));
+	}
+}
+
+void tst_CoreSlots::spanNumaNodes()
+{
+	// Only one 5-CPU slot fits in each node, so the third slot
+	// can't be placed without spanning nodes
+	CoreSlots slots;
+	slots.setCpusPerSlot(5);
+	QVERIFY(slots.initialize(3, topology()));
+	QCOMPARE(slots.slotCount(), 3);
+	QVERIFY(verifyDisjoint(slots));
+
+	bool spans = false;
+	for (int i = 0; i < slots.slotCount(); i++)
+	{
+		const auto cpus = slots.cpus(i);
+		QCOMPARE(cpus.size(), 5);
+		for (int cpu : cpus)
+			spans |= node(cpu) != node(cpus.first());
+	}
+	QVERIFY(spans);
+}
+
+void tst_CoreSlots::notEnoughCpus()
+{
+	CoreSlots slots;
+	QVERIFY(!slots.initialize(17, topology()));
+	QCOMPARE(slots.slotCount(), 0);
+
+	slots.setCpusPerSlot(4);
+	QVERIFY(!slots.initialize(5, topology()));
+	QVERIFY(!slots.initialize(0, topology()));
+}
+
+QTEST_MAIN(tst_CoreSlots)
+#include "tst_coreslots.moc"
@@ -0,0 +1,87 @@
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <engineprocess.h>
+
+class tst_EngineProcess: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void readWrite();
+		void exitCode();
+		void workingDirectory();
+		void missingProgram();
+};
+
+void tst_EngineProcess::readWrite()
+{
+	EngineProcess process;
+	QSignalSpy spy(&process, SIGNAL(readyRead()));
+	process.start("cat", QStringList());
+	QVERIFY(process.waitForStarted());
+	QCOMPARE(process.state(), EngineProcess::Running);
+	QVERIFY(process.processId() > 0);
+
+	const QByteArray data("uci\nisready\n");
+	QCOMPARE(process.write(data), qint64(data.size()));
+	while (process.bytesAvailable() < data.size())
+		QVERIFY(spy.wait(5000));
+	QVERIFY(process.canReadLine());
+	QCOMPARE(process.readLine(), QByteArray("uci\n"));
+	QCOMPARE(process.readLine(), QByteArray("isready\n"));
+	QVERIFY(!process.canReadLine());
+
+	process.close();
+	QCOMPARE(process.state(), EngineProcess::NotRunning);
+	QCOMPARE(process.exitStatus(), EngineProcess::CrashExit);
+}
+
+void tst_EngineProcess::exitCode()
+{
+	EngineProcess process;
+	QSignalSpy readSpy(&process, SIGNAL(readChannelFinished()));
+	QSignalSpy finishedSpy(&process, &EngineProcess::finished);
+	process.start("sh", QStringList() << "-c" << "echo bye; exit 3");
+	QVERIFY(process.waitForStarted());
+
+	QVERIFY(finishedSpy.wait(5000));
+	QCOMPARE(readSpy.count(), 1);
+	QCOMPARE(process.readAll(), QByteArray("bye\n"));
+	QCOMPARE(process.exitCode(), 3);
+	QCOMPARE(process.exitStatus(), EngineProcess::NormalExit);
+}
+
+void tst_EngineProcess::workingDirectory()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	const QString stderrFile(dir.filePath("stderr.txt"));
+
+	EngineProcess process;
+	process.setWorkingDirectory(dir.path());
+	process.setStandardErrorFile(stderrFile);
+	process.start("sh", QStringList() << "-c" << "pwd; echo err >&2");
+	QVERIFY(process.waitForStarted());
+	QVERIFY(process.waitForFinished(5000));
+
+	const QString pwd(QString::fromLocal8Bit(process.readAll()).trimmed());
+	QCOMPARE(QFileInfo(pwd).canonicalFilePath(),
+		 QFileInfo(dir.path()).canonicalFilePath());
+
+	QFile file(stderrFile);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QCOMPARE(file.readAll(), QByteArray("err\n"));
+}
+
+void tst_EngineProcess::missingProgram()
+{
+	EngineProcess process;
+	process.start("cutechess-no-such-program", QStringList());
+	QVERIFY(!process.waitForStarted());
+	QCOMPARE(process.state(), EngineProcess::NotRunning);
+	QVERIFY(!process.errorString().isEmpty());
+}
+
+QTEST_MAIN(tst_EngineProcess)
+#include "tst_engineprocess.moc"
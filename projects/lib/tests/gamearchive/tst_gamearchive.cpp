@@ -0,0 +1,188 @@
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <gamearchive.h>
+#include <pgnstream.h>
+#include <pgngame.h>
+
+namespace {
+
+const char s_games[] =
+	"[Event \"?\"]\n"
+	"[Site \"?\"]\n"
+	"[Date \"2023.01.01\"]\n"
+	"[Round \"1\"]\n"
+	"[White \"Engine A\"]\n"
+	"[Black \"Engine B\"]\n"
+	"[Result \"1-0\"]\n"
+	"[TimeControl \"40/60\"]\n\n"
+	"1. e4 {+0.31/12 0.5s} e5 {-0.20/11 0.4s} 2. Qh5 {+0.10/10 0.3s} Nc6\n"
+	"3. Bc4 Nf6 4. Qxf7# {+M1/1 0.1s, White mates} 1-0\n\n"
+	"[Event \"?\"]\n"
+	"[Site \"?\"]\n"
+	"[Date \"2023.01.01\"]\n"
+	"[Round \"2\"]\n"
+	"[White \"Engine B\"]\n"
+	"[Black \"Engine A\"]\n"
+	"[Result \"0-1\"]\n"
+	"[FEN \"8/P7/8/8/8/8/6pk/K7 b - - 0 1\"]\n"
+	"[SetUp \"1\"]\n\n"
+	"1... g1=Q+ 2. Kb2 Qb6+ 3. Kc3 Qxa7 0-1\n\n"
+	"[Event \"?\"]\n"
+	"[Site \"?\"]\n"
+	"[Date \"2023.01.01\"]\n"
+	"[Round \"3\"]\n"
+	"[White \"Engine A\"]\n"
+	"[Black \"Engine B\"]\n"
+	"[Result \"1/2-1/2\"]\n"
+	"[Variant \"crazyhouse\"]\n\n"
+	"1. e4 d5 2. exd5 Qxd5 3. Nc3 Qa5 4. P@b5 1/2-1/2\n\n";
+
+QString toPgn(const PgnGame& game)
+{
+	QString str;
+	QTextStream out(&str);
+	game.write(out);
+	return str;
+}
+
+} // anonymous namespace
+
+class tst_GameArchive: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void roundTrip();
+		void maxMoves();
+		void truncated();
+		void invalidHeader();
+		void invalidRecordSize();
+
+	private:
+		QList<PgnGame> readPgn() const;
+		QByteArray archive(const QList<PgnGame>& games) const;
+};
+
+QList<PgnGame> tst_GameArchive::readPgn() const
+{
+	QByteArray data(s_games);
+	PgnStream stream(&data);
+	QList<PgnGame> games;
+	PgnGame game;
+	while (game.read(stream, INT_MAX - 1, false))
+		games << game;
+	return games;
+}
+
+QByteArray tst_GameArchive::archive(const QList<PgnGame>& games) const
+{
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	GameArchiveWriter writer(&buffer);
+	for (const PgnGame& game : games)
+	{
+		if (!game.write(writer))
+			return QByteArray();
+	}
+	return buffer.data();
+}
+
+void tst_GameArchive::roundTrip()
+{
+	const QList<PgnGame> games(readPgn());
+	QCOMPARE(games.size(), 3);
+
+	QByteArray data(archive(games));
+	QVERIFY(data.startsWith(GameArchiveWriter::fileHeader()));
+	QVERIFY(data.size() < int(sizeof(s_games)));
+
+	QBuffer buffer(&data);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	GameArchiveReader reader(&buffer);
+
+	PgnGame game;
+	for (const PgnGame& expected : games)
+	{
+		QVERIFY(reader.read(game, INT_MAX - 1, false));
+		QVERIFY(game.startingSide() == expected.startingSide());
+		QCOMPARE(game.moves().size(), expected.moves().size());
+		for (int i = 0; i < game.moves().size(); i++)
+		{
+			const auto& md = game.moves().at(i);
+			QVERIFY(md.move == expected.moves().at(i).move);
+			QCOMPARE(md.moveString, expected.moves().at(i).moveString);
+			QCOMPARE(md.comment, expected.moves().at(i).comment);
+		}
+		QCOMPARE(toPgn(game), toPgn(expected));
+	}
+
+	QVERIFY(!reader.read(game));
+	QCOMPARE(reader.status(), GameArchiveReader::ReadPastEnd);
+	QVERIFY(reader.errorString().isEmpty());
+}
+
+void tst_GameArchive::maxMoves()
+{
+	QByteArray data(archive(readPgn()));
+	QBuffer buffer(&data);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	GameArchiveReader reader(&buffer);
+
+	PgnGame game;
+	QVERIFY(reader.read(game, 3));
+	QCOMPARE(game.moves().size(), 3);
+	QCOMPARE(game.tagValue("PlyCount"), QString("3"));
+
+	// The rest of the record is skipped
+	QVERIFY(reader.read(game, 3));
+	QCOMPARE(game.tagValue("Round"), QString("2"));
+}
+
+void tst_GameArchive::truncated()
+{
+	QByteArray data(archive(readPgn()));
+	data.chop(5);
+
+	QBuffer buffer(&data);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	GameArchiveReader reader(&buffer);
+
+	PgnGame game;
+	QVERIFY(reader.read(game));
+	QVERIFY(reader.read(game));
+	QVERIFY(!reader.read(game));
+	QCOMPARE(reader.status(), GameArchiveReader::ReadPastEnd);
+	QVERIFY(!reader.errorString().isEmpty());
+}
+
+void tst_GameArchive::invalidHeader()
+{
+	QByteArray data(s_games);
+	QBuffer buffer(&data);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	GameArchiveReader reader(&buffer);
+
+	PgnGame game;
+	QVERIFY(!reader.read(game));
+	QCOMPARE(reader.status(), GameArchiveReader::InvalidData);
+}
+
+void tst_GameArchive::invalidRecordSize()
+{
+	// A record size of 2^32 - 1 bytes
+	QByteArray data(GameArchiveWriter::fileHeader());
+	data.append("\xff\xff\xff\xff\x0f", 5);
+	data.append(QByteArray(16, '\0'));
+
+	QBuffer buffer(&data);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	GameArchiveReader reader(&buffer);
+
+	PgnGame game;
+	QVERIFY(!reader.read(game));
+	QCOMPARE(reader.status(), GameArchiveReader::InvalidData);
+	QVERIFY(!reader.errorString().isEmpty());
+}
+
+QTEST_MAIN(tst_GameArchive)
+#include "tst_gamearchive.moc"
@@ -0,0 +1,276 @@
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <gamemanager.h>
+#include <chessgame.h>
+#include <chessplayer.h>
+#include <playerbuilder.h>
+#include <pgngame.h>
+#include <timecontrol.h>
+#include <gameadjudicator.h>
+#include <moveevaluation.h>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+namespace {
+
+/*!
+ * A player that plays its first legal move right away, or never
+ * moves if it's passive.
+ */
+class FakePlayer : public ChessPlayer
+{
+	Q_OBJECT
+
+	public:
+		FakePlayer(bool passive, QObject* parent = nullptr)
+			: ChessPlayer(parent),
+			  m_passive(passive)
+		{
+			setState(Idle);
+			setName("Fake");
+		}
+
+		virtual void makeMove(const Chess::Move& move)
+		{
+			Q_UNUSED(move);
+		}
+		virtual bool supportsVariant(const QString& variant) const
+		{
+			return variant == "standard";
+		}
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+
+	protected:
+		virtual void startGame()
+		{
+		}
+		virtual void startThinking()
+		{
+			if (m_passive)
+				return;
+
+			QTimer::singleShot(0, this, [=]()
+			{
+				if (state() != Thinking)
+					return;
+				const auto moves = board()->legalMoves();
+				if (!moves.isEmpty())
+					emitMove(moves.first());
+			});
+		}
+
+	private:
+		bool m_passive;
+};
+
+class FakeBuilder : public PlayerBuilder
+{
+	public:
+		FakeBuilder(bool passive = false)
+			: PlayerBuilder("Fake"),
+			  m_passive(passive)
+		{
+		}
+
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+		virtual ChessPlayer* create(QObject* receiver,
+					    const char* method,
+					    QObject* parent,
+					    QString* error) const
+		{
+			Q_UNUSED(receiver);
+			Q_UNUSED(method);
+			Q_UNUSED(error);
+			return new FakePlayer(m_passive, parent);
+		}
+
+	private:
+		bool m_passive;
+};
+
+} // anonymous namespace
+
+class tst_GameManager: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void workers();
+		void destroyWhilePlaying();
+		void playerPool();
+
+	private:
+		ChessGame* createGame();
+};
+
+ChessGame* tst_GameManager::createGame()
+{
+	ChessGame* game = new ChessGame(Chess::BoardFactory::create("standard"),
+					new PgnGame());
+	TimeControl tc;
+	tc.setInfinity();
+	game->setTimeControl(tc);
+
+	GameAdjudicator adjudicator;
+	adjudicator.setMaximumGameLength(5);
+	game->setAdjudicator(adjudicator);
+
+	return game;
+}
+
+void tst_GameManager::initTestCase()
+{
+	qRegisterMetaType<Chess::Move>("Chess::Move");
+	qRegisterMetaType<Chess::Result>("Chess::Result");
+	qRegisterMetaType<MoveEvaluation>("MoveEvaluation");
+}
+
+void tst_GameManager::workers()
+{
+	const int gameCount = 6;
+	GameManager manager;
+	manager.setConcurrency(4);
+	manager.setWorkerCount(2);
+	QCOMPARE(manager.workerCount(), 2);
+
+	QSignalSpy destroyedSpy(&manager, SIGNAL(gameDestroyed(ChessGame*)));
+	for (int i = 0; i < gameCount; i++)
+	{
+		ChessGame* game = createGame();
+		connect(game, &ChessGame::finished, this, [=]()
+		{
+			// Each game is played in one of the workers
+			QVERIFY(game->thread() != QThread::currentThread());
+			delete game->pgn();
+			game->deleteLater();
+		});
+		manager.newGame(game, new FakeBuilder, new FakeBuilder,
+				GameManager::Enqueue);
+	}
+	QTRY_COMPARE_WITH_TIMEOUT(destroyedSpy.count(), gameCount, 10000);
+
+	// The games were spread across both workers
+	const auto loads = manager.workerLoads();
+	QCOMPARE(loads.size(), 2);
+	int totalGames = 0;
+	for (const auto& load : loads)
+	{
+		QVERIFY(load.totalGames > 0);
+		QVERIFY(load.utilization >= 0.0 && load.utilization <= 1.0);
+		totalGames += load.totalGames;
+	}
+	QCOMPARE(totalGames, gameCount);
+
+	// The workers lose their games when the players have quit
+	QSignalSpy finishedSpy(&manager, SIGNAL(finished()));
+	manager.finish();
+	QVERIFY(finishedSpy.count() > 0 || finishedSpy.wait(10000));
+	QTRY_VERIFY_WITH_TIMEOUT(manager.workerLoads().at(0).games == 0
+			      && manager.workerLoads().at(1).games == 0, 10000);
+}
+
+void tst_GameManager::destroyWhilePlaying()
+{
+	ChessGame* game = createGame();
+	{
+		GameManager manager;
+		manager.setWorkerCount(1);
+
+		QSignalSpy startedSpy(&manager, SIGNAL(gameStarted(ChessGame*)));
+		manager.newGame(game, new FakeBuilder(true), new FakeBuilder(true));
+		QVERIFY(startedSpy.wait(10000));
+		QVERIFY(game->thread() != QThread::currentThread());
+	}
+
+	// The game was handed back before the worker stopped
+	QCOMPARE(game->thread(), QThread::currentThread());
+	delete game->pgn();
+	delete game;
+}
+
+void tst_GameManager::playerPool()
+{
+	GameManager manager;
+	manager.setConcurrency(2);
+	QCOMPARE(manager.playerPoolLimit(), 4);
+
+	FakeBuilder a;
+	FakeBuilder c;
+	FakeBuilder* b = new FakeBuilder;
+	QSignalSpy destroyedSpy(&manager, SIGNAL(gameDestroyed(ChessGame*)));
+
+	// The white and black player of each game
+	QVector<ChessPlayer*> players;
+	auto play = [&](const PlayerBuilder* white, const PlayerBuilder* black)
+	{
+		ChessGame* game = createGame();
+		connect(game, &ChessGame::finished, this, [=, &players]()
+		{
+			players << game->player(Chess::Side::White)
+				<< game->player(Chess::Side::Black);
+			delete game->pgn();
+			game->deleteLater();
+		});
+		manager.newGame(game, white, black, GameManager::Enqueue,
+				GameManager::ReusePlayers);
+	};
+
+	play(&a, b);
+	QTRY_COMPARE_WITH_TIMEOUT(destroyedSpy.count(), 1, 10000);
+	QCOMPARE(manager.playerPoolSize(), 2);
+	QCOMPARE(manager.playerPoolHits(), 0);
+	QCOMPARE(manager.playerPoolMisses(), 2);
+
+	// A pooled player is reused against a different opponent
+	play(&a, &c);
+	QTRY_COMPARE_WITH_TIMEOUT(destroyedSpy.count(), 2, 10000);
+	QCOMPARE(players.at(2), players.at(0));
+	QCOMPARE(manager.playerPoolSize(), 3);
+	QCOMPARE(manager.playerPoolHits(), 1);
+	QCOMPARE(manager.playerPoolMisses(), 3);
+
+	// ...and with the other color
+	play(&c, b);
+	QTRY_COMPARE_WITH_TIMEOUT(destroyedSpy.count(), 3, 10000);
+	QCOMPARE(players.at(4), players.at(3));
+	QCOMPARE(players.at(5), players.at(1));
+	QCOMPARE(manager.playerPoolSize(), 3);
+	QCOMPARE(manager.playerPoolHits(), 3);
+	QCOMPARE(manager.playerPoolMisses(), 3);
+
+	// The players of a builder about to be destroyed quit, and
+	// a new builder never gets them even at the same address
+	QPointer<ChessPlayer> oldPlayer(players.at(1));
+	manager.purgePlayerPool(b);
+	delete b;
+	QCOMPARE(manager.playerPoolSize(), 2);
+	QTRY_VERIFY_WITH_TIMEOUT(oldPlayer.isNull(), 10000);
+
+	b = new FakeBuilder;
+	play(b, &a);
+	QTRY_COMPARE_WITH_TIMEOUT(destroyedSpy.count(), 4, 10000);
+	QCOMPARE(manager.playerPoolHits(), 4);
+	QCOMPARE(manager.playerPoolMisses(), 4);
+	QCOMPARE(manager.playerPoolSize(), 3);
+
+	// A full pool drops the players that have been idle longest
+	manager.setPlayerPoolLimit(1);
+	QCOMPARE(manager.playerPoolLimit(), 1);
+	QCOMPARE(manager.playerPoolSize(), 1);
+
+	QSignalSpy finishedSpy(&manager, SIGNAL(finished()));
+	manager.finish();
+	QVERIFY(finishedSpy.count() > 0 || finishedSpy.wait(10000));
+	QCOMPARE(manager.playerPoolSize(), 0);
+	delete b;
+}
+
+QTEST_MAIN(tst_GameManager)
+#include "tst_gamemanager.moc"
@@ -0,0 +1,84 @@
+#include <QtTest/QtTest>
+#include <matchmetrics.h>
+#include <moveevaluation.h>
+#include <board/result.h>
+
+class tst_MatchMetrics: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void moves();
+		void results();
+		void concurrentUpdates();
+};
+
+void tst_MatchMetrics::moves()
+{
+	MatchMetrics metrics;
+	QCOMPARE(metrics.meanNps(), 0.0);
+	QCOMPARE(metrics.meanDepth(), 0.0);
+
+	MoveEvaluation eval;
+	eval.setDepth(20);
+	eval.setNodeCount(3000000);
+	eval.setTime(1000);
+	metrics.addMove(eval);
+
+	eval.setDepth(10);
+	eval.setNodeCount(1000000);
+	eval.setTime(1000);
+	metrics.addMove(eval);
+
+	MoveEvaluation book;
+	book.setBookEval(true);
+	metrics.addMove(book);
+
+	QCOMPARE(metrics.value(MatchMetrics::Moves), qint64(3));
+	QCOMPARE(metrics.value(MatchMetrics::SearchedMoves), qint64(2));
+	QCOMPARE(metrics.meanNps(), 2000000.0);
+	QCOMPARE(metrics.meanDepth(), 15.0);
+}
+
+void tst_MatchMetrics::results()
+{
+	MatchMetrics metrics;
+	metrics.addResult(Chess::Result(Chess::Result::Win,
+					Chess::Side::White));
+	metrics.addResult(Chess::Result(Chess::Result::Timeout,
+					Chess::Side::Black));
+	metrics.addResult(Chess::Result(Chess::Result::Disconnection,
+					Chess::Side::White));
+	metrics.addResult(Chess::Result(Chess::Result::StalledConnection,
+					Chess::Side::White));
+
+	QCOMPARE(metrics.value(MatchMetrics::GamesFinished), qint64(4));
+	QCOMPARE(metrics.value(MatchMetrics::TimeForfeits), qint64(1));
+	QCOMPARE(metrics.value(MatchMetrics::Crashes), qint64(1));
+	QCOMPARE(metrics.value(MatchMetrics::Stalls), qint64(1));
+}
+
+void tst_MatchMetrics::concurrentUpdates()
+{
+	MatchMetrics metrics;
+	QList<QThread*> threads;
+	for (int i = 0; i < 4; i++)
+	{
+		threads << QThread::create([&]()
+		{
+			for (int j = 0; j < 10000; j++)
+				metrics.add(MatchMetrics::Nodes, 2);
+		});
+		threads.last()->start();
+	}
+	for (QThread* thread : threads)
+	{
+		QVERIFY(thread->wait());
+		delete thread;
+	}
+
+	QCOMPARE(metrics.value(MatchMetrics::Nodes), qint64(80000));
+}
+
+QTEST_MAIN(tst_MatchMetrics)
+#include "tst_matchmetrics.moc"
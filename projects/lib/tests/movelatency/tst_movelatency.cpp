@@ -0,0 +1,99 @@
+#include <QtTest/QtTest>
+#include <movelatency.h>
+
+class tst_MoveLatency: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void emptyHistogram();
+		void histogram();
+		void merge();
+		void stages();
+};
+
+void tst_MoveLatency::emptyHistogram()
+{
+	LatencyHistogram histogram;
+	QVERIFY(histogram.isEmpty());
+	QCOMPARE(histogram.count(), quint64(0));
+	QCOMPARE(histogram.mean(), qint64(0));
+	QCOMPARE(histogram.percentile(50), qint64(0));
+}
+
+void tst_MoveLatency::histogram()
+{
+	LatencyHistogram histogram;
+	for (int i = 1000; i >= 1; i--)
+		histogram.add(i);
+
+	QCOMPARE(histogram.count(), quint64(1000));
+	QCOMPARE(histogram.min(), qint64(1));
+	QCOMPARE(histogram.max(), qint64(1000));
+	QCOMPARE(histogram.mean(), qint64(500));
+
+	// The buckets are at most 25% wide
+	const qint64 median = histogram.percentile(50);
+	QVERIFY(median >= 500 && median <= 625);
+	const qint64 p99 = histogram.percentile(99);
+	QVERIFY(p99 >= 990 && p99 <= 1000);
+	QCOMPARE(histogram.percentile(100), qint64(1000));
+	QCOMPARE(histogram.percentile(0), qint64(1));
+
+	// Large values and negative ones
+	histogram.add(Q_INT64_C(60000000000));
+	histogram.add(-5);
+	QCOMPARE(histogram.min(), qint64(0));
+	QCOMPARE(histogram.max(), Q_INT64_C(60000000000));
+
+	histogram.clear();
+	QVERIFY(histogram.isEmpty());
+}
+
+void tst_MoveLatency::merge()
+{
+	LatencyHistogram a;
+	LatencyHistogram b;
+	a.add(100);
+	b.add(10);
+	b.add(1000000);
+
+	a.merge(b);
+	QCOMPARE(a.count(), quint64(3));
+	QCOMPARE(a.min(), qint64(10));
+	QCOMPARE(a.max(), qint64(1000000));
+
+	LatencyHistogram empty;
+	a.merge(empty);
+	QCOMPARE(a.count(), quint64(3));
+	empty.merge(a);
+	QCOMPARE(empty.min(), qint64(10));
+}
+
+void tst_MoveLatency::stages()
+{
+	MoveLatency::Timestamps times;
+	QVERIFY(!times.isValid());
+
+	times.clockStarted = 1000;
+	times.goSent = 1100;
+	times.moveReceived = 51100;
+	times.moveParsed = 51400;
+	times.opponentNotified = 52400;
+	QVERIFY(times.isValid());
+
+	MoveLatency latency;
+	latency.add(times);
+	QCOMPARE(latency.count(), quint64(1));
+	QCOMPARE(latency.histogram(MoveLatency::GoStage).max(), qint64(100));
+	QCOMPARE(latency.histogram(MoveLatency::ThinkStage).max(), qint64(50000));
+	QCOMPARE(latency.histogram(MoveLatency::ReadStage).max(), qint64(300));
+	QCOMPARE(latency.histogram(MoveLatency::NotifyStage).max(), qint64(1000));
+	QCOMPARE(latency.histogram(MoveLatency::ClockOverhead).max(), qint64(400));
+
+	times.moveParsed = 100;
+	QVERIFY(!times.isValid());
+}
+
+QTEST_MAIN(tst_MoveLatency)
+#include "tst_movelatency.moc"
@@ -0,0 +1,206 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <openingsuite.h>
+
+class tst_OpeningSuite: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void backgroundIndex();
+		void startIndex_data() const;
+		void startIndex();
+		void staleIndex();
+		void stopIndexing();
+
+	private:
+		QString writeSuite(const QString& name, int count,
+				   int firstRound = 1);
+		bool buildIndex(const QString& fileName);
+		QString round(OpeningSuite& suite);
+
+		QTemporaryDir m_dir;
+};
+
+QString tst_OpeningSuite::writeSuite(const QString& name,
+				     int count,
+				     int firstRound)
+{
+	const QString fileName(m_dir.filePath(name));
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return QString();
+
+	QTextStream out(&file);
+	for (int i = 0; i < count; i++)
+		out << "[Event \"Suite\"]\n"
+		    << "[Round \"" << firstRound + i << "\"]\n\n"
+		    << "1. e4 e5 2. Nf3 *\n\n";
+
+	return fileName;
+}
+
+bool tst_OpeningSuite::buildIndex(const QString& fileName)
+{
+	// In sequential order the index is built in the background
+	OpeningSuite suite(fileName, OpeningSuite::PgnFormat);
+	if (!suite.initialize())
+		return false;
+
+	return QTest::qWaitFor([=]()
+	{
+		return QFile::exists(fileName + ".index");
+	}, 10000);
+}
+
+QString tst_OpeningSuite::round(OpeningSuite& suite)
+{
+	return suite.nextGame(10).tagValue("Round");
+}
+
+void tst_OpeningSuite::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+}
+
+void tst_OpeningSuite::backgroundIndex()
+{
+	const QString fileName(writeSuite("background.pgn", 50));
+	QVERIFY(!fileName.isEmpty());
+	QVERIFY(!QFile::exists(fileName + ".index"));
+
+	// Openings are read while the index is being built
+	OpeningSuite suite(fileName, OpeningSuite::PgnFormat);
+	QVERIFY(suite.initialize());
+	QCOMPARE(round(suite), QString("1"));
+	QCOMPARE(round(suite), QString("2"));
+	QTRY_VERIFY_WITH_TIMEOUT(QFile::exists(fileName + ".index"), 10000);
+	QCOMPARE(round(suite), QString("3"));
+
+	// A random order suite reads every opening through the index
+	OpeningSuite random(fileName, OpeningSuite::PgnFormat,
+			    OpeningSuite::RandomOrder);
+	QVERIFY(random.initialize());
+	QSet<QString> rounds;
+	for (int i = 0; i < 50; i++)
+		rounds.insert(round(random));
+	QCOMPARE(rounds.size(), 50);
+	QVERIFY(!rounds.contains(QString()));
+}
+
+void tst_OpeningSuite::startIndex_data() const
+{
+	QTest::addColumn<int>("start");
+	QTest::addColumn<QString>("first");
+	QTest::addColumn<QString>("second");
+
+	QTest::newRow("first") << 0 << "1" << "2";
+	QTest::newRow("middle") << 7 << "8" << "9";
+	QTest::newRow("last") << 19 << "20" << "1";
+	QTest::newRow("wrapped") << 25 << "6" << "7";
+}
+
+void tst_OpeningSuite::startIndex()
+{
+	QFETCH(int, start);
+	QFETCH(QString, first);
+	QFETCH(QString, second);
+
+	const QString fileName(m_dir.filePath("start.pgn"));
+	if (!QFile::exists(fileName + ".index"))
+	{
+		QCOMPARE(writeSuite("start.pgn", 20), fileName);
+		QVERIFY(buildIndex(fileName));
+	}
+
+	OpeningSuite suite(fileName, OpeningSuite::PgnFormat,
+			   OpeningSuite::SequentialOrder, start);
+	QVERIFY(suite.initialize());
+	QCOMPARE(round(suite), first);
+	QCOMPARE(round(suite), second);
+}
+
+void tst_OpeningSuite::staleIndex()
+{
+	const QString fileName(writeSuite("stale.pgn", 20));
+	QVERIFY(!fileName.isEmpty());
+	QVERIFY(buildIndex(fileName));
+	const QString indexName(fileName + ".index");
+	const qint64 indexSize = QFileInfo(indexName).size();
+
+	// The suite grows by a game, which the old index doesn't have
+	QCOMPARE(writeSuite("stale.pgn", 21, 0), fileName);
+	{
+		OpeningSuite suite(fileName, OpeningSuite::PgnFormat,
+				   OpeningSuite::SequentialOrder, 5);
+		QVERIFY(suite.initialize());
+		QCOMPARE(round(suite), QString("5"));
+
+		// The index is built again for the new suite
+		QTRY_COMPARE_WITH_TIMEOUT(QFileInfo(indexName).size(),
+					  indexSize + 16, 10000);
+	}
+
+	// A suite of the same size that was modified later
+	const QDateTime modified(QFileInfo(fileName).lastModified());
+	QCOMPARE(writeSuite("stale.pgn", 21, 0), fileName);
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.setFileTime(modified.addSecs(60),
+				 QFileDevice::FileModificationTime));
+	file.close();
+
+	// Make the old index easy to tell apart from a new one
+	const QDateTime past(QDate(2000, 1, 1).startOfDay());
+	QFile index(indexName);
+	QVERIFY(index.open(QIODevice::ReadWrite));
+	QVERIFY(index.setFileTime(past, QFileDevice::FileModificationTime));
+	index.close();
+
+	OpeningSuite suite(fileName, OpeningSuite::PgnFormat,
+			   OpeningSuite::SequentialOrder, 5);
+	QVERIFY(suite.initialize());
+	QCOMPARE(round(suite), QString("5"));
+	QTRY_VERIFY_WITH_TIMEOUT(QFileInfo(indexName).lastModified() > past,
+				 10000);
+}
+
+void tst_OpeningSuite::stopIndexing()
+{
+	const QString fileName(writeSuite("stop.pgn", 20000));
+	QVERIFY(!fileName.isEmpty());
+
+	// Destroying the suite stops the background build
+	{
+		OpeningSuite suite(fileName, OpeningSuite::PgnFormat);
+		QVERIFY(suite.initialize());
+		QCOMPARE(round(suite), QString("1"));
+	}
+
+	// An interrupted build leaves nothing behind, and a build that
+	// got to finish left a complete index
+	const QStringList files = QDir(m_dir.path()).entryList(
+		QStringList() << "stop.pgn*", QDir::Files | QDir::Hidden);
+	if (files.size() == 2)
+	{
+		QCOMPARE(files.at(1), QString("stop.pgn.index"));
+		OpeningSuite suite(fileName, OpeningSuite::PgnFormat,
+				   OpeningSuite::SequentialOrder, 19999);
+		QVERIFY(suite.initialize());
+		QCOMPARE(round(suite), QString("20000"));
+	}
+	else
+		QCOMPARE(files, QStringList() << "stop.pgn");
+
+	// Initializing the suite again restarts the build, which can
+	// then run to the end
+	OpeningSuite suite(fileName, OpeningSuite::PgnFormat);
+	QVERIFY(suite.initialize());
+	QVERIFY(suite.initialize());
+	QCOMPARE(round(suite), QString("1"));
+	QTRY_VERIFY_WITH_TIMEOUT(QFile::exists(fileName + ".index"), 30000);
+}
+
+QTEST_MAIN(tst_OpeningSuite)
+#include "tst_openingsuite.moc"
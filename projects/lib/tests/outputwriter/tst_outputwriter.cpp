@@ -0,0 +1,102 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <QRegularExpression>
+#include <outputwriter.h>
+
+class tst_OutputWriter: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void order_data() const;
+		void order();
+		void reopen();
+
+	private:
+		QByteArray readFile(const QString& fileName) const;
+
+		QTemporaryDir m_dir;
+};
+
+QByteArray tst_OutputWriter::readFile(const QString& fileName) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+	return file.readAll();
+}
+
+void tst_OutputWriter::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+}
+
+void tst_OutputWriter::order_data() const
+{
+	QTest::addColumn<int>("batchSize");
+	QTest::addColumn<int>("batchInterval");
+	QTest::addColumn<int>("queueLimit");
+	QTest::addColumn<int>("syncPolicy");
+
+	QTest::newRow("immediate")
+		<< 1 << 0 << 256 << int(OutputWriter::NoSync);
+	QTest::newRow("batch")
+		<< 16 << 0 << 256 << int(OutputWriter::SyncOnClose);
+	QTest::newRow("interval")
+		<< 1000 << 5 << 256 << int(OutputWriter::NoSync);
+	QTest::newRow("full queue")
+		<< 4 << 0 << 1 << int(OutputWriter::SyncOnCommit);
+}
+
+void tst_OutputWriter::order()
+{
+	QFETCH(int, batchSize);
+	QFETCH(int, batchInterval);
+	QFETCH(int, queueLimit);
+	QFETCH(int, syncPolicy);
+
+	const QString fileName(m_dir.filePath(QTest::currentDataTag()));
+	QByteArray expected;
+
+	OutputWriter writer;
+	QVERIFY(!writer.write("no file\n"));
+
+	writer.setFileName(fileName);
+	writer.setBatch(batchSize, batchInterval);
+	writer.setQueueLimit(queueLimit);
+	writer.setSyncPolicy(OutputWriter::SyncPolicy(syncPolicy));
+
+	for (int i = 1; i <= 500; i++)
+	{
+		const QString line = QString("record %1\n").arg(i);
+		QVERIFY(writer.write(line));
+		expected += line.toLatin1();
+	}
+	writer.flush();
+	QCOMPARE(readFile(fileName), expected);
+
+	QVERIFY(writer.write("last\n"));
+	expected += "last\n";
+	writer.close();
+	QCOMPARE(readFile(fileName), expected);
+}
+
+void tst_OutputWriter::reopen()
+{
+	const QString fileName(m_dir.filePath("reopen"));
+
+	OutputWriter writer;
+	writer.setFileName(fileName);
+	QVERIFY(writer.write("first\n"));
+	writer.flush();
+
+	QVERIFY(QFile::remove(fileName));
+	QTest::ignoreMessage(QtWarningMsg, QRegularExpression("does not exist"));
+	QVERIFY(writer.write("second\n"));
+	writer.flush();
+	QCOMPARE(readFile(fileName), QByteArray("second\n"));
+}
+
+QTEST_MAIN(tst_OutputWriter)
+#include "tst_outputwriter.moc"
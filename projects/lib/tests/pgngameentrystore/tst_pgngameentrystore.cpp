@@ -0,0 +1,259 @@
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <pgnstream.h>
+#include <pgngameentrystore.h>
+
+namespace {
+
+const char s_games[] =
+	"[Event \"Blitz\"]\n"
+	"[Site \"Helsinki\"]\n"
+	"[Date \"2023.01.05\"]\n"
+	"[Round \"1\"]\n"
+	"[White \"Engine A\"]\n"
+	"[Black \"Engine B\"]\n"
+	"[Result \"1-0\"]\n\n"
+	"1. e4 e5 1-0\n\n"
+	"[Event \"Blitz\"]\n"
+	"[Site \"Helsinki\"]\n"
+	"[Date \"2023.02.??\"]\n"
+	"[Round \"2.1\"]\n"
+	"[White \"Engine B\"]\n"
+	"[Black \"Engine A\"]\n"
+	"[Result \"0-1\"]\n\n"
+	"1. d4 d5 0-1\n\n"
+	"[Event \"Rapid\"]\n"
+	"[Site \"Espoo\"]\n"
+	"[Date \"2024\"]\n"
+	"[Round \"3\"]\n"
+	"[White \"Engine C\"]\n"
+	"[Black \"Engine A\"]\n"
+	"[Result \"1/2-1/2\"]\n"
+	"[Variant \"crazyhouse\"]\n\n"
+	"1. e4 d5 1/2-1/2\n\n"
+	"[Event \"Rapid\"]\n"
+	"[Site \"Espoo\"]\n"
+	"[Date \"2024.03.01\"]\n"
+	"[Round \"04\"]\n"
+	"[White \"Engine A\"]\n"
+	"[Black \"Engine C\"]\n"
+	"[Result \"*\"]\n\n"
+	"1. c4 *\n\n";
+
+} // anonymous namespace
+
+class tst_PgnGameEntryStore: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void tagValues();
+		void appendStore();
+		void fixedString_data() const;
+		void fixedString();
+		void advanced();
+		void mapStore();
+		void mapDamagedStore();
+
+	private:
+		QList<PgnGameEntry> m_entries;
+		PgnGameEntryStore m_store;
+};
+
+void tst_PgnGameEntryStore::initTestCase()
+{
+	QByteArray data(s_games);
+	QBuffer buffer(&data);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+	PgnStream in(&buffer);
+	PgnGameEntry entry;
+	while (entry.read(in))
+	{
+		m_entries.append(entry);
+		m_store.append(entry);
+	}
+	QCOMPARE(m_store.count(), 4);
+}
+
+void tst_PgnGameEntryStore::tagValues()
+{
+	for (int i = 0; i < m_entries.size(); i++)
+	{
+		const PgnGameEntry& entry = m_entries.at(i);
+		QCOMPARE(m_store.pos(i), entry.pos());
+		QCOMPARE(m_store.lineNumber(i), entry.lineNumber());
+
+		const PgnGameEntry copy(m_store.entry(i));
+		for (int type = 0; type <= PgnGameEntry::VariantTag; type++)
+		{
+			auto tagType = PgnGameEntry::TagType(type);
+			QCOMPARE(m_store.tagValue(i, tagType), entry.tagValue(tagType));
+			QCOMPARE(copy.tagValue(tagType), entry.tagValue(tagType));
+		}
+	}
+}
+
+void tst_PgnGameEntryStore::appendStore()
+{
+	PgnGameEntryStore store;
+	store.append(m_entries.at(3));
+	store.append(m_store);
+
+	QCOMPARE(store.count(), 5);
+	for (int type = 0; type <= PgnGameEntry::VariantTag; type++)
+	{
+		auto tagType = PgnGameEntry::TagType(type);
+		for (int i = 0; i < m_store.count(); i++)
+			QCOMPARE(store.tagValue(i + 1, tagType),
+				 m_store.tagValue(i, tagType));
+	}
+}
+
+void tst_PgnGameEntryStore::fixedString_data() const
+{
+	QTest::addColumn<QString>("pattern");
+	QTest::addColumn<QVector<int>>("games");
+
+	QTest::newRow("empty") << "" << (QVector<int>() << 0 << 1 << 2 << 3);
+	QTest::newRow("player") << "engine c" << (QVector<int>() << 2 << 3);
+	QTest::newRow("site") << "HELSINKI" << (QVector<int>() << 0 << 1);
+	QTest::newRow("date") << "2023.02" << (QVector<int>() << 1);
+	QTest::newRow("round") << "04" << (QVector<int>() << 3);
+	QTest::newRow("result") << "1/2" << (QVector<int>() << 2);
+	QTest::newRow("variant") << "crazy" << (QVector<int>() << 2);
+	QTest::newRow("none") << "Tokyo" << QVector<int>();
+}
+
+void tst_PgnGameEntryStore::fixedString()
+{
+	QFETCH(QString, pattern);
+	QFETCH(QVector<int>, games);
+
+	PgnGameFilter filter(pattern);
+	QCOMPARE(m_store.filter(filter), games);
+	for (int i = 0; i < m_entries.size(); i++)
+		QCOMPARE(m_entries.at(i).match(filter), games.contains(i));
+}
+
+void tst_PgnGameEntryStore::advanced()
+{
+	PgnGameFilter filter;
+	filter.setEvent("blitz");
+	QCOMPARE(m_store.filter(filter), QVector<int>() << 0 << 1);
+
+	filter = PgnGameFilter();
+	filter.setMinDate(QDate(2023, 2, 1));
+	QCOMPARE(m_store.filter(filter), QVector<int>() << 1 << 3);
+
+	filter = PgnGameFilter();
+	filter.setMinRound(2);
+	QCOMPARE(m_store.filter(filter), QVector<int>() << 2 << 3);
+
+	filter = PgnGameFilter();
+	filter.setPlayer("Engine A", Chess::Side::NoSide);
+	filter.setResult(PgnGameFilter::FirstPlayerWins);
+	QCOMPARE(m_store.filter(filter), QVector<int>() << 0 << 1);
+
+	filter = PgnGameFilter();
+	filter.setPlayer("Engine A", Chess::Side::White);
+	filter.setOpponent("Engine B");
+	QCOMPARE(m_store.filter(filter), QVector<int>() << 0);
+
+	// Matcher ranges
+	PgnGameEntryStore::Matcher matcher(m_store, PgnGameFilter());
+	QCOMPARE(matcher.filter(1, 3), QVector<int>() << 1 << 2);
+	QVERIFY(matcher.filter(3, 3).isEmpty());
+}
+
+void tst_PgnGameEntryStore::mapStore()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	const QString fileName(dir.filePath("store.ccdb"));
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	QCOMPARE(file.write("x", 1), qint64(1));
+	QVERIFY(m_store.write(&file));
+	const qint64 size = file.pos();
+	QCOMPARE(file.write("trailer", 7), qint64(7));
+	file.close();
+
+	PgnGameEntryStore store;
+	QVERIFY(!store.map(fileName));
+	qint64 end = 0;
+	QVERIFY(store.map(fileName, 1, &end));
+	QVERIFY(store.isMapped());
+	QCOMPARE(end, size);
+	QCOMPARE(store.count(), m_store.count());
+	for (int i = 0; i < m_store.count(); i++)
+	{
+		QCOMPARE(store.pos(i), m_store.pos(i));
+		for (int type = 0; type <= PgnGameEntry::VariantTag; type++)
+		{
+			auto tagType = PgnGameEntry::TagType(type);
+			QCOMPARE(store.tagValue(i, tagType),
+				 m_store.tagValue(i, tagType));
+		}
+	}
+	QCOMPARE(store.filter(PgnGameFilter("engine c")),
+		 QVector<int>() << 2 << 3);
+
+	// Appending to a mapped store copies the columns to memory
+	store.append(m_entries.at(0));
+	QCOMPARE(store.count(), m_store.count() + 1);
+	QCOMPARE(store.tagValue(4, PgnGameEntry::SiteTag),
+		 m_store.tagValue(0, PgnGameEntry::SiteTag));
+}
+
+void tst_PgnGameEntryStore::mapDamagedStore()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	const QString fileName(dir.filePath("damaged.ccdb"));
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	QVERIFY(m_store.write(&file));
+	file.close();
+
+	// The event column follows the 60-byte header and the
+	// position and line number columns, each 8-byte aligned
+	const qint64 eventPos = 64 + 2 * m_store.count() * 8;
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.seek(eventPos));
+	const quint32 badId = 1000;
+	QCOMPARE(file.write(reinterpret_cast<const char*>(&badId), 4), qint64(4));
+	file.close();
+
+	// The damaged id is only noticed when it's used
+	PgnGameEntryStore store;
+	QVERIFY(store.map(fileName));
+	QVERIFY(store.tagValue(0, PgnGameEntry::EventTag).isEmpty());
+	QCOMPARE(store.tagValue(0, PgnGameEntry::SiteTag),
+		 m_entries.at(0).tagValue(PgnGameEntry::SiteTag));
+	QCOMPARE(store.tagValue(1, PgnGameEntry::EventTag),
+		 m_entries.at(1).tagValue(PgnGameEntry::EventTag));
+
+	PgnGameFilter filter("Blitz");
+	QCOMPARE(store.filter(filter), QVector<int>() << 1);
+	filter = PgnGameFilter();
+	filter.setEvent("blitz");
+	QCOMPARE(store.filter(filter), QVector<int>() << 1);
+
+	// A store cut short fails
+	store = PgnGameEntryStore();
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	QVERIFY(m_store.write(&file));
+	file.close();
+	QVERIFY(store.map(fileName));
+	QVERIFY(file.resize(file.size() - 1));
+	store = PgnGameEntryStore();
+	QVERIFY(!store.map(fileName));
+}
+
+QTEST_MAIN(tst_PgnGameEntryStore)
+#include "tst_pgngameentrystore.moc"
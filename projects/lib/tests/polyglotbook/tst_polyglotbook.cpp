@@ -23,6 +23,11 @@ void tst_PolyglotBook::initialValues()
 	QCOMPARE(book.read("foo.bin"), false);
 	QVERIFY(book.move(1234).isNull());
 	QVERIFY(book.entries(1234).isEmpty());
+
+	book = PolyglotBook(OpeningBook::Mapped);
+	QCOMPARE(book.read("foo.bin"), false);
+	QVERIFY(book.move(1234).isNull());
+	QVERIFY(book.entries(1234).isEmpty());
 }
 
 QMap<QString,quint16> tst_PolyglotBook::entries(const OpeningBook* book,
@@ -72,6 +77,16 @@ void tst_PolyglotBook::startPos()
 
 	entries = this->entries(&book, &board);
 	QCOMPARE(entries, expect);
+
+	// Same test with a memory-mapped book
+	book = PolyglotBook(OpeningBook::Mapped);
+	QVERIFY(book.read(QStringLiteral(CUTECHESS_TEST_DATA_DIR).append("/book_small.bin")));
+
+	entries = this->entries(&book, &board);
+	QCOMPARE(entries, expect);
+	QVERIFY(expect.contains(board.moveString(
+		board.moveFromGenericMove(book.move(board.key())),
+		Chess::Board::StandardAlgebraic)));
 }
 
 QTEST_MAIN(tst_PolyglotBook)
@@ -0,0 +1,111 @@
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <positionindex.h>
+
+class tst_PositionIndex: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void emptyIndex();
+		void lookup_data() const;
+		void lookup();
+		void mergeParts();
+		void serialize();
+};
+
+void tst_PositionIndex::emptyIndex()
+{
+	PositionIndexBuilder builder;
+	PositionIndex index(builder.build());
+	QVERIFY(index.isEmpty());
+	QVERIFY(index.games(1).isEmpty());
+	QCOMPARE(index.gameCount(1), 0);
+}
+
+void tst_PositionIndex::lookup_data() const
+{
+	QTest::addColumn<int>("runSize");
+
+	QTest::newRow("single run") << 1000000;
+	QTest::newRow("many runs") << 7;
+}
+
+void tst_PositionIndex::lookup()
+{
+	QFETCH(int, runSize);
+
+	// Game n has the keys 1000..1000+n and a shared key 5
+	PositionIndexBuilder builder(runSize);
+	for (quint32 game = 0; game < 300; game++)
+	{
+		builder.addPosition(5, game);
+		builder.addPosition(5, game);
+		for (quint32 i = 0; i <= game; i++)
+			builder.addPosition(1000 + i * 997, game);
+	}
+	PositionIndex index(builder.build());
+
+	QCOMPARE(index.positionCount(), 301);
+	QCOMPARE(index.postingCount(), qint64(300 + 300 * 301 / 2));
+	QCOMPARE(index.gameCount(5), 300);
+	QCOMPARE(index.gameCount(4), 0);
+	QCOMPARE(index.gameCount(Q_UINT64_C(0xffffffffffffffff)), 0);
+
+	const auto games = index.games(1000 + 250 * 997);
+	QCOMPARE(games.size(), 50);
+	QCOMPARE(games.first(), quint32(250));
+	QCOMPARE(games.last(), quint32(299));
+	QVERIFY(std::is_sorted(games.begin(), games.end()));
+}
+
+void tst_PositionIndex::mergeParts()
+{
+	PositionIndexBuilder builder;
+	PositionIndexBuilder part1;
+	PositionIndexBuilder part2;
+
+	part1.addPosition(10, 0);
+	part1.addPosition(20, 1);
+	part2.addPosition(10, 0);
+	part2.addPosition(30, 1);
+
+	builder.addIndex(part1, 0);
+	builder.addIndex(part2, 2);
+	PositionIndex index(builder.build());
+
+	QCOMPARE(index.games(10), QVector<quint32>() << 0 << 2);
+	QCOMPARE(index.games(20), QVector<quint32>() << 1);
+	QCOMPARE(index.games(30), QVector<quint32>() << 3);
+}
+
+void tst_PositionIndex::serialize()
+{
+	PositionIndexBuilder builder;
+	for (quint32 game = 0; game < 100; game++)
+		builder.addPosition(quint64(game % 10) << 40, game);
+	PositionIndex index(builder.build());
+
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	QDataStream out(&buffer);
+	index.write(out);
+
+	buffer.seek(0);
+	QDataStream in(&buffer);
+	PositionIndex index2;
+	QVERIFY(index2.read(in));
+	QCOMPARE(index2.positionCount(), 10);
+	QCOMPARE(index2.games(quint64(3) << 40), index.games(quint64(3) << 40));
+
+	// Truncated data
+	QBuffer truncated;
+	truncated.setData(buffer.data().left(buffer.size() - 3));
+	QVERIFY(truncated.open(QIODevice::ReadOnly));
+	QDataStream in2(&truncated);
+	QVERIFY(!index2.read(in2));
+	QCOMPARE(index2.positionCount(), 10);
+}
+
+QTEST_MAIN(tst_PositionIndex)
+#include "tst_positionindex.moc"
@@ -0,0 +1,121 @@
+#include <QtTest/QtTest>
+#include <QSharedPointer>
+#include <pvconverter.h>
+#include <moveevaluation.h>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+class tst_PvConverter: public QObject
+{
+	Q_OBJECT
+
+	public:
+		tst_PvConverter();
+
+	private slots:
+		void sanPv_data() const;
+		void sanPv();
+		void gameProgress();
+		void lazyEval();
+
+		void cleanupTestCase();
+
+	private:
+		Chess::Board* m_board;
+		QString m_startFen;
+};
+
+tst_PvConverter::tst_PvConverter()
+	: m_board(Chess::BoardFactory::create("standard")),
+	  m_startFen(m_board->defaultFenString())
+{
+	m_board->setFenString(m_startFen);
+}
+
+void tst_PvConverter::cleanupTestCase()
+{
+	delete m_board;
+}
+
+void tst_PvConverter::sanPv_data() const
+{
+	QTest::addColumn<QString>("moves");
+	QTest::addColumn<QString>("pv");
+	QTest::addColumn<QString>("san");
+
+	QTest::newRow("startpos")
+		<< ""
+		<< "e2e4 e7e5 g1f3 b8c6 f1b5"
+		<< "e4 e5 Nf3 Nc6 Bb5";
+	QTest::newRow("after moves")
+		<< " e2e4 e7e5"
+		<< "g1f3 b8c6 f1c4 g8f6 f3g5 d7d5"
+		<< "Nf3 Nc6 Bc4 Nf6 Ng5 d5";
+	QTest::newRow("checkmate")
+		<< " f2f3 e7e5 g2g4"
+		<< "d8h4"
+		<< "Qh4#";
+	QTest::newRow("illegal move")
+		<< ""
+		<< "e2e4 e2e4 g1f3"
+		<< "e4";
+	QTest::newRow("whitespace")
+		<< " d2d4"
+		<< "  d7d5   c2c4 "
+		<< "d5 c4";
+}
+
+void tst_PvConverter::sanPv()
+{
+	QFETCH(QString, moves);
+	QFETCH(QString, pv);
+	QFETCH(QString, san);
+
+	PvConverter converter(m_board);
+	QCOMPARE(converter.sanPv(m_startFen, moves, pv), san);
+	// The second conversion comes from the cache
+	QCOMPARE(converter.sanPv(m_startFen, moves, pv), san);
+}
+
+void tst_PvConverter::gameProgress()
+{
+	PvConverter converter(m_board);
+
+	QCOMPARE(converter.sanPv(m_startFen, " e2e4", "e7e5 g1f3"),
+		 QString("e5 Nf3"));
+	QCOMPARE(converter.sanPv(m_startFen, " e2e4 e7e5", "g1f3 b8c6"),
+		 QString("Nf3 Nc6"));
+	QCOMPARE(converter.sanPv(m_startFen, " e2e4 e7e5 g1f3", "b8c6"),
+		 QString("Nc6"));
+
+	// Taking moves back forces a new start from the starting position
+	QCOMPARE(converter.sanPv(m_startFen, " e2e4", "c7c5 g1f3"),
+		 QString("c5 Nf3"));
+	QCOMPARE(converter.sanPv(m_startFen, " d2d4 e7e5", "d4e5"),
+		 QString("dxe5"));
+	QCOMPARE(converter.sanPv(m_startFen, " d2d4 e7e5 d4e5", "d7d6"),
+		 QString("d6"));
+
+	QCOMPARE(converter.sanPv("invalid fen", "", "e2e4"), QString());
+}
+
+void tst_PvConverter::lazyEval()
+{
+	auto converter = QSharedPointer<PvConverter>::create(m_board);
+	MoveEvaluation eval;
+
+	eval.setLanPv("e2e4 e7e5", converter, m_startFen, QString());
+	QCOMPARE(eval.lanPv(), QString("e2e4 e7e5"));
+
+	MoveEvaluation eval2;
+	eval2.merge(eval);
+	QCOMPARE(eval.pv(), QString("e4 e5"));
+	QCOMPARE(eval2.pv(), QString("e4 e5"));
+
+	eval.setPv("d4");
+	QCOMPARE(eval.pv(), QString("d4"));
+	QVERIFY(eval.lanPv().isEmpty());
+}
+
+QTEST_MAIN(tst_PvConverter)
+#include "tst_pvconverter.moc"
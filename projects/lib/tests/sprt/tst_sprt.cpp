@@ -9,6 +9,8 @@ class tst_Sprt: public QObject
 	private slots:
 		void sprt_data() const;
 		void sprt();
+		void gsprt_data() const;
+		void gsprt();
 
 	private:
 		bool fuzzyCompare(double val1, double val2);
@@ -100,5 +102,103 @@ void tst_Sprt::sprt()
 	QVERIFY(fuzzyCompare(status.uBound, ubound));
 }
 
+void tst_Sprt::gsprt_data() const
+{
+	QTest::addColumn<int>("model");
+	QTest::addColumn<double>("elo0");
+	QTest::addColumn<double>("elo1");
+	QTest::addColumn<int>("wins");
+	QTest::addColumn<int>("losses");
+	QTest::addColumn<int>("draws");
+	QTest::addColumn<QList<int>>("pairs");
+	QTest::addColumn<double>("llr");
+
+	QTest::newRow("logistic trinomial")
+		<< int(Sprt::LogisticElo)
+		<< 0.0
+		<< 5.0
+		<< 1477
+		<< 1351
+		<< 2942
+		<< QList<int>()
+		<< 2.48;
+
+	QTest::newRow("logistic pentanomial")
+		<< int(Sprt::LogisticElo)
+		<< 0.0
+		<< 5.0
+		<< 0
+		<< 0
+		<< 0
+		<< (QList<int>() << 30 << 120 << 300 << 180 << 60)
+		<< 3.42;
+
+	QTest::newRow("normalized pentanomial")
+		<< int(Sprt::NormalizedElo)
+		<< 0.0
+		<< 5.0
+		<< 0
+		<< 0
+		<< 0
+		<< (QList<int>() << 30 << 120 << 300 << 180 << 60)
+		<< 2.39;
+
+	QTest::newRow("normalized pentanomial H0")
+		<< int(Sprt::NormalizedElo)
+		<< 0.0
+		<< 5.0
+		<< 0
+		<< 0
+		<< 0
+		<< (QList<int>() << 520 << 4400 << 9500 << 4380 << 500)
+		<< -5.49;
+}
+
+void tst_Sprt::gsprt()
+{
+	QFETCH(int, model);
+	QFETCH(double, elo0);
+	QFETCH(double, elo1);
+	QFETCH(int, wins);
+	QFETCH(int, losses);
+	QFETCH(int, draws);
+	QFETCH(QList<int>, pairs);
+	QFETCH(double, llr);
+
+	Sprt sprt;
+	sprt.initialize(elo0, elo1, 0.05, 0.05, Sprt::EloModel(model));
+
+	for (int i = 0; i < wins; i++)
+		sprt.addGameResult(Sprt::Win);
+	for (int i = 0; i < losses; i++)
+		sprt.addGameResult(Sprt::Loss);
+	for (int i = 0; i < draws; i++)
+		sprt.addGameResult(Sprt::Draw);
+
+	// Pairs scoring 0, 0.5, 1, 1.5 and 2 points
+	const Sprt::GameResult pairResults[][2] = {
+		{ Sprt::Loss, Sprt::Loss },
+		{ Sprt::Loss, Sprt::Draw },
+		{ Sprt::Draw, Sprt::Draw },
+		{ Sprt::Win, Sprt::Draw },
+		{ Sprt::Win, Sprt::Win }
+	};
+	for (int i = 0; i < pairs.size(); i++)
+	{
+		const Sprt::GameResult* pair = pairResults[i];
+		for (int j = 0; j < pairs.at(i); j++)
+		{
+			sprt.addGameResult(pair[0]);
+			sprt.addGameResult(pair[1]);
+			sprt.addGamePairResult(pair[0], pair[1]);
+		}
+	}
+
+	Sprt::Status status = sprt.status();
+	QVERIFY(fuzzyCompare(status.llr, llr));
+	QVERIFY(fuzzyCompare(status.lBound, -2.94));
+	QVERIFY(fuzzyCompare(status.uBound, 2.94));
+}
+
 QTEST_MAIN(tst_Sprt)
 #include "tst_sprt.moc"
@@ -116,6 +116,9 @@ void tst_Tb::positions()
 	unsigned int tbDtz = 0;
 	QCOMPARE(m_board.tablebaseResult(&tbDtz).toShortString(), result);
 	QCOMPARE(int(tbDtz), dtz);
+
+	// Without DTZ only the WDL tables (or the cache) are probed
+	QCOMPARE(m_board.tablebaseResult().toShortString(), result);
 }
 
 QTEST_MAIN(tst_Tb)
@@ -0,0 +1,221 @@
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <roundrobintournament.h>
+#include <tournamentjournal.h>
+#include <gamemanager.h>
+#include <chessgame.h>
+#include <chessplayer.h>
+#include <playerbuilder.h>
+#include <timecontrol.h>
+#include <gameadjudicator.h>
+#include <moveevaluation.h>
+#include <board/board.h>
+
+namespace {
+
+/*!
+ * A player that plays its first legal move after a short delay, so
+ * that a tournament can be stopped while its games are running.
+ */
+class FakePlayer : public ChessPlayer
+{
+	Q_OBJECT
+
+	public:
+		FakePlayer(const QString& name, QObject* parent = nullptr)
+			: ChessPlayer(parent)
+		{
+			setState(Idle);
+			setName(name);
+		}
+
+		virtual void makeMove(const Chess::Move& move)
+		{
+			Q_UNUSED(move);
+		}
+		virtual bool supportsVariant(const QString& variant) const
+		{
+			return variant == "standard";
+		}
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+
+	protected:
+		virtual void startGame()
+		{
+		}
+		virtual void startThinking()
+		{
+			QTimer::singleShot(5, this, [=]()
+			{
+				if (state() != Thinking)
+					return;
+				const auto moves = board()->legalMoves();
+				if (!moves.isEmpty())
+					emitMove(moves.first());
+			});
+		}
+};
+
+class FakeBuilder : public PlayerBuilder
+{
+	public:
+		FakeBuilder(const QString& name)
+			: PlayerBuilder(name)
+		{
+		}
+
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+		virtual ChessPlayer* create(QObject* receiver,
+					    const char* method,
+					    QObject* parent,
+					    QString* error) const
+		{
+			Q_UNUSED(receiver);
+			Q_UNUSED(method);
+			Q_UNUSED(error);
+			return new FakePlayer(name(), parent);
+		}
+};
+
+} // anonymous namespace
+
+class tst_Tournament: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void resumeAfterStop();
+
+	private:
+		Tournament* createTournament(GameManager* manager,
+					     const QString& journalName);
+
+		QTemporaryDir m_dir;
+};
+
+Tournament* tst_Tournament::createTournament(GameManager* manager,
+					     const QString& journalName)
+{
+	Tournament* tournament = new RoundRobinTournament(manager);
+	tournament->setGamesPerEncounter(2);
+	tournament->setRoundMultiplier(2);
+
+	GameAdjudicator adjudicator;
+	adjudicator.setMaximumGameLength(10);
+	tournament->setAdjudicator(adjudicator);
+
+	TimeControl tc;
+	tc.setInfinity();
+	for (const QString& name : {"A", "B", "C"})
+		tournament->addPlayer(new FakeBuilder(name), tc);
+
+	TournamentJournal* journal = new TournamentJournal(journalName);
+	if (!journal->open())
+	{
+		delete journal;
+		delete tournament;
+		return nullptr;
+	}
+	tournament->setJournal(journal);
+
+	return tournament;
+}
+
+void tst_Tournament::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+	qRegisterMetaType<Chess::Move>("Chess::Move");
+	qRegisterMetaType<Chess::Result>("Chess::Result");
+	qRegisterMetaType<MoveEvaluation>("MoveEvaluation");
+}
+
+void tst_Tournament::resumeAfterStop()
+{
+	const QString journalName(m_dir.filePath("resume.journal"));
+	GameManager manager;
+	manager.setConcurrency(2);
+
+	// The white and black player of each finished game by number
+	QMap<int, QPair<int, int>> games;
+	auto onGameFinished = [&](ChessGame* game, int number,
+				  int whiteIndex, int blackIndex)
+	{
+		Q_UNUSED(game);
+		games[number] = qMakePair(whiteIndex, blackIndex);
+	};
+
+	// Stop the first run in the middle of the first round, while
+	// the next game is still being played
+	Tournament* tournament = createTournament(&manager, journalName);
+	QVERIFY(tournament != nullptr);
+	const int finalGameCount = 12;
+	connect(tournament, &Tournament::gameFinished, this, onGameFinished);
+	connect(tournament, &Tournament::gameFinished, this, [=]()
+	{
+		if (tournament->finishedGameCount() == 4)
+			QMetaObject::invokeMethod(tournament, "stop",
+						  Qt::QueuedConnection);
+	});
+	QSignalSpy finishedSpy(tournament, SIGNAL(finished()));
+	tournament->start();
+	QCOMPARE(tournament->finalGameCount(), finalGameCount);
+	QVERIFY(finishedSpy.wait(30000));
+	QVERIFY(tournament->finishedGameCount() < finalGameCount);
+	delete tournament;
+
+	// Only the games with a result are journaled, without gaps
+	int journaledGameCount = 0;
+	{
+		TournamentJournal journal(journalName);
+		QVERIFY(journal.open());
+		for (const auto& record : journal.tail())
+		{
+			QCOMPARE(record.type, TournamentJournal::GameRecord);
+			QVERIFY(!record.data.contains("skipped"));
+			QCOMPARE(record.data.value("number").toInt(),
+				 ++journaledGameCount);
+		}
+	}
+	QVERIFY(journaledGameCount > 0);
+
+	// Games that were not journaled are played again
+	while (!games.isEmpty() && games.lastKey() > journaledGameCount)
+		games.remove(games.lastKey());
+	QCOMPARE(games.size(), journaledGameCount);
+
+	tournament = createTournament(&manager, journalName);
+	QVERIFY(tournament != nullptr);
+	connect(tournament, &Tournament::gameFinished, this, onGameFinished);
+	QSignalSpy resumedSpy(tournament, SIGNAL(finished()));
+	tournament->start();
+	QVERIFY(resumedSpy.wait(30000));
+	QCOMPARE(tournament->finishedGameCount(), finalGameCount);
+	delete tournament;
+
+	// Every game of the schedule was played once, and each
+	// player had both colors against each opponent
+	QCOMPARE(games.size(), finalGameCount);
+	QCOMPARE(games.firstKey(), 1);
+	QCOMPARE(games.lastKey(), finalGameCount);
+	QMap<QPair<int, int>, int> colors;
+	for (const auto& players : qAsConst(games))
+		colors[players]++;
+	QCOMPARE(colors.size(), 6);
+	for (int count : qAsConst(colors))
+		QCOMPARE(count, 2);
+
+	QSignalSpy managerSpy(&manager, SIGNAL(finished()));
+	manager.finish();
+	QVERIFY(managerSpy.count() > 0 || managerSpy.wait(10000));
+}
+
+QTEST_MAIN(tst_Tournament)
+#include "tst_tournament.moc"
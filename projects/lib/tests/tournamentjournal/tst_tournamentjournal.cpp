@@ -0,0 +1,148 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <tournamentjournal.h>
+
+class tst_TournamentJournal: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void emptyJournal();
+		void tail();
+		void incompleteRecord();
+		void trailingGarbage();
+		void invalidJournal();
+
+	private:
+		QString fileName(const QString& name) const;
+		QVariantMap game(int number) const;
+
+		QTemporaryDir m_dir;
+};
+
+QString tst_TournamentJournal::fileName(const QString& name) const
+{
+	return m_dir.filePath(name);
+}
+
+QVariantMap tst_TournamentJournal::game(int number) const
+{
+	QVariantMap map;
+	map["number"] = number;
+	return map;
+}
+
+void tst_TournamentJournal::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+}
+
+void tst_TournamentJournal::emptyJournal()
+{
+	TournamentJournal journal(fileName("empty.journal"));
+	QVERIFY(journal.open());
+	QVERIFY(journal.isEmpty());
+	QVERIFY(journal.header().isEmpty());
+	QVERIFY(journal.tail().isEmpty());
+}
+
+void tst_TournamentJournal::tail()
+{
+	QVariantMap header;
+	header["type"] = "round-robin";
+
+	{
+		TournamentJournal journal(fileName("tail.journal"));
+		QVERIFY(journal.open());
+		QVERIFY(journal.append(TournamentJournal::HeaderRecord, header));
+		QVERIFY(journal.append(TournamentJournal::GameRecord, game(1)));
+		QVERIFY(journal.tail().size() == 1);
+		QVERIFY(journal.append(TournamentJournal::GameRecord, game(2)));
+		QVERIFY(journal.append(TournamentJournal::CheckpointRecord, game(2)));
+		QVERIFY(journal.append(TournamentJournal::GameRecord, game(3)));
+	}
+
+	TournamentJournal journal(fileName("tail.journal"));
+	QVERIFY(journal.open());
+	QVERIFY(!journal.isEmpty());
+	QCOMPARE(journal.header(), header);
+
+	const auto records = journal.tail();
+	QCOMPARE(records.size(), 2);
+	QCOMPARE(records.at(0).type, TournamentJournal::CheckpointRecord);
+	QCOMPARE(records.at(0).data, game(2));
+	QCOMPARE(records.at(1).type, TournamentJournal::GameRecord);
+	QCOMPARE(records.at(1).data, game(3));
+}
+
+void tst_TournamentJournal::incompleteRecord()
+{
+	QString name(fileName("incomplete.journal"));
+	{
+		TournamentJournal journal(name);
+		QVERIFY(journal.open());
+		QVERIFY(journal.append(TournamentJournal::HeaderRecord, game(0)));
+		QVERIFY(journal.append(TournamentJournal::GameRecord, game(1)));
+		QVERIFY(journal.append(TournamentJournal::GameRecord, game(2)));
+	}
+
+	// Cut the last record short
+	QFile file(name);
+	qint64 size = file.size();
+	QVERIFY(file.resize(size - 5));
+
+	TournamentJournal journal(name);
+	QVERIFY(journal.open());
+	QVERIFY(QFile(name).size() < size - 5);
+
+	auto records = journal.tail();
+	QCOMPARE(records.size(), 1);
+	QCOMPARE(records.at(0).data, game(1));
+
+	QVERIFY(journal.append(TournamentJournal::GameRecord, game(2)));
+	records = journal.tail();
+	QCOMPARE(records.size(), 2);
+	QCOMPARE(records.at(1).data, game(2));
+}
+
+void tst_TournamentJournal::trailingGarbage()
+{
+	QString name(fileName("garbage.journal"));
+	{
+		TournamentJournal journal(name);
+		QVERIFY(journal.open());
+		QVERIFY(journal.append(TournamentJournal::HeaderRecord, game(0)));
+		QVERIFY(journal.append(TournamentJournal::GameRecord, game(1)));
+	}
+	qint64 size = QFile(name).size();
+
+	QFile file(name);
+	QVERIFY(file.open(QIODevice::Append));
+	file.write(QByteArray(1000, '\xff'));
+	file.close();
+
+	TournamentJournal journal(name);
+	QVERIFY(journal.open());
+	QCOMPARE(QFile(name).size(), size);
+
+	const auto records = journal.tail();
+	QCOMPARE(records.size(), 1);
+	QCOMPARE(records.at(0).data, game(1));
+}
+
+void tst_TournamentJournal::invalidJournal()
+{
+	QString name(fileName("invalid.journal"));
+	QFile file(name);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write("[Event \"?\"]\n");
+	file.close();
+
+	TournamentJournal journal(name);
+	QVERIFY(!journal.open());
+	QVERIFY(!journal.errorString().isEmpty());
+}
+
+QTEST_MAIN(tst_TournamentJournal)
+#include "tst_tournamentjournal.moc"